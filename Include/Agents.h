@@ -0,0 +1,111 @@
+/**
+ * @file Agents.h
+ * @brief Defines the crowd of simulated visitor agents.
+ *
+ * This header contains the AgentSystem class, which stores many walking agents
+ * as structure-of-arrays data and steps them in parallel on the JobSystem using
+ * the same character controller as the player.
+ */
+
+#pragma once
+#include "Physics.h"
+#include "JobSystem.h"
+#include "Navigation.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class AgentSystem
+ * @brief Structure-of-arrays storage and parallel stepping for visitor agents.
+ *
+ * Agents wander between random goals inside a rectangular area, following
+ * navmesh paths when a PathService is set. Each agent only writes its own slots,
+ * and the broadphase and navmesh are read-only during step(), so chunks of agents
+ * (including their path queries) can be processed concurrently.
+ */
+class AgentSystem {
+public:
+    /**
+     * @brief Sets the rectangle (world XZ) in which agents pick goals.
+     */
+    void setArea(float minX, float minZ, float maxX, float maxZ);
+
+    /**
+     * @brief Adds an agent.
+     * @param x Spawn X.
+     * @param z Spawn Z.
+     * @param body Physical parameters (the agent spawns standing on the floor).
+     * @param speed Walking speed in units per second.
+     * @return The agent's index.
+     */
+    std::size_t add(float x, float z, const CharacterBody& body, float speed);
+
+    /**
+     * @brief Spawns `count` agents at random free spots inside the area.
+     * @return The number of agents actually spawned.
+     */
+    std::size_t spawn(std::size_t count, const Broadphase& broadphase, const CharacterBody& body, float speed);
+
+    /** @brief Number of agents. */
+    std::size_t size() const { return posX.size(); }
+
+    /** @brief Gets an agent's body top position (eye level). */
+    Vec3 getPosition(std::size_t i) const { return { posX[i], posY[i], posZ[i] }; }
+
+    /** @brief Gets an agent's collision radius. */
+    float getRadius(std::size_t i) const { return radius[i]; }
+
+    /** @brief Gets an agent's height. */
+    float getHeight(std::size_t i) const { return height[i]; }
+
+    /** @brief Sends an agent to a new goal. */
+    void setGoal(std::size_t i, float x, float z);
+
+    /**
+     * @brief Makes agents path around obstacles instead of walking straight at goals.
+     * @param service The path service to query (nullptr to steer directly).
+     */
+    void setNavigation(PathService* service) { navigation = service; }
+
+    /**
+     * @brief Steps every agent in parallel.
+     * @param dt Step duration in seconds.
+     * @param broadphase Solid geometry to collide against.
+     * @param pool Worker threads to split the agents across.
+     */
+    void step(float dt, const Broadphase& broadphase, JobSystem& pool);
+
+    /**
+     * @brief Draws every agent as a simple box (opaque pass).
+     */
+    void draw() const;
+
+    /** @brief Wall time of the last step() in milliseconds. */
+    double getLastStepMs() const { return lastStepMs; }
+
+    /** @brief Wall time of the last step() divided by the agent count, in microseconds. */
+    double getCostPerAgentUs() const;
+
+private:
+    // Per-agent state, one entry per agent in each array
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> velocityY;
+    std::vector<float> radius, height, gravity;
+    std::vector<float> speed;
+    std::vector<float> goalX, goalZ;
+    std::vector<float> stuckTime;
+    std::vector<std::uint32_t> rng;
+    std::vector<std::vector<Vec3>> paths;
+    std::vector<std::uint32_t> pathIndex;
+    std::vector<std::uint8_t> needsPath;
+
+    PathService* navigation = nullptr;
+
+    float areaMinX = -10.0f, areaMinZ = -10.0f;
+    float areaMaxX = 10.0f, areaMaxZ = 10.0f;
+    double lastStepMs = 0.0;
+
+    void stepRange(std::size_t begin, std::size_t end, float dt, const Broadphase& broadphase);
+    void pickGoal(std::size_t i);
+    float random01(std::size_t i);
+};
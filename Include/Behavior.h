@@ -0,0 +1,196 @@
+/**
+ * @file Behavior.h
+ * @brief Defines the typed behavior system used to animate GameObjects.
+ *
+ * Behaviors are plain data structs stored contiguously per type in a
+ * BehaviorPool. Each behavior type provides a static batch kernel that updates
+ * every instance of that type in one tight loop, replacing the per-object
+ * update callbacks for common animations (spinning turntables, hinged doors).
+ */
+
+#pragma once
+#include "GameObject.h"
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class IBehaviorPool
+ * @brief Type-erased interface to a pool of behaviors of a single type.
+ */
+class IBehaviorPool {
+public:
+    virtual ~IBehaviorPool() {}
+
+    /**
+     * @brief Runs the batch kernel over every behavior in the pool.
+     * @param deltaTime Time elapsed since the last frame (in seconds).
+     */
+    virtual void update(float deltaTime) = 0;
+};
+
+/**
+ * @class BehaviorPool
+ * @brief Contiguous storage for all behaviors of type T.
+ *
+ * T must be trivially copyable (so its state can be saved and restored as raw
+ * bytes) and must provide:
+ * `static void updateBatch(GameObject* const* owners, T* items, std::size_t count, float dt);`
+ *
+ * @tparam T The behavior data type.
+ */
+template <typename T>
+class BehaviorPool : public IBehaviorPool {
+    static_assert(std::is_trivially_copyable<T>::value, "Behaviors must be plain, serializable data");
+
+private:
+    /** @brief Behavior state, one entry per attachment. */
+    std::vector<T> items;
+
+    /** @brief The object driven by each entry (parallel to items). */
+    std::vector<GameObject*> owners;
+
+public:
+    /** @brief Stable index of a behavior within its pool. */
+    using Handle = std::size_t;
+
+    /**
+     * @brief Attaches a behavior instance to an object.
+     * @param owner The object the behavior drives.
+     * @param behavior Initial behavior state.
+     * @return A handle that remains valid for the lifetime of the pool.
+     */
+    Handle add(GameObject* owner, const T& behavior) {
+        items.push_back(behavior);
+        owners.push_back(owner);
+        return items.size() - 1;
+    }
+
+    /** @brief Accesses the behavior state behind a handle. */
+    T& get(Handle h) { return items[h]; }
+
+    /** @brief Gets the object driven by the behavior behind a handle. */
+    GameObject* getOwner(Handle h) const { return owners[h]; }
+
+    /** @brief Number of behaviors in the pool. */
+    std::size_t size() const { return items.size(); }
+
+    void update(float deltaTime) override {
+        if (!items.empty()) {
+            T::updateBatch(owners.data(), items.data(), items.size(), deltaTime);
+        }
+    }
+};
+
+/**
+ * @class BehaviorSystem
+ * @brief Owns one BehaviorPool per behavior type and updates them each frame.
+ */
+class BehaviorSystem {
+private:
+    /** @brief Pools indexed by behavior type id (nullptr for unused ids). */
+    std::vector<std::unique_ptr<IBehaviorPool>> pools;
+
+    /** @brief Allocates the next free behavior type id. */
+    static std::size_t nextTypeId();
+
+    /** @brief Returns the process-wide id assigned to behavior type T. */
+    template <typename T>
+    static std::size_t typeId() {
+        static const std::size_t id = nextTypeId();
+        return id;
+    }
+
+public:
+    /**
+     * @brief Gets (creating on first use) the pool for behavior type T.
+     * @return A reference to the pool.
+     */
+    template <typename T>
+    BehaviorPool<T>& pool() {
+        std::size_t id = typeId<T>();
+        if (id >= pools.size()) pools.resize(id + 1);
+        if (!pools[id]) pools[id].reset(new BehaviorPool<T>());
+        return *static_cast<BehaviorPool<T>*>(pools[id].get());
+    }
+
+    /**
+     * @brief Attaches a behavior to an object.
+     * * Also records a BehaviorRef on the owner's entity so ECS systems can
+     * find the behavior driving it.
+     * @param owner The object the behavior drives.
+     * @param behavior Initial behavior state.
+     * @return A handle into the pool for type T.
+     */
+    template <typename T>
+    typename BehaviorPool<T>::Handle attach(GameObject* owner, const T& behavior) {
+        typename BehaviorPool<T>::Handle h = pool<T>().add(owner, behavior);
+        BehaviorRef ref;
+        ref.type = (std::uint32_t)typeId<T>();
+        ref.handle = (std::uint32_t)h;
+        world().behaviors.emplace(owner->getEntity(), ref);
+        return h;
+    }
+
+    /**
+     * @brief Runs every pool's batch kernel.
+     * @param deltaTime Time elapsed since the last frame (in seconds).
+     */
+    void update(float deltaTime);
+};
+
+// --- Built-in behaviors ---
+
+/**
+ * @struct SpinBehavior
+ * @brief Rotates an object around its own vertical axis (e.g., a car turntable).
+ */
+struct SpinBehavior {
+    /** @brief Rotation speed in degrees per second. */
+    float speed = 20.0f;
+
+    static void updateBatch(GameObject* const* owners, SpinBehavior* items, std::size_t count, float dt);
+};
+
+/**
+ * @struct HingedDoorBehavior
+ * @brief Swings a door around a vertical hinge towards a target angle.
+ *
+ * The hinge is expressed in the coordinate space of the door's parent, matching
+ * GameObject::rotateAround().
+ */
+struct HingedDoorBehavior {
+    /** @brief Hinge X coordinate in the parent's space. */
+    float hingeX = 0.0f;
+    /** @brief Hinge Z coordinate in the parent's space. */
+    float hingeZ = 0.0f;
+    /** @brief Angle the door opens to, in degrees (sign picked on open). */
+    float openAngle = 90.0f;
+    /** @brief Swing speed in degrees per second. */
+    float speed = 120.0f;
+    /** @brief Current swing angle in degrees. */
+    float currentAngle = 0.0f;
+    /** @brief Angle the door is animating towards, in degrees. */
+    float targetAngle = 0.0f;
+
+    /** @brief Returns true if the door is open or opening. */
+    bool isOpen() const;
+
+    /**
+     * @brief Opens the door away from a viewer standing at (viewerX, viewerZ).
+     * @param door The door object (used to determine its facing).
+     */
+    void open(const GameObject* door, float viewerX, float viewerZ);
+
+    /** @brief Closes the door. */
+    void close() { targetAngle = 0.0f; }
+
+    /**
+     * @brief Opens the door if it is closed, or closes it if it is open.
+     * @param door The door object (used to determine its facing).
+     */
+    void toggle(const GameObject* door, float viewerX, float viewerZ);
+
+    static void updateBatch(GameObject* const* owners, HingedDoorBehavior* items, std::size_t count, float dt);
+};
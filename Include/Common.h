@@ -2,13 +2,15 @@
  * @file Common.h
  * @brief Defines common helper structures and the Material system for the graphics engine.
  *
- * This header contains utility structures for 3D math (Vec3) and a comprehensive
+ * This header contains utility structures for 3D math (Vec3, AABB) and a comprehensive
  * Material structure that wraps OpenGL material properties and provides factory
- * methods for common surface types.
+ * methods for common surface types, plus the MaterialLibrary that interns them.
  */
 
 #pragma once
 #include <GL/freeglut.h>
+#include <cstddef>
+#include <cstdint>
 
 /**
  * @struct Vec3
@@ -20,6 +22,22 @@ struct Vec3 {
     float z; /**< The Z coordinate. */
 };
 
+/**
+ * @struct AABB
+ * @brief An axis-aligned bounding box in world space.
+ */
+struct AABB {
+    Vec3 min; /**< Minimum corner. */
+    Vec3 max; /**< Maximum corner. */
+
+    /** @brief Checks if two boxes overlap (touching counts as overlapping). */
+    bool overlaps(const AABB& o) const {
+        return min.x <= o.max.x && max.x >= o.min.x &&
+               min.y <= o.max.y && max.y >= o.min.y &&
+               min.z <= o.max.z && max.z >= o.min.z;
+    }
+};
+
 /**
  * @struct Material
  * @brief Encapsulates standard OpenGL material properties.
@@ -44,6 +62,9 @@ struct Material {
     /** @brief Specular shininess factor. Higher values create smaller, sharper highlights. */
     float shininess = 0.0f;
 
+    /** @brief Opacity of the environment reflection from the nearest probe (0 = none). */
+    float reflectivity = 0.0f;
+
     /**
      * @brief Applies the material properties to the current OpenGL state.
      * * Handles `glMaterialfv` calls for all components and automatically enables
@@ -104,3 +125,30 @@ struct Material {
      */
     static Material CreateMatte(float r, float g, float b);
 };
+
+/**
+ * @class MaterialLibrary
+ * @brief Interns Materials so that renderables can refer to them by a small ID.
+ *
+ * Identical materials share one ID, which lets draw lists sort and batch by
+ * material. ID 0 is always the default Material.
+ */
+class MaterialLibrary {
+public:
+    /**
+     * @brief Returns the ID of a material, adding it on first use.
+     * @param m The material to intern.
+     * @return A stable material ID.
+     */
+    static std::uint32_t add(const Material& m);
+
+    /**
+     * @brief Looks up a material by ID.
+     * @param id An ID returned by add().
+     * @return A reference valid until the next call to add().
+     */
+    static const Material& get(std::uint32_t id);
+
+    /** @brief Number of distinct materials interned so far. */
+    static std::size_t count();
+};
@@ -9,6 +9,8 @@
 
 #pragma once
 #include "GameObject.h"
+#include "HLOD.h"
+#include <memory>
 #include <vector>
 
 /**
@@ -24,6 +26,19 @@ private:
     /** @brief The list of child objects managed by this container. */
     std::vector<GameObject*> children;
 
+    /** @brief Simplified stand-in for the children when far away (may be null). */
+    std::shared_ptr<HLODProxy> hlod;
+
+    /**
+     * @brief Checks if the HLOD proxy replaces the children for this draw.
+     */
+    bool useHLOD() const;
+
+    /**
+     * @brief Checks if the HLOD proxy's bounds pass the render context's cull frustum.
+     */
+    bool hlodVisible() const;
+
 public:
     /** @brief Default constructor. */
     Container();
@@ -36,11 +51,27 @@ public:
     /**
      * @brief Adds a child object to the container.
      * * The container takes ownership of the child. The child's parent pointer
-     * is updated to point to this container.
+     * is updated to point to this container, and if the container is in the
+     * scene, the child's subtree enters it too.
      * * @param child Pointer to the GameObject to add.
      */
     void addChild(GameObject* child);
 
+    /**
+     * @brief Detaches a child from the container.
+     * * Ownership passes back to the caller and the child's parent is cleared.
+     * The child's subtree leaves the scene, so lookups no longer find it.
+     * @param child Pointer to the GameObject to remove.
+     * @return True if the child was found and removed.
+     */
+    bool removeChild(GameObject* child);
+
+    /** @brief Enters the scene together with every descendant. */
+    void enterScene() override;
+
+    /** @brief Leaves the scene together with every descendant. */
+    void leaveScene() override;
+
     /**
      * @brief Renders the container and all its children.
      * * Applies the container's local transformation matrix and then iterates
@@ -80,17 +111,28 @@ public:
      */
     const std::vector<GameObject*>& getChildren() const { return children; }
 
+    /**
+     * @brief Sets the HLOD proxy drawn instead of the children at a distance.
+     * @param proxy The proxy (captured in this container's local space), or null.
+     */
+    void setHLOD(std::shared_ptr<HLODProxy> proxy) { hlod = std::move(proxy); }
+
+    /** @brief Gets the HLOD proxy (null if none was built). */
+    const std::shared_ptr<HLODProxy>& getHLOD() const { return hlod; }
+
     /**
      * @brief Renders only the opaque children in the hierarchy.
      * * Helper method for multi-pass rendering. Recursively calls itself for
-     * child Containers and calls draw() on non-transparent leaf nodes.
+     * child Containers and calls draw() on non-transparent leaf nodes. In the
+     * main view, subtrees the OcclusionCuller finds hidden are skipped.
      */
     void drawOpaqueChildren();
 
     /**
      * @brief Renders only the transparent children in the hierarchy.
      * * Helper method for multi-pass rendering. Recursively calls itself for
-     * child Containers and calls draw() on transparent leaf nodes.
+     * child Containers and calls draw() on transparent leaf nodes. Subtrees
+     * skipped by the opaque pass are skipped here too.
      */
     void drawTransparentChildren();
 };
@@ -0,0 +1,136 @@
+/**
+ * @file CookedAsset.h
+ * @brief Defines the cooked mesh format and its vertex/index codecs.
+ *
+ * This header contains the compressed representation Model caches next to each
+ * imported file, so later runs skip the importer. Vertex attributes are quantized
+ * to 16 bits (positions and texture coordinates within their bounds, normals
+ * octahedral-encoded), then each component is delta and zigzag coded and
+ * bit-packed in blocks of 16 values; indices are delta coded as variable-length
+ * integers. Decoding unpacks, integrates and dequantizes with SSE2, and every
+ * stream of every mesh is decoded as its own job, straight into the arrays the
+ * model draws from.
+ */
+
+#pragma once
+#include "Common.h"
+#include "JobSystem.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct MeshStreams
+ * @brief Geometry data for a single sub-mesh.
+ */
+struct MeshStreams {
+    std::vector<float> vertices;       /**< Flattened list of vertex positions (x, y, z). */
+    std::vector<float> normals;        /**< Flattened list of vertex normals (x, y, z); may be empty. */
+    std::vector<float> texCoords;      /**< Flattened list of texture coordinates (u, v). */
+    std::vector<unsigned int> indices; /**< Indices for indexed drawing. */
+    unsigned int materialIndex = 0;    /**< Index into the owner's material and texture arrays. */
+};
+
+/**
+ * @struct CookedMaterial
+ * @brief A material and the diffuse texture it names (relative to the model).
+ */
+struct CookedMaterial {
+    Material material;
+    std::string texture;  /**< Empty if untextured. */
+};
+
+/**
+ * @struct CookedSource
+ * @brief A file an asset was built from and its write time when it was cooked.
+ */
+struct CookedSource {
+    std::string path;
+    std::int64_t writeTime = 0;  /**< file_time_type ticks since its epoch. */
+};
+
+/**
+ * @struct CookedAsset
+ * @brief Everything Model keeps from an imported file.
+ */
+struct CookedAsset {
+    std::vector<CookedMaterial> materials;
+    std::vector<MeshStreams> meshes;
+    std::vector<CookedSource> sources;  /**< The model file, its sidecars and textures. */
+};
+
+/**
+ * @brief Records a file's current write time.
+ * @param path File to stamp.
+ * @param source Receives the path and write time.
+ * @return False if the file cannot be queried.
+ */
+bool stampCookedSource(const std::string& path, CookedSource& source);
+
+/**
+ * @struct CookStats
+ * @brief Size and decode throughput of a cooked asset.
+ */
+struct CookStats {
+    std::size_t rawBytes = 0;      /**< Size of the decoded float and index arrays. */
+    std::size_t cookedBytes = 0;   /**< Size of the cooked file. */
+    double decodeMs = 0.0;         /**< Wall time of the parallel decode (excludes reading the file). */
+
+    /** @brief Decoded megabytes per second. */
+    double decodeMBps() const { return decodeMs > 0.0 ? rawBytes / (decodeMs * 1000.0) : 0.0; }
+};
+
+/**
+ * @brief Cooks an asset and writes it to disk.
+ * @param path Output file.
+ * @param asset The imported asset.
+ * @param stats Receives the sizes (optional).
+ * @return False if the file could not be written.
+ */
+bool writeCookedAsset(const std::string& path, const CookedAsset& asset, CookStats* stats = nullptr);
+
+/**
+ * @brief Reads a cooked asset, decoding its streams in parallel.
+ * @param path Cooked file.
+ * @param asset Receives the decoded asset.
+ * @param pool Worker threads to decode on.
+ * @param stats Receives the sizes and decode time (optional).
+ * @return False if the file is missing, from another format version, corrupt, or
+ * stale (a source file was changed or removed since it was cooked).
+ */
+bool readCookedAsset(const std::string& path, CookedAsset& asset, JobSystem& pool, CookStats* stats = nullptr);
+
+/**
+ * @namespace MeshCodec
+ * @brief The stream codecs used by cooked assets.
+ */
+namespace MeshCodec {
+
+/** @brief Values per bit-packed block. */
+const std::size_t BlockSize = 16;
+
+/**
+ * @brief Delta, zigzag and block bit-pack codes a stream of 16-bit values.
+ * @param values Input values.
+ * @param count Number of values.
+ * @param out Receives the encoded bytes (appended).
+ */
+void encodeChannel(const std::uint16_t* values, std::size_t count, std::vector<std::uint8_t>& out);
+
+/**
+ * @brief Decodes a stream written by encodeChannel().
+ * @param data Encoded bytes.
+ * @param size Number of encoded bytes.
+ * @param values Receives `count` values.
+ * @param count Number of values.
+ * @return False if the data is truncated.
+ */
+bool decodeChannel(const std::uint8_t* data, std::size_t size, std::uint16_t* values, std::size_t count);
+
+/** @brief Delta codes indices as zigzag variable-length integers (appended to out). */
+void encodeIndices(const unsigned int* indices, std::size_t count, std::vector<std::uint8_t>& out);
+
+/** @brief Decodes `count` indices written by encodeIndices(). @return False if truncated. */
+bool decodeIndices(const std::uint8_t* data, std::size_t size, unsigned int* indices, std::size_t count);
+
+} // namespace MeshCodec
@@ -0,0 +1,125 @@
+/**
+ * @file Delegate.h
+ * @brief Defines a small-buffer, non-allocating callable wrapper.
+ *
+ * This header contains the Delegate template, a drop-in replacement for
+ * std::function for the engine's per-object callbacks. The callable is always
+ * stored inline; a lambda whose captures do not fit is rejected at compile time
+ * instead of silently falling back to the heap.
+ */
+
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, std::size_t Capacity = 32>
+class Delegate;
+
+/**
+ * @class Delegate
+ * @brief A type-erased callable with fixed inline storage.
+ *
+ * Copying, moving and invoking a Delegate never allocates. Invocation costs a
+ * single indirect call through a per-type trampoline.
+ *
+ * @tparam R Return type of the call.
+ * @tparam Args Argument types of the call.
+ * @tparam Capacity Size in bytes of the inline capture storage.
+ */
+template <typename R, typename... Args, std::size_t Capacity>
+class Delegate<R(Args...), Capacity> {
+private:
+    /** @brief Per-type operations used to manage the stored callable. */
+    struct Ops {
+        R (*invoke)(void* target, Args... args);
+        void (*copy)(void* dst, const void* src);
+        void (*destroy)(void* target);
+    };
+
+    template <typename F>
+    static const Ops* opsFor() {
+        static const Ops ops = {
+            [](void* target, Args... args) -> R {
+                return (*static_cast<F*>(target))(std::forward<Args>(args)...);
+            },
+            [](void* dst, const void* src) {
+                new (dst) F(*static_cast<const F*>(src));
+            },
+            [](void* target) {
+                static_cast<F*>(target)->~F();
+            }
+        };
+        return &ops;
+    }
+
+    /** @brief Inline storage for the callable's captures. */
+    alignas(std::max_align_t) unsigned char storage[Capacity];
+
+    /** @brief Operations for the stored type (nullptr when empty). */
+    const Ops* ops = nullptr;
+
+public:
+    /** @brief Constructs an empty delegate. */
+    Delegate() {}
+
+    /** @brief Constructs an empty delegate (allows `= nullptr`). */
+    Delegate(std::nullptr_t) {}
+
+    /**
+     * @brief Constructs a delegate from any callable object.
+     * @param f The lambda or function object to store.
+     */
+    template <typename F, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<F>::type, Delegate>::value &&
+        !std::is_same<typename std::decay<F>::type, std::nullptr_t>::value>::type>
+    Delegate(F&& f) {
+        using Fn = typename std::decay<F>::type;
+        static_assert(sizeof(Fn) <= Capacity, "Delegate: callable captures exceed the inline buffer");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "Delegate: callable is over-aligned");
+        new (storage) Fn(std::forward<F>(f));
+        ops = opsFor<Fn>();
+    }
+
+    Delegate(const Delegate& other) {
+        if (other.ops) {
+            other.ops->copy(storage, other.storage);
+            ops = other.ops;
+        }
+    }
+
+    Delegate& operator=(const Delegate& other) {
+        if (this != &other) {
+            reset();
+            if (other.ops) {
+                other.ops->copy(storage, other.storage);
+                ops = other.ops;
+            }
+        }
+        return *this;
+    }
+
+    Delegate& operator=(std::nullptr_t) {
+        reset();
+        return *this;
+    }
+
+    ~Delegate() { reset(); }
+
+    /** @brief Destroys the stored callable, leaving the delegate empty. */
+    void reset() {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+    /** @brief Invokes the stored callable. The delegate must not be empty. */
+    R operator()(Args... args) const {
+        return ops->invoke(const_cast<unsigned char*>(storage), std::forward<Args>(args)...);
+    }
+
+    /** @brief Returns true if a callable is stored. */
+    explicit operator bool() const { return ops != nullptr; }
+};
@@ -0,0 +1,74 @@
+/**
+ * @file DynamicResolution.h
+ * @brief Defines frame-time driven dynamic resolution scaling.
+ *
+ * This header contains the DynamicResolution class. When the measured frame time
+ * exceeds the budget, the 3D scene is drawn into an offscreen target at a reduced
+ * resolution and stretched to the window; anything drawn after end() stays at
+ * native resolution. A controller revisits the scale every few frames, with a
+ * dead band and a cooldown so it settles instead of oscillating.
+ */
+
+#pragma once
+#include <GL/freeglut.h>
+
+/**
+ * @class DynamicResolution
+ * @brief Resolution controller and the offscreen scene target.
+ */
+class DynamicResolution {
+public:
+    /** @brief Frames averaged before each decision. */
+    static const int EvaluationFrames = 8;
+
+    /**
+     * @brief Feeds one frame time to the controller.
+     * @param frameMs Duration of the last frame in milliseconds.
+     * @param budgetMs Target frame time in milliseconds.
+     * @param minScale Lowest allowed scale (fraction of the window per axis).
+     */
+    void update(double frameMs, double budgetMs, float minScale);
+
+    /**
+     * @brief Redirects scene drawing into the scaled target.
+     * * Does nothing (and returns false) at full scale, or if framebuffer objects
+     * are unavailable; the scene is then drawn straight to the window.
+     * @param windowWidth Window width in pixels.
+     * @param windowHeight Window height in pixels.
+     * @return True if end() must be called after the scene is drawn.
+     */
+    bool begin(int windowWidth, int windowHeight);
+
+    /**
+     * @brief Stretches the scaled scene over the window (bilinear filtering).
+     */
+    void end();
+
+    /** @brief Current scale (1 = native resolution). */
+    float getScale() const { return scale; }
+
+    /** @brief Forces a scale (e.g., when the controller is disabled). */
+    void setScale(float s) { scale = s; }
+
+private:
+    float scale = 1.0f;
+    double accumulatedMs = 0.0;
+    int frames = 0;
+    int cooldown = 0;               /**< Evaluations to skip after a change. */
+
+    int state = -1;                 /**< -1 not initialized, 0 unsupported, 1 ready. */
+    int targetWidth = 0, targetHeight = 0;
+    int sceneWidth = 0, sceneHeight = 0;
+    GLint windowViewport[4] = { 0, 0, 0, 0 };
+    GLint previousFramebuffer = 0;  /**< Restored by end() (the window, or a capture target). */
+    GLuint framebuffer = 0;
+    GLuint colorTexture = 0;
+    GLuint depthTexture = 0;
+
+    bool resize(int w, int h);
+};
+
+/**
+ * @brief Gets the engine-wide dynamic resolution controller.
+ */
+DynamicResolution& dynamicResolution();
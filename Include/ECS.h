@@ -0,0 +1,215 @@
+/**
+ * @file ECS.h
+ * @brief Defines the entity-component storage that backs every GameObject.
+ *
+ * This header contains the sparse-set ComponentPool, the core component types
+ * (Transform, WorldMatrix, Renderable, Collider, BehaviorRef) and the Registry
+ * that owns them. GameObject, Container and CollisionBox remain the scene-building
+ * API; they are thin facades that read and write these dense arrays, so systems
+ * such as transform propagation can iterate tightly packed data.
+ */
+
+#pragma once
+#include "Common.h"
+#include <cstdint>
+#include <vector>
+
+class GameObject;
+
+/** @brief Identifier of an entity in the Registry. */
+using Entity = std::uint32_t;
+
+/** @brief Sentinel value for "no entity". */
+const Entity NullEntity = 0xFFFFFFFFu;
+
+/**
+ * @class ComponentPool
+ * @brief Sparse-set storage for a single component type.
+ *
+ * Components are kept densely packed in insertion order; removal swaps the last
+ * element into the hole, so iteration never visits gaps. Lookup by entity is O(1)
+ * through the sparse index.
+ *
+ * @tparam T The component type.
+ */
+template <typename T>
+class ComponentPool {
+private:
+    static constexpr std::uint32_t Invalid = 0xFFFFFFFFu;
+
+    /** @brief Maps an entity to its index in dense/data (or Invalid). */
+    std::vector<std::uint32_t> sparse;
+    /** @brief The entity owning each packed component. */
+    std::vector<Entity> dense;
+    /** @brief The packed component values. */
+    std::vector<T> data;
+
+public:
+    /** @brief Checks if the entity has this component. */
+    bool has(Entity e) const {
+        return e < sparse.size() && sparse[e] != Invalid;
+    }
+
+    /** @brief Accesses the component of an entity. The entity must have one. */
+    T& get(Entity e) { return data[sparse[e]]; }
+    /** @brief Accesses the component of an entity. The entity must have one. */
+    const T& get(Entity e) const { return data[sparse[e]]; }
+
+    /** @brief Returns the component of an entity, or nullptr if it has none. */
+    T* tryGet(Entity e) { return has(e) ? &data[sparse[e]] : nullptr; }
+    /** @brief Returns the component of an entity, or nullptr if it has none. */
+    const T* tryGet(Entity e) const { return has(e) ? &data[sparse[e]] : nullptr; }
+
+    /**
+     * @brief Adds (or overwrites) the component of an entity.
+     * @return A reference to the stored component.
+     */
+    T& emplace(Entity e, const T& value = T()) {
+        if (has(e)) {
+            data[sparse[e]] = value;
+            return data[sparse[e]];
+        }
+        if (e >= sparse.size()) sparse.resize(e + 1, Invalid);
+        sparse[e] = (std::uint32_t)dense.size();
+        dense.push_back(e);
+        data.push_back(value);
+        return data.back();
+    }
+
+    /** @brief Removes the component of an entity, if present. */
+    void remove(Entity e) {
+        if (!has(e)) return;
+        std::uint32_t idx = sparse[e];
+        std::uint32_t last = (std::uint32_t)dense.size() - 1;
+        if (idx != last) {
+            dense[idx] = dense[last];
+            data[idx] = data[last];
+            sparse[dense[idx]] = idx;
+        }
+        dense.pop_back();
+        data.pop_back();
+        sparse[e] = Invalid;
+    }
+
+    /** @brief Number of packed components. */
+    std::size_t size() const { return data.size(); }
+
+    /** @brief Packed component values (size() entries). */
+    T* components() { return data.data(); }
+    /** @brief Packed component values (size() entries). */
+    const T* components() const { return data.data(); }
+
+    /** @brief Owning entity of each packed component (size() entries). */
+    const Entity* entities() const { return dense.data(); }
+};
+
+// --- Components ---
+
+/**
+ * @struct Transform
+ * @brief Local position, rotation (Euler degrees) and scale relative to the parent.
+ */
+struct Transform {
+    Vec3 position = { 0, 0, 0 };
+    Vec3 rotation = { 0, 0, 0 };
+    Vec3 scale = { 1, 1, 1 };
+    /** @brief Parent entity (NullEntity for roots). */
+    Entity parent = NullEntity;
+};
+
+/**
+ * @struct WorldMatrix
+ * @brief Column-major 4x4 local-to-world matrix, laid out like OpenGL's.
+ *
+ * Written by propagateTransforms(); matches the glTranslate/glRotate/glScale
+ * sequence used by GameObject::draw().
+ */
+struct WorldMatrix {
+    float m[16];
+
+    /** @brief Transforms a point by this matrix. */
+    Vec3 transformPoint(Vec3 p) const {
+        return { m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+                 m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+                 m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14] };
+    }
+};
+
+/**
+ * @struct Renderable
+ * @brief Marks an entity that draws geometry.
+ */
+struct Renderable {
+    /** @brief The object whose drawMesh() produces the geometry. */
+    GameObject* object = nullptr;
+    /** @brief Index into the MaterialLibrary. */
+    std::uint32_t materialId = 0;
+    /** @brief Drawn by the IndirectScene in the opaque pass (see RenderContext::indirect). */
+    bool indirect = false;
+};
+
+/**
+ * @struct Collider
+ * @brief Box collider dimensions in the entity's local space.
+ */
+struct Collider {
+    float width = 0.0f;
+    float height = 0.0f;
+    float depth = 0.0f;
+    /** @brief Triggers report overlaps but never block movement. */
+    bool trigger = false;
+};
+
+/**
+ * @struct BehaviorRef
+ * @brief Links an entity to its behavior in the BehaviorSystem.
+ */
+struct BehaviorRef {
+    /** @brief Behavior type id (see BehaviorSystem). */
+    std::uint32_t type = 0;
+    /** @brief Handle into that type's pool. */
+    std::uint32_t handle = 0;
+};
+
+/**
+ * @class Registry
+ * @brief Allocates entities and owns the component pools.
+ */
+class Registry {
+private:
+    /** @brief Destroyed entity ids available for reuse. */
+    std::vector<Entity> freeIds;
+    /** @brief Next never-used entity id. */
+    Entity nextId = 0;
+
+public:
+    ComponentPool<Transform> transforms;
+    ComponentPool<WorldMatrix> worldMatrices;
+    ComponentPool<Renderable> renderables;
+    ComponentPool<Collider> colliders;
+    ComponentPool<BehaviorRef> behaviors;
+
+    /** @brief Creates a new entity with a default Transform and WorldMatrix. */
+    Entity create();
+
+    /** @brief Destroys an entity and removes all of its components. */
+    void destroy(Entity e);
+};
+
+/**
+ * @brief Gets the registry shared by the whole scene.
+ *
+ * The registry is intentionally never destroyed so that objects living in
+ * static storage (e.g., the global light list) can be torn down safely at exit.
+ */
+Registry& world();
+
+// --- Systems ---
+
+/**
+ * @brief Recomputes the WorldMatrix of every entity from the Transform hierarchy.
+ *
+ * Entities are processed level by level (roots first), so each level only reads
+ * matrices finished by the previous one and can be split across threads.
+ */
+void propagateTransforms(Registry& reg);
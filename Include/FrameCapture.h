@@ -0,0 +1,133 @@
+/**
+ * @file FrameCapture.h
+ * @brief Defines asynchronous capture of rendered frames to image sequences.
+ *
+ * This header contains the FrameCapture class. Each captured frame is read back
+ * into one of a small ring of pixel buffer objects and fenced; the buffer is
+ * mapped a few frames later, once the GPU has finished the copy, so the render
+ * loop never waits for glReadPixels. Mapped frames are handed to a pool of
+ * encoder threads of its own (not the engine's job system, whose parallel loops
+ * the frame waits on), which encodes them as numbered PNG files or appends them
+ * (in order) to a raw Y4M video. For headless runs, frames can be rendered into an offscreen target
+ * of a fixed size instead of the window.
+ */
+
+#pragma once
+#include "JobSystem.h"
+#include <GL/freeglut.h>
+#include <GL/glext.h>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** @brief Output format of a capture. */
+enum class CaptureFormat { Png, Y4m };
+
+/**
+ * @class FrameCapture
+ * @brief Pipelined frame readback and background encoding.
+ */
+class FrameCapture {
+public:
+    /** @brief Pixel buffers in the readback ring (frames are mapped this many frames late). */
+    static const int RingSize = 3;
+
+    /** @brief Frames being encoded at most; capture waits for the encoder beyond that. */
+    static const int MaxFramesInFlight = 8;
+
+    ~FrameCapture();
+
+    /**
+     * @brief Starts a capture.
+     * @param path Directory for PNG frames (frame_000000.png, ...), or the Y4M file.
+     * @param format Output format.
+     * @param fps Frame rate recorded in the Y4M header.
+     * @return False if the output could not be opened.
+     */
+    bool start(const std::string& path, CaptureFormat format, int fps);
+
+    /**
+     * @brief Reads back every frame still in flight, waits for the encoder and
+     * closes the output.
+     */
+    void stop();
+
+    /** @brief Whether a capture is running. */
+    bool isActive() const { return active; }
+
+    /**
+     * @brief Redirects the frame into an offscreen target (for headless runs).
+     * * Call at the start of the frame; everything up to the end of the
+     * frame is drawn into it.
+     * @return False if framebuffers are unavailable (the window is used).
+     */
+    bool beginOffscreen(int width, int height);
+
+    /** @brief Restores the window as the render target. */
+    void endOffscreen();
+
+    /**
+     * @brief Queues the finished frame for readback.
+     * * Call after the frame is complete, before the buffers are swapped. Reads
+     * from the offscreen target if beginOffscreen() is active.
+     * @param width Frame width in pixels.
+     * @param height Frame height in pixels.
+     */
+    void captureFrame(int width, int height);
+
+    /** @brief Frames handed to the encoder so far. */
+    long getFramesCaptured() const { return nextFrame; }
+
+private:
+    struct Slot {
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+        long frame = -1;
+        bool busy = false;
+    };
+
+    /** @brief Output shared with the encoding jobs. */
+    struct Output {
+        CaptureFormat format = CaptureFormat::Png;
+        std::string path;
+        int fps = 30;
+        FILE* video = nullptr;
+        int videoWidth = 0, videoHeight = 0;
+        long nextToWrite = 0;                                /**< Y4M frames are appended in order. */
+        std::map<long, std::vector<std::uint8_t>> finished;  /**< Encoded Y4M frames waiting their turn. */
+        int inFlight = 0;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    Slot ring[RingSize];
+    int head = 0;        /**< Next slot to read into. */
+    int tail = 0;        /**< Oldest busy slot. */
+    int ringWidth = 0, ringHeight = 0;
+    long nextFrame = 0;
+    bool active = false;
+    bool asyncReadback = false;
+
+    GLuint framebuffer = 0;
+    GLuint colorTexture = 0, depthTexture = 0;
+    int offscreenWidth = 0, offscreenHeight = 0;
+    GLint previousFramebuffer = 0;
+    bool offscreen = false;
+
+    std::shared_ptr<Output> output;
+    std::unique_ptr<JobSystem> encoders;  /**< Created by the first start(). */
+
+    void retire(Slot& slot);
+    void drain();
+    void submit(long frame, int width, int height, std::vector<std::uint8_t> rgba);
+};
+
+/**
+ * @brief Gets the engine-wide frame capture.
+ */
+FrameCapture& frameCapture();
@@ -0,0 +1,64 @@
+/**
+ * @file Frustum.h
+ * @brief Defines convex culling volumes and world-space bounds helpers.
+ *
+ * This header contains the Frustum class, a set of inward-facing planes that can
+ * be built from a view-projection matrix or from an eye point looking through a
+ * rectangular portal (e.g., a mirror), and transformBounds(), which moves a
+ * local bounding box into world space.
+ */
+
+#pragma once
+#include "Common.h"
+#include "ECS.h"
+#include <vector>
+
+/**
+ * @struct PlaneEq
+ * @brief A plane a*x + b*y + c*z + d = 0; points with a positive value are in front.
+ */
+struct PlaneEq {
+    float a, b, c, d;
+
+    /** @brief Signed distance (scaled by the normal length) of a point. */
+    float distance(const Vec3& p) const { return a * p.x + b * p.y + c * p.z + d; }
+};
+
+/**
+ * @class Frustum
+ * @brief A convex volume bounded by planes, used to cull objects before drawing.
+ */
+class Frustum {
+public:
+    /**
+     * @brief Extracts the six planes of a combined projection * modelview matrix.
+     * @param m Column-major clip-from-world matrix.
+     */
+    static Frustum fromMatrix(const float m[16]);
+
+    /**
+     * @brief Builds the volume seen from an eye through a convex polygon.
+     * * One plane per polygon edge through the eye, plus the polygon's own plane
+     * as the near plane (keeping the side opposite the eye).
+     * @param eye The eye position.
+     * @param corners Polygon corners in order (at least 3).
+     */
+    static Frustum fromPortal(const Vec3& eye, const std::vector<Vec3>& corners);
+
+    /** @brief Adds a plane (points in front of it are kept). */
+    void addPlane(const PlaneEq& p) { planes.push_back(p); }
+
+    /** @brief Gets the planes (for culling on the GPU). */
+    const std::vector<PlaneEq>& getPlanes() const { return planes; }
+
+    /** @brief Conservative box test: false only if the box is fully outside a plane. */
+    bool intersects(const AABB& box) const;
+
+private:
+    std::vector<PlaneEq> planes;
+};
+
+/**
+ * @brief Transforms a local box by a world matrix and returns its world-space bounds.
+ */
+AABB transformBounds(const WorldMatrix& w, const AABB& local);
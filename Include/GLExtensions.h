@@ -0,0 +1,143 @@
+/**
+ * @file GLExtensions.h
+ * @brief Runtime-loaded OpenGL entry points beyond OpenGL 1.1.
+ *
+ * This header contains the GLExt namespace: function pointers for framebuffer
+ * objects, multiple render targets, GLSL shaders, occlusion queries,
+ * asynchronous readback (pixel buffer objects and fences), instanced drawing
+ * and compute-driven indirect drawing, resolved at runtime through GLUT, plus
+ * small helpers to compile shader programs. Features that need them check
+ * GLExt::load() (or loadQueries()/loadReadback()/loadInstancing()/loadIndirect())
+ * and fall back to the fixed-function path when it fails.
+ */
+
+#pragma once
+#include <GL/freeglut.h>
+#include <GL/glext.h>
+
+namespace GLExt {
+
+extern PFNGLGENFRAMEBUFFERSPROC GenFramebuffers;
+extern PFNGLDELETEFRAMEBUFFERSPROC DeleteFramebuffers;
+extern PFNGLBINDFRAMEBUFFERPROC BindFramebuffer;
+extern PFNGLFRAMEBUFFERTEXTURE2DPROC FramebufferTexture2D;
+extern PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus;
+extern PFNGLDRAWBUFFERSPROC DrawBuffers;
+extern PFNGLBLENDFUNCSEPARATEPROC BlendFuncSeparate;
+extern PFNGLACTIVETEXTUREPROC ActiveTexture;
+
+extern PFNGLCREATESHADERPROC CreateShader;
+extern PFNGLDELETESHADERPROC DeleteShader;
+extern PFNGLSHADERSOURCEPROC ShaderSource;
+extern PFNGLCOMPILESHADERPROC CompileShader;
+extern PFNGLGETSHADERIVPROC GetShaderiv;
+extern PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog;
+extern PFNGLCREATEPROGRAMPROC CreateProgram;
+extern PFNGLATTACHSHADERPROC AttachShader;
+extern PFNGLLINKPROGRAMPROC LinkProgram;
+extern PFNGLGETPROGRAMIVPROC GetProgramiv;
+extern PFNGLGETPROGRAMINFOLOGPROC GetProgramInfoLog;
+extern PFNGLUSEPROGRAMPROC UseProgram;
+extern PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation;
+extern PFNGLUNIFORM1IPROC Uniform1i;
+extern PFNGLUNIFORM1FPROC Uniform1f;
+extern PFNGLUNIFORM2FPROC Uniform2f;
+extern PFNGLUNIFORM3FPROC Uniform3f;
+extern PFNGLUNIFORM1FVPROC Uniform1fv;
+
+extern PFNGLGENQUERIESPROC GenQueries;
+extern PFNGLDELETEQUERIESPROC DeleteQueries;
+extern PFNGLBEGINQUERYPROC BeginQuery;
+extern PFNGLENDQUERYPROC EndQuery;
+extern PFNGLGETQUERYOBJECTUIVPROC GetQueryObjectuiv;
+
+extern PFNGLGENBUFFERSPROC GenBuffers;
+extern PFNGLDELETEBUFFERSPROC DeleteBuffers;
+extern PFNGLBINDBUFFERPROC BindBuffer;
+extern PFNGLBUFFERDATAPROC BufferData;
+extern PFNGLMAPBUFFERPROC MapBuffer;
+extern PFNGLUNMAPBUFFERPROC UnmapBuffer;
+extern PFNGLFENCESYNCPROC FenceSync;
+extern PFNGLCLIENTWAITSYNCPROC ClientWaitSync;
+extern PFNGLDELETESYNCPROC DeleteSync;
+
+extern PFNGLBINDATTRIBLOCATIONPROC BindAttribLocation;
+extern PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer;
+extern PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray;
+extern PFNGLDISABLEVERTEXATTRIBARRAYPROC DisableVertexAttribArray;
+extern PFNGLVERTEXATTRIBDIVISORPROC VertexAttribDivisor;
+extern PFNGLDRAWARRAYSINSTANCEDPROC DrawArraysInstanced;
+
+extern PFNGLUNIFORM4FVPROC Uniform4fv;
+extern PFNGLBINDBUFFERBASEPROC BindBufferBase;
+extern PFNGLDISPATCHCOMPUTEPROC DispatchCompute;
+extern PFNGLMEMORYBARRIERPROC MemoryBarrier;
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect;
+
+/**
+ * @brief Resolves every entry point above (once; later calls return the cached result).
+ * * Requires a current GL context.
+ * @return True if all of them are available along with float textures.
+ */
+bool load();
+
+/**
+ * @brief Resolves the occlusion query entry points (OpenGL 1.5), once.
+ * @return True if they are available.
+ */
+bool loadQueries();
+
+/**
+ * @brief Checks for boolean occlusion queries (GL_ANY_SAMPLES_PASSED, OpenGL 3.3 /
+ * ARB_occlusion_query2) and resolves the query entry points, once.
+ * @return True if they are available.
+ */
+bool loadAnySamplesQueries();
+
+/**
+ * @brief Resolves the buffer object and fence entry points (OpenGL 2.1 pixel
+ * buffers, OpenGL 3.2 / ARB_sync fences), once.
+ * @return True if they are available.
+ */
+bool loadReadback();
+
+/**
+ * @brief Resolves the vertex buffer, generic attribute and instanced drawing entry
+ * points (OpenGL 3.3 / ARB_instanced_arrays), once. Shaders need load() as well.
+ * @return True if they are available.
+ */
+bool loadInstancing();
+
+/**
+ * @brief Resolves the compute shader, storage buffer and multi-draw indirect entry
+ * points, once. Requires an OpenGL 4.3 context; also loads load(), loadReadback() and loadInstancing().
+ * @return True if they are available.
+ */
+bool loadIndirect();
+
+/**
+ * @brief Compiles and links a program from GLSL 1.20 sources.
+ * * Compile and link errors are reported with LOG_ERROR.
+ * @param vertexSource Vertex shader source.
+ * @param fragmentSource Fragment shader source.
+ * @return The program, or 0 on failure.
+ */
+GLuint buildProgram(const char* vertexSource, const char* fragmentSource);
+
+/**
+ * @brief Compiles and links a compute program (needs loadIndirect()).
+ * @param source Compute shader source.
+ * @return The program, or 0 on failure.
+ */
+GLuint buildComputeProgram(const char* source);
+
+/**
+ * @brief Creates a screen-sized texture for use as a render target.
+ * @param internalFormat E.g. GL_RGBA16F or GL_DEPTH_COMPONENT24.
+ * @param width Width in pixels.
+ * @param height Height in pixels.
+ * @param filter GL_NEAREST or GL_LINEAR.
+ */
+GLuint createTargetTexture(GLenum internalFormat, int width, int height, GLenum filter);
+
+} // namespace GLExt
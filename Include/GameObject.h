@@ -6,38 +6,44 @@
  * for positioning, rotation, scaling, hierarchy management (parenting), 
  * material properties, and update/interaction callbacks. It also defines
  * basic primitive shapes (Cube, Cylinder, Plane) and a utility CollisionBox.
+ * The transform, material and collider data live in the ECS Registry; the
+ * classes here are the scene-building facade over it.
  */
 
 #pragma once
 #include "Common.h"
-#include <functional>
+#include "Delegate.h"
+#include "ECS.h"
+#include "SceneIndex.h"
+#include <string>
 
 /**
  * @class GameObject
  * @brief The abstract base class for all 3D objects in the engine.
  *
  * GameObject handles the "Transform" (Position, Rotation, Scale), the material state,
- * and the scene graph hierarchy (parent-child relationships). It also supports
- * functional callbacks for per-frame updates and user interactions.
+ * and the scene graph hierarchy (parent-child relationships). Each GameObject owns
+ * one entity in world(); its transform and material are stored there. It also supports
+ * functional callbacks for per-frame updates and user interactions. Callbacks are
+ * stored in a fixed-size Delegate, so assigning one never allocates; reusable or
+ * stateful animations should use the BehaviorSystem instead.
  */
 class GameObject {
 public:
     /** @brief Function signature for per-frame update logic. */
-    using UpdateCallback = std::function<void(GameObject*, float)>;
+    using UpdateCallback = Delegate<void(GameObject*, float)>;
     
     /** @brief Function signature for user interaction logic. */
-    using InteractCallback = std::function<void(GameObject*)>;
+    using InteractCallback = Delegate<void(GameObject*)>;
 
 protected:
-    /** @brief Local position (X, Y, Z). */
-    Vec3 position = { 0, 0, 0 };
-    /** @brief Local rotation in Euler degrees (X, Y, Z). */
-    Vec3 rotation = { 0, 0, 0 };
-    /** @brief Local scale factors (X, Y, Z). */
-    Vec3 scale = { 1, 1, 1 };
-    
-    /** @brief The material properties used for rendering. */
-    Material material;
+    /** @brief The entity holding this object's components. */
+    Entity entity = NullEntity;
+
+    /** @brief Gets this object's Transform component. */
+    Transform& transform() { return world().transforms.get(entity); }
+    /** @brief Gets this object's Transform component. */
+    const Transform& transform() const { return world().transforms.get(entity); }
 
     /** @brief Pointer to the parent object (nullptr if this is a root object). */
     GameObject* parent = nullptr;
@@ -48,12 +54,76 @@ protected:
     /** @brief Optional callback executed when the object is interacted with. */
     InteractCallback interactAction = nullptr;
 
+    /** @brief Optional unique name (empty if anonymous). */
+    std::string name;
+
+    /** @brief Tags carried by this object. */
+    TagMask tags = 0;
+
+    /** @brief Whether the object is part of the scene (and so in the SceneIndex). */
+    bool inScene = false;
+
 public:
-    /** @brief Default constructor. */
-    GameObject() {}
+    /** @brief Default constructor. Creates the backing entity. */
+    GameObject();
+
+    /**
+     * @brief Copy constructor used by clone().
+     * * Creates a new entity holding a copy of the source's components.
+     */
+    GameObject(const GameObject& other);
+
+    GameObject& operator=(const GameObject&) = delete;
     
-    /** @brief Virtual destructor. */
-    virtual ~GameObject() {}
+    /** @brief Virtual destructor. Destroys the backing entity. */
+    virtual ~GameObject();
+
+    /** @brief Gets the entity backing this object. */
+    Entity getEntity() const { return entity; }
+
+    /**
+     * @brief Names the object so it can be found with SceneIndex::findByName()
+     * while it is in the scene.
+     * * Names are unique: naming a second object the same steals the name.
+     * Clones do not inherit the name.
+     * @param n The new name (empty to make the object anonymous).
+     */
+    void setName(const std::string& n);
+
+    /** @brief Gets the object's name (empty if anonymous). */
+    const std::string& getName() const { return name; }
+
+    /**
+     * @brief Adds a tag so the object is returned by SceneIndex::findByTag()
+     * while it is in the scene.
+     * * Clones inherit their source's tags.
+     */
+    void addTag(Tag t);
+
+    /** @brief Adds a tag by name, registering the tag on first use. */
+    void addTag(const std::string& tagName) { addTag(SceneIndex::tag(tagName)); }
+
+    /** @brief Removes a tag. */
+    void removeTag(Tag t);
+
+    /** @brief Checks if the object carries a tag. */
+    bool hasTag(Tag t) const { return (tags & tagBit(t)) != 0; }
+
+    /** @brief Gets all tags carried by the object. */
+    TagMask getTags() const { return tags; }
+
+    /**
+     * @brief Adds the object's name and tags to the SceneIndex.
+     * * Called for root objects when they join the scene, and by
+     * Container::addChild() under a container that is in the scene.
+     */
+    virtual void enterScene();
+
+    /** @brief Removes the object's name and tags from the SceneIndex. */
+    virtual void leaveScene();
+
+    /** @brief Checks if the object is part of the scene. */
+    bool isInScene() const { return inScene; }
 
     /** @brief Sets the object's local position. */
     void setPosition(float x, float y, float z);
@@ -66,6 +136,9 @@ public:
     
     /** @brief Assigns a material to the object. */
     void setMaterial(const Material& m);
+
+    /** @brief Gets the object's material (the default Material if it draws nothing). */
+    const Material& getMaterial() const;
     
     /** * @brief Checks if the object uses a transparent material.
      * @return True if the material's alpha is < 1.0. 
@@ -78,17 +151,24 @@ public:
     /** * @brief Sets the parent of this object.
      * @param p Pointer to the new parent GameObject.
      */
-    void setParent(GameObject* p) { parent = p; }
+    void setParent(GameObject* p);
     
     /** @brief Gets the current parent object. */
     GameObject* getParent() const { return parent; }
 
+    /**
+     * @brief Checks if nothing in the scene moves the object.
+     * * False if it or an ancestor has an update or interaction callback, or a
+     * behavior from the BehaviorSystem.
+     */
+    bool isStatic() const;
+
     /** @brief Gets the local position. */
-    Vec3 getPosition() const { return position; }
+    Vec3 getPosition() const { return transform().position; }
     /** @brief Gets the local rotation. */
-    Vec3 getRotation() const { return rotation; }
+    Vec3 getRotation() const { return transform().rotation; }
     /** @brief Gets the local scale. */
-    Vec3 getScale() const { return scale; }
+    Vec3 getScale() const { return transform().scale; }
 
     /** * @brief Calculates the absolute world position.
      * * Recursively adds parent positions and applies parent transformations.
@@ -157,12 +237,27 @@ public:
      */
     void rotateAround(float px, float py, float pz, float ax, float ay, float az, float angle);
 
+    /**
+     * @brief Gets the local-space bounds of the mesh drawn by drawMesh().
+     * * Defaults to the unit cube drawn by glutSolidCube(1.0).
+     */
+    virtual AABB getLocalBounds() const { return { { -0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, 0.5f } }; }
+
     /**
      * @brief Renders the object.
      * * Sets up the OpenGL matrix (translation, rotation, scaling) and material,
-     * then calls drawMesh().
+     * then calls drawMesh(). Skipped if the render context has a cull frustum
+     * and the object's world bounds lie outside it, or if the IndirectScene has
+     * already drawn it (RenderContext::indirect).
      */
     virtual void draw();
+
+    /**
+     * @brief Draws the environment reflection layer for reflective materials.
+     * * Called by draw() after drawMesh() in the main pass. Mirror panes use
+     * their planar reflection; other objects sample the nearest reflection probe.
+     */
+    void drawReflection();
     
     /** * @brief Pure virtual method to draw the specific geometry.
      * * Derived classes must implement this to define their shape (e.g., glutSolidCube).
@@ -186,6 +281,7 @@ public:
 class Cylinder : public GameObject {
 public:
     void drawMesh() override;
+    AABB getLocalBounds() const override { return { { -0.5f, -0.5f, 0.0f }, { 0.5f, 0.5f, 1.0f } }; }
     GameObject* clone() const override { return new Cylinder(*this); }
 };
 
@@ -193,6 +289,7 @@ public:
 class Plane : public GameObject {
 public:
     void drawMesh() override;
+    AABB getLocalBounds() const override { return { { -1.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 1.0f } }; }
     GameObject* clone() const override { return new Plane(*this); }
 };
 
@@ -201,8 +298,6 @@ public:
  */
 class CollisionBox : public GameObject {
 public:
-    float width, height, depth;
-    
     /**
      * @brief Constructs a CollisionBox with specified dimensions.
      * @param w Width (X-axis).
@@ -210,6 +305,29 @@ public:
      * @param d Depth (Z-axis).
      */
     CollisionBox(float w, float h, float d);
+
+    /** @brief Copy constructor used by clone(); copies the Collider component. */
+    CollisionBox(const CollisionBox& other);
+
+    /** @brief Gets the box dimensions stored in the Collider component. */
+    const Collider& getCollider() const { return world().colliders.get(entity); }
+
+    /** @brief Width (X-axis). */
+    float getWidth() const { return getCollider().width; }
+    /** @brief Height (Y-axis). */
+    float getHeight() const { return getCollider().height; }
+    /** @brief Depth (Z-axis). */
+    float getDepth() const { return getCollider().depth; }
+
+    /**
+     * @brief Marks the box as a trigger volume.
+     * * Triggers report enter/stay/exit events through the TriggerSystem and
+     * never block movement.
+     */
+    void setTrigger(bool t) { world().colliders.get(entity).trigger = t; }
+
+    /** @brief Checks if the box is a trigger volume. */
+    bool isTrigger() const { return getCollider().trigger; }
     
     void drawMesh() override;
     GameObject* clone() const override { return new CollisionBox(*this); }
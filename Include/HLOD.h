@@ -0,0 +1,88 @@
+/**
+ * @file HLOD.h
+ * @brief Defines hierarchical level-of-detail proxies for Container subtrees.
+ *
+ * This header contains the HLODProxy class, a merged and simplified copy of a
+ * whole subtree (e.g., the building or a pod) with lighting baked into vertex
+ * colours, and buildHLOD(), which creates proxies over the scene hierarchy.
+ * When a proxy's simplification error projects below a pixel threshold, the
+ * Container draws the proxy in one call instead of walking its children.
+ */
+
+#pragma once
+#include "Common.h"
+#include "Delegate.h"
+#include <memory>
+#include <vector>
+
+class Container;
+class GameObject;
+
+/**
+ * @class HLODProxy
+ * @brief Simplified, vertex-coloured stand-in for a Container's children.
+ */
+class HLODProxy {
+public:
+    /** @brief Positions the lights while geometry is captured. */
+    using LightsFn = Delegate<void()>;
+
+    /**
+     * @brief Captures and simplifies a Container's children.
+     * * Geometry is recorded in the Container's local space with OpenGL feedback
+     * mode (so lit vertex colours come for free), then simplified by vertex
+     * clustering. Requires up-to-date world matrices (propagateTransforms()).
+     * @param node The subtree root.
+     * @param clusterGrid Clustering cells along the longest side of the bounds.
+     * @param setupLights Called with the node's inverse world matrix loaded.
+     * @return The proxy, or null if the subtree drew nothing.
+     */
+    static std::shared_ptr<HLODProxy> capture(Container* node, int clusterGrid, const LightsFn& setupLights);
+
+    /**
+     * @brief Checks if the proxy should replace the subtree with the current matrices.
+     * * Decided in the main pass and reused by the other passes of the frame;
+     * display passes decide for their own camera.
+     */
+    bool shouldReplace() const;
+
+    /** @brief Draws the opaque part (the Container's transform must be applied). */
+    void drawOpaque() const;
+
+    /** @brief Draws the transparent part (the Container's transform must be applied). */
+    void drawTransparent() const;
+
+    /** @brief Local-space bounds of the captured geometry. */
+    const AABB& getBounds() const { return bounds; }
+
+    /** @brief Geometric error introduced by the simplification (local units). */
+    float getError() const { return error; }
+
+    /** @brief Triangles in the proxy (opaque + transparent). */
+    std::size_t triangleCount() const;
+
+private:
+    struct Mesh {
+        std::vector<float> positions;   /**< x, y, z per vertex. */
+        std::vector<float> colors;      /**< r, g, b, a per vertex (lit). */
+        std::vector<unsigned int> indices;
+
+        void draw() const;
+    };
+
+    Mesh opaque;
+    Mesh transparent;
+    AABB bounds = { { 0, 0, 0 }, { 0, 0, 0 } };
+    float error = 0.0f;
+    mutable bool replaced = false;
+};
+
+/**
+ * @brief Builds proxies for every Container subtree with enough drawable objects.
+ * * Nested subtrees get their own, finer proxies, so the far field collapses into
+ * a few draws while nearer rooms refine independently.
+ * @param roots The top-level scene objects.
+ * @param setupLights Positions the lights (see HLODProxy::capture()).
+ * @return The number of proxies built.
+ */
+std::size_t buildHLOD(const std::vector<GameObject*>& roots, const HLODProxy::LightsFn& setupLights);
@@ -0,0 +1,74 @@
+/**
+ * @file Impostor.h
+ * @brief Defines octahedral impostors used to draw distant models as a single quad.
+ *
+ * This header contains the ImpostorAtlas class, which pre-renders a model from a
+ * hemisphere of directions (laid out on a hemi-octahedral grid) into one texture,
+ * and draws it back as a camera-facing quad blended between the nearest views.
+ */
+
+#pragma once
+#include "Common.h"
+#include "Delegate.h"
+#include "View.h"
+#include <GL/freeglut.h>
+#include <memory>
+#include <string>
+
+/**
+ * @class ImpostorAtlas
+ * @brief A texture holding a model rendered from a grid of view directions.
+ */
+class ImpostorAtlas {
+public:
+    /** @brief Callback used while baking (sets up lights or draws the model). */
+    using BakeFn = Delegate<void()>;
+
+    /**
+     * @brief Renders a model into a new atlas.
+     * * Uses the back buffer as scratch space, so call it before the first frame
+     * (or before the next clear). The model is drawn in its local space.
+     * @param bounds Local-space bounds of the model.
+     * @param grid Views per side of the hemi-octahedral grid.
+     * @param viewSize Resolution of each view in pixels.
+     * @param setupLights Called once per view after the view matrix is loaded.
+     * @param drawModel Draws the model's geometry.
+     * @return The baked atlas.
+     */
+    static std::shared_ptr<ImpostorAtlas> bake(const AABB& bounds, int grid, int viewSize,
+                                               const BakeFn& setupLights, const BakeFn& drawModel);
+
+    /**
+     * @brief Same as bake(), but reuses the atlas already baked under the same key.
+     * @param key Identifies the model (e.g., its file path).
+     */
+    static std::shared_ptr<ImpostorAtlas> bakeShared(const std::string& key, const AABB& bounds, int grid, int viewSize,
+                                                     const BakeFn& setupLights, const BakeFn& drawModel);
+
+    ~ImpostorAtlas();
+
+    ImpostorAtlas(const ImpostorAtlas&) = delete;
+    ImpostorAtlas& operator=(const ImpostorAtlas&) = delete;
+
+    /**
+     * @brief Draws the impostor with the current modelview (the model's local space).
+     * * In the main pass the quad is unlit and textured; in the shadow pass it keeps
+     * the current colour so only its silhouette is drawn.
+     * @param opacity 1 for a solid impostor, less while crossfading from the mesh.
+     */
+    void draw(float opacity) const;
+
+    /** @brief Centre of the bounding sphere (local space). */
+    Vec3 getCenter() const { return center; }
+
+    /** @brief Radius of the bounding sphere (local space). */
+    float getRadius() const { return radius; }
+
+private:
+    ImpostorAtlas() = default;
+
+    GLuint texture = 0;
+    int grid = 0;
+    Vec3 center = { 0, 0, 0 };
+    float radius = 1.0f;
+};
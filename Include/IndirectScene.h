@@ -0,0 +1,129 @@
+/**
+ * @file IndirectScene.h
+ * @brief Defines the GPU-driven opaque pass for static primitives.
+ *
+ * This header contains the IndirectScene class. On OpenGL 4.3 contexts it packs
+ * the meshes of every static opaque Cube, Cylinder and PartBatch into one shared
+ * vertex and index buffer, and their world matrices, bounds and materials into
+ * storage buffers. Each frame the opaque traversal runs first and reports the
+ * containers it did not descend into (replaced by their HLOD proxy, or skipped by
+ * the occlusion culler); then a compute shader tests every object against the
+ * view frustum and those containers and writes one DrawElementsIndirectCommand
+ * per object (zero instances if culled), and a single glMultiDrawElementsIndirect
+ * draws them with a shader that reproduces the fixed-function lighting and fog.
+ * The CPU work per frame does not depend on the number of objects. Without 4.3,
+ * everything stays on the fixed-function path.
+ */
+
+#pragma once
+#include "GameObject.h"
+#include <GL/freeglut.h>
+#include <GL/glext.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Container;
+
+/**
+ * @class IndirectScene
+ * @brief Draws the static opaque primitives with one multi-draw indirect call.
+ *
+ * Objects taken over by the scene are flagged in their Renderable, and
+ * GameObject::draw() skips them while RenderContext::indirect is set. A pass
+ * calls begin(), traverses the scene (Container calls hide() where it stops),
+ * then draw().
+ */
+class IndirectScene {
+public:
+    /**
+     * @brief Collects the static opaque primitives under the given roots and uploads them.
+     * * Call after propagateTransforms(), and again after static objects are added,
+     * removed or moved. Does nothing without OpenGL 4.3 or with
+     * RenderSettings::indirectEnabled off.
+     * @param roots Top-level scene objects.
+     * @return Number of objects drawn indirectly.
+     */
+    std::size_t build(const std::vector<GameObject*>& roots);
+
+    /**
+     * @brief Starts an opaque pass. Only the lit opaque passes are handled (not shadows or bakes).
+     * @return True if draw() will draw the objects; false means the caller must draw
+     * them itself (leave RenderContext::indirect unset).
+     */
+    bool begin();
+
+    /**
+     * @brief Leaves out the objects under a container in this pass (its subtree was
+     * replaced by a proxy or skipped). Ignored outside begin()/draw().
+     */
+    void hide(const Container* container);
+
+    /**
+     * @brief Culls and draws every collected object not hidden since begin().
+     * * Call with the camera's modelview loaded, once the traversal is done.
+     */
+    void draw();
+
+    /** @brief Number of objects drawn indirectly. */
+    std::size_t size() const { return objects.size(); }
+
+    /** @brief Number of distinct meshes in the shared buffers. */
+    std::size_t meshCount() const { return meshTriangles.size(); }
+
+    /** @brief Triangles drawn if every object is visible. */
+    std::size_t triangleCount() const;
+
+private:
+    /** @brief One object as the compute shader reads it (std430). */
+    struct ObjectData {
+        float model[16];
+        float normal[16];      /**< Inverse transpose of the model matrix (upper 3x3). */
+        float boundsMin[4];    /**< World bounds. */
+        float boundsMax[4];
+        std::uint32_t mesh;    /**< Index into the mesh table. */
+        std::uint32_t material;
+        std::uint32_t group;   /**< Innermost container, as an index into groupParent. */
+        std::uint32_t padding;
+    };
+
+    std::vector<ObjectData> objects;
+    std::vector<Entity> flagged;              /**< Entities whose Renderable::indirect this scene set. */
+
+    /** @brief Parent group of each container group (group 0 holds top-level objects). */
+    std::vector<std::uint32_t> groupParent;
+    std::unordered_map<const Container*, std::uint32_t> groupOf;
+    std::vector<std::uint8_t> groupHidden;    /**< Containers hide() was called for in this pass. */
+    bool collecting = false;                  /**< Between begin() and draw(). */
+
+    /** @brief PartBatch vertex arrays, mesh table slots 2 onwards (the cube and cylinder come first). */
+    std::vector<std::shared_ptr<const std::vector<float>>> batchMeshes;
+    std::map<const std::vector<float>*, std::uint32_t> meshIndex;
+    std::vector<std::size_t> meshTriangles;   /**< Triangles of each mesh table slot. */
+    int builtTessellation = 0;                /**< Cylinder slices in the shared buffers. */
+
+    int state = -1;                           /**< -1 untested, 0 unsupported, 1 ready. */
+    GLuint cullProgram = 0;
+    GLuint drawProgram = 0;
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+    GLuint instanceBuffer = 0;                /**< 0..N-1, fetched per draw through baseInstance. */
+    GLuint objectBuffer = 0;
+    GLuint meshBuffer = 0;                    /**< {indexCount, firstIndex, baseVertex, 0} per mesh. */
+    GLuint materialBuffer = 0;
+    GLuint commandBuffer = 0;
+    GLuint groupBuffer = 0;                   /**< Visibility per group, written each pass. */
+
+    bool init();
+    void uploadMeshes();
+    void uploadMaterials();
+    void collect(GameObject* obj, std::uint32_t group);
+};
+
+/**
+ * @brief Gets the engine-wide indirect scene.
+ */
+IndirectScene& indirectScene();
@@ -0,0 +1,87 @@
+/**
+ * @file JobSystem.h
+ * @brief Defines the worker thread pool used to run engine systems in parallel.
+ *
+ * This header contains the JobSystem class, a fixed pool of worker threads that
+ * executes fire-and-forget jobs and splits data-parallel loops (parallelFor) into
+ * chunks. The calling thread always participates in a parallelFor, so it also
+ * works (serially) on machines with a single core. Loop helpers go to the front
+ * of the queue, and the caller stops waiting once every chunk is done, even if
+ * some helpers never got to start.
+ */
+
+#pragma once
+#include "Delegate.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class JobSystem
+ * @brief A pool of worker threads with a shared job queue.
+ */
+class JobSystem {
+public:
+    /** @brief Callback for one chunk of a parallel loop: [begin, end). */
+    using RangeFn = Delegate<void(std::size_t, std::size_t)>;
+
+    /**
+     * @brief Starts the worker threads.
+     * @param workers Number of workers (0 = one per hardware thread, minus the caller).
+     */
+    explicit JobSystem(unsigned workers = 0);
+
+    /** @brief Finishes queued jobs and joins the workers. */
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Queues a job to run on a worker thread.
+     * @param job The work to run.
+     */
+    void submit(std::function<void()> job);
+
+    /** @brief Blocks until every submitted job has finished. */
+    void waitIdle();
+
+    /**
+     * @brief Runs fn over [0, count) in chunks of `grain`, in parallel.
+     * * Blocks until all chunks are done. fn must be safe to call concurrently
+     * on disjoint ranges. Must not be called from inside another job.
+     * @param count Number of items.
+     * @param grain Items per chunk (at least 1).
+     * @param fn Called as fn(begin, end) for each chunk.
+     */
+    template <typename F>
+    void parallelFor(std::size_t count, std::size_t grain, F&& fn) {
+        auto* target = &fn;
+        runParallel(count, grain, RangeFn([target](std::size_t b, std::size_t e) { (*target)(b, e); }));
+    }
+
+    /** @brief Number of worker threads (excluding the caller). */
+    unsigned workerCount() const { return (unsigned)workers.size(); }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::size_t busy = 0;
+    bool stopping = false;
+
+    void workerLoop();
+    void runParallel(std::size_t count, std::size_t grain, const RangeFn& fn);
+};
+
+/**
+ * @brief Gets the engine-wide job system (created on first use).
+ */
+JobSystem& jobs();
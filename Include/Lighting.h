@@ -73,6 +73,9 @@ public:
      */
     void enable();
 
+    /** @brief Switches the light off (e.g., when it is not among the nearest lights). */
+    void disable();
+
     /**
      * @brief Overrides the mesh drawing method.
      * * PointLights are generally invisible in the rendered scene (unless a debug mesh is added),
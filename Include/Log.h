@@ -0,0 +1,132 @@
+/**
+ * @file Log.h
+ * @brief Defines the engine's asynchronous logger.
+ *
+ * This header contains the Logger class and the LOG_* macros. A message is
+ * formatted on the calling thread into a fixed-size slot of a bounded lock-free
+ * multi-producer queue; a background thread drains the queue and writes to
+ * stderr, so logging never waits for the console. Messages below LOG_MIN_LEVEL
+ * are removed at compile time, and each call site is rate limited: past a small
+ * burst per second, repeats are counted and reported with the next message that
+ * gets through.
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+/** @brief Message severity. */
+enum class LogLevel { Debug = 0, Info = 1, Warning = 2, Error = 3 };
+
+/**
+ * @brief Lowest level compiled in (0 Debug, 1 Info, 2 Warning, 3 Error).
+ * * Define it on the compiler command line to change it, e.g. -DLOG_MIN_LEVEL=0.
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 1
+#endif
+
+#if defined(__GNUC__)
+#define LOG_PRINTF_FORMAT(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#define LOG_PRINTF_FORMAT(fmt, args)
+#endif
+
+/**
+ * @struct LogSite
+ * @brief Rate-limit state of one LOG_* call site (a static local of the macro).
+ */
+struct LogSite {
+    std::atomic<long long> windowStart{ -1000000 };  /**< Start of the current window (ms). */
+    std::atomic<int> count{ 0 };                      /**< Messages in the current window. */
+    std::atomic<int> suppressed{ 0 };                 /**< Messages dropped since the last one written. */
+};
+
+/**
+ * @class Logger
+ * @brief Bounded lock-free message queue drained by a writer thread.
+ *
+ * The queue is a ring of sequenced slots (Vyukov's bounded queue): producers
+ * claim a slot with one compare-and-swap and publish it by bumping its sequence
+ * number, and the single consumer reads slots in order. When the ring is full the
+ * message is dropped and counted rather than waiting for the writer.
+ */
+class Logger {
+public:
+    /** @brief Slots in the ring. */
+    static const std::size_t Capacity = 1024;
+
+    /** @brief Longest message in bytes (longer ones are truncated). */
+    static const std::size_t MessageSize = 480;
+
+    /** @brief Messages per call site per second before repeats are suppressed. */
+    static const int BurstPerSecond = 10;
+
+    Logger();
+    ~Logger();
+
+    /**
+     * @brief Formats and queues a message (printf-style). Use the LOG_* macros.
+     * @param level Severity.
+     * @param site Call-site state used for rate limiting.
+     * @param format printf format string.
+     */
+    void write(LogLevel level, LogSite& site, const char* format, ...) LOG_PRINTF_FORMAT(4, 5);
+
+    /** @brief Blocks until every message queued so far has been written. */
+    void flush();
+
+    /** @brief Drops messages below this level at run time (on top of LOG_MIN_LEVEL). */
+    void setMinLevel(LogLevel level) { minLevel.store((int)level, std::memory_order_relaxed); }
+
+    /** @brief Messages lost because the queue was full. */
+    std::size_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        LogLevel level;
+        int suppressed;
+        char text[MessageSize];
+    };
+
+    Slot slots[Capacity];
+    std::atomic<std::size_t> enqueuePos{ 0 };
+    std::size_t dequeuePos = 0;              /**< Only touched by the writer thread. */
+    std::atomic<std::size_t> written{ 0 };   /**< Messages consumed so far. */
+    std::atomic<std::size_t> dropped{ 0 };
+    std::size_t droppedReported = 0;
+    std::atomic<int> minLevel{ 0 };
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    std::atomic<bool> sleeping{ false };
+    bool stopping = false;
+
+    void writerLoop();
+    void drain();
+};
+
+/**
+ * @brief Gets the engine-wide logger (its writer thread starts on first use).
+ */
+Logger& logger();
+
+/** @brief Logs at a level; compiled out entirely below LOG_MIN_LEVEL. */
+#define LOG_AT(level, ...)                                                    \
+    do {                                                                      \
+        if constexpr ((int)(level) >= LOG_MIN_LEVEL) {                        \
+            static LogSite logSite;                                           \
+            logger().write(level, logSite, __VA_ARGS__);                      \
+        }                                                                     \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_AT(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
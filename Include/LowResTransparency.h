@@ -0,0 +1,58 @@
+/**
+ * @file LowResTransparency.h
+ * @brief Defines the reduced-resolution transparent pass.
+ *
+ * This header contains the LowResTransparency class. The transparent pass is
+ * drawn into a half- or quarter-resolution buffer, depth-tested against a
+ * downsampled copy of the opaque depth, then composited at full resolution
+ * with bilateral (depth-aware) upsampling so glass edges do not bleed across
+ * opaque silhouettes. This cuts the fill cost of large glass walls, which are
+ * blended twice per pixel (back and front faces).
+ */
+
+#pragma once
+#include <GL/freeglut.h>
+
+/**
+ * @class LowResTransparency
+ * @brief Render targets and shaders for the reduced-resolution transparent pass.
+ */
+class LowResTransparency {
+public:
+    /**
+     * @brief Redirects drawing into the reduced-resolution buffer.
+     * * Copies and downsamples the opaque depth, binds the buffer (cleared to
+     * transparent black) and sets renderContext().keepBlend so the pass keeps a
+     * blend function that also accumulates coverage.
+     * @param scale 0.5 for half resolution, 0.25 (or less) for quarter resolution.
+     * @return False if the GPU lacks the needed features (nothing is bound).
+     */
+    bool begin(float scale);
+
+    /**
+     * @brief Stops drawing into the buffer and upsamples it over the frame.
+     */
+    void end();
+
+private:
+    int state = -1;                  /**< -1 not initialized, 0 unsupported, 1 ready. */
+    int width = 0, height = 0;       /**< Full resolution. */
+    int factor = 0;                  /**< Full-resolution pixels per low-resolution texel (per axis). */
+    int lowWidth = 0, lowHeight = 0;
+    GLuint framebuffer = 0;
+    GLint previousFramebuffer = 0; /**< Restored by end(). */
+    GLuint colorTexture = 0;         /**< Premultiplied colour + coverage (low resolution). */
+    GLuint lowDepthTexture = 0;      /**< Downsampled opaque depth (low resolution). */
+    GLuint fullDepthTexture = 0;     /**< Copy of the opaque depth (full resolution). */
+    GLuint downsampleProgram = 0;
+    GLuint upsampleProgram = 0;
+    float nearPlane = 0.1f, farPlane = 200.0f;
+
+    bool init();
+    bool resize(int w, int h, int f);
+};
+
+/**
+ * @brief Gets the engine-wide reduced-resolution transparent pass.
+ */
+LowResTransparency& lowResTransparency();
@@ -5,11 +5,18 @@
  * This header contains the Model class, which uses the Open Asset Import Library (Assimp)
  * to load external 3D models (OBJ, FBX, DAE, etc.). It handles mesh processing,
  * texture loading, and material extraction to render complex geometry within the
- * engine's GameObject framework.
+ * engine's GameObject framework. Imported geometry is cached as a compressed cooked
+ * asset next to the source file (see CookedAsset.h), which later loads decode instead
+ * of re-importing. Textures and vertex buffers are created by the ResourceLoader;
+ * until a mesh's buffers are ready it is drawn from client memory.
  */
 
 #pragma once
+#include "CookedAsset.h"
 #include "GameObject.h"
+#include "Impostor.h"
+#include "ResourceLoader.h"
+#include <memory>
 #include <vector>
 #include <string>
 #include <assimp/scene.h>
@@ -26,23 +33,25 @@
  */
 class Model : public GameObject {
 private:
+    /** @brief Collection of meshes that make up the model. */
+    std::vector<MeshStreams> meshes;
+    
+    /** @brief Textures of the model's materials (null if untextured). */
+    std::vector<std::shared_ptr<StreamedResource>> textures;
+
     /**
-     * @struct MeshEntry
-     * @brief Internal structure holding geometry data for a single sub-mesh.
+     * @struct MeshBuffers
+     * @brief Buffer objects holding one sub-mesh: positions, then normals and texture coordinates.
      */
-    struct MeshEntry {
-        std::vector<float> vertices;      /**< Flattened list of vertex positions (x, y, z). */
-        std::vector<float> normals;       /**< Flattened list of vertex normals (x, y, z). */
-        std::vector<float> texCoords;     /**< Flattened list of texture coordinates (u, v). */
-        std::vector<unsigned int> indices; /**< Indices for indexed drawing. */
-        unsigned int materialIndex;       /**< Index into the loadedMaterials and textures arrays. */
+    struct MeshBuffers {
+        std::shared_ptr<StreamedResource> vertices;
+        std::shared_ptr<StreamedResource> indices;
+        std::size_t normalOffset = 0;    /**< Byte offset of the normals (unused if the mesh has none). */
+        std::size_t texCoordOffset = 0;  /**< Byte offset of the texture coordinates. */
     };
-    
-    /** @brief Collection of meshes that make up the model. */
-    std::vector<MeshEntry> meshes;
-    
-    /** @brief List of OpenGL texture IDs associated with the model's materials. */
-    std::vector<GLuint> textures;
+
+    /** @brief Buffer objects of each sub-mesh (empty without buffer object support). */
+    std::vector<MeshBuffers> buffers;
     
     /** @brief List of material properties extracted from the model file. */
     std::vector<Material> loadedMaterials; 
@@ -50,26 +59,57 @@ private:
     /** @brief The root directory of the model file, used for loading relative texture paths. */
     std::string directory;
 
+    /** @brief The file the model was loaded from (also keys its shared impostor). */
+    std::string path;
+
+    /** @brief Local-space bounds of every sub-mesh. */
+    AABB bounds = { { 0, 0, 0 }, { 0, 0, 0 } };
+
+    /** @brief Pre-rendered views used when the model is small on screen (may be null). */
+    std::shared_ptr<ImpostorAtlas> impostor;
+
+    /** @brief Impostor weight chosen in the last main pass (0 = mesh, 1 = impostor). */
+    float impostorBlend = 0.0f;
+
+    /**
+     * @brief Draws every sub-mesh with its material and texture.
+     */
+    void drawMeshes();
+
+    /**
+     * @brief Imports the model file with Assimp.
+     * @param asset Receives the materials and meshes.
+     * @return False if the file could not be imported.
+     */
+    bool import(CookedAsset& asset);
+
     /**
      * @brief Recursively processes Assimp nodes to extract mesh data.
      * @param node The current Assimp node being processed.
      * @param scene The root Assimp scene object.
+     * @param asset Receives the meshes.
      */
-    void processNode(aiNode* node, const aiScene* scene);
+    void processNode(aiNode* node, const aiScene* scene, CookedAsset& asset);
 
     /**
-     * @brief Extracts material properties (colors, textures) from the Assimp scene.
+     * @brief Extracts material properties (colors, texture names) from the Assimp scene.
      * @param scene The Assimp scene containing material definitions.
+     * @param asset Receives the materials.
      */
-    void loadMaterials(const aiScene* scene); 
+    void loadMaterials(const aiScene* scene, CookedAsset& asset);
 
     /**
-     * @brief Loads a texture from disk and generates an OpenGL texture ID.
+     * @brief Requests a texture from the resource loader.
      * @param path The relative or absolute path to the image file.
      * @param directory The directory context for relative paths.
-     * @return The OpenGL ID of the generated texture, or 0 on failure.
+     * @return The texture, or null if the file does not exist.
+     */
+    std::shared_ptr<StreamedResource> loadTextureFromFile(const char* path, const std::string& directory);
+
+    /**
+     * @brief Requests buffer objects for every sub-mesh from the resource loader.
      */
-    GLuint loadTextureFromFile(const char* path, const std::string& directory);
+    void loadBuffers();
 
 public:
     /**
@@ -81,10 +121,21 @@ public:
     /**
      * @brief Renders the model.
      * * Iterates through all sub-meshes, binds their specific textures and materials,
-     * and issues OpenGL drawing commands.
+     * and issues OpenGL drawing commands. Beyond the impostor screen-size threshold
+     * (see RenderSettings) the impostor quad is drawn instead, crossfading in between.
      */
     void drawMesh() override;
 
+    /**
+     * @brief Bakes (or reuses) the impostor atlas for this model's file.
+     * * Must be called with a GL context, before the first frame is drawn.
+     * @param setupLights Positions the lights for each baked view.
+     */
+    void bakeImpostor(const ImpostorAtlas::BakeFn& setupLights);
+
+    /** @brief Gets the local-space bounds of the model. */
+    AABB getLocalBounds() const override { return bounds; }
+
     /**
      * @brief Creates a deep copy of the model.
      * @return A pointer to the new Model instance.
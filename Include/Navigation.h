@@ -0,0 +1,170 @@
+/**
+ * @file Navigation.h
+ * @brief Defines the navigation mesh baked from scene colliders and the path service.
+ *
+ * This header contains the NavMesh class, which voxelizes the floor into a grid of
+ * walkable cells and merges them into rectangular regions linked by portals, and
+ * the PathService class, which answers A* queries over those regions (many at once,
+ * in parallel) and caches region corridors between queries.
+ */
+
+#pragma once
+#include "Physics.h"
+#include "JobSystem.h"
+#include "SceneIndex.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct NavBakeSettings
+ * @brief Parameters used when baking a NavMesh.
+ */
+struct NavBakeSettings {
+    float cellSize = 0.5f;    /**< Edge length of a voxel cell in world units. */
+    float agentRadius = 0.25f; /**< Clearance kept from solid boxes. */
+    float agentHeight = 1.5f; /**< Boxes entirely above this height do not block. */
+    Tag gateTag = 0;          /**< Boxes under an object with this tag become gates. */
+    bool useGates = false;    /**< Whether gateTag is set. */
+};
+
+/**
+ * @class NavMesh
+ * @brief Rectangular walkable regions over a voxelized floor, with gated links.
+ *
+ * Cells blocked only by gate boxes (doors) are kept as separate gate regions.
+ * A gate region is traversable while its door box no longer covers the middle of
+ * the doorway, so opening or closing a door only toggles links instead of
+ * rebaking. (The cells at the hinge stay covered by a door swung open.)
+ */
+class NavMesh {
+public:
+    /** @brief A link from one region to a neighbour through a shared edge. */
+    struct Link {
+        int region;    /**< The neighbouring region. */
+        Vec3 portal;   /**< Midpoint of the shared edge (on the floor). */
+    };
+
+    /** @brief A rectangle of walkable cells (inclusive cell range). */
+    struct Region {
+        int x0, z0, x1, z1;
+        int gate;                /**< Gate index, or -1 for plain floor. */
+        Vec3 center;
+        std::vector<Link> links;
+    };
+
+    /**
+     * @brief Bakes the mesh over a floor area.
+     * * Voxelization and region merging are split across the job system.
+     * @param broadphase Registered collision boxes (after Broadphase::update()).
+     * @param floor World bounds of the walkable floor (only X and Z are used).
+     * @param settings Cell size, agent size and gate tag.
+     * @param pool Worker threads to bake on.
+     */
+    void bake(const Broadphase& broadphase, const AABB& floor, const NavBakeSettings& settings, JobSystem& pool);
+
+    /**
+     * @brief Re-evaluates gates whose door boxes moved in the last Broadphase::update().
+     * @return True if any gate opened or closed (the version is bumped).
+     */
+    bool refreshGates(const Broadphase& broadphase);
+
+    /**
+     * @brief Finds the region containing a point (or the nearest one within a few cells).
+     * @return The region index, or -1 if the point is not near the mesh.
+     */
+    int findRegion(float x, float z) const;
+
+    /** @brief Checks if a region can currently be walked through. */
+    bool isPassable(int region) const;
+
+    /** @brief Gets every region. */
+    const std::vector<Region>& getRegions() const { return regions; }
+
+    /** @brief Number of gates found while baking. */
+    std::size_t gateCount() const { return gates.size(); }
+
+    /** @brief Incremented whenever a gate opens or closes. */
+    std::uint32_t getVersion() const { return version.load(); }
+
+private:
+    struct Gate {
+        CollisionBox* box;
+        std::vector<int> cells;
+        std::vector<int> core;   /**< Cells in the middle half of the closed door's span. */
+        bool open;
+    };
+
+    NavBakeSettings settings;
+    float originX = 0.0f, originZ = 0.0f;
+    int width = 0, depth = 0;
+    std::vector<int> cellRegion; /**< Region per cell, -1 if blocked. */
+    std::vector<Region> regions;
+    std::vector<Gate> gates;
+    std::unordered_map<const CollisionBox*, int> gateOf;
+    std::atomic<std::uint32_t> version{ 0 };
+
+    Vec3 cellCenter(int x, int z) const;
+    void buildLinks();
+};
+
+/**
+ * @struct PathRequest
+ * @brief One query in a PathService::solve() batch.
+ */
+struct PathRequest {
+    Vec3 start;
+    Vec3 goal;
+    std::vector<Vec3> path; /**< Filled with waypoints (ending at the goal). */
+    bool found = false;
+};
+
+/**
+ * @class PathService
+ * @brief Thread-safe A* over NavMesh regions with a corridor cache.
+ *
+ * Corridors (region sequences) are cached per start/goal region pair and the
+ * cache is dropped whenever the mesh's gate version changes.
+ */
+class PathService {
+public:
+    /**
+     * @brief Constructs a service over a baked mesh.
+     * @param mesh The navigation mesh (must outlive the service).
+     * @param cacheCapacity Corridors kept before the cache is flushed.
+     */
+    explicit PathService(const NavMesh& mesh, std::size_t cacheCapacity = 4096);
+
+    /**
+     * @brief Finds a path between two points. Safe to call from several threads.
+     * @param start Start position.
+     * @param goal Goal position.
+     * @param out Receives the waypoints after the start, ending at the goal.
+     * @return True if the goal is reachable.
+     */
+    bool findPath(Vec3 start, Vec3 goal, std::vector<Vec3>& out);
+
+    /**
+     * @brief Solves a batch of requests in parallel.
+     */
+    void solve(std::vector<PathRequest>& requests, JobSystem& pool);
+
+    /** @brief Queries answered from the cache. */
+    std::size_t getCacheHits() const { return hits.load(); }
+
+    /** @brief Queries that needed an A* search. */
+    std::size_t getCacheMisses() const { return misses.load(); }
+
+private:
+    const NavMesh& mesh;
+    std::size_t capacity;
+    std::mutex cacheMutex;
+    std::unordered_map<std::uint64_t, std::vector<int>> cache;
+    std::uint32_t cacheVersion = 0;
+    std::atomic<std::size_t> hits{ 0 };
+    std::atomic<std::size_t> misses{ 0 };
+
+    bool search(int from, int to, Vec3 goal, std::vector<int>& corridor) const;
+};
@@ -0,0 +1,60 @@
+/**
+ * @file OIT.h
+ * @brief Defines weighted blended order-independent transparency.
+ *
+ * This header contains the WeightedOIT class. Transparent geometry is drawn once,
+ * in any order, into an accumulation target (premultiplied colour weighted by
+ * depth, plus revealage) and a weight target; a full-screen composite then
+ * resolves them over the opaque frame. No sorting and no second traversal are
+ * needed, so the cost does not grow with how many panes overlap.
+ */
+
+#pragma once
+#include <GL/freeglut.h>
+
+/**
+ * @class WeightedOIT
+ * @brief Render targets and shaders for weighted blended transparency.
+ */
+class WeightedOIT {
+public:
+    /**
+     * @brief Starts accumulating transparent geometry.
+     * * Copies the opaque depth buffer, binds the accumulation targets and a
+     * shader that emulates the fixed-function lighting and fog. While active,
+     * renderContext().oit and keepBlend are set so materials keep the
+     * accumulation blending.
+     * @return False if the GPU lacks the needed features (nothing is bound).
+     */
+    bool begin();
+
+    /**
+     * @brief Stops accumulating and composites the result over the frame.
+     */
+    void end();
+
+    /**
+     * @brief Switches lighting in the accumulation shader (for pre-lit vertex colours).
+     * * Only valid between begin() and end().
+     */
+    void setLighting(bool enabled);
+
+private:
+    int state = -1;            /**< -1 not initialized, 0 unsupported, 1 ready. */
+    int width = 0, height = 0;
+    GLuint framebuffer = 0;
+    GLint previousFramebuffer = 0; /**< Restored by end(). */
+    GLuint accumTexture = 0;   /**< rgb: weighted premultiplied colour, a: revealage. */
+    GLuint weightTexture = 0;  /**< r: sum of weighted alpha. */
+    GLuint depthTexture = 0;   /**< Copy of the opaque depth buffer. */
+    GLuint accumProgram = 0;
+    GLuint compositeProgram = 0;
+
+    bool init();
+    bool resize(int w, int h);
+};
+
+/**
+ * @brief Gets the engine-wide weighted blended OIT renderer.
+ */
+WeightedOIT& weightedOIT();
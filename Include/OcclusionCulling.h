@@ -0,0 +1,99 @@
+/**
+ * @file OcclusionCulling.h
+ * @brief Defines temporally coherent occlusion culling of Container subtrees.
+ *
+ * This header contains the OcclusionCuller class, a coherent hierarchical culling
+ * scheme in the style of CHC++ (Mattausch et al. 2008) for the main view. Every
+ * Container visited by the opaque pass keeps its visibility from earlier frames:
+ * hidden containers are skipped (with all their children, including those the
+ * IndirectScene draws, which the container hides there) and tested again every
+ * frame, visible ones are drawn and only re-tested after a few frames, staggered so
+ * the tests spread out. A test draws the container's world bounding box against the
+ * finished opaque depth buffer inside a GL_ANY_SAMPLES_PASSED query; results are
+ * read once available, never waited for, so a change of visibility shows up a frame
+ * or two later. Containers the camera is inside, or that come back into view, are
+ * assumed visible until a test says otherwise.
+ */
+
+#pragma once
+#include "Common.h"
+#include <GL/freeglut.h>
+#include <GL/glext.h>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class Container;
+
+/**
+ * @class OcclusionCuller
+ * @brief Skips Container subtrees hidden behind the rest of the scene.
+ */
+class OcclusionCuller {
+public:
+    /**
+     * @brief Starts the main view. Call with the camera's modelview loaded.
+     * * Does nothing (and the culler stays inactive) without ARB_occlusion_query2
+     * or with RenderSettings::occlusionCullingEnabled off.
+     */
+    void beginView();
+
+    /**
+     * @brief Decides whether a container's subtree is drawn in this view.
+     * * The opaque pass decides (and queues tests); the transparent pass reuses
+     * the decision. Always false outside beginView()/endView() and outside the
+     * main pass.
+     * @param node The container about to draw its children.
+     * @return True if it is outside the cull frustum or was found hidden.
+     */
+    bool skip(const Container* node);
+
+    /**
+     * @brief Issues the queued tests. Call once the opaque geometry is in the depth buffer.
+     */
+    void issueQueries();
+
+    /** @brief Ends the main view. */
+    void endView();
+
+    /** @brief Drops a container's state and query (when it is destroyed). */
+    void forget(const Container* node);
+
+    /** @brief Containers skipped as hidden in the last view. */
+    std::size_t getOccluded() const { return occluded; }
+
+    /** @brief Tests issued in the last view. */
+    std::size_t getQueries() const { return queries; }
+
+private:
+    /** @brief What is known about one container. */
+    struct Node {
+        AABB bounds = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };  /**< World bounds of the drawable descendants. */
+        bool boundsValid = false;
+        bool moving = false;        /**< Has a non-static descendant, so the bounds are recomputed each visit. */
+        bool visible = true;
+        unsigned long visitedFrame = 0;
+        unsigned long nextTest = 0;  /**< Frame a visible node is tested again. */
+        unsigned long skippedFrame = 0;
+        unsigned offset = 0;        /**< Staggers the re-tests of visible nodes. */
+        GLuint query = 0;
+        bool pending = false;       /**< A test is in flight. */
+        bool discard = false;       /**< The test in flight predates a gap in visits; its answer is ignored. */
+    };
+
+    std::unordered_map<const Container*, Node> nodes;
+    std::vector<Node*> queued;
+    unsigned long frame = 0;
+    Vec3 eye = { 0.0f, 0.0f, 0.0f };
+    bool active = false;
+    bool deciding = false;         /**< In the opaque pass (before issueQueries()). */
+    std::size_t occluded = 0;
+    std::size_t queries = 0;
+
+    void poll(Node& n);
+};
+
+/**
+ * @brief Gets the engine-wide occlusion culler.
+ */
+OcclusionCuller& occlusionCuller();
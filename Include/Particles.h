@@ -0,0 +1,162 @@
+/**
+ * @file Particles.h
+ * @brief Defines the particle system (sparks, exhaust, dust).
+ *
+ * This header contains the ParticleSystem class. Particles are stored as
+ * structure-of-arrays data, one contiguous segment per emitter, and are simulated
+ * with SSE kernels split across the JobSystem. Emitters can follow a GameObject
+ * (its world matrix places and orients them). Each frame the live particles are
+ * turned into camera-facing quads: particles beyond the fog distance are dropped,
+ * alpha-blended emitters are sorted back to front and additive ones are drawn
+ * unsorted. With instanced drawing available one quad is instanced per particle,
+ * otherwise the quads are expanded on the CPU.
+ */
+
+#pragma once
+#include "Common.h"
+#include "ECS.h"
+#include "GameObject.h"
+#include "JobSystem.h"
+#include <GL/freeglut.h>
+#include <cstdint>
+#include <vector>
+
+/** @brief How an emitter's particles are blended. */
+enum class ParticleBlend {
+    Additive,  /**< Glows (sparks); order-independent, drawn unsorted. */
+    Alpha      /**< Smoke and dust; sorted back to front. */
+};
+
+/**
+ * @struct EmitterSettings
+ * @brief Spawn rate, initial motion and appearance of an emitter's particles.
+ *
+ * Offsets and directions are in the owner's local space (world space for
+ * emitters without an owner).
+ */
+struct EmitterSettings {
+    float rate = 100.0f;                        /**< Particles spawned per second. */
+    float lifetime = 1.0f;                      /**< Seconds a particle lives. */
+    float lifetimeJitter = 0.0f;                /**< Random extra lifetime, up to this many seconds. */
+    Vec3 offset = { 0.0f, 0.0f, 0.0f };         /**< Spawn centre. */
+    Vec3 extent = { 0.0f, 0.0f, 0.0f };         /**< Half-size of the spawn box around the centre. */
+    Vec3 direction = { 0.0f, 1.0f, 0.0f };      /**< Mean launch direction. */
+    float spread = 0.2f;                        /**< Random deviation added to the direction (0 = none). */
+    float speed = 1.0f;                         /**< Launch speed in units per second. */
+    float speedJitter = 0.0f;                   /**< Random extra speed, up to this much. */
+    Vec3 gravity = { 0.0f, 0.0f, 0.0f };        /**< Acceleration (world space). */
+    float drag = 0.0f;                          /**< Velocity damping per second. */
+    float sizeStart = 0.05f;                    /**< Quad half-size at birth. */
+    float sizeEnd = 0.05f;                      /**< Quad half-size at death. */
+    float colorStart[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    float colorEnd[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+    ParticleBlend blend = ParticleBlend::Alpha;
+    std::size_t maxParticles = 0;               /**< Capacity (0 = enough for rate x longest lifetime). */
+};
+
+/**
+ * @class ParticleSystem
+ * @brief Structure-of-arrays storage, parallel simulation and batched drawing of particles.
+ */
+class ParticleSystem {
+public:
+    /**
+     * @brief Adds an emitter.
+     * @param owner Object the emitter is attached to (nullptr for a fixed world-space emitter).
+     * @param settings Spawn and appearance settings.
+     * @return The emitter's index.
+     */
+    int addEmitter(const GameObject* owner, const EmitterSettings& settings);
+
+    /** @brief Starts or stops spawning (live particles finish their lives). */
+    void setEmitting(int emitter, bool emitting);
+
+    /**
+     * @brief Spawns, moves and retires particles.
+     * * Call after propagateTransforms(), so emitters follow their owners.
+     * @param dt Step duration in seconds.
+     * @param pool Worker threads to split the particles across.
+     */
+    void step(float dt, JobSystem& pool);
+
+    /**
+     * @brief Draws the live particles (after the transparent pass, main view only).
+     * * Call with the camera view loaded. Particles past the draw distance or
+     * fully fogged, and chunks outside the cull frustum, are skipped.
+     */
+    void draw();
+
+    /** @brief Number of live particles. */
+    std::size_t size() const { return liveCount; }
+
+    /** @brief Particles drawn in the last draw(). */
+    std::size_t getDrawnCount() const { return drawnCount; }
+
+    /** @brief Wall time of the last step() in milliseconds. */
+    double getLastStepMs() const { return lastStepMs; }
+
+private:
+    struct Emitter {
+        EmitterSettings settings;
+        Entity owner = NullEntity;
+        std::size_t begin = 0;      /**< First slot of the emitter's segment. */
+        std::size_t capacity = 0;
+        std::size_t count = 0;      /**< Live particles, packed at the front of the segment. */
+        float pending = 0.0f;       /**< Fractional particles carried to the next step. */
+        std::uint32_t rng = 1;
+        bool emitting = true;
+    };
+
+    /** @brief A run of one emitter's particles processed (and culled) together. */
+    struct Chunk {
+        int emitter = 0;
+        std::size_t begin = 0, end = 0;
+        Vec3 min, max;              /**< Bounds after the last step. */
+        std::size_t drawn = 0;      /**< Instances written by the last draw(). */
+    };
+
+    /** @brief One quad as uploaded for drawing. */
+    struct Instance {
+        float x, y, z, size;
+        std::uint8_t color[4];
+    };
+
+    std::vector<Emitter> emitters;
+
+    // Per-particle state, one entry per slot in each array
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> velX, velY, velZ;
+    std::vector<float> age;        /**< Normalized age; the particle dies at 1. */
+    std::vector<float> ageRate;    /**< 1 / lifetime. */
+
+    std::vector<Chunk> chunks;
+    std::vector<Instance> scratch;      /**< Per-chunk regions written in parallel. */
+    std::vector<Instance> batch;        /**< Additive instances, then sorted alpha instances. */
+    std::vector<Instance> sorted;
+    std::vector<std::uint32_t> keys[2], order[2];
+
+    std::size_t liveCount = 0;
+    std::size_t drawnCount = 0;
+    double lastStepMs = 0.0;
+
+    int instancingState = -1;  /**< -1 not checked, 0 CPU-expanded quads, 1 instanced. */
+    GLuint program = 0;
+    GLuint cornerBuffer = 0, instanceBuffer = 0;
+    GLuint spriteTexture = 0;
+    std::vector<float> quadVertices;
+    std::vector<std::uint8_t> quadColors;
+
+    void spawn(Emitter& emitter, std::size_t count);
+    void simulate(Chunk& chunk, float dt);
+    void retire(Emitter& emitter);
+    void buildChunks();
+    void sortBackToFront(std::size_t first, std::size_t count, const float viewPlane[4]);
+    bool prepareInstancing();
+    void drawInstanced(std::size_t additive, std::size_t alpha, const float right[3], const float up[3]);
+    void drawExpanded(std::size_t additive, std::size_t alpha, const float right[3], const float up[3]);
+};
+
+/**
+ * @brief Gets the engine-wide particle system.
+ */
+ParticleSystem& particles();
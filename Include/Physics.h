@@ -0,0 +1,218 @@
+/**
+ * @file Physics.h
+ * @brief Defines the collision broadphase, body overlap test and trigger volumes.
+ *
+ * This header contains the Broadphase class (a uniform grid over the world-space
+ * bounds of every CollisionBox), the OBB-versus-body overlap test and character
+ * controller shared by the player and other movers, and the TriggerSystem that
+ * turns overlaps with trigger boxes into enter/stay/exit events.
+ */
+
+#pragma once
+#include "GameObject.h"
+#include "Delegate.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Checks if an upright body overlaps a CollisionBox.
+ * * Uses local space transformation to handle Oriented Bounding Box (OBB) collision.
+ * The body is a vertical box of the given radius whose top sits at (px, py, pz)
+ * and which extends `height` units downwards (eye level to feet).
+ * @param box The collision box to check against.
+ * @param px Body top X.
+ * @param py Body top Y.
+ * @param pz Body top Z.
+ * @param radius Horizontal radius of the body.
+ * @param height Height of the body.
+ * @return True if the body intersects the box.
+ */
+bool overlapsBody(const CollisionBox* box, float px, float py, float pz, float radius, float height);
+
+/**
+ * @brief Computes the world-space bounds of a body (see overlapsBody()).
+ */
+AABB bodyBounds(float px, float py, float pz, float radius, float height);
+
+/**
+ * @class Broadphase
+ * @brief Uniform XZ grid over the world bounds of registered CollisionBoxes.
+ *
+ * Bounds are refreshed from the ECS world matrices by update(); only boxes whose
+ * bounds changed are re-bucketed, and those are reported as moved for the frame.
+ * Queries are read-only and may run concurrently with each other.
+ */
+class Broadphase {
+public:
+    /**
+     * @brief Constructs an empty broadphase.
+     * @param cellSize Edge length of a grid cell in world units.
+     */
+    explicit Broadphase(float cellSize = 2.0f);
+
+    /** @brief Registers a single collision box. */
+    void add(CollisionBox* box);
+
+    /** @brief Registers every CollisionBox in a subtree (or the node itself). */
+    void addHierarchy(GameObject* node);
+
+    /**
+     * @brief Refreshes the bounds of every box from its WorldMatrix.
+     * * Call after propagateTransforms().
+     */
+    void update(const Registry& reg);
+
+    /**
+     * @brief Collects every box whose bounds overlap a region.
+     * @param bounds The query region.
+     * @param out Receives each overlapping box once.
+     */
+    void query(const AABB& bounds, std::vector<CollisionBox*>& out) const;
+
+    /**
+     * @brief Checks if a body overlaps any solid (non-trigger) box.
+     * @return True if the body is blocked at that position.
+     */
+    bool isBlocked(float px, float py, float pz, float radius, float height) const;
+
+    /**
+     * @brief Gets the world bounds of a registered box as of the last update().
+     * @return False if the box is not registered.
+     */
+    bool getBounds(const CollisionBox* box, AABB& out) const;
+
+    /** @brief Checks if a box's bounds changed in the last update(). */
+    bool hasMoved(const CollisionBox* box) const;
+
+    /** @brief Boxes whose bounds changed in the last update(). */
+    const std::vector<CollisionBox*>& getMoved() const { return moved; }
+
+    /** @brief Number of registered boxes. */
+    std::size_t size() const { return entries.size(); }
+
+private:
+    struct Entry {
+        CollisionBox* box;
+        AABB bounds;
+        int x0, z0, x1, z1; /**< Inclusive cell range covered by bounds. */
+        bool moved;
+    };
+
+    float cellSize;
+    std::vector<Entry> entries;
+    std::unordered_map<const CollisionBox*, std::uint32_t> entryOf;
+    std::unordered_map<std::int64_t, std::vector<std::uint32_t>> cells;
+    std::vector<CollisionBox*> moved;
+
+    static std::int64_t cellKey(int x, int z) {
+        return ((std::int64_t)x << 32) ^ (std::uint32_t)z;
+    }
+
+    int cellCoord(float v) const;
+    void insertCells(std::uint32_t index);
+    void removeCells(std::uint32_t index);
+};
+
+/**
+ * @struct CharacterBody
+ * @brief Physical parameters of an upright walking body.
+ */
+struct CharacterBody {
+    float radius;  /**< Horizontal collision radius. */
+    float height;  /**< Eye level above the feet; also the standing height over the floor. */
+    float gravity; /**< Downward acceleration in units per second squared. */
+};
+
+/**
+ * @brief Advances a walking character by one step.
+ * * Applies gravity, the floor ground check and vertical box collision, then
+ * tries the horizontal move one axis at a time so bodies slide along walls.
+ * Only reads the broadphase, so many characters can be stepped in parallel.
+ * @param broadphase Solid geometry to collide against.
+ * @param body The character's physical parameters.
+ * @param moveX Horizontal displacement requested this step (X).
+ * @param moveZ Horizontal displacement requested this step (Z).
+ * @param dt Step duration in seconds.
+ * @param x In/out body top X.
+ * @param y In/out body top Y (eye level).
+ * @param z In/out body top Z.
+ * @param velocityY In/out vertical velocity.
+ * @return True if the full horizontal move was possible (false if blocked on an axis).
+ */
+bool stepCharacter(const Broadphase& broadphase, const CharacterBody& body,
+                   float moveX, float moveZ, float dt,
+                   float& x, float& y, float& z, float& velocityY);
+
+/** @brief The kind of trigger event. */
+enum class TriggerEventType { Enter, Stay, Exit };
+
+/**
+ * @struct TriggerEvent
+ * @brief Describes an agent entering, staying in, or leaving a trigger.
+ */
+struct TriggerEvent {
+    TriggerEventType type;
+    CollisionBox* trigger;
+    /** @brief Agent id (0 is the player). */
+    int agent;
+    /** @brief The agent's position when the event was generated. */
+    Vec3 agentPosition;
+    /** @brief Number of agents inside the trigger after this event. */
+    int occupants;
+};
+
+/** @brief Callback receiving trigger events. */
+using TriggerCallback = Delegate<void(const TriggerEvent&)>;
+
+/**
+ * @class TriggerSystem
+ * @brief Tracks agent/trigger overlap pairs and dispatches events in a batch.
+ *
+ * Pairs are recomputed incrementally: agents that did not move only re-test the
+ * triggers they were in plus any triggers the broadphase reports as moved.
+ */
+class TriggerSystem {
+public:
+    /**
+     * @brief Turns a registered CollisionBox into a trigger volume.
+     * @param box A box already added to the broadphase.
+     * @param callback Receives events for this trigger (may be empty).
+     */
+    void addTrigger(CollisionBox* box, TriggerCallback callback);
+
+    /**
+     * @brief Updates (or creates) an agent's body for this frame.
+     * @param agent Agent id (0 is the player).
+     */
+    void setAgent(int agent, Vec3 position, float radius, float height);
+
+    /** @brief Removes an agent, generating exit events on the next update(). */
+    void removeAgent(int agent);
+
+    /**
+     * @brief Recomputes overlap pairs and dispatches all resulting events.
+     * * Call once per frame after physics and Broadphase::update().
+     */
+    void update(const Broadphase& broadphase);
+
+private:
+    struct Agent {
+        Vec3 position = { 0, 0, 0 };
+        float radius = 0.0f;
+        float height = 0.0f;
+        bool active = false;
+        bool moved = true;
+        std::vector<CollisionBox*> inside; /**< Sorted triggers currently overlapped. */
+    };
+
+    struct Trigger {
+        TriggerCallback callback;
+        int occupants = 0;
+    };
+
+    std::vector<Agent> agents;
+    std::unordered_map<CollisionBox*, Trigger> triggers;
+    std::vector<TriggerEvent> pending;
+    std::vector<CollisionBox*> scratch;
+};
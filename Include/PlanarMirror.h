@@ -0,0 +1,85 @@
+/**
+ * @file PlanarMirror.h
+ * @brief Defines planar reflections for mirror panes.
+ *
+ * This header contains the PlanarMirrors class. Every object tagged "mirror" is
+ * treated as a flat pane; panes lying in the same plane are grouped, and each
+ * visible group renders the scene mirrored about its plane once per frame into
+ * a reduced-resolution texture. The reflected pass is clipped at the mirror
+ * plane and culled to the volume seen through the panes, so its cost follows
+ * what the mirror can actually see.
+ */
+
+#pragma once
+#include "Common.h"
+#include "Delegate.h"
+#include "Frustum.h"
+#include <GL/freeglut.h>
+#include <unordered_map>
+#include <vector>
+
+class GameObject;
+
+/**
+ * @class PlanarMirrors
+ * @brief The scene's mirror panes and their reflection textures.
+ */
+class PlanarMirrors {
+public:
+    /** @brief Draws the world with the current projection and modelview. */
+    using RenderFn = Delegate<void()>;
+
+    /** @brief Draws the mirror's mesh (same geometry as the normal pass). */
+    using MeshFn = Delegate<void()>;
+
+    /**
+     * @brief Renders the reflection of every visible mirror group.
+     * * Call with the camera's projection and view loaded, before the main view
+     * clears the frame (the back buffer is used as scratch space). Objects are
+     * drawn in RenderPass::Reflection with the group's cull frustum set.
+     * @param resolutionScale Reflection size relative to the viewport (0 - 1].
+     * @param renderWorld Draws the scene.
+     * @return The number of reflections rendered.
+     */
+    int render(float resolutionScale, const RenderFn& renderWorld);
+
+    /**
+     * @brief Draws the planar reflection over a mirror pane.
+     * * Call with the pane's transform applied, in the main pass.
+     * @param obj The object being drawn.
+     * @param drawMesh Re-draws the object's geometry.
+     * @return False if the object has no reflection this frame (not a mirror, or
+     * its group was not rendered).
+     */
+    bool drawMirror(const GameObject* obj, const MeshFn& drawMesh) const;
+
+    /** @brief Number of coplanar groups found by the last render(). */
+    std::size_t groupCount() const { return groups.size(); }
+
+private:
+    struct Group {
+        PlaneEq plane;                 /**< Reflecting surface, normal towards the camera. */
+        std::vector<Vec3> corners;     /**< Rectangle covering every pane, on the plane. */
+        bool visible = false;
+        bool rendered = false;
+    };
+
+    struct Target {
+        GLuint texture = 0;
+        int texWidth = 0, texHeight = 0;
+        float textureMatrix[16];       /**< Eye space to reflection texture coordinates. */
+    };
+
+    std::vector<Group> groups;
+    std::vector<Target> targets;       /**< Indexed like groups; kept between frames. */
+    std::unordered_map<const GameObject*, std::size_t> groupOf;
+
+    void buildGroups(const Vec3& eye, const Frustum& view);
+    void renderGroup(const Group& group, Target& target, const Vec3& eye, const float projection[16],
+                     int width, int height, const RenderFn& renderWorld);
+};
+
+/**
+ * @brief Gets the engine-wide planar mirrors.
+ */
+PlanarMirrors& planarMirrors();
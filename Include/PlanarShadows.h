@@ -0,0 +1,107 @@
+/**
+ * @file PlanarShadows.h
+ * @brief Defines the culled and cached planar shadow pass.
+ *
+ * This header contains the PlanarShadows class and buildShadowMatrix(). Shadows are
+ * the casters flattened onto the ground along the sun direction. Casters that
+ * nothing moves are flattened once, at load, with OpenGL feedback mode and merged
+ * into a few ground tiles of pre-projected triangles; each frame only the tiles in
+ * view are drawn. Moving casters (doors, turntables) are drawn through the shadow
+ * matrix as before, but only when their bounds, projected onto the ground the same
+ * way, reach into the view. Cached casters are checked a few per frame, and the
+ * cache is rebuilt if one of them has moved after all.
+ */
+
+#pragma once
+#include "Common.h"
+#include "ECS.h"
+#include <cstddef>
+#include <vector>
+
+class Frustum;
+class GameObject;
+
+/**
+ * @brief Constructs a planar shadow projection matrix.
+ * @param fMatrix Output 4x4 matrix.
+ * @param fLightPos Position of the light source (x, y, z, w).
+ * @param fPlane Plane equation (Ax + By + Cz + D = 0).
+ */
+void buildShadowMatrix(float fMatrix[16], const float fLightPos[4], const float fPlane[4]);
+
+/**
+ * @class PlanarShadows
+ * @brief Draws the flattened shadows of the opaque top-level casters.
+ *
+ * Inside a caster, every leaf with castsShadow set contributes (collision boxes
+ * and transparent prefab batches do not).
+ */
+class PlanarShadows {
+public:
+    /**
+     * @brief Sorts the casters into cached and moving ones and flattens the cached ones.
+     * * Call after propagateTransforms(), and again after casters are added or removed.
+     * @param roots Top-level scene objects; the opaque ones with castsShadow set cast.
+     * @param light Light position (w = 0 for a directional light).
+     * @param plane Ground plane the shadows fall on.
+     */
+    void build(const std::vector<GameObject*>& roots, const float light[4], const float plane[4]);
+
+    /**
+     * @brief Draws the shadows seen by a view.
+     * * Call with the camera's modelview loaded and the shadow colour, depth and
+     * offset state set up; the render context should be in the Shadow pass.
+     * @param view Frustum the shadows must reach into (null draws everything).
+     */
+    void draw(const Frustum* view);
+
+    /** @brief Flattens the cached casters again at the next draw(). */
+    void invalidate() { dirty = true; }
+
+    /** @brief Triangles in the cached shadow tiles. */
+    std::size_t cachedTriangles() const;
+
+    /** @brief Casters drawn live every frame they are in view. */
+    std::size_t movingCasters() const { return moving.size(); }
+
+    /** @brief Moving casters drawn by the last draw(). */
+    std::size_t getDrawnMoving() const { return drawnMoving; }
+
+private:
+    /** @brief Cached shadow triangles whose centres fall in one ground cell. */
+    struct Tile {
+        std::vector<float> opaque;       /**< x, y, z per vertex, three per triangle. */
+        std::vector<float> transparent;  /**< Triangles of transparent casters (blended). */
+        AABB bounds = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+    };
+
+    /** @brief A cached leaf and the world matrix it was flattened with. */
+    struct Snapshot {
+        Entity entity;
+        WorldMatrix matrix;
+    };
+
+    std::vector<GameObject*> roots;
+    std::vector<GameObject*> cached;    /**< Static leaves, flattened into the tiles. */
+    std::vector<Snapshot> snapshots;    /**< Matches `cached`. */
+    std::vector<GameObject*> moving;
+    std::vector<Tile> tiles;
+    float light[4] = { 0.0f, 1.0f, 0.0f, 0.0f };
+    float plane[4] = { 0.0f, 1.0f, 0.0f, 0.0f };
+    float shadowMatrix[16] = {};
+    std::size_t checkCursor = 0;        /**< Next snapshot verified by draw(). */
+    int builtTessellation = 0;          /**< Cylinder slices in the cached tiles. */
+    std::size_t drawnMoving = 0;
+    bool dirty = false;
+
+    void rebuild();
+    void collect(GameObject* obj);
+    void capture();
+    bool snapshotsMoved();
+    AABB projectBounds(const AABB& box) const;
+};
+
+/**
+ * @brief Gets the engine-wide planar shadow renderer.
+ */
+PlanarShadows& planarShadows();
@@ -0,0 +1,60 @@
+/**
+ * @file PosterRenderer.h
+ * @brief Defines tiled rendering of images larger than the framebuffer limits.
+ *
+ * This header contains the PosterRenderer class. The camera projection is split
+ * into a grid of sub-frusta (one glFrustum window per tile); each tile is drawn
+ * offscreen at tile size with its own cull frustum, read back and written
+ * straight to its place in a binary PPM file. Only one tile is ever held in
+ * memory, so the output size is limited by disk space, not by GL_MAX_VIEWPORT_DIMS
+ * or video memory.
+ */
+
+#pragma once
+#include "Delegate.h"
+#include <GL/freeglut.h>
+#include <string>
+
+/**
+ * @class PosterRenderer
+ * @brief Renders the current view as a grid of tiles into one large image.
+ */
+class PosterRenderer {
+public:
+    /**
+     * @brief Draws one tile.
+     * * Called with the tile's target bound, its viewport set and its projection
+     * and the camera view loaded; it must clear and draw the frame.
+     */
+    using TileFn = Delegate<void()>;
+
+    /**
+     * @brief Renders a poster with the camera view currently loaded in the modelview.
+     * @param path Output file (binary PPM).
+     * @param width Poster width in pixels.
+     * @param height Poster height in pixels.
+     * @param fovY Vertical field of view of the whole poster (degrees).
+     * @param zNear Near plane.
+     * @param zFar Far plane.
+     * @param drawTile Draws a tile (see TileFn).
+     * @return False if the file could not be written.
+     */
+    bool render(const std::string& path, int width, int height, double fovY, double zNear, double zFar,
+                const TileFn& drawTile);
+
+    /** @brief Largest tile side to use (clamped to the GL limits). */
+    void setMaxTileSize(int size) { maxTileSize = size; }
+
+private:
+    int maxTileSize = 2048;
+    GLuint framebuffer = 0;
+    GLuint colorTexture = 0, depthTexture = 0;
+    int targetSize = 0;
+
+    bool prepareTarget(int size);
+};
+
+/**
+ * @brief Gets the engine-wide poster renderer.
+ */
+PosterRenderer& posterRenderer();
@@ -0,0 +1,240 @@
+/**
+ * @file Prefabs.h
+ * @brief Defines compile-time layouts for the procedural furniture and walls.
+ *
+ * This header contains the box layouts behind createGlassWall(), createGlassTable()
+ * and createModernChair(): constexpr builders that place every pillar, pane, leg
+ * and slat into a fixed-size array of transforms and material slots. With constant
+ * dimensions the arrays are computed by the compiler and live in read-only data;
+ * the same builders run at run time for dynamic dimensions. PartBatch draws the
+ * boxes of one material slot as a single vertex array, so a prefab costs one
+ * GameObject per material instead of one per part.
+ */
+
+#pragma once
+#include "GameObject.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Container;
+
+namespace Prefab {
+
+/**
+ * @struct Part
+ * @brief One box of a layout.
+ *
+ * The unit cube is scaled, moved to `position`, then tilted by `pitch` degrees
+ * about the X axis through `pivot` (how the chair leans its backrest).
+ */
+struct Part {
+    float position[3] = { 0.0f, 0.0f, 0.0f };
+    float scale[3] = { 1.0f, 1.0f, 1.0f };
+    float pivot[3] = { 0.0f, 0.0f, 0.0f };
+    float pitch = 0.0f;
+    std::uint8_t material = 0;  /**< Slot in the material table passed to instantiate(). */
+};
+
+/** @brief Material slots of the glass wall and table layouts. */
+enum : std::uint8_t { FrameSlot = 0, GlassSlot = 1 };
+
+/** @brief Makes an untilted part. */
+constexpr Part box(float x, float y, float z, float sx, float sy, float sz, std::uint8_t material) {
+    Part p;
+    p.position[0] = x; p.position[1] = y; p.position[2] = z;
+    p.scale[0] = sx; p.scale[1] = sy; p.scale[2] = sz;
+    p.material = material;
+    return p;
+}
+
+// --- Glass wall ---
+
+/**
+ * @brief Number of panes that fit a wall: N panes and N + 1 pillars, at least one pane.
+ */
+constexpr int glassWallPaneCount(float length, float paneWidth, float pillarThickness = 0.2f) {
+    int panes = (int)((length - pillarThickness) / (paneWidth + pillarThickness));
+    return panes < 1 ? 1 : panes;
+}
+
+/** @brief Number of parts in a wall of `panes` panes. */
+constexpr std::size_t glassWallPartCount(int panes) { return (std::size_t)(2 * panes + 1); }
+
+/**
+ * @brief Writes a wall of alternating pillars and panes, centred on X, standing on y = 0.
+ * @param out Receives glassWallPartCount(panes) parts.
+ */
+constexpr void buildGlassWall(Part* out, int panes, float height, float paneWidth, float pillarThickness) {
+    const float glassDepth = 0.05f;
+    float total = panes * paneWidth + (panes + 1) * pillarThickness;
+    float x = -total / 2.0f;
+    std::size_t n = 0;
+
+    for (int i = 0; i <= panes; ++i) {
+        out[n++] = box(x + pillarThickness / 2.0f, height / 2.0f, 0.0f,
+                       pillarThickness, height, pillarThickness, FrameSlot);
+        x += pillarThickness;
+
+        if (i < panes) {
+            out[n++] = box(x + paneWidth / 2.0f, height / 2.0f, 0.0f, paneWidth, height, glassDepth, GlassSlot);
+            x += paneWidth;
+        }
+    }
+}
+
+/**
+ * @brief Compile-time wall layout; use glassWallPaneCount() for `Panes`.
+ */
+template <int Panes>
+constexpr std::array<Part, glassWallPartCount(Panes)> glassWall(float height, float paneWidth,
+                                                                 float pillarThickness = 0.2f) {
+    std::array<Part, glassWallPartCount(Panes)> parts{};
+    buildGlassWall(&parts[0], Panes, height, paneWidth, pillarThickness);
+    return parts;
+}
+
+// --- Glass table ---
+
+/** @brief Four legs, four frame bars and the glass top. */
+constexpr std::size_t GlassTablePartCount = 9;
+
+/** @brief Metal-framed glass table standing on y = 0. */
+constexpr std::array<Part, GlassTablePartCount> glassTable(float width, float height, float depth) {
+    const float legThick = 0.1f;
+    const float frameThick = 0.1f;
+    const float glassThick = 0.05f;
+    float legX = width / 2.0f - legThick / 2.0f;
+    float legZ = depth / 2.0f - legThick / 2.0f;
+    float frameY = height - frameThick / 2.0f;
+
+    std::array<Part, GlassTablePartCount> parts{};
+    std::size_t n = 0;
+    for (int xDir = -1; xDir <= 1; xDir += 2) {
+        for (int zDir = -1; zDir <= 1; zDir += 2) {
+            parts[n++] = box(xDir * legX, height / 2.0f, zDir * legZ, legThick, height, legThick, FrameSlot);
+        }
+    }
+    for (int dir = -1; dir <= 1; dir += 2) {
+        parts[n++] = box(0.0f, frameY, dir * legZ, width, frameThick, legThick, FrameSlot);
+        parts[n++] = box(dir * legX, frameY, 0.0f, legThick, frameThick, depth - 2 * legThick, FrameSlot);
+    }
+    parts[n++] = box(0.0f, frameY, 0.0f, width - legThick, glassThick, depth - legThick, GlassSlot);
+    return parts;
+}
+
+// --- Modern chair ---
+
+/** @brief Four legs, the seat, two backrest supports and three slats. */
+constexpr std::size_t ModernChairPartCount = 10;
+
+/** @brief Seat height of the modern chair. */
+constexpr float ChairSeatHeight = 0.45f;
+
+/** @brief Height of the chair's backrest supports. */
+constexpr float ChairBackHeight = 0.5f;
+
+/** @brief Width and depth of the chair's seat. */
+constexpr float ChairSeatSize = 0.45f;
+
+/** @brief Single-material chair with a backrest leaning back 15 degrees. */
+constexpr std::array<Part, ModernChairPartCount> modernChair() {
+    const float legThick = 0.04f;
+    const float legOffset = ChairSeatSize / 2.0f - legThick;
+    const int slatCount = 3;
+    const float slatStart = 0.2f;
+    const float slatGap = (ChairBackHeight - slatStart) / slatCount;
+
+    std::array<Part, ModernChairPartCount> parts{};
+    std::size_t n = 0;
+    for (int xDir = -1; xDir <= 1; xDir += 2) {
+        for (int zDir = -1; zDir <= 1; zDir += 2) {
+            parts[n++] = box(xDir * legOffset, ChairSeatHeight / 2.0f, zDir * legOffset,
+                             legThick, ChairSeatHeight, legThick, 0);
+        }
+    }
+    parts[n++] = box(0.0f, ChairSeatHeight, 0.0f, ChairSeatSize, 0.06f, ChairSeatSize, 0);
+
+    // The backrest pivots at the back of the seat
+    std::size_t backStart = n;
+    for (int xDir = -1; xDir <= 1; xDir += 2) {
+        parts[n++] = box(xDir * legOffset, ChairBackHeight / 2.0f, 0.0f, legThick, ChairBackHeight, legThick, 0);
+    }
+    for (int i = 0; i < slatCount; ++i) {
+        parts[n++] = box(0.0f, slatStart + i * slatGap + 0.05f, 0.0f, ChairSeatSize, 0.03f, 0.02f, 0);
+    }
+    for (std::size_t i = backStart; i < n; ++i) {
+        parts[i].pivot[1] = ChairSeatHeight;
+        parts[i].pivot[2] = -ChairSeatSize / 2.0f + 0.05f;
+        parts[i].pitch = -15.0f;
+    }
+    return parts;
+}
+
+// --- Instancing ---
+
+/**
+ * @brief Builds a Container holding one PartBatch per material slot the layout uses.
+ * * Batches with a transparent material do not cast shadows.
+ * @param parts The layout (may be a temporary; the boxes are copied into vertex arrays).
+ * @param count Number of parts.
+ * @param materials Material of each slot.
+ * @param materialCount Number of slots.
+ */
+Container* instantiate(const Part* parts, std::size_t count, const Material* materials, std::size_t materialCount);
+
+/** @brief instantiate() for a std::array layout. */
+template <std::size_t N, std::size_t M>
+Container* instantiate(const std::array<Part, N>& parts, const std::array<Material, M>& materials) {
+    return instantiate(parts.data(), N, materials.data(), M);
+}
+
+/**
+ * @brief Gets the box around every part of a layout (tilted parts included).
+ * @param parts The layout.
+ * @param count Number of parts.
+ * @return The layout-space bounds (empty at the origin for no parts).
+ */
+AABB bounds(const Part* parts, std::size_t count);
+
+/** @brief bounds() for a std::array layout. */
+template <std::size_t N>
+AABB bounds(const std::array<Part, N>& parts) { return bounds(parts.data(), N); }
+
+} // namespace Prefab
+
+/**
+ * @class PartBatch
+ * @brief Draws the boxes of one material slot of a layout in a single call.
+ *
+ * The boxes are expanded once into an interleaved normal/position array; clones
+ * share it.
+ */
+class PartBatch : public GameObject {
+public:
+    /**
+     * @brief Expands the parts of a layout that use one material slot.
+     * @param parts The layout.
+     * @param count Number of parts.
+     * @param slot The material slot to take.
+     */
+    PartBatch(const Prefab::Part* parts, std::size_t count, std::uint8_t slot);
+
+    /** @brief Number of boxes drawn. */
+    std::size_t size() const { return vertices->size() / FloatsPerBox; }
+
+    /** @brief The expanded boxes: quads of normal and position (GL_N3F_V3F), shared with clones. */
+    const std::shared_ptr<const std::vector<float>>& getVertices() const { return vertices; }
+
+    AABB getLocalBounds() const override { return bounds; }
+    void drawMesh() override;
+    GameObject* clone() const override { return new PartBatch(*this); }
+
+private:
+    /** @brief Six quads of normal and position (GL_N3F_V3F). */
+    static const std::size_t FloatsPerBox = 6 * 4 * 6;
+
+    std::shared_ptr<const std::vector<float>> vertices;
+    AABB bounds = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+};
@@ -0,0 +1,77 @@
+/**
+ * @file Profiler.h
+ * @brief Defines a lightweight per-frame CPU profiler.
+ *
+ * This header contains the FrameProfiler class, which measures the total frame
+ * time and named sections within the frame (e.g., "agents", "render"). Values are
+ * smoothed with an exponential moving average so they can drive on-screen stats
+ * and runtime quality decisions.
+ */
+
+#pragma once
+#include <chrono>
+#include <vector>
+
+/**
+ * @class FrameProfiler
+ * @brief Records frame time and named section times on the main thread.
+ */
+class FrameProfiler {
+public:
+    /**
+     * @class Scope
+     * @brief RAII helper that times the enclosing block as a section.
+     */
+    class Scope {
+    public:
+        Scope(FrameProfiler& p, const char* section);
+        ~Scope();
+    private:
+        FrameProfiler& profiler;
+        const char* section;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /** @brief Marks the start of a new frame (and the end of the previous one). */
+    void beginFrame();
+
+    /**
+     * @brief Adds time to a section for the current frame.
+     * @param section A string literal naming the section.
+     * @param ms Milliseconds spent.
+     */
+    void addSample(const char* section, double ms);
+
+    /** @brief Smoothed total frame time in milliseconds. */
+    double getFrameMs() const { return frameMs; }
+
+    /** @brief Last complete frame time in milliseconds (unsmoothed). */
+    double getLastFrameMs() const { return lastFrameMs; }
+
+    /** @brief Smoothed time of a section in milliseconds (0 if never sampled). */
+    double getSectionMs(const char* section) const;
+
+    /** @brief Number of frames recorded so far. */
+    unsigned long getFrameCount() const { return frameCount; }
+
+private:
+    struct Section {
+        const char* name;
+        double current; /**< Accumulated during the frame in progress. */
+        double average; /**< Smoothed over completed frames. */
+    };
+
+    std::vector<Section> sections;
+    std::chrono::steady_clock::time_point frameStart;
+    bool started = false;
+    double frameMs = 0.0;
+    double lastFrameMs = 0.0;
+    unsigned long frameCount = 0;
+
+    Section& find(const char* section);
+};
+
+/**
+ * @brief Gets the engine-wide frame profiler.
+ */
+FrameProfiler& profiler();
@@ -0,0 +1,108 @@
+/**
+ * @file QualityGovernor.h
+ * @brief Defines the automatic quality governor.
+ *
+ * This header contains the QualityGovernor class, which watches the frame
+ * profiler and steps through a fixed list of quality tiers (point lights,
+ * shadows, level-of-detail bias, primitive tessellation, draw distance and
+ * transparency resolution) until the frame budget is sustained. Decisions use
+ * hysteresis and a lock-in period, and are logged (through LOG_INFO, to stderr),
+ * so one build can run on very different machines without per-machine tuning.
+ * Every tier change overwrites the governed RenderSettings fields; the
+ * transparency resolution is capped by maxTransparencyResolutionScale, so a
+ * scale set by hand is kept as an upper bound.
+ */
+
+#pragma once
+#include "RenderSettings.h"
+
+/**
+ * @struct QualityTier
+ * @brief The values of every governed knob at one quality level.
+ */
+struct QualityTier {
+    const char* name;
+    int maxPointLights;                 /**< Nearest point lights kept enabled. */
+    bool shadows;                       /**< Planar projected shadows. */
+    float lodBias;                      /**< Multiplies impostor and HLOD thresholds. */
+    int tessellation;                   /**< Plane grid cells / cylinder slices per side. */
+    float drawDistance;                 /**< Far plane; fog thickens to hide the cut. */
+    float transparencyResolutionScale;  /**< See RenderSettings. */
+};
+
+/**
+ * @class QualityGovernor
+ * @brief Steps quality tiers to hold a frame-time budget.
+ */
+class QualityGovernor {
+public:
+    /** @brief Seconds over budget before stepping down. */
+    static constexpr float DowngradeDelay = 1.0f;
+
+    /** @brief Seconds well under budget before stepping up. */
+    static constexpr float UpgradeDelay = 5.0f;
+
+    /** @brief Frames must be under this fraction of the budget to count towards an upgrade. */
+    static constexpr float UpgradeHeadroom = 0.7f;
+
+    /**
+     * @brief Seconds an upgrade is on probation; falling back within it locks the
+     * lower tier in (doubling each time, up to MaxLockIn).
+     */
+    static constexpr float Probation = 4.0f;
+
+    /** @brief First lock-in period in seconds. */
+    static constexpr float BaseLockIn = 20.0f;
+
+    /** @brief Longest lock-in period in seconds. */
+    static constexpr float MaxLockIn = 160.0f;
+
+    /** @brief Gets the tier table, from highest to lowest quality. */
+    static const QualityTier* tiers();
+
+    /** @brief Number of tiers. */
+    static int tierCount();
+
+    /**
+     * @brief Feeds one frame to the governor.
+     * * Quality is only lowered once dynamic resolution is at its floor, and only
+     * raised once it is back at native resolution, so the two controllers do not
+     * fight over the same budget.
+     * @param dt Seconds since the last call.
+     * @param frameMs Smoothed frame time (FrameProfiler::getFrameMs()).
+     * @param budgetMs Target frame time.
+     * @param resolutionAtMin True if dynamic resolution cannot go lower.
+     * @param resolutionAtMax True if dynamic resolution is at native resolution.
+     */
+    void update(float dt, double frameMs, double budgetMs, bool resolutionAtMin, bool resolutionAtMax);
+
+    /**
+     * @brief Selects a tier and writes its values into the settings.
+     * * The transparency resolution never exceeds
+     * RenderSettings::maxTransparencyResolutionScale.
+     * @param tier Index into tiers() (clamped).
+     * @param settings The settings to change.
+     */
+    void apply(int tier, RenderSettings& settings);
+
+    /** @brief Current tier index (0 = highest quality). */
+    int getTier() const { return tier; }
+
+    /** @brief Name of the current tier. */
+    const char* getTierName() const { return tiers()[tier].name; }
+
+private:
+    int tier = 0;
+    float overBudget = 0.0f;    /**< Seconds continuously over budget. */
+    float underBudget = 0.0f;   /**< Seconds continuously well under budget. */
+    float sinceUpgrade = 1e9f;  /**< Seconds since the last step up. */
+    float lockIn = 0.0f;        /**< Seconds left before upgrades are allowed again. */
+    float nextLockIn = BaseLockIn;
+
+    void change(int newTier, double frameMs, double budgetMs, const char* reason);
+};
+
+/**
+ * @brief Gets the engine-wide quality governor.
+ */
+QualityGovernor& qualityGovernor();
@@ -0,0 +1,95 @@
+/**
+ * @file ReflectionProbe.h
+ * @brief Defines time-sliced cube map reflection probes.
+ *
+ * This header contains the ReflectionProbes class, which owns a set of cube maps
+ * placed in the scene. Faces are re-rendered at low resolution a few per frame,
+ * round-robin, and only after nearby content changed. Reflective materials draw
+ * an extra pass that samples the nearest probe with reflection-map texgen.
+ */
+
+#pragma once
+#include "Common.h"
+#include "Delegate.h"
+#include <GL/freeglut.h>
+#include <vector>
+
+/**
+ * @class ReflectionProbes
+ * @brief The scene's reflection probes and their update schedule.
+ */
+class ReflectionProbes {
+public:
+    /** @brief Draws the world with the current projection and modelview. */
+    using RenderFn = Delegate<void()>;
+
+    /** @brief Draws the reflected mesh (same geometry as the normal pass). */
+    using MeshFn = Delegate<void()>;
+
+    /**
+     * @brief Places a probe.
+     * @param position Capture point in world space.
+     * @param radius Influence radius; changes within it mark the probe dirty.
+     * @return The probe index.
+     */
+    int add(Vec3 position, float radius);
+
+    /**
+     * @brief Marks every probe whose influence overlaps a sphere as dirty.
+     * @param center Centre of the changed content (world space).
+     * @param radius Radius of the changed content.
+     */
+    void markDirty(Vec3 center, float radius);
+
+    /** @brief Marks every face of every probe dirty. */
+    void markAllDirty();
+
+    /**
+     * @brief Re-renders up to `faceBudget` dirty faces, continuing round-robin.
+     * * Uses the back buffer as scratch space, so call it before the main view
+     * clears the frame. Objects are drawn in RenderPass::Reflection.
+     * @param faceBudget Maximum faces to render this frame.
+     * @param resolution Cube face size in pixels (clamped to the window size).
+     * @param renderWorld Draws the scene.
+     * @return The number of faces rendered.
+     */
+    int update(int faceBudget, int resolution, const RenderFn& renderWorld);
+
+    /**
+     * @brief Records the camera rotation for this frame.
+     * * Call after the camera's view matrix is loaded, before drawing reflections.
+     */
+    void beginView();
+
+    /**
+     * @brief Draws a reflection layer over a mesh from the nearest probe.
+     * @param worldPosition Object position used to pick the probe.
+     * @param strength Opacity of the reflection (0 - 1).
+     * @param drawMesh Re-draws the object's geometry.
+     */
+    void drawReflection(Vec3 worldPosition, float strength, const MeshFn& drawMesh) const;
+
+    /** @brief Number of probes. */
+    std::size_t size() const { return probes.size(); }
+
+private:
+    struct Probe {
+        Vec3 position;
+        float radius;
+        GLuint texture = 0;
+        int resolution = 0;
+        bool dirty[6] = { true, true, true, true, true, true };
+        bool captured = false; /**< Every face rendered at least once. */
+    };
+
+    std::vector<Probe> probes;
+    std::size_t cursor = 0;
+    float viewInverse[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+    void renderFace(Probe& probe, int face, const RenderFn& renderWorld);
+};
+
+/**
+ * @brief Gets the engine-wide reflection probes.
+ */
+ReflectionProbes& reflectionProbes();
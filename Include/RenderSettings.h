@@ -0,0 +1,184 @@
+/**
+ * @file RenderSettings.h
+ * @brief Defines the runtime rendering knobs and the per-pass render context.
+ *
+ * This header contains the RenderSettings struct (level-of-detail thresholds and
+ * quality options that can be tuned at runtime) and the RenderContext struct,
+ * which tells objects which pass of the frame they are being drawn in.
+ */
+
+#pragma once
+
+class Frustum;
+
+/**
+ * @struct RenderSettings
+ * @brief Tunable rendering options shared by every renderer.
+ */
+struct RenderSettings {
+    /** @brief Whether distant models may be drawn as impostors. */
+    bool impostorsEnabled = true;
+
+    /**
+     * @brief Screen size (bounding sphere diameter / viewport height) below which
+     * a model is drawn as an impostor.
+     */
+    float impostorScreenSize = 0.08f;
+
+    /** @brief Width of the crossfade band around impostorScreenSize. */
+    float impostorFade = 0.02f;
+
+    /** @brief Views per side of the octahedral impostor atlas. */
+    int impostorGrid = 8;
+
+    /** @brief Resolution (pixels) of one impostor view. */
+    int impostorViewSize = 96;
+
+    /** @brief Whether far Container subtrees may be replaced by their HLOD proxy. */
+    bool hlodEnabled = true;
+
+    /**
+     * @brief Proxies are used once their simplification error projects below
+     * this many pixels (distance fog hides most of the difference).
+     */
+    float hlodPixelError = 8.0f;
+
+    /** @brief Vertex clustering cells along the longest side of a proxy. */
+    int hlodClusterGrid = 24;
+
+    /** @brief Drawable objects a subtree needs before it gets a proxy. */
+    int hlodMinObjects = 8;
+
+    /** @brief Whether reflective materials draw their probe reflection. */
+    bool reflectionsEnabled = true;
+
+    /** @brief Dirty reflection probe faces re-rendered per frame. */
+    int probeFacesPerFrame = 1;
+
+    /** @brief Reflection probe cube face size in pixels. */
+    int probeResolution = 128;
+
+    /** @brief Whether mirror panes render a planar reflection. */
+    bool mirrorsEnabled = true;
+
+    /** @brief Size of the planar reflection render relative to the window. */
+    float mirrorResolutionScale = 0.5f;
+
+    /**
+     * @brief Whether the main view draws glass with weighted blended OIT instead
+     * of the two sorted cull-face passes (needs framebuffer and shader support).
+     */
+    bool oitEnabled = false;
+
+    /**
+     * @brief Resolution of the transparent pass relative to the window (1, 0.5 or
+     * 0.25). Below 1, glass is drawn into a smaller buffer against downsampled
+     * depth and upsampled with depth-aware weights.
+     */
+    float transparencyResolutionScale = 1.0f;
+
+    /**
+     * @brief Highest transparent pass resolution the quality governor may pick
+     * (set by --transparent-scale); tiers only ever lower the scale below it.
+     */
+    float maxTransparencyResolutionScale = 1.0f;
+
+    /** @brief Whether the scene resolution follows the measured frame time. */
+    bool dynamicResolutionEnabled = true;
+
+    /** @brief Frame time the dynamic resolution controller aims for (milliseconds). */
+    float frameBudgetMs = 33.3f;
+
+    /** @brief Lowest scene resolution, as a fraction of the window per axis. */
+    float minResolutionScale = 0.5f;
+
+    /** @brief Whether the quality governor may change the knobs below. */
+    bool qualityGovernorEnabled = true;
+
+    /** @brief Point lights enabled per frame (the nearest to the camera). */
+    int maxPointLights = 8;
+
+    /** @brief Whether opaque objects cast planar projected shadows. */
+    bool shadowsEnabled = true;
+
+    /** @brief Multiplies the impostor and HLOD switch thresholds (higher = coarser). */
+    float lodBias = 1.0f;
+
+    /** @brief Grid cells per side of a Plane, and slices/stacks of a Cylinder. */
+    int tessellation = 20;
+
+    /**
+     * @brief Far plane of the main view. Objects beyond it are culled and the fog
+     * is thickened so they fade out before the cut.
+     */
+    float drawDistance = 200.0f;
+
+    /**
+     * @brief Whether static opaque primitives are culled by a compute shader and drawn
+     * with one multi-draw indirect call (needs OpenGL 4.3; read when the scene is built).
+     */
+    bool indirectEnabled = true;
+
+    /**
+     * @brief Whether the main view skips Container subtrees that occlusion queries
+     * found hidden (needs ARB_occlusion_query2).
+     */
+    bool occlusionCullingEnabled = true;
+
+    /** @brief Frames a container found visible is drawn before it is tested again. */
+    int occlusionPersistence = 8;
+
+    /** @brief Whether in-scene displays re-render their camera views. */
+    bool displaysEnabled = true;
+
+    /** @brief Display views re-rendered per frame at most (the most overdue first). */
+    int displayUpdatesPerFrame = 1;
+};
+
+/**
+ * @brief Gets the engine-wide render settings.
+ */
+RenderSettings& renderSettings();
+
+/**
+ * @brief The pass of the frame currently being drawn.
+ * * Bake is used while capturing geometry for proxies, and forces full detail.
+ * Reflection is used while rendering reflection probe faces and mirrors.
+ * Display is used while rendering in-scene screens from their own cameras, which
+ * pick their level of detail for that camera.
+ */
+enum class RenderPass { Main, Shadow, Bake, Reflection, Display };
+
+/**
+ * @struct RenderContext
+ * @brief State describing the draw in progress.
+ */
+struct RenderContext {
+    RenderPass pass = RenderPass::Main;
+
+    /** @brief If set, objects whose world bounds fall outside it are skipped. */
+    const Frustum* cull = nullptr;
+
+    /**
+     * @brief Set while transparent geometry is accumulated for weighted blended OIT
+     * (reflection overlays are skipped).
+     */
+    bool oit = false;
+
+    /** @brief Set while an offscreen pass owns the blend function; materials leave it alone. */
+    bool keepBlend = false;
+
+    /** @brief Extra LOD bias of the view being drawn (multiplies RenderSettings::lodBias). */
+    float lodBias = 1.0f;
+
+    /**
+     * @brief Set while the opaque pass runs after IndirectScene::draw(): objects it
+     * drew are skipped and HLOD proxies are not used.
+     */
+    bool indirect = false;
+};
+
+/**
+ * @brief Gets the render context of the draw in progress.
+ */
+RenderContext& renderContext();
@@ -0,0 +1,150 @@
+/**
+ * @file ResourceLoader.h
+ * @brief Defines the background thread that creates textures and buffers.
+ *
+ * This header contains the ResourceLoader class. Its thread owns a GL context
+ * that shares objects with the window's context (a GLX share list), so it decodes
+ * images and creates textures and buffer objects itself; each resource is published
+ * with a fence, and the render thread starts using it once the fence has signalled.
+ * Without a shared context (no GLX, no fences, or the context cannot be made
+ * current) the thread only decodes, and ResourceLoader::update() creates the
+ * objects on the render thread.
+ */
+
+#pragma once
+#include <GL/freeglut.h>
+#include <GL/glext.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class StreamedResource
+ * @brief A texture or buffer object created by the ResourceLoader.
+ */
+class StreamedResource {
+public:
+    /** @brief Gets the GL name once the object may be used on the render thread (0 until then, or on failure). */
+    GLuint get() const { return state.load(std::memory_order_acquire) == Ready ? name : 0; }
+
+    /** @brief Checks if the object could not be created (e.g., a missing or corrupt image). */
+    bool failed() const { return state.load(std::memory_order_acquire) == Failed; }
+
+private:
+    friend class ResourceLoader;
+
+    enum State { Pending, Published, Ready, Failed };
+
+    std::atomic<int> state{ Pending };
+    GLuint name = 0;
+    GLsync fence = nullptr;  /**< Signalled when the loader's commands creating the object have completed. */
+};
+
+/**
+ * @class ResourceLoader
+ * @brief Creates textures and buffers on a thread with a shared GL context.
+ */
+class ResourceLoader {
+public:
+    ResourceLoader() = default;
+
+    /** @brief Stops and joins the thread (its context is left to the process exit). */
+    ~ResourceLoader();
+
+    ResourceLoader(const ResourceLoader&) = delete;
+    ResourceLoader& operator=(const ResourceLoader&) = delete;
+
+    /**
+     * @brief Prepares the windowing system for a second GL thread.
+     * * Must be called before glutInit() (on X11 it enables Xlib's thread locking).
+     */
+    static void initThreads();
+
+    /**
+     * @brief Starts the thread and its shared context.
+     * * Call once on the render thread with the window's context current. Until
+     * then, requests are served synchronously on the calling thread.
+     * @return True if the thread creates the objects itself.
+     */
+    bool start();
+
+    /**
+     * @brief Queues a texture (mipmapped, repeating) decoded from an image file.
+     * * Requests for a file already queued or loaded return the same resource.
+     * @param path Image file.
+     */
+    std::shared_ptr<StreamedResource> loadTexture(const std::string& path);
+
+    /**
+     * @brief Queues a static buffer object.
+     * @param target GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+     * @param data Contents (moved to the loader).
+     */
+    std::shared_ptr<StreamedResource> loadBuffer(GLenum target, std::vector<unsigned char> data);
+
+    /**
+     * @brief Makes finished resources available. Call once per frame on the render thread.
+     * * Retires signalled fences; without a shared context, also creates the objects
+     * the thread has decoded.
+     */
+    void update();
+
+    /** @brief Blocks until every queued resource is ready (or failed). Render thread only. */
+    void finish();
+
+    /** @brief Checks if the thread owns a shared context. */
+    bool hasSharedContext() const { return shared; }
+
+    /** @brief Resources queued and not yet ready. */
+    std::size_t getPending() const { return pending.load(std::memory_order_relaxed); }
+
+private:
+    struct Request {
+        std::shared_ptr<StreamedResource> resource;
+        GLenum target = 0;                /**< Buffer target, or 0 for a texture. */
+        std::string path;                 /**< Texture file. */
+        std::vector<unsigned char> data;  /**< Buffer contents. */
+        unsigned char* pixels = nullptr;  /**< Decoded texels (freed by create()). */
+        int width = 0, height = 0, components = 0;
+    };
+
+    struct SharedContext;
+
+    std::unique_ptr<SharedContext> context;
+    std::thread thread;
+    bool started = false;
+    bool shared = false;
+    bool threadReady = false;  /**< The thread has tried to make its context current. */
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<Request> queue;           /**< Waiting for the thread. */
+    std::vector<Request> decoded;        /**< Decoded, waiting for update() (no shared context). */
+    std::vector<std::shared_ptr<StreamedResource>> published;  /**< Created, fence not yet retired. */
+    bool busy = false;
+    bool stopping = false;
+    std::atomic<std::size_t> pending{ 0 };
+
+    std::map<std::string, std::weak_ptr<StreamedResource>> texturesByPath;
+
+    void threadLoop();
+    void enqueue(Request request);
+    void retire(bool wait);
+
+    static SharedContext* createSharedContext();
+    static bool decode(Request& request);
+    static bool create(Request& request);
+};
+
+/**
+ * @brief Gets the engine-wide resource loader.
+ */
+ResourceLoader& resourceLoader();
@@ -0,0 +1,137 @@
+/**
+ * @file SceneDisplay.h
+ * @brief Defines in-scene screens showing secondary camera views.
+ *
+ * This header contains the SceneDisplays class and the DisplayScreen primitive.
+ * A display view is a camera (e.g., a security camera, or a close-up of a car on
+ * its turntable) rendered into a texture at its own resolution, refresh rate,
+ * level-of-detail bias and draw distance. Screens are cubes that show a view's
+ * texture on their front (+Z) face. Several screens can show the same view, and
+ * views added with the same camera are merged, so they share one render (and its
+ * culling and light sorting). A view is only refreshed while one of its screens
+ * was in the camera frustum and not fully occluded in the previous frame.
+ */
+
+#pragma once
+#include "Common.h"
+#include "Delegate.h"
+#include "GameObject.h"
+#include <GL/freeglut.h>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct DisplayView
+ * @brief Camera and quality settings of a display view.
+ */
+struct DisplayView {
+    Vec3 eye = { 0.0f, 2.0f, 0.0f };      /**< Camera position (world space). */
+    Vec3 target = { 0.0f, 0.0f, -1.0f };  /**< Point the camera looks at. */
+    float fov = 50.0f;                     /**< Vertical field of view (degrees). */
+    int width = 256;                       /**< Texture width in pixels. */
+    int height = 144;                      /**< Texture height in pixels. */
+    float refreshHz = 10.0f;               /**< Re-renders per second while visible. */
+    float lodBias = 2.0f;                  /**< Multiplies the LOD thresholds (coarser). */
+    float drawDistance = 40.0f;            /**< Far plane; objects beyond it are culled. */
+};
+
+/**
+ * @class SceneDisplays
+ * @brief The display views, their textures and refresh schedule.
+ */
+class SceneDisplays {
+public:
+    /** @brief Draws the world with the current projection and modelview. */
+    using RenderFn = Delegate<void()>;
+
+    /**
+     * @brief Adds a view, or merges it into an existing one with the same camera.
+     * * A merged view keeps the larger resolution, refresh rate and draw distance
+     * and the smaller LOD bias of the two.
+     * @return The view index (pass it to DisplayScreen).
+     */
+    int addView(const DisplayView& view);
+
+    /**
+     * @brief Re-renders up to `budget` views that are due and visible.
+     * * Call with the camera's projection and view loaded, before the main view
+     * clears the frame (without framebuffer support the back buffer is used as
+     * scratch space). Objects are drawn in RenderPass::Display, culled to the
+     * view's frustum.
+     * @param now Current time in seconds.
+     * @param budget Maximum views to render this frame.
+     * @param renderWorld Draws the scene.
+     * @return The number of views rendered.
+     */
+    int render(double now, int budget, const RenderFn& renderWorld);
+
+    /**
+     * @brief Draws a view's picture on the +Z face of a unit cube.
+     * * Call with the screen's transform applied. In the main pass, the picture
+     * also runs an occlusion query that decides whether the view is refreshed
+     * next frame.
+     * @param screen The screen being drawn.
+     * @param view The view it shows.
+     */
+    void drawPicture(const GameObject* screen, int view);
+
+    /** @brief Drops the visibility state of a destroyed screen. */
+    void forget(const GameObject* screen);
+
+    /** @brief Number of views. */
+    std::size_t size() const { return views.size(); }
+
+private:
+    struct View {
+        DisplayView settings;
+        GLuint texture = 0;
+        GLuint depthTexture = 0;
+        GLuint framebuffer = 0;
+        int texWidth = 0, texHeight = 0;
+        int usedWidth = 0, usedHeight = 0;  /**< Rendered part (smaller when clamped to the window). */
+        double lastRender = -1e9;
+        bool captured = false;
+        bool visible = false;
+    };
+
+    struct Screen {
+        int view = -1;
+        GLuint query = 0;
+        bool pending = false;   /**< Query issued, result not read yet. */
+        bool drawn = false;     /**< Drawn in the main pass since the last render(). */
+        bool visible = true;
+    };
+
+    std::vector<View> views;
+    std::unordered_map<const GameObject*, Screen> screens;
+    int framebufferState = -1;  /**< -1 not checked, 0 back buffer fallback, 1 framebuffers. */
+    int renderingView = -1;     /**< View being rendered (its screens are drawn blank). */
+
+    void updateVisibility();
+    bool prepareTarget(View& view, int windowWidth, int windowHeight);
+    void renderView(View& view, const RenderFn& renderWorld);
+};
+
+/**
+ * @brief Gets the engine-wide in-scene displays.
+ */
+SceneDisplays& sceneDisplays();
+
+/**
+ * @class DisplayScreen
+ * @brief A cube that shows a display view on its front (+Z) face.
+ */
+class DisplayScreen : public Cube {
+public:
+    /** @param view View index returned by SceneDisplays::addView(). */
+    explicit DisplayScreen(int view) : view(view) {}
+    ~DisplayScreen() override { sceneDisplays().forget(this); }
+
+    void drawMesh() override;
+    GameObject* clone() const override { return new DisplayScreen(*this); }
+
+    int getView() const { return view; }
+
+private:
+    int view;
+};
@@ -0,0 +1,80 @@
+/**
+ * @file SceneIndex.h
+ * @brief Defines hash indices for looking up GameObjects by name and tag.
+ *
+ * This header contains the SceneIndex class, which keeps an O(1) name lookup
+ * table and one object list per tag. Only objects in the scene are indexed:
+ * roots join it explicitly, children when Container::addChild() attaches them
+ * under it, and Container::removeChild() or destruction takes them out again.
+ * GameObject keeps the indices up to date when a name or tag changes, so scripts
+ * and tools can find objects without walking the scene graph.
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class GameObject;
+
+/** @brief Index of a tag bit (0 - 63). */
+using Tag = std::uint8_t;
+
+/** @brief A set of tags, one bit per Tag. */
+using TagMask = std::uint64_t;
+
+/** @brief Returned by SceneIndex::tag() once every bit is taken; carries no bit. */
+const Tag NoTag = 0xFF;
+
+/** @brief Converts a tag to its bit in a TagMask (empty for NoTag). */
+inline TagMask tagBit(Tag t) { return t < 64 ? TagMask(1) << t : 0; }
+
+/**
+ * @class SceneIndex
+ * @brief Global name and tag indices over the GameObjects in the scene.
+ */
+class SceneIndex {
+public:
+    /** @brief Maximum number of distinct tags. */
+    static const int MaxTags = 64;
+
+    /**
+     * @brief Gets the tag registered under a name, registering it on first use.
+     * * Once MaxTags names are registered, new names are rejected with an error
+     * and get NoTag, which adding, removing and finding ignore.
+     * @param name Human-readable tag name (e.g., "neon", "door").
+     * @return The tag index, or NoTag.
+     */
+    static Tag tag(const std::string& name);
+
+    /**
+     * @brief Finds an object by its unique name.
+     * @return The object, or nullptr if no object in the scene has that name.
+     */
+    static GameObject* findByName(const std::string& name);
+
+    /**
+     * @brief Gets every object in the scene carrying a tag.
+     * @return The list of objects (order is unspecified; empty for NoTag).
+     */
+    static const std::vector<GameObject*>& findByTag(Tag t);
+
+    /**
+     * @brief Collects every object in the scene carrying all tags in a mask.
+     * * Scans only the shortest tag list involved and filters the rest by bitmask.
+     * @param mask Tags the object must have.
+     * @param out Receives the matching objects.
+     */
+    static void query(TagMask mask, std::vector<GameObject*>& out);
+
+    // --- Maintenance hooks (called by GameObject) ---
+
+    /** @brief Moves an object from oldName to newName in the name table. */
+    static void rename(GameObject* obj, const std::string& oldName, const std::string& newName);
+
+    /** @brief Adds an object to the lists of every tag in added. */
+    static void addTags(GameObject* obj, TagMask added);
+
+    /** @brief Removes an object from the lists of every tag in removed. */
+    static void removeTags(GameObject* obj, TagMask removed);
+};
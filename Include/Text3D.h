@@ -38,6 +38,9 @@ public:
      */
     void drawMesh() override;
 
+    /** @brief Gets the bounds of the centred, scaled stroke text. */
+    AABB getLocalBounds() const override;
+
     /**
      * @brief Creates a deep copy of the text object.
      * @return A pointer to the new Text3D instance.
@@ -0,0 +1,52 @@
+/**
+ * @file View.h
+ * @brief Helpers that measure objects against the current camera.
+ *
+ * This header contains small utilities built on the current OpenGL modelview and
+ * projection matrices (screen size of a bounding sphere, projected error of a
+ * simplified mesh, camera position in an object's local space), shared by the
+ * impostor and HLOD level-of-detail switches.
+ */
+
+#pragma once
+#include "Common.h"
+#include "Frustum.h"
+
+/**
+ * @brief Inverts an affine column-major 4x4 matrix (rotation/scale + translation).
+ * @param m The matrix to invert.
+ * @param out Receives the inverse.
+ * @return False if the matrix is singular (out is left untouched).
+ */
+bool invertAffine(const float m[16], float out[16]);
+
+/**
+ * @brief Gets the camera position in the current local space.
+ * * Inverts the current modelview matrix, so call it while the object's
+ * transform is applied.
+ */
+Vec3 localEyePosition();
+
+/**
+ * @brief Measures how large a sphere appears with the current GL matrices.
+ * * Reads the current modelview and projection matrices, so call it while the
+ * object's transform is applied.
+ * @param center Sphere centre in the current local space.
+ * @param radius Sphere radius in the current local space.
+ * @return Projected diameter as a fraction of the viewport height.
+ */
+float projectedSize(const Vec3& center, float radius);
+
+/**
+ * @brief Projects a geometric error to pixels at the nearest point of a box.
+ * @param bounds Box in the current local space.
+ * @param error Error distance in the current local space.
+ * @return Error in pixels (very large if the camera is inside the box).
+ */
+float projectedErrorPixels(const AABB& bounds, float error);
+
+/**
+ * @brief Gets the frustum of the current projection and modelview matrices.
+ * * With the camera view loaded (no object transform), the planes are in world space.
+ */
+Frustum viewFrustum();
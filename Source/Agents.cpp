@@ -0,0 +1,178 @@
+/**
+ * @file Agents.cpp
+ * @brief Implementation of the crowd simulation.
+ */
+
+#include "Agents.h"
+#include "Frustum.h"
+#include "RenderSettings.h"
+#include <chrono>
+#include <cmath>
+
+/** @brief Agents within this distance of their goal pick a new one. */
+static const float GOAL_RADIUS = 0.5f;
+
+/** @brief Agents within this distance of a waypoint move on to the next one. */
+static const float WAYPOINT_RADIUS = 0.3f;
+
+/** @brief Seconds an agent may be blocked before it gives up on its goal. */
+static const float STUCK_TIMEOUT = 1.5f;
+
+/** @brief Agents processed per job chunk. */
+static const std::size_t AGENT_GRAIN = 64;
+
+void AgentSystem::setArea(float minX, float minZ, float maxX, float maxZ) {
+    areaMinX = minX; areaMinZ = minZ;
+    areaMaxX = maxX; areaMaxZ = maxZ;
+}
+
+std::size_t AgentSystem::add(float x, float z, const CharacterBody& body, float walkSpeed) {
+    std::size_t i = posX.size();
+
+    posX.push_back(x);
+    posY.push_back(body.height);
+    posZ.push_back(z);
+    velocityY.push_back(0.0f);
+    radius.push_back(body.radius);
+    height.push_back(body.height);
+    gravity.push_back(body.gravity);
+    speed.push_back(walkSpeed);
+    goalX.push_back(x);
+    goalZ.push_back(z);
+    stuckTime.push_back(0.0f);
+    rng.push_back(0x9E3779B9u * (std::uint32_t)(i + 1));
+    paths.emplace_back();
+    pathIndex.push_back(0);
+    needsPath.push_back(1);
+
+    pickGoal(i);
+    return i;
+}
+
+std::size_t AgentSystem::spawn(std::size_t count, const Broadphase& broadphase, const CharacterBody& body, float walkSpeed) {
+    std::uint32_t seed = 12345u;
+    auto next01 = [&seed]() {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        return (seed & 0xFFFFFF) / float(0x1000000);
+    };
+
+    std::size_t spawned = 0;
+    for (std::size_t attempt = 0; spawned < count && attempt < count * 20; ++attempt) {
+        float x = areaMinX + next01() * (areaMaxX - areaMinX);
+        float z = areaMinZ + next01() * (areaMaxZ - areaMinZ);
+        if (broadphase.isBlocked(x, body.height, z, body.radius, body.height)) continue;
+
+        add(x, z, body, walkSpeed);
+        ++spawned;
+    }
+    return spawned;
+}
+
+void AgentSystem::setGoal(std::size_t i, float x, float z) {
+    goalX[i] = x;
+    goalZ[i] = z;
+    stuckTime[i] = 0.0f;
+    needsPath[i] = 1;
+}
+
+float AgentSystem::random01(std::size_t i) {
+    // xorshift32, one independent stream per agent so chunks never share state
+    std::uint32_t& s = rng[i];
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return (s & 0xFFFFFF) / float(0x1000000);
+}
+
+void AgentSystem::pickGoal(std::size_t i) {
+    setGoal(i, areaMinX + random01(i) * (areaMaxX - areaMinX),
+               areaMinZ + random01(i) * (areaMaxZ - areaMinZ));
+}
+
+void AgentSystem::stepRange(std::size_t begin, std::size_t end, float dt, const Broadphase& broadphase) {
+    for (std::size_t i = begin; i < end; ++i) {
+        // 1. Plan a path to a new goal (A* runs here, in parallel across chunks)
+        if (navigation && needsPath[i]) {
+            needsPath[i] = 0;
+            pathIndex[i] = 0;
+            if (!navigation->findPath(getPosition(i), { goalX[i], posY[i], goalZ[i] }, paths[i])) {
+                pickGoal(i);
+                continue;
+            }
+        }
+
+        float goalDx = goalX[i] - posX[i];
+        float goalDz = goalZ[i] - posZ[i];
+        if (std::sqrt(goalDx * goalDx + goalDz * goalDz) < GOAL_RADIUS) {
+            pickGoal(i);
+            continue;
+        }
+
+        // 2. Steer towards the next waypoint (or straight at the goal)
+        float targetX = goalX[i], targetZ = goalZ[i];
+        if (navigation) {
+            while (pathIndex[i] + 1 < paths[i].size()) {
+                const Vec3& w = paths[i][pathIndex[i]];
+                float wx = w.x - posX[i], wz = w.z - posZ[i];
+                if (wx * wx + wz * wz > WAYPOINT_RADIUS * WAYPOINT_RADIUS) break;
+                ++pathIndex[i];
+            }
+            if (pathIndex[i] < paths[i].size()) {
+                targetX = paths[i][pathIndex[i]].x;
+                targetZ = paths[i][pathIndex[i]].z;
+            }
+        }
+
+        float dx = targetX - posX[i];
+        float dz = targetZ - posZ[i];
+        float dist = std::sqrt(dx * dx + dz * dz);
+        if (dist < 1e-4f) continue;
+
+        float stepLen = speed[i] * dt;
+        if (stepLen > dist) stepLen = dist;
+        float moveX = dx / dist * stepLen;
+        float moveZ = dz / dist * stepLen;
+
+        // 3. Shared character controller (gravity, ground, OBB collision)
+        CharacterBody body = { radius[i], height[i], gravity[i] };
+        bool free = stepCharacter(broadphase, body, moveX, moveZ, dt,
+                                  posX[i], posY[i], posZ[i], velocityY[i]);
+
+        // 4. Give up on goals we keep running into walls trying to reach
+        stuckTime[i] = free ? 0.0f : stuckTime[i] + dt;
+        if (stuckTime[i] > STUCK_TIMEOUT) pickGoal(i);
+    }
+}
+
+void AgentSystem::step(float dt, const Broadphase& broadphase, JobSystem& pool) {
+    auto start = std::chrono::steady_clock::now();
+
+    pool.parallelFor(size(), AGENT_GRAIN, [&](std::size_t b, std::size_t e) {
+        stepRange(b, e, dt, broadphase);
+    });
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    lastStepMs = elapsed.count();
+}
+
+double AgentSystem::getCostPerAgentUs() const {
+    return size() ? lastStepMs * 1000.0 / size() : 0.0;
+}
+
+void AgentSystem::draw() const {
+    Material::CreatePlastic(0.9f, 0.6f, 0.2f).apply();
+
+    const Frustum* cull = renderContext().cull;
+    for (std::size_t i = 0; i < size(); ++i) {
+        if (cull) {
+            AABB body = { { posX[i] - radius[i], posY[i] - height[i], posZ[i] - radius[i] },
+                          { posX[i] + radius[i], posY[i], posZ[i] + radius[i] } };
+            if (!cull->intersects(body)) continue;
+        }
+
+        glPushMatrix();
+        // Body spans from the feet up to eye level
+        glTranslatef(posX[i], posY[i] - height[i] / 2.0f, posZ[i]);
+        glScalef(radius[i] * 2.0f, height[i], radius[i] * 2.0f);
+        glutSolidCube(1.0);
+        glPopMatrix();
+    }
+}
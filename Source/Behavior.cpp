@@ -0,0 +1,83 @@
+/**
+ * @file Behavior.cpp
+ * @brief Implementation of the behavior system and built-in behaviors.
+ */
+
+#include "Behavior.h"
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// --- BehaviorSystem Implementation ---
+
+std::size_t BehaviorSystem::nextTypeId() {
+    static std::size_t counter = 0;
+    return counter++;
+}
+
+void BehaviorSystem::update(float deltaTime) {
+    for (auto& p : pools) {
+        if (p) p->update(deltaTime);
+    }
+}
+
+// --- SpinBehavior ---
+
+void SpinBehavior::updateBatch(GameObject* const* owners, SpinBehavior* items, std::size_t count, float dt) {
+    for (std::size_t i = 0; i < count; ++i) {
+        Vec3 p = owners[i]->getPosition();
+        owners[i]->rotateAround(p.x, p.y, p.z, 0.0f, 1.0f, 0.0f, items[i].speed * dt);
+    }
+}
+
+// --- HingedDoorBehavior ---
+
+bool HingedDoorBehavior::isOpen() const {
+    return std::abs(targetAngle) > 1.0f;
+}
+
+void HingedDoorBehavior::open(const GameObject* door, float viewerX, float viewerZ) {
+    // Swing away from the viewer: compare the viewer's side against the door's facing
+    Vec3 doorPos = door->getRealPosition();
+    float dx = viewerX - doorPos.x;
+    float dz = viewerZ - doorPos.z;
+
+    Vec3 rot = door->getRealRotation();
+    float rad = rot.y * (float)(M_PI / 180.0f);
+    float dot = dx * std::sin(rad) + dz * std::cos(rad);
+
+    targetAngle = (dot > 0) ? openAngle : -openAngle;
+}
+
+void HingedDoorBehavior::toggle(const GameObject* door, float viewerX, float viewerZ) {
+    if (isOpen()) {
+        close();
+    } else {
+        open(door, viewerX, viewerZ);
+    }
+}
+
+void HingedDoorBehavior::updateBatch(GameObject* const* owners, HingedDoorBehavior* items, std::size_t count, float dt) {
+    for (std::size_t i = 0; i < count; ++i) {
+        HingedDoorBehavior& d = items[i];
+        float diff = d.targetAngle - d.currentAngle;
+
+        // Snap the last fraction of a degree so the door settles exactly
+        if (std::abs(diff) < 1.0f) {
+            if (d.currentAngle != d.targetAngle) {
+                owners[i]->rotateAround(d.hingeX, 0.0f, d.hingeZ, 0.0f, 1.0f, 0.0f, diff);
+                d.currentAngle = d.targetAngle;
+            }
+            continue;
+        }
+
+        float step = d.speed * dt;
+        if (step > std::abs(diff)) step = std::abs(diff);
+        if (diff < 0) step = -step;
+
+        owners[i]->rotateAround(d.hingeX, 0.0f, d.hingeZ, 0.0f, 1.0f, 0.0f, step);
+        d.currentAngle += step;
+    }
+}
@@ -4,6 +4,10 @@
  */
 
 #include "Common.h"
+#include "RenderSettings.h"
+#include <cstring>
+#include <unordered_map>
+#include <vector>
 
 void Material::apply() const {
     glMaterialfv(GL_FRONT, GL_AMBIENT, ambient);
@@ -12,6 +16,9 @@ void Material::apply() const {
     glMaterialfv(GL_FRONT, GL_EMISSION, emission);
     glMaterialf(GL_FRONT, GL_SHININESS, shininess);
 
+    // Offscreen transparency passes own the blend state
+    if (renderContext().keepBlend) return;
+
     if (diffuse[3] < 1.0f) {
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -35,6 +42,7 @@ Material Material::CreateGlass() {
     // Pure white specular
     m.specular[0] = 1.0f; m.specular[1] = 1.0f; m.specular[2] = 1.0f; m.specular[3] = 1.0f;
     m.shininess = 120.0f; 
+    m.reflectivity = 0.3f;
     return m;
 }
 
@@ -53,6 +61,7 @@ Material Material::CreateChrome() {
     // Very bright, sharp specular
     m.specular[0] = 0.77f; m.specular[1] = 0.77f; m.specular[2] = 0.77f; m.specular[3] = 1.0f;
     m.shininess = 76.8f;
+    m.reflectivity = 0.5f;
     return m;
 }
 
@@ -86,3 +95,56 @@ Material Material::CreateMatte(float r, float g, float b) {
     m.shininess = 0.0f;
     return m;
 }
+
+// --- MaterialLibrary Implementation ---
+
+namespace {
+    // FNV-1a over the raw material bytes (Material is plain floats)
+    std::uint64_t hashMaterial(const Material& m) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&m);
+        std::uint64_t h = 1469598103934665603ull;
+        for (std::size_t i = 0; i < sizeof(Material); ++i) {
+            h = (h ^ bytes[i]) * 1099511628211ull;
+        }
+        return h;
+    }
+
+    struct MaterialStore {
+        std::vector<Material> materials;
+        std::unordered_multimap<std::uint64_t, std::uint32_t> byHash;
+
+        MaterialStore() {
+            materials.push_back(Material());
+            byHash.emplace(hashMaterial(materials[0]), 0);
+        }
+    };
+
+    MaterialStore& store() {
+        static MaterialStore* instance = new MaterialStore();
+        return *instance;
+    }
+}
+
+std::uint32_t MaterialLibrary::add(const Material& m) {
+    MaterialStore& s = store();
+    std::uint64_t h = hashMaterial(m);
+
+    auto range = s.byHash.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (std::memcmp(&s.materials[it->second], &m, sizeof(Material)) == 0) return it->second;
+    }
+
+    std::uint32_t id = (std::uint32_t)s.materials.size();
+    s.materials.push_back(m);
+    s.byHash.emplace(h, id);
+    return id;
+}
+
+const Material& MaterialLibrary::get(std::uint32_t id) {
+    MaterialStore& s = store();
+    return id < s.materials.size() ? s.materials[id] : s.materials[0];
+}
+
+std::size_t MaterialLibrary::count() {
+    return store().materials.size();
+}
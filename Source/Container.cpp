@@ -4,11 +4,20 @@
  */
 
 #include "Container.h"
+#include "Frustum.h"
+#include "IndirectScene.h"
+#include "OcclusionCulling.h"
+#include "RenderSettings.h"
 #include <algorithm> 
 
-Container::Container() {}
+Container::Container() {
+    // Containers only group other objects; they draw nothing themselves
+    world().renderables.remove(entity);
+}
 
 Container::~Container() {
+    occlusionCuller().forget(this);
+
     // When the container is destroyed, delete all children to prevent memory leaks
     for (auto* child : children) {
         delete child;
@@ -30,17 +39,60 @@ void Container::addChild(GameObject* child) {
     // Set the parent relationship
     child->setParent(this);
     children.push_back(child);
+    if (inScene) child->enterScene();
+}
+
+bool Container::removeChild(GameObject* child) {
+    auto it = std::find(children.begin(), children.end(), child);
+    if (it == children.end()) return false;
+
+    children.erase(it);
+    child->setParent(nullptr);
+    child->leaveScene();
+    return true;
+}
+
+void Container::enterScene() {
+    GameObject::enterScene();
+    for (auto* child : children) child->enterScene();
+}
+
+void Container::leaveScene() {
+    GameObject::leaveScene();
+    for (auto* child : children) child->leaveScene();
+}
+
+bool Container::useHLOD() const {
+    return hlod && renderSettings().hlodEnabled && renderContext().pass != RenderPass::Bake &&
+           hlod->shouldReplace();
+}
+
+bool Container::hlodVisible() const {
+    const Frustum* cull = renderContext().cull;
+    return !cull || cull->intersects(transformBounds(world().worldMatrices.get(entity), hlod->getBounds()));
 }
 
 void Container::draw() {
     glPushMatrix();
 
     // Apply local transformation
-    glTranslatef(position.x, position.y, position.z);
-    glRotatef(rotation.x, 1, 0, 0);
-    glRotatef(rotation.y, 0, 1, 0);
-    glRotatef(rotation.z, 0, 0, 1);
-    glScalef(scale.x, scale.y, scale.z);
+    const Transform& t = transform();
+    glTranslatef(t.position.x, t.position.y, t.position.z);
+    glRotatef(t.rotation.x, 1, 0, 0);
+    glRotatef(t.rotation.y, 0, 1, 0);
+    glRotatef(t.rotation.z, 0, 0, 1);
+    glScalef(t.scale.x, t.scale.y, t.scale.z);
+
+    // Far away: one proxy draw instead of the whole subtree
+    if (useHLOD()) {
+        indirectScene().hide(this);
+        if (hlodVisible()) {
+            hlod->drawOpaque();
+            hlod->drawTransparent();
+        }
+        glPopMatrix();
+        return;
+    }
 
     // Draw all children relative to this container
     for (auto* child : children) {
@@ -51,14 +103,30 @@ void Container::draw() {
 }
 
 void Container::drawOpaqueChildren() {
+    // Hidden behind other geometry in earlier frames (or outside the view); the
+    // indirect pass leaves out the static children as well
+    if (occlusionCuller().skip(this)) {
+        indirectScene().hide(this);
+        return;
+    }
+
     glPushMatrix();
     
     // Apply Local Transform
-    glTranslatef(position.x, position.y, position.z);
-    glRotatef(rotation.x, 1, 0, 0);
-    glRotatef(rotation.y, 0, 1, 0);
-    glRotatef(rotation.z, 0, 0, 1);
-    glScalef(scale.x, scale.y, scale.z);
+    const Transform& t = transform();
+    glTranslatef(t.position.x, t.position.y, t.position.z);
+    glRotatef(t.rotation.x, 1, 0, 0);
+    glRotatef(t.rotation.y, 0, 1, 0);
+    glRotatef(t.rotation.z, 0, 0, 1);
+    glScalef(t.scale.x, t.scale.y, t.scale.z);
+
+    if (useHLOD()) {
+        // The proxy stands in for the static children the indirect pass would draw too
+        indirectScene().hide(this);
+        if (hlodVisible()) hlod->drawOpaque();
+        glPopMatrix();
+        return;
+    }
 
     // Iterate Children
     for (auto* child : children) {
@@ -78,14 +146,23 @@ void Container::drawOpaqueChildren() {
 }
 
 void Container::drawTransparentChildren() {
+    if (occlusionCuller().skip(this)) return;
+
     glPushMatrix();
     
     // Apply Local Transform
-    glTranslatef(position.x, position.y, position.z);
-    glRotatef(rotation.x, 1, 0, 0);
-    glRotatef(rotation.y, 0, 1, 0);
-    glRotatef(rotation.z, 0, 0, 1);
-    glScalef(scale.x, scale.y, scale.z);
+    const Transform& t = transform();
+    glTranslatef(t.position.x, t.position.y, t.position.z);
+    glRotatef(t.rotation.x, 1, 0, 0);
+    glRotatef(t.rotation.y, 0, 1, 0);
+    glRotatef(t.rotation.z, 0, 0, 1);
+    glScalef(t.scale.x, t.scale.y, t.scale.z);
+
+    if (useHLOD()) {
+        if (hlodVisible()) hlod->drawTransparent();
+        glPopMatrix();
+        return;
+    }
 
     // Iterate Children
     for (auto* child : children) {
@@ -108,11 +185,12 @@ GameObject* Container::clone() const {
     Container* newC = new Container();
     
     // Copy Properties
-    newC->setPosition(position.x, position.y, position.z);
-    newC->setRotation(rotation.x, rotation.y, rotation.z);
-    newC->setScale(scale.x, scale.y, scale.z);
-    newC->setMaterial(material);
+    const Transform& t = transform();
+    newC->setPosition(t.position.x, t.position.y, t.position.z);
+    newC->setRotation(t.rotation.x, t.rotation.y, t.rotation.z);
+    newC->setScale(t.scale.x, t.scale.y, t.scale.z);
     newC->castsShadow = castsShadow;
+    newC->hlod = hlod; // captured in local space, so it fits the copy too
 
     // Deep Copy Children
     for (auto* child : children) {
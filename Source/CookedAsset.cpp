@@ -0,0 +1,534 @@
+/**
+ * @file CookedAsset.cpp
+ * @brief Implementation of the cooked mesh format and its codecs.
+ */
+
+#include "CookedAsset.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MESH_CODEC_SSE 1
+#endif
+
+/** @brief File signature, followed by FORMAT_VERSION. */
+static const char MAGIC[8] = { 'C', 'G', 'E', 'C', 'O', 'O', 'K', '1' };
+static const std::uint32_t FORMAT_VERSION = 2;
+
+/** @brief Bits per value for each block width code. */
+static const int WIDTHS[5] = { 0, 2, 4, 8, 16 };
+
+/** @brief Streams per mesh: position x/y/z, octahedral normal u/v, texture u/v, indices. */
+enum Stream { PositionX, PositionY, PositionZ, NormalU, NormalV, TexU, TexV, Indices, StreamCount };
+
+/** @brief Mesh has normals. */
+static const std::uint32_t FLAG_NORMALS = 1;
+
+namespace MeshCodec {
+
+static std::uint16_t zigzag(std::uint16_t delta) {
+    return (std::uint16_t)((delta << 1) ^ (std::uint16_t)((std::int16_t)delta >> 15));
+}
+
+void encodeChannel(const std::uint16_t* values, std::size_t count, std::vector<std::uint8_t>& out) {
+    std::size_t blocks = (count + BlockSize - 1) / BlockSize;
+    std::size_t headerStart = out.size();
+    out.resize(headerStart + blocks);
+
+    std::uint16_t previous = 0;
+    for (std::size_t b = 0; b < blocks; ++b) {
+        std::uint16_t z[BlockSize] = {};
+        std::uint16_t largest = 0;
+        for (std::size_t i = 0; i < BlockSize && b * BlockSize + i < count; ++i) {
+            std::uint16_t v = values[b * BlockSize + i];
+            z[i] = zigzag((std::uint16_t)(v - previous));
+            previous = v;
+            largest = std::max(largest, z[i]);
+        }
+
+        int code = 0;
+        while (code < 4 && largest >= (1u << WIDTHS[code])) ++code;
+        out[headerStart + b] = (std::uint8_t)code;
+
+        // Layouts chosen so the decoder can unpack a block with a few shifts and masks
+        switch (WIDTHS[code]) {
+        case 2:
+            for (int j = 0; j < 4; ++j)
+                out.push_back((std::uint8_t)(z[j] | z[j + 4] << 2 | z[j + 8] << 4 | z[j + 12] << 6));
+            break;
+        case 4:
+            for (int j = 0; j < 8; ++j) out.push_back((std::uint8_t)(z[j] | z[j + 8] << 4));
+            break;
+        case 8:
+            for (int j = 0; j < 16; ++j) out.push_back((std::uint8_t)z[j]);
+            break;
+        case 16:
+            for (int j = 0; j < 16; ++j) {
+                out.push_back((std::uint8_t)(z[j] & 0xFF));
+                out.push_back((std::uint8_t)(z[j] >> 8));
+            }
+            break;
+        }
+    }
+}
+
+bool decodeChannel(const std::uint8_t* data, std::size_t size, std::uint16_t* values, std::size_t count) {
+    std::size_t blocks = (count + BlockSize - 1) / BlockSize;
+    if (size < blocks) return false;
+    const std::uint8_t* p = data + blocks;
+    const std::uint8_t* end = data + size;
+
+#ifdef MESH_CODEC_SSE
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i previous = zero;  // last decoded value, in every lane
+
+    for (std::size_t b = 0; b < blocks; ++b) {
+        if (data[b] > 4) return false;
+        int width = WIDTHS[data[b]];
+        if (p + width * 2 > end) return false;
+
+        // Unpack 16 zigzag values into two vectors of eight 16-bit lanes
+        __m128i lo, hi;
+        switch (width) {
+        case 0:
+            lo = hi = zero;
+            break;
+        case 2: {
+            std::uint32_t word;
+            std::memcpy(&word, p, 4);
+            __m128i bytes = _mm_cvtsi32_si128((int)word);
+            __m128i mask = _mm_set1_epi8(3);
+            __m128i v0 = _mm_and_si128(bytes, mask);
+            __m128i v1 = _mm_and_si128(_mm_srli_epi16(bytes, 2), mask);
+            __m128i v2 = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+            __m128i v3 = _mm_and_si128(_mm_srli_epi16(bytes, 6), mask);
+            __m128i all = _mm_unpacklo_epi64(_mm_unpacklo_epi32(v0, v1), _mm_unpacklo_epi32(v2, v3));
+            lo = _mm_unpacklo_epi8(all, zero);
+            hi = _mm_unpackhi_epi8(all, zero);
+            break;
+        }
+        case 4: {
+            __m128i bytes = _mm_loadl_epi64((const __m128i*)p);
+            __m128i mask = _mm_set1_epi8(15);
+            __m128i all = _mm_unpacklo_epi64(_mm_and_si128(bytes, mask), _mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+            lo = _mm_unpacklo_epi8(all, zero);
+            hi = _mm_unpackhi_epi8(all, zero);
+            break;
+        }
+        case 8: {
+            __m128i all = _mm_loadu_si128((const __m128i*)p);
+            lo = _mm_unpacklo_epi8(all, zero);
+            hi = _mm_unpackhi_epi8(all, zero);
+            break;
+        }
+        default:
+            lo = _mm_loadu_si128((const __m128i*)p);
+            hi = _mm_loadu_si128((const __m128i*)(p + 16));
+            break;
+        }
+        p += width * 2;
+
+        // Zigzag decode, then integrate the deltas (log-step prefix sum per vector)
+        __m128i* halves[2] = { &lo, &hi };
+        for (__m128i* v : halves) {
+            __m128i d = _mm_xor_si128(_mm_srli_epi16(*v, 1), _mm_sub_epi16(zero, _mm_and_si128(*v, one)));
+            d = _mm_add_epi16(d, _mm_slli_si128(d, 2));
+            d = _mm_add_epi16(d, _mm_slli_si128(d, 4));
+            d = _mm_add_epi16(d, _mm_slli_si128(d, 8));
+            *v = _mm_add_epi16(d, previous);
+            previous = _mm_shufflehi_epi16(*v, 0xFF);
+            previous = _mm_unpackhi_epi64(previous, previous);
+        }
+
+        std::size_t first = b * BlockSize;
+        if (first + BlockSize <= count) {
+            _mm_storeu_si128((__m128i*)(values + first), lo);
+            _mm_storeu_si128((__m128i*)(values + first + 8), hi);
+        } else {
+            std::uint16_t tail[BlockSize];
+            _mm_storeu_si128((__m128i*)tail, lo);
+            _mm_storeu_si128((__m128i*)(tail + 8), hi);
+            std::copy(tail, tail + (count - first), values + first);
+        }
+    }
+#else
+    std::uint16_t previous = 0;
+    for (std::size_t b = 0; b < blocks; ++b) {
+        if (data[b] > 4) return false;
+        int width = WIDTHS[data[b]];
+        if (p + width * 2 > end) return false;
+
+        std::uint16_t z[BlockSize] = {};
+        for (int j = 0; j < 16; ++j) {
+            switch (width) {
+            case 2: z[j] = (p[j & 3] >> ((j >> 2) * 2)) & 3; break;
+            case 4: z[j] = (p[j & 7] >> ((j >> 3) * 4)) & 15; break;
+            case 8: z[j] = p[j]; break;
+            case 16: z[j] = (std::uint16_t)(p[j * 2] | p[j * 2 + 1] << 8); break;
+            }
+        }
+        p += width * 2;
+
+        for (std::size_t j = 0; j < BlockSize && b * BlockSize + j < count; ++j) {
+            std::uint16_t delta = (std::uint16_t)((z[j] >> 1) ^ (std::uint16_t)-(z[j] & 1));
+            previous = (std::uint16_t)(previous + delta);
+            values[b * BlockSize + j] = previous;
+        }
+    }
+#endif
+    return true;
+}
+
+void encodeIndices(const unsigned int* indices, std::size_t count, std::vector<std::uint8_t>& out) {
+    std::uint32_t previous = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint32_t delta = indices[i] - previous;
+        std::uint32_t z = (delta << 1) ^ (std::uint32_t)((std::int32_t)delta >> 31);
+        previous = indices[i];
+        while (z >= 0x80) {
+            out.push_back((std::uint8_t)(z | 0x80));
+            z >>= 7;
+        }
+        out.push_back((std::uint8_t)z);
+    }
+}
+
+bool decodeIndices(const std::uint8_t* data, std::size_t size, unsigned int* indices, std::size_t count) {
+    const std::uint8_t* p = data;
+    const std::uint8_t* end = data + size;
+    std::uint32_t previous = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint32_t z = 0;
+        int shift = 0;
+        for (;;) {
+            if (p == end || shift > 28) return false;
+            std::uint8_t byte = *p++;
+            z |= (std::uint32_t)(byte & 0x7F) << shift;
+            if (byte < 0x80) break;
+            shift += 7;
+        }
+        previous += (z >> 1) ^ (std::uint32_t)-(std::int32_t)(z & 1);
+        indices[i] = previous;
+    }
+    return true;
+}
+
+} // namespace MeshCodec
+
+// --- Quantization ---
+
+/** @brief Maps a value in [min, min + 65535 * scale] to 16 bits. */
+static std::uint16_t quantize(float value, float min, float scale) {
+    if (scale <= 0.0f) return 0;
+    float q = std::round((value - min) / scale);
+    return (std::uint16_t)std::min(65535.0f, std::max(0.0f, q));
+}
+
+/** @brief Octahedral encoding of a unit normal into two 16-bit values. */
+static void encodeNormal(const float* n, std::uint16_t& u, std::uint16_t& v) {
+    float sum = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+    float x = sum > 0.0f ? n[0] / sum : 0.0f;
+    float y = sum > 0.0f ? n[1] / sum : 0.0f;
+    if (n[2] < 0.0f) {
+        float fx = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float fy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx;
+        y = fy;
+    }
+    u = quantize(x, -1.0f, 2.0f / 65535.0f);
+    v = quantize(y, -1.0f, 2.0f / 65535.0f);
+}
+
+/**
+ * @brief Bounds of one component of an interleaved float array, as a quantization range.
+ */
+static void componentRange(const std::vector<float>& data, int stride, int component, float& min, float& scale) {
+    min = scale = 0.0f;
+    if (data.size() <= (std::size_t)component) return;
+
+    float lo = data[component], hi = lo;
+    for (std::size_t i = component + stride; i < data.size(); i += stride) {
+        lo = std::min(lo, data[i]);
+        hi = std::max(hi, data[i]);
+    }
+    min = lo;
+    scale = (hi - lo) / 65535.0f;
+}
+
+// --- File I/O ---
+
+namespace {
+
+/** @brief Per-mesh header as stored in the file. */
+struct MeshHeader {
+    std::uint32_t materialIndex;
+    std::uint32_t vertexCount;
+    std::uint32_t indexCount;
+    std::uint32_t flags;
+    float positionMin[3], positionScale[3];
+    float texMin[2], texScale[2];
+    std::uint32_t streamBytes[StreamCount];
+};
+
+void append(std::vector<std::uint8_t>& out, const void* data, std::size_t size) {
+    const std::uint8_t* bytes = (const std::uint8_t*)data;
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+/** @brief Bounds-checked reads from the file image. */
+struct Reader {
+    const std::uint8_t* p;
+    const std::uint8_t* end;
+
+    bool read(void* out, std::size_t size) {
+        if ((std::size_t)(end - p) < size) return false;
+        std::memcpy(out, p, size);
+        p += size;
+        return true;
+    }
+};
+
+} // namespace
+
+bool stampCookedSource(const std::string& path, CookedSource& source) {
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(path, error);
+    if (error) return false;
+    source.path = path;
+    source.writeTime = (std::int64_t)time.time_since_epoch().count();
+    return true;
+}
+
+bool writeCookedAsset(const std::string& path, const CookedAsset& asset, CookStats* stats) {
+    std::vector<std::uint8_t> out;
+    append(out, MAGIC, sizeof(MAGIC));
+    append(out, &FORMAT_VERSION, 4);
+    std::uint32_t materialCount = (std::uint32_t)asset.materials.size();
+    std::uint32_t meshCount = (std::uint32_t)asset.meshes.size();
+    append(out, &materialCount, 4);
+    append(out, &meshCount, 4);
+
+    std::uint32_t sourceCount = (std::uint32_t)asset.sources.size();
+    append(out, &sourceCount, 4);
+    for (const CookedSource& source : asset.sources) {
+        std::uint32_t length = (std::uint32_t)source.path.size();
+        append(out, &length, 4);
+        append(out, source.path.data(), length);
+        append(out, &source.writeTime, 8);
+    }
+
+    for (const CookedMaterial& m : asset.materials) {
+        append(out, m.material.ambient, sizeof(m.material.ambient));
+        append(out, m.material.diffuse, sizeof(m.material.diffuse));
+        append(out, m.material.specular, sizeof(m.material.specular));
+        append(out, m.material.emission, sizeof(m.material.emission));
+        append(out, &m.material.shininess, 4);
+        std::uint32_t length = (std::uint32_t)m.texture.size();
+        append(out, &length, 4);
+        append(out, m.texture.data(), length);
+    }
+
+    std::size_t rawBytes = 0;
+    std::vector<std::uint16_t> channel;
+    std::vector<std::uint8_t> streams[StreamCount];
+    for (const MeshStreams& mesh : asset.meshes) {
+        MeshHeader header = {};
+        header.materialIndex = mesh.materialIndex;
+        header.vertexCount = (std::uint32_t)(mesh.vertices.size() / 3);
+        header.indexCount = (std::uint32_t)mesh.indices.size();
+        bool hasNormals = mesh.normals.size() == mesh.vertices.size() && !mesh.normals.empty();
+        bool hasTexCoords = mesh.texCoords.size() == (std::size_t)header.vertexCount * 2;
+        header.flags = hasNormals ? FLAG_NORMALS : 0;
+        std::size_t n = header.vertexCount;
+        rawBytes += (mesh.vertices.size() + mesh.normals.size() + mesh.texCoords.size()) * sizeof(float) +
+                    mesh.indices.size() * sizeof(unsigned int);
+
+        for (auto& s : streams) s.clear();
+        channel.resize(n);
+        for (int axis = 0; axis < 3; ++axis) {
+            componentRange(mesh.vertices, 3, axis, header.positionMin[axis], header.positionScale[axis]);
+            for (std::size_t i = 0; i < n; ++i)
+                channel[i] = quantize(mesh.vertices[i * 3 + axis], header.positionMin[axis], header.positionScale[axis]);
+            MeshCodec::encodeChannel(channel.data(), n, streams[PositionX + axis]);
+        }
+        if (hasNormals) {
+            std::vector<std::uint16_t> second(n);
+            for (std::size_t i = 0; i < n; ++i) encodeNormal(&mesh.normals[i * 3], channel[i], second[i]);
+            MeshCodec::encodeChannel(channel.data(), n, streams[NormalU]);
+            MeshCodec::encodeChannel(second.data(), n, streams[NormalV]);
+        }
+        for (int axis = 0; axis < 2; ++axis) {
+            if (hasTexCoords) componentRange(mesh.texCoords, 2, axis, header.texMin[axis], header.texScale[axis]);
+            for (std::size_t i = 0; i < n; ++i)
+                channel[i] = hasTexCoords ? quantize(mesh.texCoords[i * 2 + axis], header.texMin[axis], header.texScale[axis]) : 0;
+            MeshCodec::encodeChannel(channel.data(), n, streams[TexU + axis]);
+        }
+        MeshCodec::encodeIndices(mesh.indices.data(), mesh.indices.size(), streams[Indices]);
+
+        for (int s = 0; s < StreamCount; ++s) header.streamBytes[s] = (std::uint32_t)streams[s].size();
+        append(out, &header, sizeof(header));
+        for (const auto& s : streams) append(out, s.data(), s.size());
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write((const char*)out.data(), (std::streamsize)out.size());
+    if (!file) return false;
+
+    if (stats) {
+        stats->rawBytes = rawBytes;
+        stats->cookedBytes = out.size();
+        stats->decodeMs = 0.0;
+    }
+    return true;
+}
+
+bool readCookedAsset(const std::string& path, CookedAsset& asset, JobSystem& pool, CookStats* stats) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    std::vector<std::uint8_t> image((std::size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read((char*)image.data(), (std::streamsize)image.size())) return false;
+
+    Reader in = { image.data(), image.data() + image.size() };
+    char magic[8];
+    std::uint32_t version = 0, materialCount = 0, meshCount = 0;
+    if (!in.read(magic, 8) || std::memcmp(magic, MAGIC, 8) != 0) return false;
+    if (!in.read(&version, 4) || version != FORMAT_VERSION) return false;
+    if (!in.read(&materialCount, 4) || !in.read(&meshCount, 4)) return false;
+
+    // Stale once any source changed, before anything is decoded
+    std::uint32_t sourceCount = 0;
+    if (!in.read(&sourceCount, 4)) return false;
+    asset.sources.assign(sourceCount, CookedSource());
+    for (CookedSource& source : asset.sources) {
+        std::uint32_t length = 0;
+        if (!in.read(&length, 4) || (std::size_t)(in.end - in.p) < length) return false;
+        source.path.assign((const char*)in.p, length);
+        in.p += length;
+        CookedSource current;
+        if (!in.read(&source.writeTime, 8) || !stampCookedSource(source.path, current) ||
+            current.writeTime != source.writeTime) {
+            return false;
+        }
+    }
+
+    asset.materials.assign(materialCount, CookedMaterial());
+    for (CookedMaterial& m : asset.materials) {
+        std::uint32_t length = 0;
+        bool ok = in.read(m.material.ambient, sizeof(m.material.ambient)) &&
+                  in.read(m.material.diffuse, sizeof(m.material.diffuse)) &&
+                  in.read(m.material.specular, sizeof(m.material.specular)) &&
+                  in.read(m.material.emission, sizeof(m.material.emission)) &&
+                  in.read(&m.material.shininess, 4) && in.read(&length, 4);
+        if (!ok || (std::size_t)(in.end - in.p) < length) return false;
+        m.texture.assign((const char*)in.p, length);
+        in.p += length;
+    }
+
+    // Lay out every mesh's arrays, then decode each stream as its own job
+    struct Job {
+        std::size_t mesh;
+        int stream;
+        const std::uint8_t* data;
+    };
+    std::vector<MeshHeader> headers(meshCount);
+    std::vector<Job> jobList;
+    std::size_t rawBytes = 0;
+    asset.meshes.assign(meshCount, MeshStreams());
+    for (std::size_t m = 0; m < meshCount; ++m) {
+        MeshHeader& header = headers[m];
+        if (!in.read(&header, sizeof(header))) return false;
+
+        MeshStreams& mesh = asset.meshes[m];
+        std::size_t n = header.vertexCount;
+        mesh.materialIndex = header.materialIndex;
+        mesh.vertices.resize(n * 3);
+        mesh.normals.resize((header.flags & FLAG_NORMALS) ? n * 3 : 0);
+        mesh.texCoords.resize(n * 2);
+        mesh.indices.resize(header.indexCount);
+        rawBytes += (mesh.vertices.size() + mesh.normals.size() + mesh.texCoords.size()) * sizeof(float) +
+                    mesh.indices.size() * sizeof(unsigned int);
+
+        const std::uint8_t* streamStart[StreamCount];
+        for (int s = 0; s < StreamCount; ++s) {
+            if ((std::size_t)(in.end - in.p) < header.streamBytes[s]) return false;
+            streamStart[s] = in.p;
+            in.p += header.streamBytes[s];
+        }
+        jobList.push_back({ m, PositionX, streamStart[PositionX] });
+        if (header.flags & FLAG_NORMALS) jobList.push_back({ m, NormalU, streamStart[NormalU] });
+        jobList.push_back({ m, TexU, streamStart[TexU] });
+        jobList.push_back({ m, Indices, streamStart[Indices] });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::uint8_t> failed(jobList.size(), 0);
+    pool.parallelFor(jobList.size(), 1, [&](std::size_t begin, std::size_t end) {
+        std::vector<std::uint16_t> channels[3];
+        for (std::size_t j = begin; j < end; ++j) {
+            const Job& job = jobList[j];
+            const MeshHeader& header = headers[job.mesh];
+            MeshStreams& mesh = asset.meshes[job.mesh];
+            std::size_t n = header.vertexCount;
+            const std::uint8_t* data = job.data;
+
+            // Decode the attribute's component streams (they are stored back to back)
+            int components = job.stream == PositionX ? 3 : job.stream == Indices ? 0 : 2;
+            for (int c = 0; c < components; ++c) {
+                channels[c].resize(n);
+                std::size_t bytes = header.streamBytes[job.stream + c];
+                if (!MeshCodec::decodeChannel(data, bytes, channels[c].data(), n)) failed[j] = 1;
+                data += bytes;
+            }
+
+            if (job.stream == PositionX) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    const std::uint16_t* q = channels[axis].data();
+                    float min = header.positionMin[axis], scale = header.positionScale[axis];
+                    for (std::size_t i = 0; i < n; ++i) mesh.vertices[i * 3 + axis] = min + q[i] * scale;
+                }
+            } else if (job.stream == NormalU) {
+                const float toSigned = 2.0f / 65535.0f;
+                for (std::size_t i = 0; i < n; ++i) {
+                    float x = channels[0][i] * toSigned - 1.0f;
+                    float y = channels[1][i] * toSigned - 1.0f;
+                    float z = 1.0f - std::fabs(x) - std::fabs(y);
+                    float t = std::max(-z, 0.0f);
+                    x += x >= 0.0f ? -t : t;
+                    y += y >= 0.0f ? -t : t;
+                    float inv = 1.0f / std::sqrt(x * x + y * y + z * z);
+                    mesh.normals[i * 3] = x * inv;
+                    mesh.normals[i * 3 + 1] = y * inv;
+                    mesh.normals[i * 3 + 2] = z * inv;
+                }
+            } else if (job.stream == TexU) {
+                for (int axis = 0; axis < 2; ++axis) {
+                    const std::uint16_t* q = channels[axis].data();
+                    float min = header.texMin[axis], scale = header.texScale[axis];
+                    for (std::size_t i = 0; i < n; ++i) mesh.texCoords[i * 2 + axis] = min + q[i] * scale;
+                }
+            } else {
+                if (!MeshCodec::decodeIndices(data, header.streamBytes[Indices], mesh.indices.data(), header.indexCount)) failed[j] = 1;
+                for (unsigned int index : mesh.indices) {
+                    if (index >= n) failed[j] = 1;
+                }
+            }
+        }
+    });
+    double decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (std::find(failed.begin(), failed.end(), 1) != failed.end()) return false;
+    if (stats) {
+        stats->rawBytes = rawBytes;
+        stats->cookedBytes = image.size();
+        stats->decodeMs = decodeMs;
+    }
+    return true;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file DynamicResolution.cpp
+ * @brief Implementation of the dynamic resolution controller.
+ */
+
+#include "DynamicResolution.h"
+#include "GLExtensions.h"
+#include "Log.h"
+#include <algorithm>
+#include <cmath>
+
+/** @brief Scale only rises once frames are this far under budget (dead band). */
+static const double HEADROOM = 0.8;
+
+/** @brief Largest change in scale per decision. */
+static const float MAX_STEP = 0.1f;
+
+/** @brief Scales are snapped to multiples of this to avoid tiny changes. */
+static const float SCALE_QUANTUM = 0.05f;
+
+void DynamicResolution::update(double frameMs, double budgetMs, float minScale) {
+    accumulatedMs += frameMs;
+    if (++frames < EvaluationFrames) return;
+
+    double averageMs = accumulatedMs / frames;
+    accumulatedMs = 0.0;
+    frames = 0;
+    if (cooldown > 0) { --cooldown; return; }
+
+    // Fill cost is roughly proportional to pixel count, i.e. scale squared
+    float target = scale;
+    if (averageMs > budgetMs) {
+        target = scale * (float)std::sqrt(budgetMs / averageMs);
+        target = std::max(target, scale - MAX_STEP);
+    } else if (averageMs < budgetMs * HEADROOM) {
+        target = std::min(scale * (float)std::sqrt(budgetMs * HEADROOM / averageMs), scale + MAX_STEP);
+    }
+
+    target = std::round(target / SCALE_QUANTUM) * SCALE_QUANTUM;
+    target = std::min(1.0f, std::max(minScale, target));
+    if (target != scale) {
+        scale = target;
+        cooldown = 1; // let the new resolution show up in the measurements first
+    }
+}
+
+bool DynamicResolution::resize(int w, int h) {
+    if (w == targetWidth && h == targetHeight) return true;
+
+    if (colorTexture) {
+        GLuint textures[2] = { colorTexture, depthTexture };
+        glDeleteTextures(2, textures);
+    }
+
+    // Allocated at window size; lower scales only use the lower-left part,
+    // so changing the scale never reallocates
+    colorTexture = GLExt::createTargetTexture(GL_RGBA8, w, h, GL_LINEAR);
+    depthTexture = GLExt::createTargetTexture(GL_DEPTH_COMPONENT24, w, h, GL_NEAREST);
+    targetWidth = w;
+    targetHeight = h;
+
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    GLenum status = GLExt::CheckFramebufferStatus(GL_FRAMEBUFFER);
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_WARNING("Dynamic resolution framebuffer incomplete (0x%x); rendering at native resolution.", status);
+        state = 0;
+        return false;
+    }
+    return true;
+}
+
+bool DynamicResolution::begin(int windowWidth, int windowHeight) {
+    if (scale >= 1.0f || state == 0) return false;
+    if (state < 0) {
+        state = GLExt::load() ? 1 : 0;
+        if (state == 0) return false;
+        GLExt::GenFramebuffers(1, &framebuffer);
+    }
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    if (!resize(windowWidth, windowHeight)) return false;
+
+    sceneWidth = std::max(1, (int)(windowWidth * scale));
+    sceneHeight = std::max(1, (int)(windowHeight * scale));
+
+    glGetIntegerv(GL_VIEWPORT, windowViewport);
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, sceneWidth, sceneHeight);
+    return true;
+}
+
+void DynamicResolution::end() {
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(windowViewport[0], windowViewport[1], windowViewport[2], windowViewport[3]);
+
+    glPushAttrib(GL_ENABLE_BIT | GL_TRANSFORM_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_FOG);
+    glDisable(GL_BLEND);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    float u = (float)sceneWidth / targetWidth;
+    float v = (float)sceneHeight / targetHeight;
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(-1.0f, -1.0f);
+    glTexCoord2f(u, 0.0f);    glVertex2f(1.0f, -1.0f);
+    glTexCoord2f(u, v);       glVertex2f(1.0f, 1.0f);
+    glTexCoord2f(0.0f, v);    glVertex2f(-1.0f, 1.0f);
+    glEnd();
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPopAttrib();
+}
+
+DynamicResolution& dynamicResolution() {
+    static DynamicResolution instance;
+    return instance;
+}
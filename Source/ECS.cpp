@@ -0,0 +1,119 @@
+/**
+ * @file ECS.cpp
+ * @brief Implementation of the entity registry and the transform propagation system.
+ */
+
+#include "ECS.h"
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// --- Registry Implementation ---
+
+Entity Registry::create() {
+    Entity e;
+    if (!freeIds.empty()) {
+        e = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        e = nextId++;
+    }
+
+    transforms.emplace(e);
+    WorldMatrix identity = { { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 } };
+    worldMatrices.emplace(e, identity);
+    return e;
+}
+
+void Registry::destroy(Entity e) {
+    if (e == NullEntity || !transforms.has(e)) return;
+    transforms.remove(e);
+    worldMatrices.remove(e);
+    renderables.remove(e);
+    colliders.remove(e);
+    behaviors.remove(e);
+    freeIds.push_back(e);
+}
+
+Registry& world() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+// --- Transform Propagation ---
+
+/**
+ * @brief Builds the local matrix T * Rx * Ry * Rz * S (column-major).
+ */
+static void buildLocalMatrix(const Transform& t, float out[16]) {
+    float ax = t.rotation.x * (float)(M_PI / 180.0f);
+    float ay = t.rotation.y * (float)(M_PI / 180.0f);
+    float az = t.rotation.z * (float)(M_PI / 180.0f);
+    float cx = std::cos(ax), sx = std::sin(ax);
+    float cy = std::cos(ay), sy = std::sin(ay);
+    float cz = std::cos(az), sz = std::sin(az);
+
+    // R = Rx * Ry * Rz, stored by columns
+    float r00 = cy * cz,                 r01 = -cy * sz,                r02 = sy;
+    float r10 = sx * sy * cz + cx * sz,  r11 = -sx * sy * sz + cx * cz, r12 = -sx * cy;
+    float r20 = -cx * sy * cz + sx * sz, r21 = cx * sy * sz + sx * cz,  r22 = cx * cy;
+
+    out[0] = r00 * t.scale.x; out[1] = r10 * t.scale.x; out[2] = r20 * t.scale.x;  out[3] = 0.0f;
+    out[4] = r01 * t.scale.y; out[5] = r11 * t.scale.y; out[6] = r21 * t.scale.y;  out[7] = 0.0f;
+    out[8] = r02 * t.scale.z; out[9] = r12 * t.scale.z; out[10] = r22 * t.scale.z; out[11] = 0.0f;
+    out[12] = t.position.x;   out[13] = t.position.y;   out[14] = t.position.z;    out[15] = 1.0f;
+}
+
+/**
+ * @brief out = a * b for column-major affine matrices.
+ */
+static void multiplyAffine(const float a[16], const float b[16], float out[16]) {
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            out[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1] +
+                             a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+        }
+    }
+}
+
+void propagateTransforms(Registry& reg) {
+    std::size_t count = reg.transforms.size();
+    const Transform* transforms = reg.transforms.components();
+    const Entity* entities = reg.transforms.entities();
+
+    // 1. Depth of every entity (hierarchies are shallow, so walking up is cheap)
+    std::vector<std::uint32_t> depth(count);
+    std::uint32_t maxDepth = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint32_t d = 0;
+        for (Entity p = transforms[i].parent; p != NullEntity; p = reg.transforms.get(p).parent) ++d;
+        depth[i] = d;
+        if (d > maxDepth) maxDepth = d;
+    }
+
+    // 2. Counting sort by depth so parents are always finished before children
+    std::vector<std::size_t> levelStart(maxDepth + 2, 0);
+    for (std::size_t i = 0; i < count; ++i) levelStart[depth[i] + 1]++;
+    for (std::size_t l = 1; l < levelStart.size(); ++l) levelStart[l] += levelStart[l - 1];
+
+    std::vector<std::uint32_t> order(count);
+    std::vector<std::size_t> cursor(levelStart.begin(), levelStart.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) order[cursor[depth[i]]++] = (std::uint32_t)i;
+
+    // 3. Compose level by level
+    for (std::size_t k = 0; k < count; ++k) {
+        std::uint32_t i = order[k];
+        const Transform& t = transforms[i];
+        WorldMatrix& out = reg.worldMatrices.get(entities[i]);
+
+        if (t.parent == NullEntity) {
+            buildLocalMatrix(t, out.m);
+        } else {
+            float local[16];
+            buildLocalMatrix(t, local);
+            multiplyAffine(reg.worldMatrices.get(t.parent).m, local, out.m);
+        }
+    }
+}
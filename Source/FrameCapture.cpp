@@ -0,0 +1,461 @@
+/**
+ * @file FrameCapture.cpp
+ * @brief Implementation of the asynchronous frame capture and its encoders.
+ */
+
+#include "FrameCapture.h"
+#include "GLExtensions.h"
+#include "Log.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+// --- PNG ---
+
+/** @brief Bit writer for a deflate stream (bits are packed LSB first). */
+struct BitWriter {
+    std::vector<std::uint8_t>& out;
+    std::uint32_t bits = 0;
+    int count = 0;
+
+    explicit BitWriter(std::vector<std::uint8_t>& out) : out(out) {}
+
+    void put(std::uint32_t value, int n) {
+        bits |= value << count;
+        count += n;
+        while (count >= 8) {
+            out.push_back((std::uint8_t)bits);
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    /** @brief Huffman codes are defined MSB first. */
+    void putCode(std::uint32_t code, int n) {
+        std::uint32_t reversed = 0;
+        for (int i = 0; i < n; ++i) reversed |= ((code >> i) & 1u) << (n - 1 - i);
+        put(reversed, n);
+    }
+
+    void flush() {
+        if (count > 0) out.push_back((std::uint8_t)bits);
+        bits = 0;
+        count = 0;
+    }
+};
+
+const int LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                              35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const int LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                               3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const int DIST_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+                            513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const int DIST_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7,
+                             8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+/** @brief Writes a literal/length symbol with the fixed Huffman code. */
+void putSymbol(BitWriter& w, int symbol) {
+    if (symbol < 144) w.putCode(0x30 + symbol, 8);
+    else if (symbol < 256) w.putCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280) w.putCode(symbol - 256, 7);
+    else w.putCode(0xC0 + symbol - 280, 8);
+}
+
+/**
+ * @brief Compresses data into a zlib stream: greedy LZ77 (one hash candidate per
+ * position) in a single fixed-Huffman block. Rendered frames have long runs, so
+ * this gets most of the way to zlib at a fraction of the cost.
+ */
+std::vector<std::uint8_t> zlibCompress(const std::vector<std::uint8_t>& data) {
+    static const int WINDOW = 32768, MAX_MATCH = 258, HASH_BITS = 15;
+
+    std::vector<std::uint8_t> out;
+    out.reserve(data.size() / 4 + 64);
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    BitWriter w(out);
+    w.put(1, 1); // final block
+    w.put(1, 2); // fixed Huffman codes
+
+    std::vector<int> head(1 << HASH_BITS, -1);
+    const std::size_t n = data.size();
+    std::size_t i = 0;
+    while (i < n) {
+        int length = 0, distance = 0;
+        if (i + 3 <= n) {
+            std::uint32_t h = ((data[i] << 16) | (data[i + 1] << 8) | data[i + 2]) * 2654435761u >> (32 - HASH_BITS);
+            int candidate = head[h];
+            head[h] = (int)i;
+            if (candidate >= 0 && (int)i - candidate <= WINDOW) {
+                std::size_t limit = std::min<std::size_t>(MAX_MATCH, n - i);
+                std::size_t k = 0;
+                while (k < limit && data[candidate + k] == data[i + k]) ++k;
+                if (k >= 3) { length = (int)k; distance = (int)i - candidate; }
+            }
+        }
+
+        if (length == 0) {
+            putSymbol(w, data[i]);
+            ++i;
+            continue;
+        }
+
+        int lc = 0;
+        while (lc < 28 && LENGTH_BASE[lc + 1] <= length) ++lc;
+        putSymbol(w, 257 + lc);
+        w.put(length - LENGTH_BASE[lc], LENGTH_EXTRA[lc]);
+
+        int dc = 0;
+        while (dc < 29 && DIST_BASE[dc + 1] <= distance) ++dc;
+        w.putCode(dc, 5);
+        w.put(distance - DIST_BASE[dc], DIST_EXTRA[dc]);
+
+        // Keep the hash table fed inside the match (sparsely, for speed)
+        for (std::size_t k = 1; k < (std::size_t)length && i + k + 3 <= n; k += 4) {
+            std::uint32_t h = ((data[i + k] << 16) | (data[i + k + 1] << 8) | data[i + k + 2]) * 2654435761u >> (32 - HASH_BITS);
+            head[h] = (int)(i + k);
+        }
+        i += length;
+    }
+    putSymbol(w, 256); // end of block
+    w.flush();
+
+    std::uint32_t a = 1, b = 0;
+    for (std::uint8_t byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    std::uint32_t adler = (b << 16) | a;
+    for (int s = 24; s >= 0; s -= 8) out.push_back((std::uint8_t)(adler >> s));
+    return out;
+}
+
+std::uint32_t crc32(const std::uint8_t* data, std::size_t n, std::uint32_t crc = 0) {
+    // Built once, thread-safely: encoders run on several threads
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> t = {};
+        for (std::uint32_t k = 0; k < 256; ++k) {
+            std::uint32_t c = k;
+            for (int j = 0; j < 8; ++j) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[k] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (std::size_t k = 0; k < n; ++k) crc = table[(crc ^ data[k]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void appendChunk(std::vector<std::uint8_t>& png, const char type[4], const std::vector<std::uint8_t>& data) {
+    std::uint32_t length = (std::uint32_t)data.size();
+    for (int s = 24; s >= 0; s -= 8) png.push_back((std::uint8_t)(length >> s));
+    std::size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    std::uint32_t crc = crc32(png.data() + start, png.size() - start);
+    for (int s = 24; s >= 0; s -= 8) png.push_back((std::uint8_t)(crc >> s));
+}
+
+/** @brief Encodes a bottom-up RGBA readback as an RGB PNG. */
+std::vector<std::uint8_t> encodePng(int width, int height, const std::vector<std::uint8_t>& rgba) {
+    // Rows top-down, each with the "Up" filter (readbacks are very coherent vertically)
+    std::size_t stride = (std::size_t)width * 3;
+    std::vector<std::uint8_t> raw((stride + 1) * height);
+    std::vector<std::uint8_t> previous(stride, 0), row(stride);
+    for (int y = 0; y < height; ++y) {
+        const std::uint8_t* src = rgba.data() + (std::size_t)(height - 1 - y) * width * 4;
+        for (int x = 0; x < width; ++x) {
+            row[x * 3] = src[x * 4];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        std::uint8_t* dst = raw.data() + (stride + 1) * y;
+        dst[0] = 2;
+        for (std::size_t k = 0; k < stride; ++k) dst[k + 1] = (std::uint8_t)(row[k] - previous[k]);
+        previous.swap(row);
+    }
+
+    static const std::uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<std::uint8_t> png(SIGNATURE, SIGNATURE + 8);
+
+    std::vector<std::uint8_t> header;
+    for (std::uint32_t v : { (std::uint32_t)width, (std::uint32_t)height }) {
+        for (int s = 24; s >= 0; s -= 8) header.push_back((std::uint8_t)(v >> s));
+    }
+    header.insert(header.end(), { 8, 2, 0, 0, 0 }); // 8-bit RGB, deflate, no interlace
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", zlibCompress(raw));
+    appendChunk(png, "IEND", {});
+    return png;
+}
+
+// --- Y4M ---
+
+/** @brief Converts a bottom-up RGBA readback to top-down 4:2:0 BT.601 (studio range) planes. */
+std::vector<std::uint8_t> encodeI420(int width, int height, const std::vector<std::uint8_t>& rgba) {
+    int cw = (width + 1) / 2, ch = (height + 1) / 2;
+    std::vector<std::uint8_t> planes((std::size_t)width * height + 2 * (std::size_t)cw * ch);
+    std::uint8_t* py = planes.data();
+    std::uint8_t* pu = py + (std::size_t)width * height;
+    std::uint8_t* pv = pu + (std::size_t)cw * ch;
+
+    auto pixel = [&](int x, int y) { return rgba.data() + ((std::size_t)(height - 1 - y) * width + x) * 4; };
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const std::uint8_t* p = pixel(x, y);
+            py[(std::size_t)y * width + x] = (std::uint8_t)((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) / 256 + 16);
+        }
+    }
+    for (int y = 0; y < ch; ++y) {
+        for (int x = 0; x < cw; ++x) {
+            int r = 0, g = 0, b = 0, count = 0;
+            for (int dy = 0; dy < 2; ++dy) {
+                for (int dx = 0; dx < 2; ++dx) {
+                    int sx = std::min(x * 2 + dx, width - 1), sy = std::min(y * 2 + dy, height - 1);
+                    const std::uint8_t* p = pixel(sx, sy);
+                    r += p[0]; g += p[1]; b += p[2]; ++count;
+                }
+            }
+            r /= count; g /= count; b /= count;
+            pu[(std::size_t)y * cw + x] = (std::uint8_t)((-38 * r - 74 * g + 112 * b + 128) / 256 + 128);
+            pv[(std::size_t)y * cw + x] = (std::uint8_t)((112 * r - 94 * g - 18 * b + 128) / 256 + 128);
+        }
+    }
+    return planes;
+}
+
+} // namespace
+
+// --- FrameCapture Implementation ---
+
+FrameCapture::~FrameCapture() {
+    // No GL calls here (the context may be gone): only the encoder is waited for
+    if (!output) return;
+    std::unique_lock<std::mutex> lock(output->mutex);
+    output->done.wait(lock, [this]() { return output->inFlight == 0; });
+    if (output->video) std::fclose(output->video);
+    output->video = nullptr;
+}
+
+bool FrameCapture::start(const std::string& path, CaptureFormat format, int fps) {
+    if (active) stop();
+
+    std::shared_ptr<Output> out = std::make_shared<Output>();
+    out->format = format;
+    out->path = path;
+    out->fps = std::max(1, fps);
+
+    if (format == CaptureFormat::Png) {
+        std::error_code error;
+        std::filesystem::create_directories(path, error);
+        if (error) {
+            LOG_ERROR("Capture: cannot create %s: %s", path.c_str(), error.message().c_str());
+            return false;
+        }
+    } else {
+        out->video = std::fopen(path.c_str(), "wb");
+        if (!out->video) {
+            LOG_ERROR("Capture: cannot open %s", path.c_str());
+            return false;
+        }
+    }
+
+    // Encodes queued on jobs() would sit ahead of the frame loop's parallelFor helpers
+    if (!encoders) {
+        unsigned hw = std::thread::hardware_concurrency();
+        encoders.reset(new JobSystem(std::min(4u, std::max(1u, hw / 2))));
+    }
+
+    output = out;
+    asyncReadback = GLExt::loadReadback();
+    nextFrame = 0;
+    head = tail = 0;
+    active = true;
+    return true;
+}
+
+void FrameCapture::stop() {
+    if (!active) return;
+    drain();
+    active = false;
+
+    std::unique_lock<std::mutex> lock(output->mutex);
+    output->done.wait(lock, [this]() { return output->inFlight == 0; });
+    if (output->video) std::fclose(output->video);
+    output->video = nullptr;
+    LOG_INFO("Capture: %ld frames written to %s", nextFrame, output->path.c_str());
+}
+
+bool FrameCapture::beginOffscreen(int width, int height) {
+    if (!GLExt::load()) return false;
+
+    if (width != offscreenWidth || height != offscreenHeight) {
+        if (colorTexture) {
+            GLuint textures[2] = { colorTexture, depthTexture };
+            glDeleteTextures(2, textures);
+        }
+        if (!framebuffer) GLExt::GenFramebuffers(1, &framebuffer);
+        colorTexture = GLExt::createTargetTexture(GL_RGBA8, width, height, GL_NEAREST);
+        depthTexture = GLExt::createTargetTexture(GL_DEPTH_COMPONENT24, width, height, GL_NEAREST);
+        offscreenWidth = width;
+        offscreenHeight = height;
+
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        GLenum status = GLExt::CheckFramebufferStatus(GL_FRAMEBUFFER);
+        GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            LOG_WARNING("Capture framebuffer incomplete (0x%x); capturing the window.", status);
+            offscreenWidth = offscreenHeight = 0;
+            return false;
+        }
+    }
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+    offscreen = true;
+    return true;
+}
+
+void FrameCapture::endOffscreen() {
+    if (!offscreen) return;
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    offscreen = false;
+}
+
+void FrameCapture::captureFrame(int width, int height) {
+    if (!active || width <= 0 || height <= 0) return;
+
+    // Without pixel buffers the readback blocks; still correct, just slower
+    if (!asyncReadback) {
+        std::vector<std::uint8_t> rgba((std::size_t)width * height * 4);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        submit(nextFrame++, width, height, std::move(rgba));
+        return;
+    }
+
+    if (width != ringWidth || height != ringHeight) {
+        drain();
+        for (auto& slot : ring) {
+            if (!slot.buffer) GLExt::GenBuffers(1, &slot.buffer);
+            GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            GLExt::BufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, nullptr, GL_STREAM_READ);
+        }
+        GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        ringWidth = width;
+        ringHeight = height;
+    }
+
+    // Ring full: the oldest frame was issued RingSize frames ago and is normally done
+    Slot& slot = ring[head];
+    if (slot.busy) retire(ring[tail]);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = GLExt::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = nextFrame++;
+    slot.busy = true;
+    head = (head + 1) % RingSize;
+
+    // Map whatever the GPU already finished, oldest first, without waiting
+    while (ring[tail].busy) {
+        GLenum state = GLExt::ClientWaitSync(ring[tail].fence, 0, 0);
+        if (state != GL_ALREADY_SIGNALED && state != GL_CONDITION_SATISFIED) break;
+        retire(ring[tail]);
+    }
+}
+
+void FrameCapture::retire(Slot& slot) {
+    while (GLExt::ClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+    GLExt::DeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    std::vector<std::uint8_t> rgba((std::size_t)ringWidth * ringHeight * 4);
+    GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (const void* mapped = GLExt::MapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY)) {
+        std::memcpy(rgba.data(), mapped, rgba.size());
+        GLExt::UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    GLExt::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.busy = false;
+    tail = (tail + 1) % RingSize;
+    submit(slot.frame, ringWidth, ringHeight, std::move(rgba));
+}
+
+void FrameCapture::drain() {
+    while (ring[tail].busy) retire(ring[tail]);
+}
+
+void FrameCapture::submit(long frame, int width, int height, std::vector<std::uint8_t> rgba) {
+    std::shared_ptr<Output> out = output;
+    {
+        // Back-pressure: a slow encoder slows the capture down instead of piling up frames
+        std::unique_lock<std::mutex> lock(out->mutex);
+        out->done.wait(lock, [&out]() { return out->inFlight < MaxFramesInFlight; });
+        ++out->inFlight;
+    }
+
+    auto pixels = std::make_shared<std::vector<std::uint8_t>>(std::move(rgba));
+    encoders->submit([out, frame, width, height, pixels]() {
+        if (out->format == CaptureFormat::Png) {
+            std::vector<std::uint8_t> png = encodePng(width, height, *pixels);
+            char name[32];
+            std::snprintf(name, sizeof(name), "frame_%06ld.png", frame);
+            std::string file = out->path + "/" + name;
+            if (FILE* f = std::fopen(file.c_str(), "wb")) {
+                std::fwrite(png.data(), 1, png.size(), f);
+                std::fclose(f);
+            }
+
+            std::lock_guard<std::mutex> lock(out->mutex);
+            --out->inFlight;
+            out->done.notify_all();
+            return;
+        }
+
+        std::vector<std::uint8_t> planes = encodeI420(width, height, *pixels);
+
+        // Frames finish out of order; append them to the stream in order
+        std::lock_guard<std::mutex> lock(out->mutex);
+        if (out->videoWidth == 0) {
+            out->videoWidth = width;
+            out->videoHeight = height;
+            if (out->video) std::fprintf(out->video, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, out->fps);
+        }
+        if (width != out->videoWidth || height != out->videoHeight) {
+            LOG_WARNING("Capture: frame %ld skipped (window resized during a Y4M capture)", frame);
+            planes.clear();
+        }
+        out->finished[frame] = std::move(planes);
+
+        for (auto it = out->finished.find(out->nextToWrite); it != out->finished.end();
+             it = out->finished.find(out->nextToWrite)) {
+            if (out->video && !it->second.empty()) {
+                std::fputs("FRAME\n", out->video);
+                std::fwrite(it->second.data(), 1, it->second.size(), out->video);
+            }
+            out->finished.erase(it);
+            ++out->nextToWrite;
+        }
+
+        --out->inFlight;
+        out->done.notify_all();
+    });
+}
+
+FrameCapture& frameCapture() {
+    static FrameCapture instance;
+    return instance;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file Frustum.cpp
+ * @brief Implementation of the culling volumes.
+ */
+
+#include "Frustum.h"
+#include <cmath>
+
+Frustum Frustum::fromMatrix(const float m[16]) {
+    // Gribb/Hartmann: each plane is the fourth row plus or minus another row
+    auto row = [m](int r, float s[4]) {
+        for (int c = 0; c < 4; ++c) s[c] = m[c * 4 + r];
+    };
+    float r0[4], r1[4], r2[4], r3[4];
+    row(0, r0); row(1, r1); row(2, r2); row(3, r3);
+
+    Frustum f;
+    f.planes.push_back({ r3[0] + r0[0], r3[1] + r0[1], r3[2] + r0[2], r3[3] + r0[3] }); // left
+    f.planes.push_back({ r3[0] - r0[0], r3[1] - r0[1], r3[2] - r0[2], r3[3] - r0[3] }); // right
+    f.planes.push_back({ r3[0] + r1[0], r3[1] + r1[1], r3[2] + r1[2], r3[3] + r1[3] }); // bottom
+    f.planes.push_back({ r3[0] - r1[0], r3[1] - r1[1], r3[2] - r1[2], r3[3] - r1[3] }); // top
+    f.planes.push_back({ r3[0] + r2[0], r3[1] + r2[1], r3[2] + r2[2], r3[3] + r2[3] }); // near
+    f.planes.push_back({ r3[0] - r2[0], r3[1] - r2[1], r3[2] - r2[2], r3[3] - r2[3] }); // far
+    return f;
+}
+
+Frustum Frustum::fromPortal(const Vec3& eye, const std::vector<Vec3>& corners) {
+    Frustum f;
+    if (corners.size() < 3) return f;
+
+    Vec3 center = { 0, 0, 0 };
+    for (const auto& c : corners) { center.x += c.x; center.y += c.y; center.z += c.z; }
+    float inv = 1.0f / corners.size();
+    center = { center.x * inv, center.y * inv, center.z * inv };
+
+    // A plane through three points, flipped so `inside` is in front of it
+    auto planeThrough = [](Vec3 a, Vec3 b, Vec3 c, Vec3 inside) {
+        Vec3 u = { b.x - a.x, b.y - a.y, b.z - a.z };
+        Vec3 v = { c.x - a.x, c.y - a.y, c.z - a.z };
+        PlaneEq p;
+        p.a = u.y * v.z - u.z * v.y;
+        p.b = u.z * v.x - u.x * v.z;
+        p.c = u.x * v.y - u.y * v.x;
+        p.d = -(p.a * a.x + p.b * a.y + p.c * a.z);
+        if (p.distance(inside) < 0.0f) { p.a = -p.a; p.b = -p.b; p.c = -p.c; p.d = -p.d; }
+        return p;
+    };
+
+    // Side planes: eye + one portal edge, keeping the ray through the portal centre
+    Vec3 beyond = { center.x * 2.0f - eye.x, center.y * 2.0f - eye.y, center.z * 2.0f - eye.z };
+    for (std::size_t i = 0; i < corners.size(); ++i) {
+        const Vec3& a = corners[i];
+        const Vec3& b = corners[(i + 1) % corners.size()];
+        f.planes.push_back(planeThrough(eye, a, b, beyond));
+    }
+
+    // Near plane: the portal itself, keeping the far side
+    f.planes.push_back(planeThrough(corners[0], corners[1], corners[2], beyond));
+    return f;
+}
+
+bool Frustum::intersects(const AABB& box) const {
+    for (const auto& p : planes) {
+        // The box corner furthest along the plane normal
+        Vec3 v = { p.a >= 0.0f ? box.max.x : box.min.x,
+                   p.b >= 0.0f ? box.max.y : box.min.y,
+                   p.c >= 0.0f ? box.max.z : box.min.z };
+        if (p.distance(v) < 0.0f) return false;
+    }
+    return true;
+}
+
+AABB transformBounds(const WorldMatrix& w, const AABB& local) {
+    // Arvo's method: centre moves with the matrix, extents through |M|
+    Vec3 c = { (local.min.x + local.max.x) * 0.5f, (local.min.y + local.max.y) * 0.5f, (local.min.z + local.max.z) * 0.5f };
+    Vec3 e = { (local.max.x - local.min.x) * 0.5f, (local.max.y - local.min.y) * 0.5f, (local.max.z - local.min.z) * 0.5f };
+    const float* m = w.m;
+
+    Vec3 wc = w.transformPoint(c);
+    Vec3 we = {
+        std::abs(m[0]) * e.x + std::abs(m[4]) * e.y + std::abs(m[8]) * e.z,
+        std::abs(m[1]) * e.x + std::abs(m[5]) * e.y + std::abs(m[9]) * e.z,
+        std::abs(m[2]) * e.x + std::abs(m[6]) * e.y + std::abs(m[10]) * e.z,
+    };
+    return { { wc.x - we.x, wc.y - we.y, wc.z - we.z }, { wc.x + we.x, wc.y + we.y, wc.z + we.z } };
+}
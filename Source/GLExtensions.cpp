@@ -0,0 +1,298 @@
+/**
+ * @file GLExtensions.cpp
+ * @brief Loading of the OpenGL entry points and shader helpers.
+ */
+
+#include "GLExtensions.h"
+#include "Log.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace GLExt {
+
+PFNGLGENFRAMEBUFFERSPROC GenFramebuffers = nullptr;
+PFNGLDELETEFRAMEBUFFERSPROC DeleteFramebuffers = nullptr;
+PFNGLBINDFRAMEBUFFERPROC BindFramebuffer = nullptr;
+PFNGLFRAMEBUFFERTEXTURE2DPROC FramebufferTexture2D = nullptr;
+PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus = nullptr;
+PFNGLDRAWBUFFERSPROC DrawBuffers = nullptr;
+PFNGLBLENDFUNCSEPARATEPROC BlendFuncSeparate = nullptr;
+PFNGLACTIVETEXTUREPROC ActiveTexture = nullptr;
+
+PFNGLCREATESHADERPROC CreateShader = nullptr;
+PFNGLDELETESHADERPROC DeleteShader = nullptr;
+PFNGLSHADERSOURCEPROC ShaderSource = nullptr;
+PFNGLCOMPILESHADERPROC CompileShader = nullptr;
+PFNGLGETSHADERIVPROC GetShaderiv = nullptr;
+PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog = nullptr;
+PFNGLCREATEPROGRAMPROC CreateProgram = nullptr;
+PFNGLATTACHSHADERPROC AttachShader = nullptr;
+PFNGLLINKPROGRAMPROC LinkProgram = nullptr;
+PFNGLGETPROGRAMIVPROC GetProgramiv = nullptr;
+PFNGLGETPROGRAMINFOLOGPROC GetProgramInfoLog = nullptr;
+PFNGLUSEPROGRAMPROC UseProgram = nullptr;
+PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation = nullptr;
+PFNGLUNIFORM1IPROC Uniform1i = nullptr;
+PFNGLUNIFORM1FPROC Uniform1f = nullptr;
+PFNGLUNIFORM2FPROC Uniform2f = nullptr;
+PFNGLUNIFORM3FPROC Uniform3f = nullptr;
+PFNGLUNIFORM1FVPROC Uniform1fv = nullptr;
+
+PFNGLGENQUERIESPROC GenQueries = nullptr;
+PFNGLDELETEQUERIESPROC DeleteQueries = nullptr;
+PFNGLBEGINQUERYPROC BeginQuery = nullptr;
+PFNGLENDQUERYPROC EndQuery = nullptr;
+PFNGLGETQUERYOBJECTUIVPROC GetQueryObjectuiv = nullptr;
+
+PFNGLGENBUFFERSPROC GenBuffers = nullptr;
+PFNGLDELETEBUFFERSPROC DeleteBuffers = nullptr;
+PFNGLBINDBUFFERPROC BindBuffer = nullptr;
+PFNGLBUFFERDATAPROC BufferData = nullptr;
+PFNGLMAPBUFFERPROC MapBuffer = nullptr;
+PFNGLUNMAPBUFFERPROC UnmapBuffer = nullptr;
+PFNGLFENCESYNCPROC FenceSync = nullptr;
+PFNGLCLIENTWAITSYNCPROC ClientWaitSync = nullptr;
+PFNGLDELETESYNCPROC DeleteSync = nullptr;
+
+PFNGLBINDATTRIBLOCATIONPROC BindAttribLocation = nullptr;
+PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer = nullptr;
+PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray = nullptr;
+PFNGLDISABLEVERTEXATTRIBARRAYPROC DisableVertexAttribArray = nullptr;
+PFNGLVERTEXATTRIBDIVISORPROC VertexAttribDivisor = nullptr;
+PFNGLDRAWARRAYSINSTANCEDPROC DrawArraysInstanced = nullptr;
+
+PFNGLUNIFORM4FVPROC Uniform4fv = nullptr;
+PFNGLBINDBUFFERBASEPROC BindBufferBase = nullptr;
+PFNGLDISPATCHCOMPUTEPROC DispatchCompute = nullptr;
+PFNGLMEMORYBARRIERPROC MemoryBarrier = nullptr;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect = nullptr;
+
+/** @brief Looks up one entry point, trying the core name first and then the ARB/EXT names. */
+template <typename T>
+static bool resolve(T& fn, const char* name) {
+    static const char* SUFFIXES[] = { "", "ARB", "EXT" };
+    for (const char* suffix : SUFFIXES) {
+        std::string full = std::string(name) + suffix;
+        fn = reinterpret_cast<T>(glutGetProcAddress(full.c_str()));
+        if (fn) return true;
+    }
+    return false;
+}
+
+bool load() {
+    static int state = -1; // -1 not tried, 0 unavailable, 1 loaded
+    if (state >= 0) return state == 1;
+
+    bool ok = true;
+    ok &= resolve(GenFramebuffers, "glGenFramebuffers");
+    ok &= resolve(DeleteFramebuffers, "glDeleteFramebuffers");
+    ok &= resolve(BindFramebuffer, "glBindFramebuffer");
+    ok &= resolve(FramebufferTexture2D, "glFramebufferTexture2D");
+    ok &= resolve(CheckFramebufferStatus, "glCheckFramebufferStatus");
+    ok &= resolve(DrawBuffers, "glDrawBuffers");
+    ok &= resolve(BlendFuncSeparate, "glBlendFuncSeparate");
+    ok &= resolve(ActiveTexture, "glActiveTexture");
+    ok &= resolve(CreateShader, "glCreateShader");
+    ok &= resolve(DeleteShader, "glDeleteShader");
+    ok &= resolve(ShaderSource, "glShaderSource");
+    ok &= resolve(CompileShader, "glCompileShader");
+    ok &= resolve(GetShaderiv, "glGetShaderiv");
+    ok &= resolve(GetShaderInfoLog, "glGetShaderInfoLog");
+    ok &= resolve(CreateProgram, "glCreateProgram");
+    ok &= resolve(AttachShader, "glAttachShader");
+    ok &= resolve(LinkProgram, "glLinkProgram");
+    ok &= resolve(GetProgramiv, "glGetProgramiv");
+    ok &= resolve(GetProgramInfoLog, "glGetProgramInfoLog");
+    ok &= resolve(UseProgram, "glUseProgram");
+    ok &= resolve(GetUniformLocation, "glGetUniformLocation");
+    ok &= resolve(Uniform1i, "glUniform1i");
+    ok &= resolve(Uniform1f, "glUniform1f");
+    ok &= resolve(Uniform2f, "glUniform2f");
+    ok &= resolve(Uniform3f, "glUniform3f");
+    ok &= resolve(Uniform1fv, "glUniform1fv");
+
+    // Float render targets are core in 3.0, an extension before that
+    const char* version = (const char*)glGetString(GL_VERSION);
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    bool floatTextures = (version && version[0] >= '3') ||
+                         (extensions && std::strstr(extensions, "GL_ARB_texture_float"));
+    ok &= floatTextures;
+
+    if (!ok) LOG_WARNING("OpenGL 2.0 framebuffer/shader support missing; using the fixed-function path.");
+    state = ok ? 1 : 0;
+    return ok;
+}
+
+bool loadQueries() {
+    static int state = -1;
+    if (state >= 0) return state == 1;
+
+    bool ok = true;
+    ok &= resolve(GenQueries, "glGenQueries");
+    ok &= resolve(DeleteQueries, "glDeleteQueries");
+    ok &= resolve(BeginQuery, "glBeginQuery");
+    ok &= resolve(EndQuery, "glEndQuery");
+    ok &= resolve(GetQueryObjectuiv, "glGetQueryObjectuiv");
+
+    if (!ok) LOG_WARNING("OpenGL occlusion queries missing; visibility tests are skipped.");
+    state = ok ? 1 : 0;
+    return ok;
+}
+
+bool loadAnySamplesQueries() {
+    static int state = -1;
+    if (state >= 0) return state == 1;
+
+    // Core in 3.3, an extension before that
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    bool ok = major * 10 + minor >= 33 || (extensions && std::strstr(extensions, "GL_ARB_occlusion_query2"));
+    ok = ok && loadQueries();
+
+    if (!ok) LOG_INFO("ARB_occlusion_query2 unavailable; hidden rooms are not culled.");
+    state = ok ? 1 : 0;
+    return ok;
+}
+
+bool loadReadback() {
+    static int state = -1;
+    if (state >= 0) return state == 1;
+
+    bool ok = true;
+    ok &= resolve(GenBuffers, "glGenBuffers");
+    ok &= resolve(DeleteBuffers, "glDeleteBuffers");
+    ok &= resolve(BindBuffer, "glBindBuffer");
+    ok &= resolve(BufferData, "glBufferData");
+    ok &= resolve(MapBuffer, "glMapBuffer");
+    ok &= resolve(UnmapBuffer, "glUnmapBuffer");
+    ok &= resolve(FenceSync, "glFenceSync");
+    ok &= resolve(ClientWaitSync, "glClientWaitSync");
+    ok &= resolve(DeleteSync, "glDeleteSync");
+
+    if (!ok) LOG_WARNING("OpenGL pixel buffers/fences missing; frames are read back synchronously.");
+    state = ok ? 1 : 0;
+    return ok;
+}
+
+bool loadInstancing() {
+    static int state = -1;
+    if (state >= 0) return state == 1;
+
+    bool ok = true;
+    ok &= resolve(GenBuffers, "glGenBuffers");
+    ok &= resolve(DeleteBuffers, "glDeleteBuffers");
+    ok &= resolve(BindBuffer, "glBindBuffer");
+    ok &= resolve(BufferData, "glBufferData");
+    ok &= resolve(BindAttribLocation, "glBindAttribLocation");
+    ok &= resolve(VertexAttribPointer, "glVertexAttribPointer");
+    ok &= resolve(EnableVertexAttribArray, "glEnableVertexAttribArray");
+    ok &= resolve(DisableVertexAttribArray, "glDisableVertexAttribArray");
+    ok &= resolve(VertexAttribDivisor, "glVertexAttribDivisor");
+    ok &= resolve(DrawArraysInstanced, "glDrawArraysInstanced");
+
+    if (!ok) LOG_WARNING("OpenGL instanced drawing missing; particles are expanded on the CPU.");
+    state = ok ? 1 : 0;
+    return ok;
+}
+
+bool loadIndirect() {
+    static int state = -1;
+    if (state >= 0) return state == 1;
+
+    // Compute shaders and storage buffers are core in 4.3
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool ok = major * 10 + minor >= 43 && load() && loadReadback() && loadInstancing();
+    if (ok) {
+        ok &= resolve(Uniform4fv, "glUniform4fv");
+        ok &= resolve(BindBufferBase, "glBindBufferBase");
+        ok &= resolve(DispatchCompute, "glDispatchCompute");
+        ok &= resolve(MemoryBarrier, "glMemoryBarrier");
+        ok &= resolve(MultiDrawElementsIndirect, "glMultiDrawElementsIndirect");
+    }
+
+    if (!ok) LOG_INFO("OpenGL 4.3 compute/indirect drawing unavailable; static objects are drawn one by one.");
+    state = ok ? 1 : 0;
+    return ok;
+}
+
+/** @brief Compiles one shader stage, printing the log on failure. */
+static GLuint compile(GLenum type, const char* source) {
+    GLuint shader = CreateShader(type);
+    ShaderSource(shader, 1, &source, nullptr);
+    CompileShader(shader);
+
+    GLint status = GL_FALSE;
+    GetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint length = 0;
+        GetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length + 1, '\0');
+        GetShaderInfoLog(shader, length, nullptr, log.data());
+        LOG_ERROR("Shader compile error: %s", log.data());
+        DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+/** @brief Links a program from compiled stages (deleted once attached), printing the log on failure. */
+static GLuint link(GLuint first, GLuint second) {
+    GLuint program = CreateProgram();
+    AttachShader(program, first);
+    if (second) AttachShader(program, second);
+    LinkProgram(program);
+    DeleteShader(first); // freed with the program
+    if (second) DeleteShader(second);
+
+    GLint status = GL_FALSE;
+    GetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint length = 0;
+        GetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length + 1, '\0');
+        GetProgramInfoLog(program, length, nullptr, log.data());
+        LOG_ERROR("Shader link error: %s", log.data());
+        return 0;
+    }
+    return program;
+}
+
+GLuint buildProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint vs = compile(GL_VERTEX_SHADER, vertexSource);
+    GLuint fs = compile(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vs || !fs) {
+        if (vs) DeleteShader(vs);
+        if (fs) DeleteShader(fs);
+        return 0;
+    }
+    return link(vs, fs);
+}
+
+GLuint buildComputeProgram(const char* source) {
+    GLuint cs = compile(GL_COMPUTE_SHADER, source);
+    return cs ? link(cs, 0) : 0;
+}
+
+GLuint createTargetTexture(GLenum internalFormat, int width, int height, GLenum filter) {
+    bool depth = internalFormat == GL_DEPTH_COMPONENT || internalFormat == GL_DEPTH_COMPONENT16 ||
+                 internalFormat == GL_DEPTH_COMPONENT24 || internalFormat == GL_DEPTH_COMPONENT32;
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0,
+                 depth ? GL_DEPTH_COMPONENT : GL_RGBA, depth ? GL_UNSIGNED_INT : GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+} // namespace GLExt
@@ -4,6 +4,11 @@
  */
 
 #include "GameObject.h"
+#include "Frustum.h"
+#include "PlanarMirror.h"
+#include "ReflectionProbe.h"
+#include "RenderSettings.h"
+#include <algorithm>
 #include <cmath> 
 
 #ifndef M_PI
@@ -12,13 +17,95 @@
 
 // --- GameObject Implementation ---
 
-void GameObject::setPosition(float x, float y, float z) { position = { x, y, z }; }
-void GameObject::setRotation(float x, float y, float z) { rotation = { x, y, z }; }
-void GameObject::setScale(float x, float y, float z) { scale = { x, y, z }; }
-void GameObject::setMaterial(const Material& m) { material = m; }
+GameObject::GameObject() {
+    entity = world().create();
+    Renderable r;
+    r.object = this;
+    world().renderables.emplace(entity, r);
+}
+
+GameObject::GameObject(const GameObject& other)
+    : parent(other.parent),
+      updateAction(other.updateAction),
+      interactAction(other.interactAction),
+      tags(other.tags),
+      castsShadow(other.castsShadow) {
+    Registry& reg = world();
+    entity = reg.create();
+    reg.transforms.get(entity) = other.transform();
+
+    // Only copy the Renderable if the source draws something (Containers do not)
+    if (const Renderable* src = reg.renderables.tryGet(other.entity)) {
+        Renderable r = *src;
+        r.object = this;
+        r.indirect = false; // the IndirectScene only draws what it collected
+        reg.renderables.emplace(entity, r);
+    }
+}
+
+GameObject::~GameObject() {
+    GameObject::leaveScene();
+    world().destroy(entity);
+}
+
+void GameObject::setName(const std::string& n) {
+    if (inScene) SceneIndex::rename(this, name, n);
+    name = n;
+}
+
+void GameObject::addTag(Tag t) {
+    tags |= tagBit(t);
+    if (inScene) SceneIndex::addTags(this, tagBit(t));
+}
+
+void GameObject::removeTag(Tag t) {
+    tags &= ~tagBit(t);
+    if (inScene) SceneIndex::removeTags(this, tagBit(t));
+}
+
+void GameObject::enterScene() {
+    if (inScene) return;
+    inScene = true;
+    SceneIndex::rename(this, std::string(), name);
+    SceneIndex::addTags(this, tags);
+}
+
+void GameObject::leaveScene() {
+    if (!inScene) return;
+    inScene = false;
+    SceneIndex::rename(this, name, std::string());
+    SceneIndex::removeTags(this, tags);
+}
+
+void GameObject::setPosition(float x, float y, float z) { transform().position = { x, y, z }; }
+void GameObject::setRotation(float x, float y, float z) { transform().rotation = { x, y, z }; }
+void GameObject::setScale(float x, float y, float z) { transform().scale = { x, y, z }; }
+
+void GameObject::setMaterial(const Material& m) {
+    if (Renderable* r = world().renderables.tryGet(entity)) {
+        r->materialId = MaterialLibrary::add(m);
+    }
+}
+
+const Material& GameObject::getMaterial() const {
+    const Renderable* r = world().renderables.tryGet(entity);
+    return MaterialLibrary::get(r ? r->materialId : 0);
+}
 
 bool GameObject::isTransparent() const {
-    return material.isTransparent();
+    return getMaterial().isTransparent();
+}
+
+void GameObject::setParent(GameObject* p) {
+    parent = p;
+    transform().parent = p ? p->entity : NullEntity;
+}
+
+bool GameObject::isStatic() const {
+    for (const GameObject* o = this; o; o = o->parent) {
+        if (o->updateAction || o->interactAction || world().behaviors.has(o->entity)) return false;
+    }
+    return true;
 }
 
 void GameObject::setUpdateCallback(UpdateCallback action) {
@@ -59,6 +146,9 @@ void GameObject::rotateAround(float px, float py, float pz, float ax, float ay,
     if (len < 0.0001f) return; // Prevent divide by zero
     ax /= len; ay /= len; az /= len;
 
+    Vec3& position = transform().position;
+    Vec3& rotation = transform().rotation;
+
     // 3. Calculate Relative Position (Vector from Pivot to Object)
     float rx = position.x - px;
     float ry = position.y - py;
@@ -83,6 +173,8 @@ void GameObject::rotateAround(float px, float py, float pz, float ax, float ay,
 }
 
 Vec3 GameObject::getRealRotation() const {
+    const Vec3& rotation = transform().rotation;
+
     // 1. If we have a parent, add our rotation to theirs
     if (parent) {
         Vec3 pRot = parent->getRealRotation();
@@ -150,6 +242,8 @@ static Vec3 applyInverseRotation(Vec3 v, Vec3 rotDeg) {
 }
 
 Vec3 GameObject::getRealPosition() const {
+    const Vec3& position = transform().position;
+
     // 1. If no parent, local position IS real position
     if (!parent) {
         return position;
@@ -160,6 +254,11 @@ Vec3 GameObject::getRealPosition() const {
 }
 
 Vec3 GameObject::getPointInWorldSpace(Vec3 localPoint) const {
+    const Transform& t = transform();
+    const Vec3& position = t.position;
+    const Vec3& rotation = t.rotation;
+    const Vec3& scale = t.scale;
+
     // 1. Apply Local Scale
     Vec3 p = localPoint;
     p.x *= scale.x;
@@ -190,6 +289,11 @@ Vec3 GameObject::getPointInLocalSpace(Vec3 worldPoint) const {
         p = parent->getPointInLocalSpace(p);
     }
 
+    const Transform& t = transform();
+    const Vec3& position = t.position;
+    const Vec3& rotation = t.rotation;
+    const Vec3& scale = t.scale;
+
     // 2. Apply Inverse Local Position
     p.x -= position.x;
     p.y -= position.y;
@@ -207,29 +311,63 @@ Vec3 GameObject::getPointInLocalSpace(Vec3 worldPoint) const {
 }
 
 void GameObject::draw() {
+    if (renderContext().indirect) {
+        const Renderable* r = world().renderables.tryGet(entity);
+        if (r && r->indirect) return;
+    }
+
+    if (const Frustum* cull = renderContext().cull) {
+        if (!cull->intersects(transformBounds(world().worldMatrices.get(entity), getLocalBounds()))) return;
+    }
+
+    const Transform& t = transform();
+
     glPushMatrix();
-    glTranslatef(position.x, position.y, position.z);
-    glRotatef(rotation.x, 1, 0, 0);
-    glRotatef(rotation.y, 0, 1, 0);
-    glRotatef(rotation.z, 0, 0, 1);
-    glScalef(scale.x, scale.y, scale.z);
+    glTranslatef(t.position.x, t.position.y, t.position.z);
+    glRotatef(t.rotation.x, 1, 0, 0);
+    glRotatef(t.rotation.y, 0, 1, 0);
+    glRotatef(t.rotation.z, 0, 0, 1);
+    glScalef(t.scale.x, t.scale.y, t.scale.z);
     
-    material.apply();
+    getMaterial().apply();
     drawMesh();
+    drawReflection();
     
     glPopMatrix();
 }
 
+void GameObject::drawReflection() {
+    const Material& m = getMaterial();
+    const RenderContext& ctx = renderContext();
+    if (m.reflectivity <= 0.0f || ctx.pass != RenderPass::Main || ctx.oit) return;
+
+    // The transparent pass draws back faces first; only reflect on the front faces
+    if (glIsEnabled(GL_CULL_FACE)) {
+        GLint mode;
+        glGetIntegerv(GL_CULL_FACE_MODE, &mode);
+        if (mode == GL_FRONT) return;
+    }
+
+    if (planarMirrors().drawMirror(this, [this]() { drawMesh(); })) return;
+    if (!renderSettings().reflectionsEnabled) return;
+
+    const WorldMatrix& w = world().worldMatrices.get(entity);
+    reflectionProbes().drawReflection({ w.m[12], w.m[13], w.m[14] }, m.reflectivity, [this]() { drawMesh(); });
+}
+
 // --- Primitive Shape Implementations ---
 
 void Cube::drawMesh() { glutSolidCube(1.0); }
 
-void Cylinder::drawMesh() { glutSolidCylinder(0.5, 1.0, 20, 20); }
+void Cylinder::drawMesh() {
+    int slices = std::max(3, renderSettings().tessellation);
+    glutSolidCylinder(0.5, 1.0, slices, slices);
+}
 
 void Plane::drawMesh() {
-    // Determine the number of divisions (e.g., 20x20 grid)
+    // Determine the number of divisions (RenderSettings::tessellation, 20x20 at full quality)
     // More divisions = better lighting/fog quality but more processing
-    int divisions = 20; 
+    int divisions = std::max(1, renderSettings().tessellation);
     float step = 2.0f / divisions; // Total width is 2 (-1 to 1)
 
     glNormal3f(0, 1, 0); // Normal points up for the whole floor
@@ -255,11 +393,17 @@ void Plane::drawMesh() {
 
 // --- Collision Box Implementation ---
 
-CollisionBox::CollisionBox(float w, float h, float d) 
-    : width(w), height(h), depth(d) {
+CollisionBox::CollisionBox(float w, float h, float d) {
+    Collider c;
+    c.width = w; c.height = h; c.depth = d;
+    world().colliders.emplace(entity, c);
     castsShadow = false; 
 }
 
+CollisionBox::CollisionBox(const CollisionBox& other) : GameObject(other) {
+    world().colliders.emplace(entity, other.getCollider());
+}
+
 void CollisionBox::drawMesh() {
 #ifdef SHOW_COLLISION_BOXES
     // 1. Check if global lighting is currently enabled.
@@ -281,7 +425,8 @@ void CollisionBox::drawMesh() {
     glColor3f(1.0f, 0.0f, 1.0f); // Magenta
     
     glPushMatrix();
-    glScalef(width, height, depth);
+    const Collider& c = getCollider();
+    glScalef(c.width, c.height, c.depth);
     glutWireCube(1.0);
     glPopMatrix();
     
@@ -0,0 +1,297 @@
+/**
+ * @file HLOD.cpp
+ * @brief Implementation of HLOD proxy capture, simplification and drawing.
+ */
+
+#include "HLOD.h"
+#include "Container.h"
+#include "OIT.h"
+#include "RenderSettings.h"
+#include "View.h"
+#include <GL/freeglut.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+/** @brief Half-extent of the orthographic volume used for feedback capture. */
+static const float CAPTURE_EXTENT = 4096.0f;
+
+/** @brief Viewport size used for feedback capture (only scales window coordinates). */
+static const int CAPTURE_VIEWPORT = 1024;
+
+namespace {
+
+/** @brief A captured vertex: local position and lit colour. */
+struct CapturedVertex {
+    float p[3];
+    float c[4];
+};
+
+/**
+ * @brief Draws the opaque or transparent children of a node in its local space.
+ */
+void drawChildren(Container* node, bool transparentPass) {
+    for (auto* child : node->getChildren()) {
+        Container* sub = dynamic_cast<Container*>(child);
+        if (sub) {
+            if (transparentPass) sub->drawTransparentChildren();
+            else sub->drawOpaqueChildren();
+        } else if (child->isTransparent() == transparentPass) {
+            child->draw();
+        }
+    }
+}
+
+/**
+ * @brief Records triangles with feedback mode, growing the buffer until they fit.
+ * @param out Receives three vertices per triangle.
+ */
+void captureTriangles(Container* node, bool transparentPass, std::vector<CapturedVertex>& out) {
+    static const int FLOATS_PER_VERTEX = 7; // GL_3D_COLOR in RGBA mode
+    std::vector<GLfloat> buffer(1 << 20);
+    GLint count;
+
+    for (;;) {
+        glFeedbackBuffer((GLsizei)buffer.size(), GL_3D_COLOR, buffer.data());
+        glRenderMode(GL_FEEDBACK);
+        drawChildren(node, transparentPass);
+        count = glRenderMode(GL_RENDER);
+        if (count >= 0) break;
+        buffer.resize(buffer.size() * 2); // overflowed
+    }
+
+    // Window coordinates back to local space (inverse of the capture ortho + viewport)
+    auto toVertex = [](const GLfloat* f) {
+        CapturedVertex v;
+        v.p[0] = (f[0] / CAPTURE_VIEWPORT * 2.0f - 1.0f) * CAPTURE_EXTENT;
+        v.p[1] = (f[1] / CAPTURE_VIEWPORT * 2.0f - 1.0f) * CAPTURE_EXTENT;
+        v.p[2] = -(f[2] * 2.0f - 1.0f) * CAPTURE_EXTENT;
+        v.c[0] = f[3]; v.c[1] = f[4]; v.c[2] = f[5]; v.c[3] = f[6];
+        return v;
+    };
+
+    for (GLint i = 0; i < count;) {
+        GLfloat token = buffer[i++];
+
+        if (token == GL_POLYGON_TOKEN) {
+            int n = (int)buffer[i++];
+            const GLfloat* first = &buffer[i];
+            // Fan-triangulate the (possibly clipped) polygon
+            for (int k = 1; k + 1 < n; ++k) {
+                out.push_back(toVertex(first));
+                out.push_back(toVertex(first + k * FLOATS_PER_VERTEX));
+                out.push_back(toVertex(first + (k + 1) * FLOATS_PER_VERTEX));
+            }
+            i += n * FLOATS_PER_VERTEX;
+        } else if (token == GL_LINE_TOKEN || token == GL_LINE_RESET_TOKEN) {
+            i += 2 * FLOATS_PER_VERTEX;
+        } else if (token == GL_POINT_TOKEN || token == GL_BITMAP_TOKEN ||
+                   token == GL_DRAW_PIXEL_TOKEN || token == GL_COPY_PIXEL_TOKEN) {
+            i += FLOATS_PER_VERTEX;
+        } else if (token == GL_PASS_THROUGH_TOKEN) {
+            i += 1;
+        } else {
+            break; // unknown token, stop parsing rather than misread the rest
+        }
+    }
+}
+
+/**
+ * @brief Counts drawable leaves (everything except containers and collision boxes).
+ */
+int countDrawables(GameObject* obj) {
+    if (Container* c = dynamic_cast<Container*>(obj)) {
+        int n = 0;
+        for (auto* child : c->getChildren()) n += countDrawables(child);
+        return n;
+    }
+    return dynamic_cast<CollisionBox*>(obj) ? 0 : 1;
+}
+
+std::size_t buildRecursive(GameObject* obj, const RenderSettings& settings, const HLODProxy::LightsFn& setupLights) {
+    Container* node = dynamic_cast<Container*>(obj);
+    if (!node) return 0;
+
+    std::size_t built = 0;
+    for (auto* child : node->getChildren()) built += buildRecursive(child, settings, setupLights);
+
+    if (countDrawables(node) >= settings.hlodMinObjects) {
+        node->setHLOD(HLODProxy::capture(node, settings.hlodClusterGrid, setupLights));
+        if (node->getHLOD()) ++built;
+    }
+    return built;
+}
+
+} // namespace
+
+// --- HLODProxy Implementation ---
+
+std::shared_ptr<HLODProxy> HLODProxy::capture(Container* node, int clusterGrid, const LightsFn& setupLights) {
+    std::vector<CapturedVertex> captured[2];
+
+    // 1. Capture in the node's local space: lights are placed through the inverse
+    //    world matrix, geometry is drawn with an identity modelview
+    float inverseWorld[16];
+    if (!invertAffine(world().worldMatrices.get(node->getEntity()).m, inverseWorld)) return nullptr;
+
+    glPushAttrib(GL_ALL_ATTRIB_BITS);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(-CAPTURE_EXTENT, CAPTURE_EXTENT, -CAPTURE_EXTENT, CAPTURE_EXTENT, -CAPTURE_EXTENT, CAPTURE_EXTENT);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadMatrixf(inverseWorld);
+    setupLights();
+    glLoadIdentity();
+
+    glViewport(0, 0, CAPTURE_VIEWPORT, CAPTURE_VIEWPORT);
+    glDepthRange(0.0, 1.0);
+    glDisable(GL_CULL_FACE);
+
+    RenderPass previous = renderContext().pass;
+    renderContext().pass = RenderPass::Bake;
+    captureTriangles(node, false, captured[0]);
+    captureTriangles(node, true, captured[1]);
+    renderContext().pass = previous;
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    glPopAttrib();
+
+    if (captured[0].empty() && captured[1].empty()) return nullptr;
+
+    // 2. Bounds and clustering cell size
+    std::shared_ptr<HLODProxy> proxy(new HLODProxy());
+    AABB& b = proxy->bounds;
+    b.min = { 1e30f, 1e30f, 1e30f };
+    b.max = { -1e30f, -1e30f, -1e30f };
+    for (const auto& list : captured) {
+        for (const auto& v : list) {
+            b.min = { std::min(b.min.x, v.p[0]), std::min(b.min.y, v.p[1]), std::min(b.min.z, v.p[2]) };
+            b.max = { std::max(b.max.x, v.p[0]), std::max(b.max.y, v.p[1]), std::max(b.max.z, v.p[2]) };
+        }
+    }
+
+    float longest = std::max(b.max.x - b.min.x, std::max(b.max.y - b.min.y, b.max.z - b.min.z));
+    float cell = std::max(longest / std::max(1, clusterGrid), 1e-4f);
+    proxy->error = cell * 0.8660254f; // half the cell diagonal
+
+    // 3. Vertex clustering: one representative (average) per occupied cell,
+    //    dropping triangles that collapse and duplicates
+    Mesh* meshes[2] = { &proxy->opaque, &proxy->transparent };
+    for (int pass = 0; pass < 2; ++pass) {
+        const auto& tris = captured[pass];
+        Mesh& mesh = *meshes[pass];
+
+        struct Cluster { double p[3]; double c[4]; int count; };
+        std::unordered_map<std::uint64_t, unsigned int> clusterOf;
+        std::vector<Cluster> clusters;
+        std::vector<unsigned int> corner(tris.size());
+
+        for (std::size_t i = 0; i < tris.size(); ++i) {
+            const CapturedVertex& v = tris[i];
+            std::uint64_t ix = (std::uint64_t)((v.p[0] - b.min.x) / cell);
+            std::uint64_t iy = (std::uint64_t)((v.p[1] - b.min.y) / cell);
+            std::uint64_t iz = (std::uint64_t)((v.p[2] - b.min.z) / cell);
+            std::uint64_t key = (ix << 42) | (iy << 21) | iz;
+
+            auto it = clusterOf.find(key);
+            unsigned int id;
+            if (it == clusterOf.end()) {
+                id = (unsigned int)clusters.size();
+                clusterOf.emplace(key, id);
+                clusters.push_back({ { 0, 0, 0 }, { 0, 0, 0, 0 }, 0 });
+            } else {
+                id = it->second;
+            }
+
+            Cluster& c = clusters[id];
+            for (int k = 0; k < 3; ++k) c.p[k] += v.p[k];
+            for (int k = 0; k < 4; ++k) c.c[k] += v.c[k];
+            ++c.count;
+            corner[i] = id;
+        }
+
+        std::unordered_set<std::uint64_t> seen;
+        for (std::size_t i = 0; i + 2 < corner.size(); i += 3) {
+            unsigned int a = corner[i], bb = corner[i + 1], c = corner[i + 2];
+            if (a == bb || bb == c || a == c) continue;
+
+            // Same three clusters with the same winding count as one triangle
+            std::array<unsigned int, 3> key = { a, bb, c };
+            std::rotate(key.begin(), std::min_element(key.begin(), key.end()), key.end());
+            std::uint64_t hash = ((std::uint64_t)key[0] << 42) ^ ((std::uint64_t)key[1] << 21) ^ key[2];
+            if (!seen.insert(hash).second) continue;
+
+            mesh.indices.push_back(a);
+            mesh.indices.push_back(bb);
+            mesh.indices.push_back(c);
+        }
+
+        mesh.positions.reserve(clusters.size() * 3);
+        mesh.colors.reserve(clusters.size() * 4);
+        for (const auto& c : clusters) {
+            for (int k = 0; k < 3; ++k) mesh.positions.push_back((float)(c.p[k] / c.count));
+            for (int k = 0; k < 4; ++k) mesh.colors.push_back((float)(c.c[k] / c.count));
+        }
+    }
+
+    return proxy;
+}
+
+bool HLODProxy::shouldReplace() const {
+    const RenderContext& ctx = renderContext();
+    if (ctx.pass == RenderPass::Main || ctx.pass == RenderPass::Display) {
+        const RenderSettings& settings = renderSettings();
+        bool replace = projectedErrorPixels(bounds, error) < settings.hlodPixelError * settings.lodBias * ctx.lodBias;
+        if (ctx.pass == RenderPass::Display) return replace;
+        replaced = replace;
+    }
+    return replaced;
+}
+
+void HLODProxy::Mesh::draw() const {
+    if (indices.empty()) return;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glDisable(GL_TEXTURE_2D);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, positions.data());
+
+    // Lighting is baked into the colours; the shadow pass keeps its own colour
+    if (renderContext().pass != RenderPass::Shadow) {
+        glDisable(GL_LIGHTING);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(4, GL_FLOAT, 0, colors.data());
+    }
+    if (renderContext().oit) weightedOIT().setLighting(false);
+
+    glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, indices.data());
+
+    if (renderContext().oit) weightedOIT().setLighting(true);
+
+    glPopClientAttrib();
+    glPopAttrib();
+}
+
+void HLODProxy::drawOpaque() const { opaque.draw(); }
+
+void HLODProxy::drawTransparent() const { transparent.draw(); }
+
+std::size_t HLODProxy::triangleCount() const {
+    return (opaque.indices.size() + transparent.indices.size()) / 3;
+}
+
+std::size_t buildHLOD(const std::vector<GameObject*>& roots, const HLODProxy::LightsFn& setupLights) {
+    const RenderSettings& settings = renderSettings();
+    std::size_t built = 0;
+    for (auto* obj : roots) built += buildRecursive(obj, settings, setupLights);
+    return built;
+}
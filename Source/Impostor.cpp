@@ -0,0 +1,237 @@
+/**
+ * @file Impostor.cpp
+ * @brief Implementation of octahedral impostor baking and drawing.
+ */
+
+#include "Impostor.h"
+#include "RenderSettings.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+Vec3 normalize(Vec3 v) {
+    float len = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    return len > 0.0f ? Vec3{ v.x / len, v.y / len, v.z / len } : Vec3{ 0.0f, 1.0f, 0.0f };
+}
+
+Vec3 cross(Vec3 a, Vec3 b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+/**
+ * @brief Maps a grid coordinate in [-1, 1]^2 to an upper-hemisphere direction.
+ */
+Vec3 decodeHemiOct(float u, float v) {
+    float px = (u + v) * 0.5f;
+    float pz = (u - v) * 0.5f;
+    return normalize({ px, 1.0f - std::abs(px) - std::abs(pz), pz });
+}
+
+/**
+ * @brief Maps an upper-hemisphere direction to a grid coordinate in [-1, 1]^2.
+ */
+void encodeHemiOct(Vec3 d, float& u, float& v) {
+    d.y = std::max(d.y, 0.0f);
+    float sum = std::abs(d.x) + d.y + std::abs(d.z);
+    float px = d.x / sum, pz = d.z / sum;
+    u = px + pz;
+    v = px - pz;
+}
+
+/**
+ * @brief Screen axes of a view looking at the model from direction d.
+ * * Shared by baking and drawing so quads line up with their views.
+ */
+void viewBasis(Vec3 d, Vec3& right, Vec3& up) {
+    Vec3 worldUp = std::abs(d.y) > 0.999f ? Vec3{ 0.0f, 0.0f, -1.0f } : Vec3{ 0.0f, 1.0f, 0.0f };
+    right = normalize(cross(worldUp, d));
+    up = cross(d, right);
+}
+
+std::unordered_map<std::string, std::weak_ptr<ImpostorAtlas>>& sharedAtlases() {
+    static std::unordered_map<std::string, std::weak_ptr<ImpostorAtlas>> atlases;
+    return atlases;
+}
+
+} // namespace
+
+std::shared_ptr<ImpostorAtlas> ImpostorAtlas::bake(const AABB& bounds, int grid, int viewSize,
+                                                   const BakeFn& setupLights, const BakeFn& drawModel) {
+    std::shared_ptr<ImpostorAtlas> atlas(new ImpostorAtlas());
+    atlas->grid = std::max(2, grid);
+    atlas->center = { (bounds.min.x + bounds.max.x) * 0.5f, (bounds.min.y + bounds.max.y) * 0.5f, (bounds.min.z + bounds.max.z) * 0.5f };
+
+    Vec3 ext = { bounds.max.x - atlas->center.x, bounds.max.y - atlas->center.y, bounds.max.z - atlas->center.z };
+    atlas->radius = std::max(1e-4f, std::sqrt(ext.x * ext.x + ext.y * ext.y + ext.z * ext.z));
+
+    const int n = atlas->grid;
+    const int side = n * viewSize;
+    const float r = atlas->radius;
+    const Vec3 c = atlas->center;
+
+    std::vector<unsigned char> image(side * side * 4, 0);
+    std::vector<unsigned char> pixels(viewSize * viewSize * 4);
+    std::vector<float> depth(viewSize * viewSize);
+
+    glPushAttrib(GL_ALL_ATTRIB_BITS);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(-r, r, -r, r, 0.0, 4.0 * r);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+
+    glViewport(0, 0, viewSize, viewSize);
+    glDisable(GL_FOG);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    // 1. One orthographic view per grid cell, read back from the back buffer
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) {
+            Vec3 d = decodeHemiOct(-1.0f + 2.0f * i / (n - 1), -1.0f + 2.0f * j / (n - 1));
+            Vec3 right, up;
+            viewBasis(d, right, up);
+
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glLoadIdentity();
+            gluLookAt(c.x + d.x * 2.0f * r, c.y + d.y * 2.0f * r, c.z + d.z * 2.0f * r,
+                      c.x, c.y, c.z, up.x, up.y, up.z);
+            setupLights();
+            drawModel();
+
+            glReadPixels(0, 0, viewSize, viewSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            glReadPixels(0, 0, viewSize, viewSize, GL_DEPTH_COMPONENT, GL_FLOAT, depth.data());
+
+            // Anything the model covered is opaque; the cleared background is not
+            for (int y = 0; y < viewSize; ++y) {
+                unsigned char* dst = &image[((j * viewSize + y) * side + i * viewSize) * 4];
+                const unsigned char* src = &pixels[y * viewSize * 4];
+                for (int x = 0; x < viewSize; ++x) {
+                    dst[x * 4 + 0] = src[x * 4 + 0];
+                    dst[x * 4 + 1] = src[x * 4 + 1];
+                    dst[x * 4 + 2] = src[x * 4 + 2];
+                    dst[x * 4 + 3] = depth[y * viewSize + x] < 1.0f ? 255 : 0;
+                }
+            }
+        }
+    }
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    glPopAttrib();
+
+    // 2. Upload (no mipmaps, which would bleed between neighbouring views)
+    glGenTextures(1, &atlas->texture);
+    glBindTexture(GL_TEXTURE_2D, atlas->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, side, side, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return atlas;
+}
+
+std::shared_ptr<ImpostorAtlas> ImpostorAtlas::bakeShared(const std::string& key, const AABB& bounds, int grid, int viewSize,
+                                                         const BakeFn& setupLights, const BakeFn& drawModel) {
+    auto& atlases = sharedAtlases();
+    if (auto existing = atlases[key].lock()) return existing;
+
+    std::shared_ptr<ImpostorAtlas> atlas = bake(bounds, grid, viewSize, setupLights, drawModel);
+    atlases[key] = atlas;
+    return atlas;
+}
+
+ImpostorAtlas::~ImpostorAtlas() {
+    if (texture) glDeleteTextures(1, &texture);
+}
+
+void ImpostorAtlas::draw(float opacity) const {
+    // 1. Camera position in local space
+    Vec3 eye = localEyePosition();
+
+    // 2. Nearest grid view, plus the runner-up along the axis we are furthest off
+    Vec3 dir = normalize({ eye.x - center.x, eye.y - center.y, eye.z - center.z });
+    float u, v;
+    encodeHemiOct(dir, u, v);
+
+    float fu = (u + 1.0f) * 0.5f * (grid - 1);
+    float fv = (v + 1.0f) * 0.5f * (grid - 1);
+    int i0 = (int)std::lround(fu), j0 = (int)std::lround(fv);
+    float du = fu - i0, dv = fv - j0;
+
+    int i1 = i0, j1 = j0;
+    float weight;
+    if (std::abs(du) > std::abs(dv)) { i1 += du > 0 ? 1 : -1; weight = std::abs(du); }
+    else                             { j1 += dv > 0 ? 1 : -1; weight = std::abs(dv); }
+    bool hasSecond = i1 >= 0 && j1 >= 0 && i1 < grid && j1 < grid && weight > 0.01f;
+
+    Vec3 right, up;
+    viewBasis(dir, right, up);
+
+    auto quad = [&](int i, int j) {
+        float s0 = (float)i / grid, s1 = (float)(i + 1) / grid;
+        float t0 = (float)j / grid, t1 = (float)(j + 1) / grid;
+        float rx = right.x * radius, ry = right.y * radius, rz = right.z * radius;
+        float ux = up.x * radius, uy = up.y * radius, uz = up.z * radius;
+
+        glBegin(GL_QUADS);
+        glTexCoord2f(s0, t0); glVertex3f(center.x - rx - ux, center.y - ry - uy, center.z - rz - uz);
+        glTexCoord2f(s1, t0); glVertex3f(center.x + rx - ux, center.y + ry - uy, center.z + rz - uz);
+        glTexCoord2f(s1, t1); glVertex3f(center.x + rx + ux, center.y + ry + uy, center.z + rz + uz);
+        glTexCoord2f(s0, t1); glVertex3f(center.x - rx + ux, center.y - ry + uy, center.z - rz + uz);
+        glEnd();
+    };
+
+    // 3. Draw
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_TEXTURE_BIT);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_ALPHA_TEST);
+    glAlphaFunc(GL_GREATER, 0.0f);
+
+    if (renderContext().pass == RenderPass::Shadow) {
+        // Keep the shadow colour; the texture alpha cuts out the silhouette
+        quad(i0, j0);
+        glPopAttrib();
+        return;
+    }
+
+    glDisable(GL_LIGHTING); // lighting is baked into the views
+
+    if (opacity >= 1.0f) {
+        glDisable(GL_BLEND);
+        glAlphaFunc(GL_GREATER, 0.5f);
+    } else {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    glColor4f(1.0f, 1.0f, 1.0f, opacity);
+    quad(i0, j0);
+
+    if (hasSecond) {
+        // Blend the neighbouring view on top, weighted by how far off the grid we are
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glAlphaFunc(GL_GREATER, 0.0f);
+        glDepthFunc(GL_LEQUAL);
+        glDepthMask(GL_FALSE);
+        glColor4f(1.0f, 1.0f, 1.0f, weight * opacity);
+        quad(i1, j1);
+    }
+
+    glPopAttrib();
+}
@@ -0,0 +1,475 @@
+/**
+ * @file IndirectScene.cpp
+ * @brief Implementation of the GPU-driven opaque pass.
+ */
+
+#include "IndirectScene.h"
+#include "Container.h"
+#include "Frustum.h"
+#include "GLExtensions.h"
+#include "Log.h"
+#include "Prefabs.h"
+#include "RenderSettings.h"
+#include "View.h"
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
+
+/** @brief Planes the cull shader tests; extra planes are ignored (the test stays conservative). */
+static const int MAX_PLANES = 8;
+
+/** @brief Mesh table slots of the shared primitives (PartBatch meshes follow). */
+enum : std::uint32_t { CubeMesh = 0, CylinderMesh = 1 };
+
+/**
+ * @brief Writes one DrawElementsIndirectCommand per object, with no instance if its
+ * bounds are outside a plane or its container was hidden by the traversal.
+ */
+static const char* CULL_COMPUTE = R"(
+#version 430
+layout(local_size_x = 64) in;
+
+struct Object { mat4 model; mat4 normal; vec4 boundsMin; vec4 boundsMax; uvec4 info; };
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, binding = 1) writeonly buffer Commands { uint commands[]; };
+layout(std430, binding = 2) readonly buffer Meshes { uvec4 meshes[]; };
+layout(std430, binding = 4) readonly buffer Groups { uint groupVisible[]; };
+
+uniform vec4 planes[8];
+uniform int planeCount;
+uniform int objectCount;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= uint(objectCount)) return;
+
+    vec3 lo = objects[i].boundsMin.xyz;
+    vec3 hi = objects[i].boundsMax.xyz;
+    bool visible = groupVisible[objects[i].info.z] != 0u;
+    for (int p = 0; visible && p < planeCount; ++p) {
+        // The corner furthest along the plane normal
+        vec3 corner = mix(lo, hi, step(0.0, planes[p].xyz));
+        if (dot(planes[p].xyz, corner) + planes[p].w < 0.0) {
+            visible = false;
+            break;
+        }
+    }
+
+    uvec4 mesh = meshes[objects[i].info.x];
+    uint c = i * 5u;
+    commands[c] = mesh.x;
+    commands[c + 1u] = visible ? 1u : 0u;
+    commands[c + 2u] = mesh.y;
+    commands[c + 3u] = mesh.z;
+    commands[c + 4u] = i;
+}
+)";
+
+/** @brief Per-vertex emulation of the fixed-function lighting, with the material read per object. */
+static const char* DRAW_VERTEX = R"(
+#version 430 compatibility
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in float objectIndex;
+
+struct Object { mat4 model; mat4 normal; vec4 boundsMin; vec4 boundsMax; uvec4 info; };
+struct MaterialData { vec4 ambient; vec4 diffuse; vec4 specular; vec4 emission; vec4 shininess; };
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, binding = 3) readonly buffer Materials { MaterialData materials[]; };
+
+uniform float lightEnabled[8];
+out vec4 color;
+out float fogDistance;
+
+void main() {
+    int index = int(objectIndex);
+    vec4 eye = gl_ModelViewMatrix * (objects[index].model * vec4(position, 1.0));
+    gl_Position = gl_ProjectionMatrix * eye;
+    gl_ClipVertex = eye;
+    fogDistance = abs(eye.z);
+
+    MaterialData m = materials[objects[index].info.y];
+    vec3 n = normalize(gl_NormalMatrix * (mat3(objects[index].normal) * normal));
+    vec3 v = normalize(-eye.xyz);
+    vec4 c = m.emission + gl_LightModel.ambient * m.ambient;
+
+    for (int i = 0; i < 8; ++i) {
+        if (lightEnabled[i] < 0.5) continue;
+
+        vec4 lp = gl_LightSource[i].position;
+        vec3 l = normalize(lp.xyz);
+        float attenuation = 1.0;
+        if (lp.w != 0.0) {
+            vec3 d = lp.xyz - eye.xyz;
+            float dist = length(d);
+            l = d / dist;
+            attenuation = 1.0 / (gl_LightSource[i].constantAttenuation +
+                                 gl_LightSource[i].linearAttenuation * dist +
+                                 gl_LightSource[i].quadraticAttenuation * dist * dist);
+        }
+
+        float ndl = max(dot(n, l), 0.0);
+        vec4 term = gl_LightSource[i].ambient * m.ambient + ndl * gl_LightSource[i].diffuse * m.diffuse;
+        if (ndl > 0.0) {
+            float nh = max(dot(n, normalize(l + v)), 0.0);
+            term += pow(nh, m.shininess.x) * gl_LightSource[i].specular * m.specular;
+        }
+        c += attenuation * term;
+    }
+    color = vec4(clamp(c.rgb, 0.0, 1.0), m.diffuse.a);
+}
+)";
+
+static const char* DRAW_FRAGMENT = R"(
+#version 430 compatibility
+uniform float fog;
+in vec4 color;
+in float fogDistance;
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    vec3 rgb = color.rgb;
+    if (fog > 0.5) {
+        float f = clamp(exp(-pow(gl_Fog.density * fogDistance, 2.0)), 0.0, 1.0);
+        rgb = mix(gl_Fog.color.rgb, rgb, f);
+    }
+    fragColor = vec4(rgb, color.a);
+}
+)";
+
+/** @brief Appends a unit cube (as glutSolidCube(1.0)): position and normal per vertex. */
+static void appendCube(std::vector<float>& vertices, std::vector<std::uint32_t>& indices) {
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int sign = -1; sign <= 1; sign += 2) {
+            // u x v points along the face normal
+            int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            if (sign < 0) std::swap(u, v);
+
+            std::uint32_t base = (std::uint32_t)(vertices.size() / 6);
+            static const float corners[4][2] = { { -0.5f, -0.5f }, { 0.5f, -0.5f }, { 0.5f, 0.5f }, { -0.5f, 0.5f } };
+            for (const auto& corner : corners) {
+                float p[3], n[3] = { 0.0f, 0.0f, 0.0f };
+                p[axis] = 0.5f * sign;
+                p[u] = corner[0];
+                p[v] = corner[1];
+                n[axis] = (float)sign;
+                vertices.insert(vertices.end(), { p[0], p[1], p[2], n[0], n[1], n[2] });
+            }
+            indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+        }
+    }
+}
+
+/** @brief Appends a capped cylinder (as glutSolidCylinder(0.5, 1.0, slices, slices)) along +Z. */
+static void appendCylinder(std::vector<float>& vertices, std::vector<std::uint32_t>& indices, int slices) {
+    const float radius = 0.5f;
+    std::uint32_t base = (std::uint32_t)(vertices.size() / 6);
+
+    // Side: slices + 1 rings (the seam is duplicated) of slices + 1 vertices
+    for (int k = 0; k <= slices; ++k) {
+        float z = (float)k / slices;
+        for (int i = 0; i <= slices; ++i) {
+            float a = 2.0f * 3.14159265f * i / slices;
+            float c = std::cos(a), s = std::sin(a);
+            vertices.insert(vertices.end(), { radius * c, radius * s, z, c, s, 0.0f });
+        }
+    }
+    std::uint32_t row = (std::uint32_t)slices + 1;
+    for (std::uint32_t k = 0; k < (std::uint32_t)slices; ++k) {
+        for (std::uint32_t i = 0; i < (std::uint32_t)slices; ++i) {
+            std::uint32_t a = base + k * row + i, b = a + 1, c = a + row + 1, d = a + row;
+            indices.insert(indices.end(), { a, b, c, a, c, d });
+        }
+    }
+
+    // Caps: a fan around each centre
+    for (int cap = 0; cap < 2; ++cap) {
+        float z = (float)cap, nz = cap ? 1.0f : -1.0f;
+        std::uint32_t center = (std::uint32_t)(vertices.size() / 6);
+        vertices.insert(vertices.end(), { 0.0f, 0.0f, z, 0.0f, 0.0f, nz });
+        for (int i = 0; i <= slices; ++i) {
+            float a = 2.0f * 3.14159265f * i / slices;
+            vertices.insert(vertices.end(), { radius * std::cos(a), radius * std::sin(a), z, 0.0f, 0.0f, nz });
+        }
+        for (std::uint32_t i = 0; i < (std::uint32_t)slices; ++i) {
+            std::uint32_t a = center + 1 + i, b = a + 1;
+            if (cap) indices.insert(indices.end(), { center, a, b });
+            else indices.insert(indices.end(), { center, b, a });
+        }
+    }
+}
+
+/** @brief Appends the quads of a PartBatch (GL_N3F_V3F), split into triangles. */
+static void appendQuads(std::vector<float>& vertices, std::vector<std::uint32_t>& indices, const std::vector<float>& quads) {
+    std::uint32_t base = (std::uint32_t)(vertices.size() / 6);
+    for (std::size_t v = 0; v + 6 <= quads.size(); v += 6) {
+        vertices.insert(vertices.end(), { quads[v + 3], quads[v + 4], quads[v + 5], quads[v], quads[v + 1], quads[v + 2] });
+    }
+    std::uint32_t count = (std::uint32_t)(quads.size() / 6);
+    for (std::uint32_t q = 0; q + 4 <= count; q += 4) {
+        std::uint32_t a = base + q;
+        indices.insert(indices.end(), { a, a + 1, a + 2, a, a + 2, a + 3 });
+    }
+}
+
+bool IndirectScene::init() {
+    if (state >= 0) return state == 1;
+    state = 0;
+    if (!GLExt::loadIndirect()) return false;
+
+    cullProgram = GLExt::buildComputeProgram(CULL_COMPUTE);
+    drawProgram = GLExt::buildProgram(DRAW_VERTEX, DRAW_FRAGMENT);
+    if (!cullProgram || !drawProgram) return false;
+
+    GLuint buffers[8];
+    GLExt::GenBuffers(8, buffers);
+    vertexBuffer = buffers[0];
+    indexBuffer = buffers[1];
+    instanceBuffer = buffers[2];
+    objectBuffer = buffers[3];
+    meshBuffer = buffers[4];
+    materialBuffer = buffers[5];
+    commandBuffer = buffers[6];
+    groupBuffer = buffers[7];
+    state = 1;
+    return true;
+}
+
+void IndirectScene::collect(GameObject* obj, std::uint32_t group) {
+    if (Container* container = dynamic_cast<Container*>(obj)) {
+        std::uint32_t own = (std::uint32_t)groupParent.size();
+        groupParent.push_back(group);
+        groupOf[container] = own;
+        for (GameObject* child : container->getChildren()) collect(child, own);
+        return;
+    }
+
+    // Exact types only: subclasses may draw something else
+    const std::type_info& type = typeid(*obj);
+    if (type != typeid(Cube) && type != typeid(Cylinder) && type != typeid(PartBatch)) return;
+
+    Renderable* r = world().renderables.tryGet(obj->getEntity());
+    if (!r) return;
+    const Material& m = MaterialLibrary::get(r->materialId);
+    if (m.isTransparent() || m.reflectivity > 0.0f || !obj->isStatic()) return;
+
+    std::uint32_t mesh = type == typeid(Cylinder) ? CylinderMesh : CubeMesh;
+    if (type == typeid(PartBatch)) {
+        const auto& quads = static_cast<PartBatch*>(obj)->getVertices();
+        if (quads->empty()) return;
+        auto known = meshIndex.find(quads.get());
+        if (known == meshIndex.end()) {
+            known = meshIndex.emplace(quads.get(), (std::uint32_t)(2 + batchMeshes.size())).first;
+            batchMeshes.push_back(quads);
+        }
+        mesh = known->second;
+    }
+
+    const WorldMatrix& w = world().worldMatrices.get(obj->getEntity());
+    AABB bounds = transformBounds(w, obj->getLocalBounds());
+    ObjectData data = {};
+    std::copy(w.m, w.m + 16, data.model);
+
+    // Normals go through the inverse transpose (scaled boxes are common)
+    float inverse[16];
+    if (!invertAffine(w.m, inverse)) return;
+    for (int c = 0; c < 4; ++c) {
+        for (int row = 0; row < 4; ++row) data.normal[c * 4 + row] = inverse[row * 4 + c];
+    }
+
+    data.boundsMin[0] = bounds.min.x; data.boundsMin[1] = bounds.min.y; data.boundsMin[2] = bounds.min.z;
+    data.boundsMax[0] = bounds.max.x; data.boundsMax[1] = bounds.max.y; data.boundsMax[2] = bounds.max.z;
+    data.mesh = mesh;
+    data.material = r->materialId;
+    data.group = group;
+    objects.push_back(data);
+
+    r->indirect = true;
+    flagged.push_back(obj->getEntity());
+}
+
+std::size_t IndirectScene::build(const std::vector<GameObject*>& roots) {
+    // Hand everything back to the fixed-function path first
+    for (Entity e : flagged) {
+        if (Renderable* r = world().renderables.tryGet(e)) r->indirect = false;
+    }
+    flagged.clear();
+    objects.clear();
+    batchMeshes.clear();
+    meshIndex.clear();
+    groupOf.clear();
+    groupParent.assign(1, 0); // group 0: objects outside any container
+
+    if (!renderSettings().indirectEnabled || !init()) return 0;
+
+    for (GameObject* obj : roots) collect(obj, 0);
+    if (objects.empty()) return 0;
+
+    GLExt::BindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+    GLExt::BufferData(GL_SHADER_STORAGE_BUFFER, objects.size() * sizeof(ObjectData), objects.data(), GL_STATIC_DRAW);
+    GLExt::BindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+    GLExt::BufferData(GL_SHADER_STORAGE_BUFFER, objects.size() * 5 * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+    GLExt::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    std::vector<float> instances(objects.size());
+    for (std::size_t i = 0; i < instances.size(); ++i) instances[i] = (float)i;
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    GLExt::BufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(float), instances.data(), GL_STATIC_DRAW);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    uploadMaterials();
+    uploadMeshes();
+    return objects.size();
+}
+
+void IndirectScene::uploadMeshes() {
+    builtTessellation = std::max(3, renderSettings().tessellation);
+
+    std::vector<float> vertices;
+    std::vector<std::uint32_t> indices;
+    std::vector<GLuint> table;
+    auto addMesh = [&](std::size_t firstVertex, std::size_t firstIndex) {
+        // Indices are relative to the mesh; baseVertex moves them into the shared buffer
+        for (std::size_t i = firstIndex; i < indices.size(); ++i) indices[i] -= (std::uint32_t)firstVertex;
+        table.insert(table.end(), { (GLuint)(indices.size() - firstIndex), (GLuint)firstIndex, (GLuint)firstVertex, 0u });
+    };
+
+    std::size_t v = 0, i = 0;
+    appendCube(vertices, indices);
+    addMesh(v, i);
+    v = vertices.size() / 6, i = indices.size();
+    appendCylinder(vertices, indices, builtTessellation);
+    addMesh(v, i);
+    for (const auto& quads : batchMeshes) {
+        v = vertices.size() / 6, i = indices.size();
+        appendQuads(vertices, indices, *quads);
+        addMesh(v, i);
+    }
+
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    GLExt::BufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    GLExt::BufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(std::uint32_t), indices.data(), GL_STATIC_DRAW);
+    GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLExt::BindBuffer(GL_SHADER_STORAGE_BUFFER, meshBuffer);
+    GLExt::BufferData(GL_SHADER_STORAGE_BUFFER, table.size() * sizeof(GLuint), table.data(), GL_STATIC_DRAW);
+    GLExt::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    meshTriangles.clear();
+    for (std::size_t m = 0; m < table.size(); m += 4) meshTriangles.push_back(table[m] / 3);
+}
+
+void IndirectScene::uploadMaterials() {
+    // Interned materials never change, so every ID in use is covered
+    std::size_t count = MaterialLibrary::count();
+    std::vector<float> data;
+    data.reserve(count * 20);
+    for (std::size_t id = 0; id < count; ++id) {
+        const Material& m = MaterialLibrary::get((std::uint32_t)id);
+        data.insert(data.end(), m.ambient, m.ambient + 4);
+        data.insert(data.end(), m.diffuse, m.diffuse + 4);
+        data.insert(data.end(), m.specular, m.specular + 4);
+        data.insert(data.end(), m.emission, m.emission + 4);
+        data.insert(data.end(), { m.shininess, 0.0f, 0.0f, 0.0f });
+    }
+
+    GLExt::BindBuffer(GL_SHADER_STORAGE_BUFFER, materialBuffer);
+    GLExt::BufferData(GL_SHADER_STORAGE_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+    GLExt::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+std::size_t IndirectScene::triangleCount() const {
+    std::size_t total = 0;
+    for (const ObjectData& o : objects) total += meshTriangles[o.mesh];
+    return total;
+}
+
+bool IndirectScene::begin() {
+    const RenderContext& ctx = renderContext();
+    collecting = false;
+    if (objects.empty() || state != 1 || !renderSettings().indirectEnabled) return false;
+    if (ctx.pass == RenderPass::Shadow || ctx.pass == RenderPass::Bake || !glIsEnabled(GL_LIGHTING)) return false;
+
+    groupHidden.assign(groupParent.size(), 0);
+    collecting = true;
+    return true;
+}
+
+void IndirectScene::hide(const Container* container) {
+    if (!collecting) return;
+    auto it = groupOf.find(container);
+    if (it != groupOf.end()) groupHidden[it->second] = 1;
+}
+
+void IndirectScene::draw() {
+    if (!collecting) return;
+    collecting = false;
+    const RenderContext& ctx = renderContext();
+
+    // Groups are numbered parents first, so one pass hides every nested group too
+    std::vector<GLuint> visible(groupParent.size(), 1u);
+    for (std::size_t g = 1; g < visible.size(); ++g) {
+        visible[g] = !groupHidden[g] && visible[groupParent[g]] ? 1u : 0u;
+    }
+    GLExt::BindBuffer(GL_SHADER_STORAGE_BUFFER, groupBuffer);
+    GLExt::BufferData(GL_SHADER_STORAGE_BUFFER, visible.size() * sizeof(GLuint), visible.data(), GL_STREAM_DRAW);
+    GLExt::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // The quality governor changes cylinder tessellation; only the shared meshes are rebuilt
+    if (std::max(3, renderSettings().tessellation) != builtTessellation) uploadMeshes();
+
+    // 1. Cull: the pass's frustum, or the one of the current matrices
+    Frustum frustum = ctx.cull ? *ctx.cull : viewFrustum();
+    const std::vector<PlaneEq>& planes = frustum.getPlanes();
+    int planeCount = std::min((int)planes.size(), MAX_PLANES);
+
+    GLExt::UseProgram(cullProgram);
+    if (planeCount > 0) GLExt::Uniform4fv(GLExt::GetUniformLocation(cullProgram, "planes"), planeCount, &planes[0].a);
+    GLExt::Uniform1i(GLExt::GetUniformLocation(cullProgram, "planeCount"), planeCount);
+    GLExt::Uniform1i(GLExt::GetUniformLocation(cullProgram, "objectCount"), (GLint)objects.size());
+    GLExt::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, objectBuffer);
+    GLExt::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+    GLExt::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, meshBuffer);
+    GLExt::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, groupBuffer);
+    GLExt::DispatchCompute((GLuint)((objects.size() + 63) / 64), 1, 1);
+    GLExt::MemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+    // 2. Draw every command in one call
+    GLfloat lightEnabled[8];
+    for (int i = 0; i < 8; ++i) lightEnabled[i] = glIsEnabled(GL_LIGHT0 + i) ? 1.0f : 0.0f;
+
+    GLExt::UseProgram(drawProgram);
+    GLExt::Uniform1fv(GLExt::GetUniformLocation(drawProgram, "lightEnabled"), 8, lightEnabled);
+    GLExt::Uniform1f(GLExt::GetUniformLocation(drawProgram, "fog"), glIsEnabled(GL_FOG) ? 1.0f : 0.0f);
+    GLExt::BindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, materialBuffer);
+    if (!ctx.keepBlend) glDisable(GL_BLEND);
+
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    GLExt::VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), nullptr);
+    GLExt::VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (const void*)(3 * sizeof(float)));
+    GLExt::EnableVertexAttribArray(0);
+    GLExt::EnableVertexAttribArray(1);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    GLExt::VertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
+    GLExt::EnableVertexAttribArray(2);
+    GLExt::VertexAttribDivisor(2, 1);
+
+    GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    GLExt::BindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    GLExt::MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)objects.size(), 0);
+
+    GLExt::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    GLExt::VertexAttribDivisor(2, 0);
+    GLExt::DisableVertexAttribArray(0);
+    GLExt::DisableVertexAttribArray(1);
+    GLExt::DisableVertexAttribArray(2);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLExt::UseProgram(0);
+}
+
+IndirectScene& indirectScene() {
+    static IndirectScene instance;
+    return instance;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file JobSystem.cpp
+ * @brief Implementation of the worker thread pool.
+ */
+
+#include "JobSystem.h"
+#include <memory>
+
+JobSystem::JobSystem(unsigned count) {
+    if (count == 0) {
+        unsigned hw = std::thread::hardware_concurrency();
+        count = hw > 1 ? hw - 1 : 0;
+    }
+    for (unsigned i = 0; i < count; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void JobSystem::submit(std::function<void()> job) {
+    // Without workers, run inline so jobs still make progress
+    if (workers.empty()) {
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void JobSystem::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return queue.empty() && busy == 0; });
+}
+
+void JobSystem::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // stopping and drained
+            job = std::move(queue.front());
+            queue.pop_front();
+            ++busy;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busy;
+            if (queue.empty() && busy == 0) idle.notify_all();
+        }
+    }
+}
+
+void JobSystem::runParallel(std::size_t count, std::size_t grain, const RangeFn& fn) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+
+    std::size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || workers.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    // Shared chunk counters; helpers and the caller pull chunks until none remain.
+    // Helpers own the state, so one that only starts after the caller returned
+    // finds no chunk left and exits without touching fn.
+    struct Loop {
+        std::atomic<std::size_t> next{ 0 };
+        std::atomic<std::size_t> finished{ 0 };
+        std::size_t count, grain, chunks;
+        const RangeFn* fn;
+        std::mutex doneMutex;
+        std::condition_variable done;
+    };
+    auto loop = std::make_shared<Loop>();
+    loop->count = count;
+    loop->grain = grain;
+    loop->chunks = chunks;
+    loop->fn = &fn;
+
+    auto drain = [](Loop& l) {
+        for (;;) {
+            std::size_t c = l.next.fetch_add(1);
+            if (c >= l.chunks) break;
+            std::size_t b = c * l.grain;
+            std::size_t e = b + l.grain < l.count ? b + l.grain : l.count;
+            (*l.fn)(b, e);
+            if (l.finished.fetch_add(1) + 1 == l.chunks) {
+                std::lock_guard<std::mutex> lock(l.doneMutex);
+                l.done.notify_one();
+            }
+        }
+    };
+
+    // Ahead of queued fire-and-forget jobs, so the loop does not wait behind them
+    std::size_t helpers = chunks - 1 < workers.size() ? chunks - 1 : workers.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::size_t i = 0; i < helpers; ++i) {
+            queue.push_front([loop, drain]() { drain(*loop); });
+        }
+    }
+    wake.notify_all();
+
+    drain(*loop);
+
+    // Only chunks already claimed by a helper are waited for, not idle helpers
+    std::unique_lock<std::mutex> lock(loop->doneMutex);
+    loop->done.wait(lock, [&] { return loop->finished.load() == chunks; });
+}
+
+JobSystem& jobs() {
+    static JobSystem* instance = new JobSystem();
+    return *instance;
+}
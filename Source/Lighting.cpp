@@ -30,6 +30,7 @@ void PointLight::enable() {
     glEnable(lightId);
     
     // Positional light indicated by w=1.0
+    const Vec3& position = transform().position;
     GLfloat light_position[] = { position.x, position.y, position.z, 1.0f }; 
     
     // Multiply color by intensity
@@ -45,6 +46,11 @@ void PointLight::enable() {
     glLightf(lightId, GL_LINEAR_ATTENUATION, attenuation);
 }
 
+void PointLight::disable() {
+    if (lightId > GL_LIGHT7) return;
+    glDisable(lightId);
+}
+
 void PointLight::drawMesh() {
     // Intentionally empty
 }
@@ -0,0 +1,141 @@
+/**
+ * @file Log.cpp
+ * @brief Implementation of the asynchronous logger.
+ */
+
+#include "Log.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/** @brief The writer wakes at least this often to drain the queue. */
+static const int WRITER_INTERVAL_MS = 20;
+
+/** @brief Length of a rate-limit window. */
+static const long long RATE_WINDOW_MS = 1000;
+
+static const char* LEVEL_NAMES[] = { "debug", "info", "warning", "error" };
+
+Logger::Logger() {
+    for (std::size_t i = 0; i < Capacity; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    writer = std::thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void Logger::write(LogLevel level, LogSite& site, const char* format, ...) {
+    if ((int)level < minLevel.load(std::memory_order_relaxed)) return;
+
+    // Rate limit per call site; the first message of a new window carries the count
+    long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    long long start = site.windowStart.load(std::memory_order_relaxed);
+    if (now - start >= RATE_WINDOW_MS &&
+        site.windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        site.count.store(0, std::memory_order_relaxed);
+    }
+    if (site.count.fetch_add(1, std::memory_order_relaxed) >= BurstPerSecond) {
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Claim a slot: its sequence equals the position while it is free for that lap
+    Slot* slot;
+    std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        slot = &slots[pos % Capacity];
+        std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        std::intptr_t diff = (std::intptr_t)sequence - (std::intptr_t)pos;
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed); // full: the writer is a lap behind
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(slot->text, MessageSize, format, args);
+    va_end(args);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // The writer polls; only errors and a filling ring are worth waking it for
+    bool urgent = level == LogLevel::Error || pos - written.load(std::memory_order_relaxed) >= Capacity / 2;
+    if (urgent && sleeping.load(std::memory_order_relaxed)) wake.notify_one();
+}
+
+void Logger::drain() {
+    std::string out;
+
+    for (;;) {
+        Slot& slot = slots[dequeuePos % Capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break; // not published yet
+
+        out += '[';
+        out += LEVEL_NAMES[(int)slot.level];
+        out += "] ";
+        out += slot.text;
+        if (slot.suppressed > 0) {
+            out += " (" + std::to_string(slot.suppressed) + " similar messages suppressed)";
+        }
+        out += '\n';
+
+        // Free the slot for the producers' next lap
+        slot.sequence.store(dequeuePos + Capacity, std::memory_order_release);
+        ++dequeuePos;
+    }
+
+    std::size_t lost = dropped.load(std::memory_order_relaxed);
+    if (lost != droppedReported) {
+        out += "[warning] log queue full; " + std::to_string(lost - droppedReported) + " messages dropped\n";
+        droppedReported = lost;
+    }
+
+    if (!out.empty()) {
+        std::fwrite(out.data(), 1, out.size(), stderr);
+        std::fflush(stderr);
+    }
+    written.store(dequeuePos, std::memory_order_release);
+}
+
+void Logger::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        bool stop = stopping;
+        lock.unlock();
+        drain();
+        lock.lock();
+        drained.notify_all();
+        if (stop) return;
+
+        sleeping.store(true, std::memory_order_relaxed);
+        wake.wait_for(lock, std::chrono::milliseconds(WRITER_INTERVAL_MS));
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+void Logger::flush() {
+    std::size_t target = enqueuePos.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.notify_one();
+    drained.wait(lock, [&]() { return stopping || written.load(std::memory_order_acquire) >= target; });
+}
+
+Logger& logger() {
+    static Logger instance;
+    return instance;
+}
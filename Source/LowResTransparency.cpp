@@ -0,0 +1,235 @@
+/**
+ * @file LowResTransparency.cpp
+ * @brief Implementation of the reduced-resolution transparent pass.
+ */
+
+#include "LowResTransparency.h"
+#include "GLExtensions.h"
+#include "Log.h"
+#include "RenderSettings.h"
+
+static const char* QUAD_VERTEX = R"(
+#version 120
+varying vec2 uv;
+
+void main() {
+    gl_Position = gl_Vertex;
+    uv = gl_Vertex.xy * 0.5 + 0.5;
+}
+)";
+
+/** @brief Keeps the farthest opaque depth of each block, so glass is not lost at silhouettes. */
+static const char* DOWNSAMPLE_FRAGMENT = R"(
+#version 120
+uniform sampler2D depth;
+uniform vec2 fullSize;
+uniform float factor;
+
+void main() {
+    vec2 origin = floor(gl_FragCoord.xy) * factor;
+    float z = 0.0;
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            if (float(x) >= factor || float(y) >= factor) continue;
+            vec2 p = min(origin + vec2(x, y), fullSize - 1.0) + 0.5;
+            z = max(z, texture2D(depth, p / fullSize).r);
+        }
+    }
+    gl_FragDepth = z;
+}
+)";
+
+/**
+ * @brief Bilinear upsampling where each low-resolution texel is also weighted by
+ * how close its depth is to the full-resolution pixel's depth.
+ */
+static const char* UPSAMPLE_FRAGMENT = R"(
+#version 120
+uniform sampler2D color;
+uniform sampler2D lowDepth;
+uniform sampler2D fullDepth;
+uniform vec2 lowSize;
+uniform float nearPlane;
+uniform float farPlane;
+varying vec2 uv;
+
+float linearDepth(float d) {
+    float z = d * 2.0 - 1.0;
+    return 2.0 * nearPlane * farPlane / (farPlane + nearPlane - z * (farPlane - nearPlane));
+}
+
+void main() {
+    float center = linearDepth(texture2D(fullDepth, uv).r);
+    vec2 pos = uv * lowSize - 0.5;
+    vec2 base = floor(pos);
+    vec2 f = pos - base;
+
+    vec4 sum = vec4(0.0);
+    float total = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        vec2 offset = vec2(float(i - (i / 2) * 2), float(i / 2));
+        vec2 texel = (base + offset + 0.5) / lowSize;
+        vec2 b = mix(1.0 - f, f, offset);
+        float dz = abs(linearDepth(texture2D(lowDepth, texel).r) - center) / center;
+        float w = b.x * b.y / (1e-3 + dz * 50.0);
+        sum += texture2D(color, texel) * w;
+        total += w;
+    }
+    vec4 c = sum / max(total, 1e-6);
+    if (c.a <= 0.0) discard;
+    gl_FragColor = c;
+}
+)";
+
+/** @brief Draws a quad covering the whole viewport (positions are clip coordinates). */
+static void drawFullScreenQuad() {
+    glBegin(GL_QUADS);
+    glVertex2f(-1.0f, -1.0f);
+    glVertex2f(1.0f, -1.0f);
+    glVertex2f(1.0f, 1.0f);
+    glVertex2f(-1.0f, 1.0f);
+    glEnd();
+}
+
+bool LowResTransparency::init() {
+    if (state >= 0) return state == 1;
+    state = 0;
+    if (!GLExt::load()) return false;
+
+    downsampleProgram = GLExt::buildProgram(QUAD_VERTEX, DOWNSAMPLE_FRAGMENT);
+    upsampleProgram = GLExt::buildProgram(QUAD_VERTEX, UPSAMPLE_FRAGMENT);
+    if (!downsampleProgram || !upsampleProgram) return false;
+
+    GLExt::GenFramebuffers(1, &framebuffer);
+    state = 1;
+    return true;
+}
+
+bool LowResTransparency::resize(int w, int h, int f) {
+    if (w == width && h == height && f == factor) return true;
+
+    GLuint textures[3] = { colorTexture, lowDepthTexture, fullDepthTexture };
+    if (colorTexture) glDeleteTextures(3, textures);
+
+    width = w;
+    height = h;
+    factor = f;
+    lowWidth = (w + f - 1) / f;
+    lowHeight = (h + f - 1) / f;
+    colorTexture = GLExt::createTargetTexture(GL_RGBA8, lowWidth, lowHeight, GL_NEAREST);
+    lowDepthTexture = GLExt::createTargetTexture(GL_DEPTH_COMPONENT24, lowWidth, lowHeight, GL_NEAREST);
+    fullDepthTexture = GLExt::createTargetTexture(GL_DEPTH_COMPONENT24, w, h, GL_NEAREST);
+
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, lowDepthTexture, 0);
+    GLenum status = GLExt::CheckFramebufferStatus(GL_FRAMEBUFFER);
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_WARNING("Low-resolution transparency framebuffer incomplete (0x%x); disabled.", status);
+        state = 0;
+        return false;
+    }
+    return true;
+}
+
+bool LowResTransparency::begin(float scale) {
+    if (!init()) return false;
+
+    // Scene may itself be drawn offscreen (dynamic resolution)
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (!resize(viewport[2], viewport[3], scale <= 0.25f ? 4 : 2)) return false;
+
+    // Depth range of the current projection, for linearizing depth in the upsample
+    GLfloat projection[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    nearPlane = projection[14] / (projection[10] - 1.0f);
+    farPlane = projection[14] / (projection[10] + 1.0f);
+
+    // 1. Opaque depth at full resolution
+    glBindTexture(GL_TEXTURE_2D, fullDepthTexture);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, viewport[0], viewport[1], width, height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT | GL_VIEWPORT_BIT);
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, lowWidth, lowHeight);
+
+    // 2. Downsampled into the low-resolution depth buffer
+    glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_ALWAYS);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_FOG);
+    glDisable(GL_BLEND);
+    glDisable(GL_CULL_FACE);
+
+    glBindTexture(GL_TEXTURE_2D, fullDepthTexture);
+    GLExt::UseProgram(downsampleProgram);
+    GLExt::Uniform1i(GLExt::GetUniformLocation(downsampleProgram, "depth"), 0);
+    GLExt::Uniform2f(GLExt::GetUniformLocation(downsampleProgram, "fullSize"), (float)width, (float)height);
+    GLExt::Uniform1f(GLExt::GetUniformLocation(downsampleProgram, "factor"), (float)factor);
+    drawFullScreenQuad();
+    GLExt::UseProgram(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPopAttrib();
+
+    // 3. Transparent pass: premultiplied colour, coverage accumulated in alpha
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_BLEND);
+    GLExt::BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    renderContext().keepBlend = true;
+    return true;
+}
+
+void LowResTransparency::end() {
+    renderContext().keepBlend = false;
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glPopAttrib();
+
+    // Depth-aware upsample over the full-resolution frame
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_FOG);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLExt::ActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, fullDepthTexture);
+    GLExt::ActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, lowDepthTexture);
+    GLExt::ActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+
+    GLExt::UseProgram(upsampleProgram);
+    GLExt::Uniform1i(GLExt::GetUniformLocation(upsampleProgram, "color"), 0);
+    GLExt::Uniform1i(GLExt::GetUniformLocation(upsampleProgram, "lowDepth"), 1);
+    GLExt::Uniform1i(GLExt::GetUniformLocation(upsampleProgram, "fullDepth"), 2);
+    GLExt::Uniform2f(GLExt::GetUniformLocation(upsampleProgram, "lowSize"), (float)lowWidth, (float)lowHeight);
+    GLExt::Uniform1f(GLExt::GetUniformLocation(upsampleProgram, "nearPlane"), nearPlane);
+    GLExt::Uniform1f(GLExt::GetUniformLocation(upsampleProgram, "farPlane"), farPlane);
+    drawFullScreenQuad();
+    GLExt::UseProgram(0);
+
+    GLExt::ActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GLExt::ActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GLExt::ActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPopAttrib();
+}
+
+LowResTransparency& lowResTransparency() {
+    static LowResTransparency instance;
+    return instance;
+}
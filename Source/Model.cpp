@@ -1,20 +1,94 @@
 /**
  * @file Model.cpp
- * @brief Implementation of the Model class using Assimp and stb_image.
+ * @brief Implementation of the Model class using Assimp.
  */
 
 #include "Model.h"
+#include "GLExtensions.h"
+#include "Log.h"
+#include "RenderSettings.h"
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+namespace {
 
-Model::Model(const std::string& path) {
+/**
+ * @brief Assimp file system that records every file the importer opens (the
+ * model and sidecars such as .mtl or .bin).
+ */
+class RecordingIOSystem : public Assimp::DefaultIOSystem {
+public:
+    explicit RecordingIOSystem(std::vector<std::string>& opened) : opened(opened) {}
+
+    Assimp::IOStream* Open(const char* file, const char* mode = "rb") override {
+        Assimp::IOStream* stream = DefaultIOSystem::Open(file, mode);
+        if (stream) opened.push_back(file);
+        return stream;
+    }
+
+private:
+    std::vector<std::string>& opened;
+};
+
+} // namespace
+
+/** @brief Resolves a material's texture name against the model directory. */
+static std::filesystem::path texturePath(const std::string& directory, const char* path) {
+    std::filesystem::path texPath(path);
+    return texPath.is_absolute() ? texPath : std::filesystem::path(directory) / texPath;
+}
+
+Model::Model(const std::string& filePath) : path(filePath) {
+    directory = path.substr(0, path.find_last_of('/'));
+
+    // 1. Geometry and materials: the cooked cache while none of its sources changed, else import (and cook)
+    CookedAsset asset;
+    CookStats stats;
+    std::string cookedPath = path + ".cooked";
+
+    if (readCookedAsset(cookedPath, asset, jobs(), &stats)) {
+        LOG_INFO("Cooked %s: %.1f KB (%.0f%% of %.1f KB), decoded in %.2f ms (%.0f MB/s)", cookedPath.c_str(),
+                 stats.cookedBytes / 1024.0, 100.0 * stats.cookedBytes / std::max<std::size_t>(stats.rawBytes, 1),
+                 stats.rawBytes / 1024.0, stats.decodeMs, stats.decodeMBps());
+    } else {
+        if (!import(asset)) return;
+        if (writeCookedAsset(cookedPath, asset, &stats)) {
+            LOG_INFO("Cooked %s: %.1f KB -> %.1f KB (%.0f%%)", path.c_str(), stats.rawBytes / 1024.0,
+                     stats.cookedBytes / 1024.0, 100.0 * stats.cookedBytes / std::max<std::size_t>(stats.rawBytes, 1));
+        } else {
+            LOG_WARNING("Cannot write cooked asset %s", cookedPath.c_str());
+        }
+    }
+
+    // 2. Materials and their textures
+    for (const CookedMaterial& m : asset.materials) {
+        loadedMaterials.push_back(m.material);
+        textures.push_back(m.texture.empty() ? nullptr : loadTextureFromFile(m.texture.c_str(), directory));
+    }
+    meshes = std::move(asset.meshes);
+    loadBuffers();
+
+    // 3. Bounds (used for impostors and LOD decisions)
+    bool first = true;
+    for (const auto& mesh : meshes) {
+        for (std::size_t i = 0; i + 2 < mesh.vertices.size(); i += 3) {
+            Vec3 v = { mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2] };
+            if (first) { bounds.min = bounds.max = v; first = false; continue; }
+            bounds.min = { std::min(bounds.min.x, v.x), std::min(bounds.min.y, v.y), std::min(bounds.min.z, v.z) };
+            bounds.max = { std::max(bounds.max.x, v.x), std::max(bounds.max.y, v.y), std::max(bounds.max.z, v.z) };
+        }
+    }
+}
+
+bool Model::import(CookedAsset& asset) {
     Assimp::Importer importer;
-    
+    std::vector<std::string> opened;
+    importer.SetIOHandler(new RecordingIOSystem(opened)); // owned by the importer
+
     // Load scene with flags for triangulation, smoothing, UV flipping, and pre-transforming vertices
 	const aiScene* scene = importer.ReadFile(path, 
         aiProcess_Triangulate | 
@@ -24,26 +98,35 @@ Model::Model(const std::string& path) {
     );
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        std::cerr << "Assimp Error: " << importer.GetErrorString() << std::endl;
-        return;
+        LOG_ERROR("Assimp: %s (%s)", importer.GetErrorString(), path.c_str());
+        return false;
     }
 
-    directory = path.substr(0, path.find_last_of('/'));
-
-    // 1. Load Materials (Textures + Properties)
-    loadMaterials(scene);
-
-    // 2. Process Geometry
-    processNode(scene->mRootNode, scene);
+    loadMaterials(scene, asset);
+    processNode(scene->mRootNode, scene, asset);
+
+    // Everything the cooked copy depends on (files that cannot be stamped are left out)
+    std::vector<std::string> sources = { path };
+    sources.insert(sources.end(), opened.begin(), opened.end());
+    for (const CookedMaterial& m : asset.materials)
+        if (!m.texture.empty()) sources.push_back(texturePath(directory, m.texture.c_str()).string());
+    std::sort(sources.begin() + 1, sources.end());
+    sources.erase(std::unique(sources.begin() + 1, sources.end()), sources.end());
+    sources.erase(std::remove(sources.begin() + 1, sources.end(), path), sources.end());
+    for (const std::string& file : sources) {
+        CookedSource source;
+        if (stampCookedSource(file, source)) asset.sources.push_back(source);
+    }
+    return true;
 }
 
-void Model::loadMaterials(const aiScene* scene) {
+void Model::loadMaterials(const aiScene* scene, CookedAsset& asset) {
     // Resize the materials vector to match the scene's material count
-    loadedMaterials.resize(scene->mNumMaterials);
+    asset.materials.resize(scene->mNumMaterials);
 
     for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
         aiMaterial* aiMat = scene->mMaterials[i];
-        Material& myMat = loadedMaterials[i]; 
+        Material& myMat = asset.materials[i].material;
 
         // --- Load Material Properties (Colors) ---
         aiColor3D color(0.f, 0.f, 0.f);
@@ -75,74 +158,58 @@ void Model::loadMaterials(const aiScene* scene) {
             myMat.shininess = shininess;
         }
 
-        // --- Load Textures ---
+        // --- Texture (loaded by the constructor, also for cooked assets) ---
         if (aiMat->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
             aiString str;
             aiMat->GetTexture(aiTextureType_DIFFUSE, 0, &str);
-            GLuint textureId = loadTextureFromFile(str.C_Str(), this->directory);
-            textures.push_back(textureId);
-        } else {
-            textures.push_back(0); 
+            asset.materials[i].texture = str.C_Str();
         }
     }
 }
 
-GLuint Model::loadTextureFromFile(const char* path, const std::string& dir) {
-	std::cerr << "Loading texture: " << path << std::endl;
-    std::string filename = std::string(path);
-	
-	std::filesystem::path modelDir(directory);
-	std::filesystem::path texPath(path); 
-
-	// Handle absolute vs relative paths
-	std::filesystem::path fullPath;
-	if (texPath.is_absolute()) {
-		fullPath = texPath;
-	} else {
-		fullPath = modelDir / texPath;
-	}
+std::shared_ptr<StreamedResource> Model::loadTextureFromFile(const char* path, const std::string& dir) {
+	std::filesystem::path fullPath = texturePath(directory, path);
 
-	std::cerr << "Loading texture: " << fullPath << std::endl;
+	LOG_DEBUG("Loading texture %s", fullPath.c_str());
 	
 	if (!std::filesystem::exists(fullPath)) {
-		std::cerr << "Texture missing: " << fullPath << std::endl;
-		return 0;
+		LOG_WARNING("Texture missing: %s", fullPath.c_str());
+		return nullptr;
 	}
 
-    GLuint textureID;
-    glGenTextures(1, &textureID);
+    // Decoded and uploaded by the loader thread; models sharing a file share the texture
+    return resourceLoader().loadTexture(fullPath.string());
+}
 
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(fullPath.c_str(), &width, &height, &nrComponents, 0);
-    
-    if (data) {
-        GLenum format;
-        if (nrComponents == 1) format = GL_RED;
-        else if (nrComponents == 3) format = GL_RGB;
-        else if (nrComponents == 4) format = GL_RGBA;
+void Model::loadBuffers() {
+    if (!GLExt::loadReadback()) return;
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        gluBuild2DMipmaps(GL_TEXTURE_2D, format, width, height, format, GL_UNSIGNED_BYTE, data);
+    for (const auto& mesh : meshes) {
+        MeshBuffers gpu;
+        std::size_t positionBytes = mesh.vertices.size() * sizeof(float);
+        std::size_t normalBytes = mesh.normals.size() * sizeof(float);
+        std::size_t texCoordBytes = mesh.texCoords.size() * sizeof(float);
+        gpu.normalOffset = positionBytes;
+        gpu.texCoordOffset = positionBytes + normalBytes;
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        std::vector<unsigned char> vertexData(positionBytes + normalBytes + texCoordBytes);
+        if (positionBytes) std::memcpy(vertexData.data(), mesh.vertices.data(), positionBytes);
+        if (normalBytes) std::memcpy(vertexData.data() + gpu.normalOffset, mesh.normals.data(), normalBytes);
+        if (texCoordBytes) std::memcpy(vertexData.data() + gpu.texCoordOffset, mesh.texCoords.data(), texCoordBytes);
 
-        stbi_image_free(data);
-    } else {
-        std::cout << "Texture failed to load at path: " << fullPath << std::endl;
-        stbi_image_free(data);
-        return 0;
-    }
+        std::vector<unsigned char> indexData(mesh.indices.size() * sizeof(unsigned int));
+        if (!indexData.empty()) std::memcpy(indexData.data(), mesh.indices.data(), indexData.size());
 
-    return textureID;
+        gpu.vertices = resourceLoader().loadBuffer(GL_ARRAY_BUFFER, std::move(vertexData));
+        gpu.indices = resourceLoader().loadBuffer(GL_ELEMENT_ARRAY_BUFFER, std::move(indexData));
+        buffers.push_back(std::move(gpu));
+    }
 }
 
-void Model::processNode(aiNode* node, const aiScene* scene) {
+void Model::processNode(aiNode* node, const aiScene* scene, CookedAsset& asset) {
     for (unsigned int i = 0; i < node->mNumMeshes; i++) {
         aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        MeshEntry myMesh;
+        MeshStreams myMesh;
         myMesh.materialIndex = mesh->mMaterialIndex;
 
         for (unsigned int j = 0; j < mesh->mNumVertices; j++) {
@@ -170,29 +237,90 @@ void Model::processNode(aiNode* node, const aiScene* scene) {
             for (unsigned int k = 0; k < face.mNumIndices; k++)
                 myMesh.indices.push_back(face.mIndices[k]);
         }
-        meshes.push_back(myMesh);
+        asset.meshes.push_back(std::move(myMesh));
     }
     
     for (unsigned int i = 0; i < node->mNumChildren; i++) {
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, asset);
     }
 }
 
+void Model::bakeImpostor(const ImpostorAtlas::BakeFn& setupLights) {
+    if (meshes.empty()) return;
+
+    const RenderSettings& settings = renderSettings();
+    impostor = ImpostorAtlas::bakeShared(path, bounds, settings.impostorGrid, settings.impostorViewSize,
+                                         setupLights, [this]() { drawMeshes(); });
+}
+
 void Model::drawMesh() {
+    const RenderSettings& settings = renderSettings();
+
+    if (!impostor || !settings.impostorsEnabled || renderContext().pass == RenderPass::Bake) {
+        drawMeshes();
+        return;
+    }
+
+    // The shadow pass reuses the main pass decision (its matrix is a projection);
+    // displays decide for their own camera without disturbing it
+    const RenderContext& ctx = renderContext();
+    float blend = impostorBlend;
+    if (ctx.pass == RenderPass::Main || ctx.pass == RenderPass::Display) {
+        float size = projectedSize(impostor->getCenter(), impostor->getRadius());
+        float fade = std::max(settings.impostorFade, 1e-4f);
+        float t = (settings.impostorScreenSize * settings.lodBias * ctx.lodBias + fade * 0.5f - size) / fade;
+        blend = std::min(1.0f, std::max(0.0f, t));
+        if (ctx.pass == RenderPass::Main) impostorBlend = blend;
+    }
+
+    // Crossfade: the mesh stays underneath until the impostor is fully opaque
+    if (blend < 1.0f) drawMeshes();
+    if (blend > 0.0f) impostor->draw(blend);
+}
+
+void Model::drawMeshes() {
     glEnable(GL_TEXTURE_2D);
 
-    for (auto& mesh : meshes) {
-        
+    for (std::size_t i = 0; i < meshes.size(); ++i) {
+        const MeshStreams& mesh = meshes[i];
+
         // Apply extracted material properties
         if (mesh.materialIndex < loadedMaterials.size()) {
             loadedMaterials[mesh.materialIndex].apply();
         }
 
-        // Apply texture if available
-        if (mesh.materialIndex < textures.size() && textures[mesh.materialIndex] != 0) {
-            glBindTexture(GL_TEXTURE_2D, textures[mesh.materialIndex]);
-        } else {
-            glBindTexture(GL_TEXTURE_2D, 0); 
+        // Apply texture if available (and finished loading)
+        GLuint texture = 0;
+        if (mesh.materialIndex < textures.size() && textures[mesh.materialIndex]) {
+            texture = textures[mesh.materialIndex]->get();
+        }
+        glBindTexture(GL_TEXTURE_2D, texture);
+
+        // Buffer objects once the loader has created them, else straight from memory
+        GLuint vertexBuffer = i < buffers.size() ? buffers[i].vertices->get() : 0;
+        GLuint indexBuffer = i < buffers.size() ? buffers[i].indices->get() : 0;
+        if (vertexBuffer && indexBuffer) {
+            const MeshBuffers& gpu = buffers[i];
+            glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+            GLExt::BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+            GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+            glEnableClientState(GL_VERTEX_ARRAY);
+            glVertexPointer(3, GL_FLOAT, 0, nullptr);
+            if (!mesh.normals.empty()) {
+                glEnableClientState(GL_NORMAL_ARRAY);
+                glNormalPointer(GL_FLOAT, 0, (const void*)gpu.normalOffset);
+            }
+            if (!mesh.texCoords.empty()) {
+                glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+                glTexCoordPointer(2, GL_FLOAT, 0, (const void*)gpu.texCoordOffset);
+            }
+            glDrawElements(GL_TRIANGLES, (GLsizei)mesh.indices.size(), GL_UNSIGNED_INT, nullptr);
+
+            GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+            GLExt::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+            glPopClientAttrib();
+            continue;
         }
 
         glBegin(GL_TRIANGLES);
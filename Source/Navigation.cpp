@@ -0,0 +1,379 @@
+/**
+ * @file Navigation.cpp
+ * @brief Implementation of the navigation mesh baker and the path service.
+ */
+
+#include "Navigation.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+/** @brief Cell class for a cell blocked by solid geometry. */
+static const int CELL_BLOCKED = -2;
+
+/** @brief Cell class for an open floor cell. */
+static const int CELL_FREE = -1;
+
+/** @brief Grid rows merged into regions per job. */
+static const int BAND_ROWS = 16;
+
+/** @brief Cells searched around a point that is not on the mesh. */
+static const int SNAP_CELLS = 2;
+
+/**
+ * @brief Checks if a box (or one of its ancestors) carries a tag.
+ */
+static bool isTaggedBox(const GameObject* obj, Tag t) {
+    for (; obj; obj = obj->getParent()) {
+        if (obj->hasTag(t)) return true;
+    }
+    return false;
+}
+
+// --- NavMesh Implementation ---
+
+Vec3 NavMesh::cellCenter(int x, int z) const {
+    return { originX + (x + 0.5f) * settings.cellSize, 0.0f, originZ + (z + 0.5f) * settings.cellSize };
+}
+
+void NavMesh::bake(const Broadphase& broadphase, const AABB& floor, const NavBakeSettings& bakeSettings, JobSystem& pool) {
+    settings = bakeSettings;
+    originX = floor.min.x;
+    originZ = floor.min.z;
+    width = std::max(1, (int)std::ceil((floor.max.x - floor.min.x) / settings.cellSize));
+    depth = std::max(1, (int)std::ceil((floor.max.z - floor.min.z) / settings.cellSize));
+
+    regions.clear();
+    gates.clear();
+    gateOf.clear();
+
+    // 1. Gates: every door box in the area (serial, so the map is read-only below)
+    if (settings.useGates) {
+        std::vector<CollisionBox*> boxes;
+        AABB all = { { floor.min.x, -1e9f, floor.min.z }, { floor.max.x, 1e9f, floor.max.z } };
+        broadphase.query(all, boxes);
+
+        for (auto* box : boxes) {
+            if (box->isTrigger() || !isTaggedBox(box, settings.gateTag)) continue;
+            gateOf[box] = (int)gates.size();
+            gates.push_back({ box, {}, {}, false });
+        }
+    }
+
+    // 2. Voxelize: classify each cell by what an agent standing there would hit
+    std::vector<int> cellClass(width * depth, CELL_FREE);
+    float h = settings.agentHeight;
+    float r = settings.agentRadius;
+
+    pool.parallelFor(depth, 4, [&](std::size_t zb, std::size_t ze) {
+        std::vector<CollisionBox*> candidates;
+        for (int z = (int)zb; z < (int)ze; ++z) {
+            for (int x = 0; x < width; ++x) {
+                Vec3 c = cellCenter(x, z);
+                broadphase.query(bodyBounds(c.x, h, c.z, r, h), candidates);
+
+                int cls = CELL_FREE;
+                for (auto* box : candidates) {
+                    if (box->isTrigger() || !overlapsBody(box, c.x, h, c.z, r, h)) continue;
+
+                    auto gate = gateOf.find(box);
+                    if (gate == gateOf.end()) { cls = CELL_BLOCKED; break; }
+                    if (cls == CELL_FREE) cls = gate->second;
+                }
+                cellClass[z * width + x] = cls;
+            }
+        }
+    });
+
+    for (int i = 0; i < width * depth; ++i) {
+        if (cellClass[i] >= 0) gates[cellClass[i]].cells.push_back(i);
+    }
+
+    // The middle of each doorway: a door swinging about either end clears it
+    for (auto& g : gates) {
+        AABB b;
+        if (broadphase.getBounds(g.box, b)) {
+            bool alongX = b.max.x - b.min.x >= b.max.z - b.min.z;
+            float mid = alongX ? (b.min.x + b.max.x) / 2.0f : (b.min.z + b.max.z) / 2.0f;
+            float quarter = (alongX ? b.max.x - b.min.x : b.max.z - b.min.z) / 4.0f;
+            for (int i : g.cells) {
+                Vec3 c = cellCenter(i % width, i / width);
+                if (std::fabs((alongX ? c.x : c.z) - mid) <= quarter) g.core.push_back(i);
+            }
+        }
+        if (g.core.empty()) g.core = g.cells;
+    }
+
+    // 3. Regions: greedily merge same-class cells into rectangles, one band of rows per job
+    int bandCount = (depth + BAND_ROWS - 1) / BAND_ROWS;
+    std::vector<std::vector<Region>> bands(bandCount);
+    cellRegion.assign(width * depth, -1);
+
+    pool.parallelFor(bandCount, 1, [&](std::size_t bb, std::size_t be) {
+        for (int band = (int)bb; band < (int)be; ++band) {
+            int zStart = band * BAND_ROWS;
+            int zEnd = std::min(depth, zStart + BAND_ROWS);
+            std::vector<Region>& local = bands[band];
+
+            for (int z = zStart; z < zEnd; ++z) {
+                for (int x = 0; x < width; ++x) {
+                    int cls = cellClass[z * width + x];
+                    if (cls == CELL_BLOCKED || cellRegion[z * width + x] != -1) continue;
+
+                    // Grow right, then down while the whole span still matches
+                    int x1 = x;
+                    while (x1 + 1 < width && cellClass[z * width + x1 + 1] == cls &&
+                           cellRegion[z * width + x1 + 1] == -1) ++x1;
+
+                    int z1 = z;
+                    for (bool grow = true; grow && z1 + 1 < zEnd;) {
+                        for (int sx = x; sx <= x1; ++sx) {
+                            int i = (z1 + 1) * width + sx;
+                            if (cellClass[i] != cls || cellRegion[i] != -1) { grow = false; break; }
+                        }
+                        if (grow) ++z1;
+                    }
+
+                    int id = (int)local.size();
+                    for (int sz = z; sz <= z1; ++sz) {
+                        for (int sx = x; sx <= x1; ++sx) cellRegion[sz * width + sx] = id;
+                    }
+
+                    Vec3 a = cellCenter(x, z), b = cellCenter(x1, z1);
+                    local.push_back({ x, z, x1, z1, cls >= 0 ? cls : -1, { (a.x + b.x) / 2.0f, 0.0f, (a.z + b.z) / 2.0f }, {} });
+                }
+            }
+        }
+    });
+
+    // Band-local ids become global ids
+    std::vector<int> bandOffset(bandCount, 0);
+    for (int band = 0; band < bandCount; ++band) {
+        bandOffset[band] = (int)regions.size();
+        regions.insert(regions.end(), bands[band].begin(), bands[band].end());
+    }
+    pool.parallelFor(bandCount, 1, [&](std::size_t bb, std::size_t be) {
+        for (int band = (int)bb; band < (int)be; ++band) {
+            int zEnd = std::min(depth, (band + 1) * BAND_ROWS);
+            for (int i = band * BAND_ROWS * width; i < zEnd * width; ++i) {
+                if (cellRegion[i] != -1) cellRegion[i] += bandOffset[band];
+            }
+        }
+    });
+
+    buildLinks();
+
+    // Every door starts wherever it was during the bake (usually closed)
+    for (auto& g : gates) g.open = g.cells.empty();
+    ++version;
+}
+
+void NavMesh::buildLinks() {
+    struct Portal { float sumX, sumZ; int count; };
+    std::unordered_map<std::uint64_t, Portal> portals;
+
+    auto touch = [&](int a, int b, float px, float pz) {
+        if (a < 0 || b < 0 || a == b) return;
+        if (a > b) std::swap(a, b);
+        Portal& p = portals[((std::uint64_t)a << 32) | (std::uint32_t)b];
+        p.sumX += px; p.sumZ += pz; ++p.count;
+    };
+
+    float half = settings.cellSize / 2.0f;
+    for (int z = 0; z < depth; ++z) {
+        for (int x = 0; x < width; ++x) {
+            int here = cellRegion[z * width + x];
+            Vec3 c = cellCenter(x, z);
+            if (x + 1 < width) touch(here, cellRegion[z * width + x + 1], c.x + half, c.z);
+            if (z + 1 < depth) touch(here, cellRegion[(z + 1) * width + x], c.x, c.z + half);
+        }
+    }
+
+    for (const auto& entry : portals) {
+        int a = (int)(entry.first >> 32);
+        int b = (int)(entry.first & 0xFFFFFFFFu);
+        Vec3 mid = { entry.second.sumX / entry.second.count, 0.0f, entry.second.sumZ / entry.second.count };
+        regions[a].links.push_back({ b, mid });
+        regions[b].links.push_back({ a, mid });
+    }
+}
+
+bool NavMesh::refreshGates(const Broadphase& broadphase) {
+    bool changed = false;
+    float h = settings.agentHeight;
+    float r = settings.agentRadius;
+
+    for (auto& g : gates) {
+        if (!broadphase.hasMoved(g.box)) continue;
+
+        // Open once the door no longer covers the middle of its doorway
+        bool open = true;
+        for (int i : g.core) {
+            Vec3 c = cellCenter(i % width, i / width);
+            if (overlapsBody(g.box, c.x, h, c.z, r, h)) { open = false; break; }
+        }
+
+        if (open != g.open) {
+            g.open = open;
+            changed = true;
+        }
+    }
+
+    if (changed) ++version;
+    return changed;
+}
+
+int NavMesh::findRegion(float x, float z) const {
+    if (width == 0) return -1;
+    int cx = (int)std::floor((x - originX) / settings.cellSize);
+    int cz = (int)std::floor((z - originZ) / settings.cellSize);
+
+    // Exact cell first, then growing rings around it
+    for (int ring = 0; ring <= SNAP_CELLS; ++ring) {
+        for (int dz = -ring; dz <= ring; ++dz) {
+            for (int dx = -ring; dx <= ring; ++dx) {
+                if (std::max(std::abs(dx), std::abs(dz)) != ring) continue;
+                int sx = cx + dx, sz = cz + dz;
+                if (sx < 0 || sz < 0 || sx >= width || sz >= depth) continue;
+                int region = cellRegion[sz * width + sx];
+                if (region >= 0 && isPassable(region)) return region;
+            }
+        }
+    }
+    return -1;
+}
+
+bool NavMesh::isPassable(int region) const {
+    int gate = regions[region].gate;
+    return gate < 0 || gates[gate].open;
+}
+
+// --- PathService Implementation ---
+
+PathService::PathService(const NavMesh& m, std::size_t cacheCapacity)
+    : mesh(m), capacity(cacheCapacity) {}
+
+bool PathService::search(int from, int to, Vec3 goal, std::vector<int>& corridor) const {
+    // Per-thread scratch reused across searches; stamps avoid clearing per query
+    struct Scratch {
+        std::vector<float> cost;
+        std::vector<int> parent;
+        std::vector<std::uint32_t> stamp;
+        std::uint32_t current = 0;
+    };
+    static thread_local Scratch s;
+
+    const auto& regions = mesh.getRegions();
+    if (s.stamp.size() != regions.size()) {
+        s.cost.assign(regions.size(), 0.0f);
+        s.parent.assign(regions.size(), -1);
+        s.stamp.assign(regions.size(), 0);
+        s.current = 0;
+    }
+    ++s.current;
+
+    auto heuristic = [&](int r) {
+        float dx = regions[r].center.x - goal.x, dz = regions[r].center.z - goal.z;
+        return std::sqrt(dx * dx + dz * dz);
+    };
+
+    using Node = std::pair<float, int>; // (estimated total cost, region)
+    std::priority_queue<Node, std::vector<Node>, std::greater<Node>> open;
+
+    s.stamp[from] = s.current;
+    s.cost[from] = 0.0f;
+    s.parent[from] = -1;
+    open.push({ heuristic(from), from });
+
+    while (!open.empty()) {
+        Node top = open.top();
+        open.pop();
+        int r = top.second;
+
+        if (r == to) {
+            corridor.clear();
+            for (int at = to; at != -1; at = s.parent[at]) corridor.push_back(at);
+            std::reverse(corridor.begin(), corridor.end());
+            return true;
+        }
+        if (top.first > s.cost[r] + heuristic(r) + 1e-4f) continue; // stale entry
+
+        for (const auto& link : regions[r].links) {
+            if (!mesh.isPassable(link.region)) continue;
+
+            // Centre -> portal -> centre, so long thin regions are costed fairly
+            const Vec3& a = regions[r].center;
+            const Vec3& b = regions[link.region].center;
+            float step = std::sqrt((a.x - link.portal.x) * (a.x - link.portal.x) + (a.z - link.portal.z) * (a.z - link.portal.z)) +
+                         std::sqrt((b.x - link.portal.x) * (b.x - link.portal.x) + (b.z - link.portal.z) * (b.z - link.portal.z));
+            float cost = s.cost[r] + step;
+
+            if (s.stamp[link.region] != s.current || cost < s.cost[link.region]) {
+                s.stamp[link.region] = s.current;
+                s.cost[link.region] = cost;
+                s.parent[link.region] = r;
+                open.push({ cost + heuristic(link.region), link.region });
+            }
+        }
+    }
+    return false;
+}
+
+bool PathService::findPath(Vec3 start, Vec3 goal, std::vector<Vec3>& out) {
+    out.clear();
+    int from = mesh.findRegion(start.x, start.z);
+    int to = mesh.findRegion(goal.x, goal.z);
+    if (from < 0 || to < 0) return false;
+
+    std::uint64_t key = ((std::uint64_t)from << 32) | (std::uint32_t)to;
+    std::uint32_t meshVersion = mesh.getVersion();
+    std::vector<int> corridor;
+    bool cached = false;
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (cacheVersion != meshVersion) {
+            cache.clear();
+            cacheVersion = meshVersion;
+        }
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            corridor = it->second;
+            cached = true;
+        }
+    }
+
+    if (cached) {
+        ++hits;
+    } else {
+        ++misses;
+        if (!search(from, to, goal, corridor)) return false;
+
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (cacheVersion == meshVersion) {
+            if (cache.size() >= capacity) cache.clear();
+            cache[key] = corridor;
+        }
+    }
+
+    // Waypoints are the portals between consecutive regions, then the goal itself
+    const auto& regions = mesh.getRegions();
+    for (std::size_t i = 0; i + 1 < corridor.size(); ++i) {
+        for (const auto& link : regions[corridor[i]].links) {
+            if (link.region == corridor[i + 1]) {
+                out.push_back({ link.portal.x, goal.y, link.portal.z });
+                break;
+            }
+        }
+    }
+    out.push_back(goal);
+    return true;
+}
+
+void PathService::solve(std::vector<PathRequest>& requests, JobSystem& pool) {
+    pool.parallelFor(requests.size(), 8, [&](std::size_t b, std::size_t e) {
+        for (std::size_t i = b; i < e; ++i) {
+            requests[i].found = findPath(requests[i].start, requests[i].goal, requests[i].path);
+        }
+    });
+}
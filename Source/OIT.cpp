@@ -0,0 +1,248 @@
+/**
+ * @file OIT.cpp
+ * @brief Implementation of weighted blended order-independent transparency.
+ */
+
+#include "OIT.h"
+#include "GLExtensions.h"
+#include "Log.h"
+#include "RenderSettings.h"
+
+/** @brief Per-vertex emulation of the fixed-function lighting used by the scene. */
+static const char* ACCUM_VERTEX = R"(
+#version 120
+uniform float lightEnabled[8];
+uniform float lighting;
+varying vec4 color;
+varying float eyeDistance;
+
+void main() {
+    vec4 eye = gl_ModelViewMatrix * gl_Vertex;
+    gl_Position = ftransform();
+    gl_ClipVertex = eye;
+    eyeDistance = length(eye.xyz);
+
+    if (lighting < 0.5) {
+        color = gl_Color;
+        return;
+    }
+
+    vec3 n = normalize(gl_NormalMatrix * gl_Normal);
+    vec3 v = normalize(-eye.xyz);
+    vec4 c = gl_FrontMaterial.emission + gl_LightModel.ambient * gl_FrontMaterial.ambient;
+
+    for (int i = 0; i < 8; ++i) {
+        if (lightEnabled[i] < 0.5) continue;
+
+        vec4 lp = gl_LightSource[i].position;
+        vec3 l = normalize(lp.xyz);
+        float attenuation = 1.0;
+        if (lp.w != 0.0) {
+            vec3 d = lp.xyz - eye.xyz;
+            float dist = length(d);
+            l = d / dist;
+            attenuation = 1.0 / (gl_LightSource[i].constantAttenuation +
+                                 gl_LightSource[i].linearAttenuation * dist +
+                                 gl_LightSource[i].quadraticAttenuation * dist * dist);
+        }
+
+        float ndl = max(dot(n, l), 0.0);
+        vec4 term = gl_LightSource[i].ambient * gl_FrontMaterial.ambient +
+                    ndl * gl_LightSource[i].diffuse * gl_FrontMaterial.diffuse;
+        if (ndl > 0.0) {
+            float nh = max(dot(n, normalize(l + v)), 0.0);
+            term += pow(nh, gl_FrontMaterial.shininess) * gl_LightSource[i].specular * gl_FrontMaterial.specular;
+        }
+        c += attenuation * term;
+    }
+    color = vec4(c.rgb, gl_FrontMaterial.diffuse.a);
+}
+)";
+
+/** @brief Writes weighted premultiplied colour and revealage (McGuire & Bavoil 2013, eq. 10). */
+static const char* ACCUM_FRAGMENT = R"(
+#version 120
+uniform float fog;
+varying vec4 color;
+varying float eyeDistance;
+
+void main() {
+    vec3 rgb = color.rgb;
+    if (fog > 0.5) {
+        float f = clamp(exp(-pow(gl_Fog.density * eyeDistance, 2.0)), 0.0, 1.0);
+        rgb = mix(gl_Fog.color.rgb, rgb, f);
+    }
+
+    float a = clamp(color.a, 0.0, 1.0);
+    float z = eyeDistance;
+    float w = a * clamp(10.0 / (1e-5 + pow(z / 5.0, 2.0) + pow(z / 200.0, 6.0)), 1e-2, 3e3);
+
+    gl_FragData[0] = vec4(rgb * w, a);
+    gl_FragData[1] = vec4(w);
+}
+)";
+
+static const char* COMPOSITE_VERTEX = R"(
+#version 120
+varying vec2 uv;
+
+void main() {
+    gl_Position = gl_Vertex;
+    uv = gl_Vertex.xy * 0.5 + 0.5;
+}
+)";
+
+static const char* COMPOSITE_FRAGMENT = R"(
+#version 120
+uniform sampler2D accum;
+uniform sampler2D weights;
+varying vec2 uv;
+
+void main() {
+    vec4 a = texture2D(accum, uv);
+    float revealage = a.a;
+    if (revealage >= 0.999) discard;
+
+    float w = max(texture2D(weights, uv).r, 1e-5);
+    gl_FragColor = vec4(a.rgb / w, 1.0 - revealage);
+}
+)";
+
+bool WeightedOIT::init() {
+    if (state >= 0) return state == 1;
+    state = 0;
+    if (!GLExt::load()) return false;
+
+    accumProgram = GLExt::buildProgram(ACCUM_VERTEX, ACCUM_FRAGMENT);
+    compositeProgram = GLExt::buildProgram(COMPOSITE_VERTEX, COMPOSITE_FRAGMENT);
+    if (!accumProgram || !compositeProgram) return false;
+
+    GLExt::GenFramebuffers(1, &framebuffer);
+    state = 1;
+    return true;
+}
+
+bool WeightedOIT::resize(int w, int h) {
+    if (w == width && h == height) return true;
+
+    GLuint textures[3] = { accumTexture, weightTexture, depthTexture };
+    if (accumTexture) glDeleteTextures(3, textures);
+
+    accumTexture = GLExt::createTargetTexture(GL_RGBA16F, w, h, GL_NEAREST);
+    weightTexture = GLExt::createTargetTexture(GL_RGBA16F, w, h, GL_NEAREST);
+    depthTexture = GLExt::createTargetTexture(GL_DEPTH_COMPONENT24, w, h, GL_NEAREST);
+    width = w;
+    height = h;
+
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumTexture, 0);
+    GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, weightTexture, 0);
+    GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    GLenum status = GLExt::CheckFramebufferStatus(GL_FRAMEBUFFER);
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_WARNING("OIT framebuffer incomplete (0x%x); disabled.", status);
+        state = 0;
+        return false;
+    }
+    return true;
+}
+
+bool WeightedOIT::begin() {
+    if (!init()) return false;
+
+    // Scene may itself be drawn offscreen (dynamic resolution)
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (!resize(viewport[2], viewport[3])) return false;
+
+    // Transparent surfaces are tested against the opaque scene's depth
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, viewport[0], viewport[1], width, height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT | GL_VIEWPORT_BIT);
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+
+    // Revealage starts at 1 (nothing covers the pixel), weights at 0
+    const GLenum attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    GLExt::DrawBuffers(1, &attachments[0]);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    GLExt::DrawBuffers(1, &attachments[1]);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    GLExt::DrawBuffers(2, attachments);
+
+    // One blend function for both targets: colours and weights add up,
+    // alpha multiplies revealage by (1 - a)
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    GLExt::BlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLExt::UseProgram(accumProgram);
+    GLfloat enabled[8];
+    for (int i = 0; i < 8; ++i) enabled[i] = glIsEnabled(GL_LIGHT0 + i) ? 1.0f : 0.0f;
+    GLExt::Uniform1fv(GLExt::GetUniformLocation(accumProgram, "lightEnabled"), 8, enabled);
+    GLExt::Uniform1f(GLExt::GetUniformLocation(accumProgram, "lighting"), glIsEnabled(GL_LIGHTING) ? 1.0f : 0.0f);
+    GLExt::Uniform1f(GLExt::GetUniformLocation(accumProgram, "fog"), glIsEnabled(GL_FOG) ? 1.0f : 0.0f);
+
+    renderContext().oit = true;
+    renderContext().keepBlend = true;
+    return true;
+}
+
+void WeightedOIT::setLighting(bool enabled) {
+    GLExt::Uniform1f(GLExt::GetUniformLocation(accumProgram, "lighting"), enabled ? 1.0f : 0.0f);
+}
+
+void WeightedOIT::end() {
+    renderContext().oit = false;
+    renderContext().keepBlend = false;
+    GLExt::UseProgram(0);
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glPopAttrib();
+
+    // Full-screen resolve over the opaque frame
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_FOG);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLExt::ActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, weightTexture);
+    GLExt::ActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, accumTexture);
+
+    GLExt::UseProgram(compositeProgram);
+    GLExt::Uniform1i(GLExt::GetUniformLocation(compositeProgram, "accum"), 0);
+    GLExt::Uniform1i(GLExt::GetUniformLocation(compositeProgram, "weights"), 1);
+
+    glBegin(GL_QUADS);
+    glVertex2f(-1.0f, -1.0f);
+    glVertex2f(1.0f, -1.0f);
+    glVertex2f(1.0f, 1.0f);
+    glVertex2f(-1.0f, 1.0f);
+    glEnd();
+
+    GLExt::UseProgram(0);
+    GLExt::ActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GLExt::ActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPopAttrib();
+}
+
+WeightedOIT& weightedOIT() {
+    static WeightedOIT instance;
+    return instance;
+}
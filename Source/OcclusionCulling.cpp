@@ -0,0 +1,191 @@
+/**
+ * @file OcclusionCulling.cpp
+ * @brief Implementation of the coherent occlusion culler.
+ */
+
+#include "OcclusionCulling.h"
+#include "Container.h"
+#include "Frustum.h"
+#include "GLExtensions.h"
+#include "RenderSettings.h"
+#include "View.h"
+#include <algorithm>
+
+/** @brief Bounds are grown by this much before checking if the eye is inside (covers the near plane). */
+static const float EYE_MARGIN = 0.5f;
+
+/**
+ * @brief Query boxes are grown by this much so faces lying in the box faces do
+ * not hide their own container.
+ */
+static const float QUERY_MARGIN = 0.01f;
+
+/**
+ * @brief Grows a box by the world bounds of every drawn descendant.
+ * * Collision boxes draw nothing and are left out.
+ */
+static void gatherBounds(const GameObject* obj, AABB& box, bool& any, bool& moving) {
+    if (const Container* c = dynamic_cast<const Container*>(obj)) {
+        for (const GameObject* child : c->getChildren()) gatherBounds(child, box, any, moving);
+        return;
+    }
+    if (dynamic_cast<const CollisionBox*>(obj)) return;
+
+    AABB b = transformBounds(world().worldMatrices.get(obj->getEntity()), obj->getLocalBounds());
+    if (!any) {
+        box = b;
+        any = true;
+    } else {
+        box.min = { std::min(box.min.x, b.min.x), std::min(box.min.y, b.min.y), std::min(box.min.z, b.min.z) };
+        box.max = { std::max(box.max.x, b.max.x), std::max(box.max.y, b.max.y), std::max(box.max.z, b.max.z) };
+    }
+    if (!obj->isStatic()) moving = true;
+}
+
+void OcclusionCuller::beginView() {
+    occluded = 0;
+    queries = 0;
+    active = renderSettings().occlusionCullingEnabled && GLExt::loadAnySamplesQueries();
+    if (!active) return;
+
+    ++frame;
+    deciding = true;
+    queued.clear();
+    eye = localEyePosition();
+}
+
+void OcclusionCuller::poll(Node& n) {
+    if (!n.pending) return;
+
+    // Never wait: an unfinished test keeps the previous answer
+    GLuint available = 0;
+    GLExt::GetQueryObjectuiv(n.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    GLuint anySamples = 0;
+    GLExt::GetQueryObjectuiv(n.query, GL_QUERY_RESULT, &anySamples);
+    n.pending = false;
+    if (n.discard) {
+        n.discard = false;
+        return;
+    }
+
+    n.visible = anySamples != 0;
+    if (n.visible) n.nextTest = frame + (unsigned long)std::max(1, renderSettings().occlusionPersistence) + n.offset;
+}
+
+bool OcclusionCuller::skip(const Container* node) {
+    const RenderContext& ctx = renderContext();
+    if (!active || ctx.pass != RenderPass::Main) return false;
+
+    // Later passes of the view reuse the opaque pass's decision
+    if (!deciding) {
+        auto it = nodes.find(node);
+        return it != nodes.end() && it->second.skippedFrame == frame;
+    }
+
+    auto inserted = nodes.emplace(node, Node());
+    Node& n = inserted.first->second;
+    if (inserted.second) n.offset = (unsigned)(nodes.size() % (unsigned)std::max(1, renderSettings().occlusionPersistence));
+    poll(n);
+
+    // Not visited last frame (hidden parent, out of view): what it showed then is stale
+    if (n.visitedFrame + 1 != frame) {
+        n.visible = true;
+        n.nextTest = 0;
+        n.discard = n.pending;
+    }
+    n.visitedFrame = frame;
+
+    if (!n.boundsValid || n.moving) {
+        bool any = false;
+        n.moving = false;
+        gatherBounds(node, n.bounds, any, n.moving);
+        n.boundsValid = true;
+        if (!any) return false;
+    }
+
+    if (ctx.cull && !ctx.cull->intersects(n.bounds)) {
+        n.skippedFrame = frame;
+        n.visitedFrame = 0;
+        return true;
+    }
+
+    // The eye inside the box: visible, and the box test would be clipped anyway
+    if (eye.x > n.bounds.min.x - EYE_MARGIN && eye.x < n.bounds.max.x + EYE_MARGIN &&
+        eye.y > n.bounds.min.y - EYE_MARGIN && eye.y < n.bounds.max.y + EYE_MARGIN &&
+        eye.z > n.bounds.min.z - EYE_MARGIN && eye.z < n.bounds.max.z + EYE_MARGIN) {
+        n.visible = true;
+        return false;
+    }
+
+    // Hidden nodes are tested every frame, visible ones once their persistence runs out
+    if (!n.pending && (!n.visible || frame >= n.nextTest)) queued.push_back(&n);
+
+    if (!n.visible) {
+        n.skippedFrame = frame;
+        ++occluded;
+        return true;
+    }
+    return false;
+}
+
+void OcclusionCuller::issueQueries() {
+    if (!active || !deciding) return;
+    deciding = false;
+    if (queued.empty()) return;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_FOG);
+    glDisable(GL_BLEND);
+    glDisable(GL_CULL_FACE);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glDepthFunc(GL_LEQUAL);
+
+    for (Node* n : queued) {
+        if (!n->query) GLExt::GenQueries(1, &n->query);
+        const Vec3 lo = { n->bounds.min.x - QUERY_MARGIN, n->bounds.min.y - QUERY_MARGIN, n->bounds.min.z - QUERY_MARGIN };
+        const Vec3 hi = { n->bounds.max.x + QUERY_MARGIN, n->bounds.max.y + QUERY_MARGIN, n->bounds.max.z + QUERY_MARGIN };
+
+        GLExt::BeginQuery(GL_ANY_SAMPLES_PASSED, n->query);
+        glBegin(GL_QUAD_STRIP);
+        glVertex3f(lo.x, lo.y, lo.z); glVertex3f(lo.x, hi.y, lo.z);
+        glVertex3f(hi.x, lo.y, lo.z); glVertex3f(hi.x, hi.y, lo.z);
+        glVertex3f(hi.x, lo.y, hi.z); glVertex3f(hi.x, hi.y, hi.z);
+        glVertex3f(lo.x, lo.y, hi.z); glVertex3f(lo.x, hi.y, hi.z);
+        glVertex3f(lo.x, lo.y, lo.z); glVertex3f(lo.x, hi.y, lo.z);
+        glEnd();
+        glBegin(GL_QUADS);
+        glVertex3f(lo.x, lo.y, lo.z); glVertex3f(hi.x, lo.y, lo.z); glVertex3f(hi.x, lo.y, hi.z); glVertex3f(lo.x, lo.y, hi.z);
+        glVertex3f(lo.x, hi.y, lo.z); glVertex3f(lo.x, hi.y, hi.z); glVertex3f(hi.x, hi.y, hi.z); glVertex3f(hi.x, hi.y, lo.z);
+        glEnd();
+        GLExt::EndQuery(GL_ANY_SAMPLES_PASSED);
+
+        n->pending = true;
+        n->discard = false;
+    }
+    queries = queued.size();
+    queued.clear();
+
+    glPopAttrib();
+}
+
+void OcclusionCuller::endView() {
+    issueQueries();
+    active = false;
+}
+
+void OcclusionCuller::forget(const Container* node) {
+    auto it = nodes.find(node);
+    if (it == nodes.end()) return;
+    if (it->second.query) GLExt::DeleteQueries(1, &it->second.query);
+    nodes.erase(it);
+}
+
+OcclusionCuller& occlusionCuller() {
+    static OcclusionCuller instance;
+    return instance;
+}
@@ -0,0 +1,552 @@
+/**
+ * @file Particles.cpp
+ * @brief Implementation of the particle system.
+ */
+
+#include "Particles.h"
+#include "Frustum.h"
+#include "GLExtensions.h"
+#include "RenderSettings.h"
+#include "View.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARTICLES_SSE 1
+#endif
+
+/** @brief Particles processed (and culled) per job chunk. */
+static const std::size_t PARTICLE_GRAIN = 16384;
+
+/** @brief EXP2 fog leaves less than 1/255 of a colour past density * distance = sqrt(ln 255). */
+static const float FOG_CUTOFF = 2.354f;
+
+/** @brief Quad corner, instanced along the particle centre, size and colour. */
+static const char* PARTICLE_VERTEX = R"(
+#version 120
+attribute vec2 corner;
+attribute vec4 center;
+attribute vec4 color;
+uniform vec3 right;
+uniform vec3 up;
+varying vec2 uv;
+varying vec4 tint;
+varying float eyeDistance;
+
+void main() {
+    vec3 p = center.xyz + (right * corner.x + up * corner.y) * center.w;
+    vec4 eye = gl_ModelViewMatrix * vec4(p, 1.0);
+    gl_Position = gl_ProjectionMatrix * eye;
+    eyeDistance = length(eye.xyz);
+    uv = corner;
+    tint = color;
+}
+)";
+
+/** @brief Soft round sprite; additive glows fade out in fog, alpha particles fade into it. */
+static const char* PARTICLE_FRAGMENT = R"(
+#version 120
+uniform float fog;
+uniform float additive;
+varying vec2 uv;
+varying vec4 tint;
+varying float eyeDistance;
+
+void main() {
+    float r2 = dot(uv, uv);
+    if (r2 >= 1.0) discard;
+    float falloff = (1.0 - r2) * (1.0 - r2);
+
+    vec4 c = vec4(tint.rgb, tint.a * falloff);
+    if (fog > 0.5) {
+        float f = clamp(exp(-pow(gl_Fog.density * eyeDistance, 2.0)), 0.0, 1.0);
+        if (additive > 0.5) c.a *= f;
+        else c.rgb = mix(gl_Fog.color.rgb, c.rgb, f);
+    }
+    gl_FragColor = c;
+}
+)";
+
+int ParticleSystem::addEmitter(const GameObject* owner, const EmitterSettings& settings) {
+    Emitter emitter;
+    emitter.settings = settings;
+    emitter.owner = owner ? owner->getEntity() : NullEntity;
+    emitter.begin = posX.size();
+    emitter.capacity = settings.maxParticles ? settings.maxParticles
+        : (std::size_t)std::ceil(settings.rate * (settings.lifetime + settings.lifetimeJitter)) + 16;
+    emitter.rng = 0x9E3779B9u * (std::uint32_t)(emitters.size() + 1);
+
+    std::size_t total = emitter.begin + emitter.capacity;
+    posX.resize(total); posY.resize(total); posZ.resize(total);
+    velX.resize(total); velY.resize(total); velZ.resize(total);
+    age.resize(total);
+    ageRate.resize(total);
+
+    emitters.push_back(emitter);
+    return (int)emitters.size() - 1;
+}
+
+void ParticleSystem::setEmitting(int emitter, bool emitting) {
+    emitters[emitter].emitting = emitting;
+    if (!emitting) emitters[emitter].pending = 0.0f;
+}
+
+void ParticleSystem::spawn(Emitter& emitter, std::size_t count) {
+    const EmitterSettings& s = emitter.settings;
+
+    WorldMatrix transform = { { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 } };
+    if (emitter.owner != NullEntity) {
+        const WorldMatrix* owner = world().worldMatrices.tryGet(emitter.owner);
+        if (!owner) return; // owner destroyed
+        transform = *owner;
+    }
+    const float* m = transform.m;
+
+    std::uint32_t& seed = emitter.rng;
+    auto next01 = [&seed]() {
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        return (seed & 0xFFFFFF) / float(0x1000000);
+    };
+    auto nextSigned = [&next01]() { return next01() * 2.0f - 1.0f; };
+
+    for (std::size_t n = 0; n < count; ++n) {
+        std::size_t i = emitter.begin + emitter.count++;
+
+        Vec3 local = { s.offset.x + nextSigned() * s.extent.x,
+                       s.offset.y + nextSigned() * s.extent.y,
+                       s.offset.z + nextSigned() * s.extent.z };
+        Vec3 p = transform.transformPoint(local);
+
+        // Jittered direction, rotated into world space and normalized (drops the owner's scale)
+        float dx = s.direction.x + nextSigned() * s.spread;
+        float dy = s.direction.y + nextSigned() * s.spread;
+        float dz = s.direction.z + nextSigned() * s.spread;
+        float wx = m[0] * dx + m[4] * dy + m[8] * dz;
+        float wy = m[1] * dx + m[5] * dy + m[9] * dz;
+        float wz = m[2] * dx + m[6] * dy + m[10] * dz;
+        float length = std::sqrt(wx * wx + wy * wy + wz * wz);
+        float speed = (s.speed + next01() * s.speedJitter) / (length > 1e-6f ? length : 1.0f);
+
+        posX[i] = p.x; posY[i] = p.y; posZ[i] = p.z;
+        velX[i] = wx * speed; velY[i] = wy * speed; velZ[i] = wz * speed;
+        age[i] = 0.0f;
+        ageRate[i] = 1.0f / std::max(1e-3f, s.lifetime + next01() * s.lifetimeJitter);
+    }
+}
+
+void ParticleSystem::retire(Emitter& emitter) {
+    // Swap-remove keeps the live particles packed at the front of the segment
+    std::size_t k = 0;
+    while (k < emitter.count) {
+        std::size_t i = emitter.begin + k;
+        if (age[i] < 1.0f) {
+            ++k;
+            continue;
+        }
+        std::size_t last = emitter.begin + --emitter.count;
+        posX[i] = posX[last]; posY[i] = posY[last]; posZ[i] = posZ[last];
+        velX[i] = velX[last]; velY[i] = velY[last]; velZ[i] = velZ[last];
+        age[i] = age[last];
+        ageRate[i] = ageRate[last];
+    }
+}
+
+void ParticleSystem::buildChunks() {
+    chunks.clear();
+    for (std::size_t e = 0; e < emitters.size(); ++e) {
+        const Emitter& emitter = emitters[e];
+        for (std::size_t b = 0; b < emitter.count; b += PARTICLE_GRAIN) {
+            Chunk chunk;
+            chunk.emitter = (int)e;
+            chunk.begin = emitter.begin + b;
+            chunk.end = emitter.begin + std::min(emitter.count, b + PARTICLE_GRAIN);
+            chunks.push_back(chunk);
+        }
+    }
+}
+
+void ParticleSystem::simulate(Chunk& chunk, float dt) {
+    const EmitterSettings& s = emitters[chunk.emitter].settings;
+    const float damping = std::exp(-s.drag * dt);
+
+    float* px = posX.data(); float* py = posY.data(); float* pz = posZ.data();
+    float* vx = velX.data(); float* vy = velY.data(); float* vz = velZ.data();
+    float* a = age.data();
+    const float* rate = ageRate.data();
+
+    float minX = 1e30f, minY = 1e30f, minZ = 1e30f;
+    float maxX = -1e30f, maxY = -1e30f, maxZ = -1e30f;
+    std::size_t i = chunk.begin;
+
+#ifdef PARTICLES_SSE
+    // Four particles per iteration: v = (v + g dt) damping, p += v dt, age += rate dt
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 damp = _mm_set1_ps(damping);
+    const __m128 gx = _mm_set1_ps(s.gravity.x * dt);
+    const __m128 gy = _mm_set1_ps(s.gravity.y * dt);
+    const __m128 gz = _mm_set1_ps(s.gravity.z * dt);
+    __m128 lo[3] = { _mm_set1_ps(minX), _mm_set1_ps(minY), _mm_set1_ps(minZ) };
+    __m128 hi[3] = { _mm_set1_ps(maxX), _mm_set1_ps(maxY), _mm_set1_ps(maxZ) };
+
+    for (; i + 4 <= chunk.end; i += 4) {
+        __m128 velocityX = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vx + i), gx), damp);
+        __m128 velocityY = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vy + i), gy), damp);
+        __m128 velocityZ = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(vz + i), gz), damp);
+        __m128 positionX = _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(velocityX, step));
+        __m128 positionY = _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(velocityY, step));
+        __m128 positionZ = _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(velocityZ, step));
+
+        _mm_storeu_ps(vx + i, velocityX);
+        _mm_storeu_ps(vy + i, velocityY);
+        _mm_storeu_ps(vz + i, velocityZ);
+        _mm_storeu_ps(px + i, positionX);
+        _mm_storeu_ps(py + i, positionY);
+        _mm_storeu_ps(pz + i, positionZ);
+        _mm_storeu_ps(a + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_mul_ps(_mm_loadu_ps(rate + i), step)));
+
+        lo[0] = _mm_min_ps(lo[0], positionX); hi[0] = _mm_max_ps(hi[0], positionX);
+        lo[1] = _mm_min_ps(lo[1], positionY); hi[1] = _mm_max_ps(hi[1], positionY);
+        lo[2] = _mm_min_ps(lo[2], positionZ); hi[2] = _mm_max_ps(hi[2], positionZ);
+    }
+
+    float lanes[4];
+    float* mins[3] = { &minX, &minY, &minZ };
+    float* maxs[3] = { &maxX, &maxY, &maxZ };
+    for (int axis = 0; axis < 3; ++axis) {
+        _mm_storeu_ps(lanes, lo[axis]);
+        *mins[axis] = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+        _mm_storeu_ps(lanes, hi[axis]);
+        *maxs[axis] = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    }
+#endif
+
+    for (; i < chunk.end; ++i) {
+        vx[i] = (vx[i] + s.gravity.x * dt) * damping;
+        vy[i] = (vy[i] + s.gravity.y * dt) * damping;
+        vz[i] = (vz[i] + s.gravity.z * dt) * damping;
+        px[i] += vx[i] * dt;
+        py[i] += vy[i] * dt;
+        pz[i] += vz[i] * dt;
+        a[i] += rate[i] * dt;
+
+        minX = std::min(minX, px[i]); maxX = std::max(maxX, px[i]);
+        minY = std::min(minY, py[i]); maxY = std::max(maxY, py[i]);
+        minZ = std::min(minZ, pz[i]); maxZ = std::max(maxZ, pz[i]);
+    }
+
+    // Quads reach up to their largest size around the centres
+    float pad = std::max(s.sizeStart, s.sizeEnd);
+    chunk.min = { minX - pad, minY - pad, minZ - pad };
+    chunk.max = { maxX + pad, maxY + pad, maxZ + pad };
+}
+
+void ParticleSystem::step(float dt, JobSystem& pool) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Particles that died last step are retired, then each emitter tops up its segment
+    pool.parallelFor(emitters.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t e = begin; e < end; ++e) {
+            Emitter& emitter = emitters[e];
+            retire(emitter);
+            if (!emitter.emitting) continue;
+
+            emitter.pending += emitter.settings.rate * dt;
+            std::size_t count = (std::size_t)emitter.pending;
+            emitter.pending -= (float)count;
+            spawn(emitter, std::min(count, emitter.capacity - emitter.count));
+        }
+    });
+
+    buildChunks();
+    pool.parallelFor(chunks.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) simulate(chunks[c], dt);
+    });
+
+    liveCount = 0;
+    for (const Emitter& emitter : emitters) liveCount += emitter.count;
+
+    lastStepMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParticleSystem::sortBackToFront(std::size_t first, std::size_t count, const float viewPlane[4]) {
+    if (count < 2) return;
+    for (auto& v : keys) v.resize(count);
+    for (auto& v : order) v.resize(count);
+
+    // Distance along the view direction; non-negative floats sort like their bits,
+    // and inverting them puts the farthest first
+    for (std::size_t i = 0; i < count; ++i) {
+        const Instance& p = batch[first + i];
+        float depth = std::max(0.0f, p.x * viewPlane[0] + p.y * viewPlane[1] + p.z * viewPlane[2] + viewPlane[3]);
+        std::uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        keys[0][i] = ~bits;
+        order[0][i] = (std::uint32_t)i;
+    }
+
+    // LSD radix sort, 11 bits per pass
+    int src = 0;
+    for (int shift = 0; shift < 32; shift += 11) {
+        std::size_t histogram[2048] = {};
+        for (std::size_t i = 0; i < count; ++i) ++histogram[(keys[src][i] >> shift) & 2047];
+        std::size_t sum = 0;
+        for (std::size_t& h : histogram) {
+            std::size_t c = h;
+            h = sum;
+            sum += c;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            std::size_t slot = histogram[(keys[src][i] >> shift) & 2047]++;
+            keys[1 - src][slot] = keys[src][i];
+            order[1 - src][slot] = order[src][i];
+        }
+        src = 1 - src;
+    }
+
+    sorted.resize(count);
+    for (std::size_t i = 0; i < count; ++i) sorted[i] = batch[first + order[src][i]];
+    std::copy(sorted.begin(), sorted.end(), batch.begin() + first);
+}
+
+void ParticleSystem::draw() {
+    drawnCount = 0;
+    if (liveCount == 0 || renderContext().pass != RenderPass::Main) return;
+
+    GLfloat modelview[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    Vec3 eye = localEyePosition();
+    const float right[3] = { modelview[0], modelview[4], modelview[8] };
+    const float up[3] = { modelview[1], modelview[5], modelview[9] };
+    const float forward[3] = { -modelview[2], -modelview[6], -modelview[10] };
+    const float viewPlane[4] = { forward[0], forward[1], forward[2],
+                                 -(forward[0] * eye.x + forward[1] * eye.y + forward[2] * eye.z) };
+
+    // Nothing is visible past the far plane or where the fog has swallowed it
+    float maxDistance = renderSettings().drawDistance;
+    if (glIsEnabled(GL_FOG)) {
+        GLfloat density = 0.0f;
+        glGetFloatv(GL_FOG_DENSITY, &density);
+        if (density > 0.0f) maxDistance = std::min(maxDistance, FOG_CUTOFF / density);
+    }
+    const float maxDistance2 = maxDistance * maxDistance;
+    const Frustum* cull = renderContext().cull;
+
+    // Each chunk writes its visible particles into its own region of the scratch array
+    scratch.resize(posX.size());
+    jobs().parallelFor(chunks.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            Chunk& chunk = chunks[c];
+            chunk.drawn = 0;
+
+            float nx = std::max(chunk.min.x, std::min(eye.x, chunk.max.x)) - eye.x;
+            float ny = std::max(chunk.min.y, std::min(eye.y, chunk.max.y)) - eye.y;
+            float nz = std::max(chunk.min.z, std::min(eye.z, chunk.max.z)) - eye.z;
+            if (nx * nx + ny * ny + nz * nz > maxDistance2) continue;
+            if (cull && !cull->intersects({ chunk.min, chunk.max })) continue;
+
+            const EmitterSettings& s = emitters[chunk.emitter].settings;
+            Instance* out = scratch.data() + chunk.begin;
+            for (std::size_t i = chunk.begin; i < chunk.end; ++i) {
+                float t = age[i];
+                if (t >= 1.0f) continue;
+                float dx = posX[i] - eye.x, dy = posY[i] - eye.y, dz = posZ[i] - eye.z;
+                if (dx * dx + dy * dy + dz * dz > maxDistance2) continue;
+
+                Instance& p = out[chunk.drawn++];
+                p.x = posX[i]; p.y = posY[i]; p.z = posZ[i];
+                p.size = s.sizeStart + (s.sizeEnd - s.sizeStart) * t;
+                for (int k = 0; k < 4; ++k) {
+                    float v = s.colorStart[k] + (s.colorEnd[k] - s.colorStart[k]) * t;
+                    p.color[k] = (std::uint8_t)(std::min(1.0f, std::max(0.0f, v)) * 255.0f + 0.5f);
+                }
+            }
+        }
+    });
+
+    // Gather: additive particles first, then the alpha-blended ones
+    std::vector<std::size_t> offsets(chunks.size());
+    std::size_t additive = 0, total = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        ParticleBlend blend = pass == 0 ? ParticleBlend::Additive : ParticleBlend::Alpha;
+        for (std::size_t c = 0; c < chunks.size(); ++c) {
+            if (emitters[chunks[c].emitter].settings.blend != blend) continue;
+            offsets[c] = total;
+            total += chunks[c].drawn;
+        }
+        if (pass == 0) additive = total;
+    }
+    if (total == 0) return;
+
+    batch.resize(total);
+    jobs().parallelFor(chunks.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t c = begin; c < end; ++c) {
+            const Instance* first = scratch.data() + chunks[c].begin;
+            std::copy(first, first + chunks[c].drawn, batch.begin() + offsets[c]);
+        }
+    });
+    sortBackToFront(additive, total - additive, viewPlane);
+    drawnCount = total;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_FOG_BIT | GL_TEXTURE_BIT);
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glDepthMask(GL_FALSE);
+
+    if (prepareInstancing()) drawInstanced(additive, total - additive, right, up);
+    else drawExpanded(additive, total - additive, right, up);
+
+    glPopClientAttrib();
+    glPopAttrib();
+}
+
+bool ParticleSystem::prepareInstancing() {
+    if (instancingState >= 0) return instancingState == 1;
+    instancingState = 0;
+
+    if (!GLExt::load() || !GLExt::loadInstancing()) return false;
+    program = GLExt::buildProgram(PARTICLE_VERTEX, PARTICLE_FRAGMENT);
+    if (!program) return false;
+
+    // Compatibility contexts only draw when attribute 0 is an enabled array
+    GLExt::BindAttribLocation(program, 0, "corner");
+    GLExt::BindAttribLocation(program, 1, "center");
+    GLExt::BindAttribLocation(program, 2, "color");
+    GLExt::LinkProgram(program);
+    GLint linked = GL_FALSE;
+    GLExt::GetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE) return false;
+
+    static const float corners[8] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+    GLExt::GenBuffers(1, &cornerBuffer);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, cornerBuffer);
+    GLExt::BufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    GLExt::GenBuffers(1, &instanceBuffer);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    instancingState = 1;
+    return true;
+}
+
+void ParticleSystem::drawInstanced(std::size_t additive, std::size_t alpha, const float right[3], const float up[3]) {
+    GLExt::UseProgram(program);
+    GLExt::Uniform3f(GLExt::GetUniformLocation(program, "right"), right[0], right[1], right[2]);
+    GLExt::Uniform3f(GLExt::GetUniformLocation(program, "up"), up[0], up[1], up[2]);
+    GLExt::Uniform1f(GLExt::GetUniformLocation(program, "fog"), glIsEnabled(GL_FOG) ? 1.0f : 0.0f);
+    GLint additiveLocation = GLExt::GetUniformLocation(program, "additive");
+
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, cornerBuffer);
+    GLExt::VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    GLExt::EnableVertexAttribArray(0);
+
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    GLExt::BufferData(GL_ARRAY_BUFFER, batch.size() * sizeof(Instance), batch.data(), GL_STREAM_DRAW);
+    GLExt::EnableVertexAttribArray(1);
+    GLExt::EnableVertexAttribArray(2);
+    GLExt::VertexAttribDivisor(1, 1);
+    GLExt::VertexAttribDivisor(2, 1);
+
+    auto drawRange = [&](std::size_t first, std::size_t count) {
+        const char* base = (const char*)(first * sizeof(Instance));
+        GLExt::VertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), base);
+        GLExt::VertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), base + offsetof(Instance, color));
+        GLExt::DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)count);
+    };
+
+    if (additive) {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        GLExt::Uniform1f(additiveLocation, 1.0f);
+        drawRange(0, additive);
+    }
+    if (alpha) {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GLExt::Uniform1f(additiveLocation, 0.0f);
+        drawRange(additive, alpha);
+    }
+
+    GLExt::VertexAttribDivisor(1, 0);
+    GLExt::VertexAttribDivisor(2, 0);
+    GLExt::DisableVertexAttribArray(0);
+    GLExt::DisableVertexAttribArray(1);
+    GLExt::DisableVertexAttribArray(2);
+    GLExt::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GLExt::UseProgram(0);
+}
+
+void ParticleSystem::drawExpanded(std::size_t additive, std::size_t alpha, const float right[3], const float up[3]) {
+    if (!spriteTexture) {
+        // Soft round sprite matching the shader's falloff
+        const int size = 32;
+        std::vector<std::uint8_t> texels(size * size * 4, 255);
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                float u = (x + 0.5f) / size * 2.0f - 1.0f, v = (y + 0.5f) / size * 2.0f - 1.0f;
+                float falloff = std::max(0.0f, 1.0f - (u * u + v * v));
+                texels[(y * size + x) * 4 + 3] = (std::uint8_t)(falloff * falloff * 255.0f);
+            }
+        }
+        glGenTextures(1, &spriteTexture);
+        glBindTexture(GL_TEXTURE_2D, spriteTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    }
+
+    // Four vertices (x, y, z, u, v) and colours per particle
+    std::size_t total = additive + alpha;
+    quadVertices.resize(total * 20);
+    quadColors.resize(total * 16);
+    jobs().parallelFor(total, PARTICLE_GRAIN, [&](std::size_t begin, std::size_t end) {
+        static const float corners[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+        for (std::size_t i = begin; i < end; ++i) {
+            const Instance& p = batch[i];
+            float* v = quadVertices.data() + i * 20;
+            for (int k = 0; k < 4; ++k, v += 5) {
+                float cx = corners[k][0] * p.size, cy = corners[k][1] * p.size;
+                v[0] = p.x + right[0] * cx + up[0] * cy;
+                v[1] = p.y + right[1] * cx + up[1] * cy;
+                v[2] = p.z + right[2] * cx + up[2] * cy;
+                v[3] = corners[k][0] * 0.5f + 0.5f;
+                v[4] = corners[k][1] * 0.5f + 0.5f;
+                std::memcpy(quadColors.data() + i * 16 + k * 4, p.color, 4);
+            }
+        }
+    });
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, spriteTexture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 5 * sizeof(float), quadVertices.data());
+    glTexCoordPointer(2, GL_FLOAT, 5 * sizeof(float), quadVertices.data() + 3);
+    glColorPointer(4, GL_UNSIGNED_BYTE, 0, quadColors.data());
+
+    if (additive) {
+        // Glows fade to nothing in the fog rather than to the fog colour
+        static const GLfloat black[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        GLfloat fogColor[4];
+        glGetFloatv(GL_FOG_COLOR, fogColor);
+        glFogfv(GL_FOG_COLOR, black);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+        glDrawArrays(GL_QUADS, 0, (GLsizei)(additive * 4));
+        glFogfv(GL_FOG_COLOR, fogColor);
+    }
+    if (alpha) {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDrawArrays(GL_QUADS, (GLint)(additive * 4), (GLsizei)(alpha * 4));
+    }
+}
+
+ParticleSystem& particles() {
+    static ParticleSystem instance;
+    return instance;
+}
@@ -0,0 +1,302 @@
+/**
+ * @file Physics.cpp
+ * @brief Implementation of the broadphase, body overlap test and trigger system.
+ */
+
+#include "Physics.h"
+#include "Container.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// --- Narrowphase ---
+
+bool overlapsBody(const CollisionBox* box, float px, float py, float pz, float radius, float height) {
+    // 1. Transform World Point to Local Space
+    Vec3 localPos = box->getPointInLocalSpace({ px, py, pz });
+
+    // 2. Get Local Bounds
+    const Collider& c = box->getCollider();
+    float hw = c.width / 2.0f;
+    float hh = c.height / 2.0f;
+    float hd = c.depth / 2.0f;
+
+    // 3. Scale Body Dimensions to Local Space
+    Vec3 s = box->getScale();
+    float sx = (std::abs(s.x) > 0.001f) ? (1.0f / s.x) : 1.0f;
+    float sy = (std::abs(s.y) > 0.001f) ? (1.0f / s.y) : 1.0f;
+    float sz = (std::abs(s.z) > 0.001f) ? (1.0f / s.z) : 1.0f;
+
+    float localRadius = radius * std::max(std::abs(sx), std::abs(sz));
+    float localHeight = height * std::abs(sy);
+
+    // 4. Check Overlaps
+    if (localPos.x < (-hw - localRadius) || localPos.x > (hw + localRadius)) return false;
+    if (localPos.z < (-hd - localRadius) || localPos.z > (hd + localRadius)) return false;
+    if ((localPos.y - localHeight) < hh && localPos.y > -hh) return true;
+
+    return false;
+}
+
+AABB bodyBounds(float px, float py, float pz, float radius, float height) {
+    return { { px - radius, py - height, pz - radius }, { px + radius, py, pz + radius } };
+}
+
+// --- Broadphase Implementation ---
+
+Broadphase::Broadphase(float cellSize) : cellSize(cellSize) {}
+
+int Broadphase::cellCoord(float v) const {
+    return (int)std::floor(v / cellSize);
+}
+
+void Broadphase::add(CollisionBox* box) {
+    if (entryOf.count(box)) return;
+
+    Entry e;
+    e.box = box;
+    e.bounds = { { 0, 0, 0 }, { 0, 0, 0 } };
+    e.x0 = e.z0 = 1;
+    e.x1 = e.z1 = 0; // Empty range until the first update()
+    e.moved = true;
+
+    entryOf[box] = (std::uint32_t)entries.size();
+    entries.push_back(e);
+}
+
+void Broadphase::addHierarchy(GameObject* node) {
+    if (CollisionBox* box = dynamic_cast<CollisionBox*>(node)) {
+        add(box);
+    }
+    if (Container* container = dynamic_cast<Container*>(node)) {
+        for (auto* child : container->getChildren()) {
+            addHierarchy(child);
+        }
+    }
+}
+
+void Broadphase::insertCells(std::uint32_t index) {
+    const Entry& e = entries[index];
+    for (int x = e.x0; x <= e.x1; ++x) {
+        for (int z = e.z0; z <= e.z1; ++z) {
+            cells[cellKey(x, z)].push_back(index);
+        }
+    }
+}
+
+void Broadphase::removeCells(std::uint32_t index) {
+    const Entry& e = entries[index];
+    for (int x = e.x0; x <= e.x1; ++x) {
+        for (int z = e.z0; z <= e.z1; ++z) {
+            std::vector<std::uint32_t>& cell = cells[cellKey(x, z)];
+            auto it = std::find(cell.begin(), cell.end(), index);
+            if (it != cell.end()) {
+                *it = cell.back();
+                cell.pop_back();
+            }
+        }
+    }
+}
+
+void Broadphase::update(const Registry& reg) {
+    moved.clear();
+
+    for (std::uint32_t i = 0; i < entries.size(); ++i) {
+        Entry& e = entries[i];
+        const Collider& c = e.box->getCollider();
+        const float* m = reg.worldMatrices.get(e.box->getEntity()).m;
+
+        // World AABB of an oriented box: center plus the absolute projected half extents
+        float hx = c.width / 2.0f, hy = c.height / 2.0f, hz = c.depth / 2.0f;
+        Vec3 center = { m[12], m[13], m[14] };
+        Vec3 ext = {
+            std::abs(m[0]) * hx + std::abs(m[4]) * hy + std::abs(m[8]) * hz,
+            std::abs(m[1]) * hx + std::abs(m[5]) * hy + std::abs(m[9]) * hz,
+            std::abs(m[2]) * hx + std::abs(m[6]) * hy + std::abs(m[10]) * hz
+        };
+        AABB b = { { center.x - ext.x, center.y - ext.y, center.z - ext.z },
+                   { center.x + ext.x, center.y + ext.y, center.z + ext.z } };
+
+        e.moved = std::memcmp(&b, &e.bounds, sizeof(AABB)) != 0;
+        if (!e.moved) continue;
+
+        e.bounds = b;
+        moved.push_back(e.box);
+
+        int x0 = cellCoord(b.min.x), x1 = cellCoord(b.max.x);
+        int z0 = cellCoord(b.min.z), z1 = cellCoord(b.max.z);
+        if (x0 == e.x0 && x1 == e.x1 && z0 == e.z0 && z1 == e.z1) continue;
+
+        removeCells(i);
+        e.x0 = x0; e.x1 = x1; e.z0 = z0; e.z1 = z1;
+        insertCells(i);
+    }
+}
+
+void Broadphase::query(const AABB& bounds, std::vector<CollisionBox*>& out) const {
+    out.clear();
+    // Reused per thread: agents query from the job system every step
+    static thread_local std::vector<std::uint32_t> hits;
+    hits.clear();
+
+    int x0 = cellCoord(bounds.min.x), x1 = cellCoord(bounds.max.x);
+    int z0 = cellCoord(bounds.min.z), z1 = cellCoord(bounds.max.z);
+    for (int x = x0; x <= x1; ++x) {
+        for (int z = z0; z <= z1; ++z) {
+            auto it = cells.find(cellKey(x, z));
+            if (it == cells.end()) continue;
+            for (std::uint32_t idx : it->second) {
+                if (entries[idx].bounds.overlaps(bounds)) hits.push_back(idx);
+            }
+        }
+    }
+
+    // Boxes spanning several cells are found more than once
+    std::sort(hits.begin(), hits.end());
+    hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+    for (std::uint32_t idx : hits) out.push_back(entries[idx].box);
+}
+
+bool Broadphase::isBlocked(float px, float py, float pz, float radius, float height) const {
+    static thread_local std::vector<CollisionBox*> candidates;
+    query(bodyBounds(px, py, pz, radius, height), candidates);
+
+    for (auto* box : candidates) {
+        if (!box->isTrigger() && overlapsBody(box, px, py, pz, radius, height)) return true;
+    }
+    return false;
+}
+
+bool Broadphase::getBounds(const CollisionBox* box, AABB& out) const {
+    auto it = entryOf.find(box);
+    if (it == entryOf.end()) return false;
+    out = entries[it->second].bounds;
+    return true;
+}
+
+bool Broadphase::hasMoved(const CollisionBox* box) const {
+    auto it = entryOf.find(box);
+    return it != entryOf.end() && entries[it->second].moved;
+}
+
+// --- Character Controller ---
+
+bool stepCharacter(const Broadphase& broadphase, const CharacterBody& body,
+                   float moveX, float moveZ, float dt,
+                   float& x, float& y, float& z, float& velocityY) {
+    // 1. Gravity
+    velocityY -= body.gravity * dt;
+
+    // Apply Vertical Movement
+    y += velocityY * dt;
+
+    // Ground Check
+    if (y < body.height) {
+        y = body.height;
+        velocityY = 0.0f;
+    }
+
+    // Vertical Collision with Boxes (landing on top or hitting the head)
+    if (broadphase.isBlocked(x, y, z, body.radius, body.height)) {
+        y -= velocityY * dt;
+        velocityY = 0.0f;
+    }
+
+    // 2. Horizontal Movement, one axis at a time
+    bool free = true;
+
+    if (moveX != 0.0f) {
+        float nextX = x + moveX;
+        if (!broadphase.isBlocked(nextX, y, z, body.radius, body.height)) x = nextX;
+        else free = false;
+    }
+
+    if (moveZ != 0.0f) {
+        float nextZ = z + moveZ;
+        if (!broadphase.isBlocked(x, y, nextZ, body.radius, body.height)) z = nextZ;
+        else free = false;
+    }
+
+    return free;
+}
+
+// --- TriggerSystem Implementation ---
+
+void TriggerSystem::addTrigger(CollisionBox* box, TriggerCallback callback) {
+    box->setTrigger(true);
+    triggers[box].callback = callback;
+}
+
+void TriggerSystem::setAgent(int agent, Vec3 position, float radius, float height) {
+    if (agent >= (int)agents.size()) agents.resize(agent + 1);
+    Agent& a = agents[agent];
+
+    a.moved = !a.active ||
+              a.position.x != position.x || a.position.y != position.y || a.position.z != position.z ||
+              a.radius != radius || a.height != height;
+    a.position = position;
+    a.radius = radius;
+    a.height = height;
+    a.active = true;
+}
+
+void TriggerSystem::removeAgent(int agent) {
+    if (agent < (int)agents.size()) agents[agent].active = false;
+}
+
+void TriggerSystem::update(const Broadphase& broadphase) {
+    pending.clear();
+
+    for (int id = 0; id < (int)agents.size(); ++id) {
+        Agent& a = agents[id];
+        std::vector<CollisionBox*> now;
+
+        auto overlaps = [&](CollisionBox* t) {
+            return overlapsBody(t, a.position.x, a.position.y, a.position.z, a.radius, a.height);
+        };
+
+        if (a.active && a.moved) {
+            // Full query around the agent
+            broadphase.query(bodyBounds(a.position.x, a.position.y, a.position.z, a.radius, a.height), scratch);
+            for (auto* box : scratch) {
+                if (triggers.count(box) && overlaps(box)) now.push_back(box);
+            }
+        } else if (a.active) {
+            // Stationary agent: keep unmoved triggers, re-test the ones that moved
+            for (auto* box : a.inside) {
+                if (!broadphase.hasMoved(box) || overlaps(box)) now.push_back(box);
+            }
+            for (auto* box : broadphase.getMoved()) {
+                if (triggers.count(box) && overlaps(box)) now.push_back(box);
+            }
+        }
+        std::sort(now.begin(), now.end());
+        now.erase(std::unique(now.begin(), now.end()), now.end());
+
+        // Diff the sorted sets into enter/stay/exit events
+        std::size_t i = 0, j = 0;
+        while (i < a.inside.size() || j < now.size()) {
+            if (j == now.size() || (i < a.inside.size() && a.inside[i] < now[j])) {
+                Trigger& t = triggers[a.inside[i]];
+                pending.push_back({ TriggerEventType::Exit, a.inside[i], id, a.position, --t.occupants });
+                ++i;
+            } else if (i == a.inside.size() || now[j] < a.inside[i]) {
+                Trigger& t = triggers[now[j]];
+                pending.push_back({ TriggerEventType::Enter, now[j], id, a.position, ++t.occupants });
+                ++j;
+            } else {
+                pending.push_back({ TriggerEventType::Stay, now[j], id, a.position, triggers[now[j]].occupants });
+                ++i; ++j;
+            }
+        }
+
+        a.inside.swap(now);
+        a.moved = false;
+    }
+
+    // Dispatch after all pairs are known so callbacks see a consistent state
+    for (const TriggerEvent& ev : pending) {
+        Trigger& t = triggers[ev.trigger];
+        if (t.callback) t.callback(ev);
+    }
+}
@@ -0,0 +1,303 @@
+/**
+ * @file PlanarMirror.cpp
+ * @brief Implementation of the planar mirror reflections.
+ */
+
+#include "PlanarMirror.h"
+#include "GameObject.h"
+#include "RenderSettings.h"
+#include "SceneIndex.h"
+#include "View.h"
+#include <algorithm>
+#include <cmath>
+
+/** @brief The clip plane sits this far in front of the surface so the pane never reflects itself. */
+static const float CLIP_OFFSET = 0.01f;
+
+/** @brief Panes whose planes differ by less than this (normal dot and distance) share a render. */
+static const float COPLANAR_TOLERANCE = 0.01f;
+
+/** @brief Opacity of the reflection drawn over the pane. */
+static const float MIRROR_OPACITY = 0.85f;
+
+/** @brief out = a * b for column-major 4x4 matrices. */
+static void multiply(const float a[16], const float b[16], float out[16]) {
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            float v = 0.0f;
+            for (int k = 0; k < 4; ++k) v += a[k * 4 + r] * b[c * 4 + k];
+            out[c * 4 + r] = v;
+        }
+    }
+}
+
+static float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+static Vec3 add(const Vec3& a, const Vec3& b, float s) { return { a.x + b.x * s, a.y + b.y * s, a.z + b.z * s }; }
+
+void PlanarMirrors::buildGroups(const Vec3& eye, const Frustum& view) {
+    groups.clear();
+    groupOf.clear();
+
+    // Surface points of every pane per group, reduced to one rectangle afterwards
+    std::vector<std::vector<Vec3>> points;
+    std::vector<Vec3> axisU;
+
+    for (GameObject* obj : SceneIndex::findByTag(SceneIndex::tag("mirror"))) {
+        const WorldMatrix& w = world().worldMatrices.get(obj->getEntity());
+        AABB local = obj->getLocalBounds();
+        Vec3 center = w.transformPoint({ (local.min.x + local.max.x) * 0.5f, (local.min.y + local.max.y) * 0.5f,
+                                         (local.min.z + local.max.z) * 0.5f });
+        float extent[3] = { (local.max.x - local.min.x) * 0.5f, (local.max.y - local.min.y) * 0.5f,
+                            (local.max.z - local.min.z) * 0.5f };
+
+        // The thinnest world-space axis is the pane's normal
+        Vec3 axis[3];
+        float length[3], half[3];
+        for (int i = 0; i < 3; ++i) {
+            axis[i] = { w.m[i * 4], w.m[i * 4 + 1], w.m[i * 4 + 2] };
+            length[i] = std::sqrt(dot(axis[i], axis[i]));
+            half[i] = extent[i] * length[i];
+        }
+        int thin = (int)(std::min_element(half, half + 3) - half);
+        if (length[thin] < 1e-6f) continue;
+
+        Vec3 n = { axis[thin].x / length[thin], axis[thin].y / length[thin], axis[thin].z / length[thin] };
+        if (dot(n, { eye.x - center.x, eye.y - center.y, eye.z - center.z }) < 0.0f) n = { -n.x, -n.y, -n.z };
+
+        // The reflecting surface is the face towards the camera
+        Vec3 surface = add(center, n, half[thin]);
+        PlaneEq plane = { n.x, n.y, n.z, -dot(n, surface) };
+        if (plane.distance(eye) < CLIP_OFFSET) continue; // camera on the surface
+
+        std::size_t g = 0;
+        for (; g < groups.size(); ++g) {
+            const PlaneEq& p = groups[g].plane;
+            if (p.a * n.x + p.b * n.y + p.c * n.z > 1.0f - COPLANAR_TOLERANCE &&
+                std::abs(p.d - plane.d) < COPLANAR_TOLERANCE) break;
+        }
+        if (g == groups.size()) {
+            groups.push_back(Group());
+            groups.back().plane = plane;
+            points.emplace_back();
+            int a = (thin + 1) % 3;
+            axisU.push_back({ axis[a].x / length[a], axis[a].y / length[a], axis[a].z / length[a] });
+        }
+
+        Group& group = groups[g];
+        groupOf[obj] = g;
+        group.visible = group.visible || view.intersects(transformBounds(w, local));
+
+        int a = (thin + 1) % 3, b = (thin + 2) % 3;
+        for (int corner = 0; corner < 4; ++corner) {
+            float sa = (corner & 1) ? extent[a] : -extent[a];
+            float sb = (corner & 2) ? extent[b] : -extent[b];
+            points[g].push_back(add(add(surface, axis[a], sa), axis[b], sb));
+        }
+    }
+
+    // One rectangle per group, on the plane, covering every pane
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        const PlaneEq& p = groups[g].plane;
+        Vec3 n = { p.a, p.b, p.c };
+        Vec3 u = axisU[g];
+        u = add(u, n, -dot(u, n));
+        float len = std::sqrt(dot(u, u));
+        u = { u.x / len, u.y / len, u.z / len };
+        Vec3 v = { n.y * u.z - n.z * u.y, n.z * u.x - n.x * u.z, n.x * u.y - n.y * u.x };
+
+        const Vec3 origin = points[g][0];
+        float minU = 0, maxU = 0, minV = 0, maxV = 0;
+        for (const Vec3& q : points[g]) {
+            Vec3 d = { q.x - origin.x, q.y - origin.y, q.z - origin.z };
+            minU = std::min(minU, dot(d, u)); maxU = std::max(maxU, dot(d, u));
+            minV = std::min(minV, dot(d, v)); maxV = std::max(maxV, dot(d, v));
+        }
+
+        // Snap the origin onto the plane so every corner lies exactly on it
+        Vec3 base = add(origin, n, -p.distance(origin));
+        groups[g].corners = {
+            add(add(base, u, minU), v, minV), add(add(base, u, maxU), v, minV),
+            add(add(base, u, maxU), v, maxV), add(add(base, u, minU), v, maxV),
+        };
+    }
+}
+
+void PlanarMirrors::renderGroup(const Group& group, Target& target, const Vec3& eye, const float projection[16],
+                                int width, int height, const RenderFn& renderWorld) {
+    const PlaneEq& p = group.plane;
+
+    // 1. Texture (power of two; the reflection occupies its lower-left corner)
+    int texWidth = 1, texHeight = 1;
+    while (texWidth < width) texWidth *= 2;
+    while (texHeight < height) texHeight *= 2;
+    if (!target.texture) glGenTextures(1, &target.texture);
+    if (target.texWidth != texWidth || target.texHeight != texHeight) {
+        glBindTexture(GL_TEXTURE_2D, target.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, texWidth, texHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        target.texWidth = texWidth;
+        target.texHeight = texHeight;
+    }
+
+    // 2. Only what the mirrored eye sees through the panes is drawn
+    Vec3 mirroredEye = add(eye, { p.a, p.b, p.c }, -2.0f * p.distance(eye));
+    Frustum cull = Frustum::fromPortal(mirroredEye, group.corners);
+
+    // 3. Scissor to the panes' screen rectangle (whole view if a corner is behind the camera)
+    GLdouble mv[16], proj[16];
+    GLint viewport[4] = { 0, 0, width, height };
+    glGetDoublev(GL_MODELVIEW_MATRIX, mv);
+    glGetDoublev(GL_PROJECTION_MATRIX, proj);
+    GLint scissor[4] = { 0, 0, width, height };
+    double x0 = width, y0 = height, x1 = 0, y1 = 0;
+    bool projected = true;
+    for (const Vec3& c : group.corners) {
+        double eyeZ = mv[2] * c.x + mv[6] * c.y + mv[10] * c.z + mv[14];
+        GLdouble wx, wy, wz;
+        if (eyeZ > -0.1 || !gluProject(c.x, c.y, c.z, mv, proj, viewport, &wx, &wy, &wz)) { projected = false; break; }
+        x0 = std::min(x0, wx); y0 = std::min(y0, wy);
+        x1 = std::max(x1, wx); y1 = std::max(y1, wy);
+    }
+    if (projected) {
+        int sx = std::max(0, (int)std::floor(x0)), sy = std::max(0, (int)std::floor(y0));
+        int ex = std::min(width, (int)std::ceil(x1) + 1), ey = std::min(height, (int)std::ceil(y1) + 1);
+        scissor[0] = sx; scissor[1] = sy;
+        scissor[2] = std::max(0, ex - sx); scissor[3] = std::max(0, ey - sy);
+    }
+
+    glViewport(0, 0, width, height);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // 4. View * reflection about the plane, clipped to the camera side of the surface
+    float reflect[16] = {
+        1 - 2 * p.a * p.a,     -2 * p.a * p.b,     -2 * p.a * p.c, 0,
+            -2 * p.a * p.b, 1 - 2 * p.b * p.b,     -2 * p.b * p.c, 0,
+            -2 * p.a * p.c,     -2 * p.b * p.c, 1 - 2 * p.c * p.c, 0,
+            -2 * p.d * p.a,     -2 * p.d * p.b,     -2 * p.d * p.c, 1,
+    };
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glMultMatrixf(reflect);
+
+    GLdouble clip[4] = { p.a, p.b, p.c, p.d - CLIP_OFFSET };
+    glClipPlane(GL_CLIP_PLANE0, clip);
+    glEnable(GL_CLIP_PLANE0);
+    glFrontFace(GL_CW); // the reflection flips the winding
+
+    RenderContext& ctx = renderContext();
+    RenderPass previousPass = ctx.pass;
+    const Frustum* previousCull = ctx.cull;
+    ctx.pass = RenderPass::Reflection;
+    ctx.cull = &cull;
+
+    renderWorld();
+
+    ctx.pass = previousPass;
+    ctx.cull = previousCull;
+
+    glFrontFace(GL_CCW);
+    glDisable(GL_CLIP_PLANE0);
+    glDisable(GL_SCISSOR_TEST);
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // 5. Eye space -> clip space -> [0, 1] -> the used part of the texture
+    float sx = (float)width / texWidth, sy = (float)height / texHeight;
+    float bias[16] = {
+        0.5f * sx, 0, 0, 0,
+        0, 0.5f * sy, 0, 0,
+        0, 0, 0.5f, 0,
+        0.5f * sx, 0.5f * sy, 0.5f, 1,
+    };
+    multiply(bias, projection, target.textureMatrix);
+}
+
+int PlanarMirrors::render(float resolutionScale, const RenderFn& renderWorld) {
+    GLint viewport[4];
+    GLfloat projection[16];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+
+    Vec3 eye = localEyePosition();
+    buildGroups(eye, viewFrustum());
+    if (targets.size() < groups.size()) targets.resize(groups.size());
+
+    float scale = std::min(std::max(resolutionScale, 0.05f), 1.0f);
+    int width = std::max(1, (int)(viewport[2] * scale));
+    int height = std::max(1, (int)(viewport[3] * scale));
+
+    int rendered = 0;
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        if (!groups[g].visible) continue;
+        renderGroup(groups[g], targets[g], eye, projection, width, height, renderWorld);
+        groups[g].rendered = true;
+        ++rendered;
+    }
+
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    return rendered;
+}
+
+bool PlanarMirrors::drawMirror(const GameObject* obj, const MeshFn& drawMesh) const {
+    if (!renderSettings().mirrorsEnabled) return false;
+    auto it = groupOf.find(obj);
+    if (it == groupOf.end() || !groups[it->second].rendered) return false;
+    const Target& target = targets[it->second];
+
+    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT | GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT | GL_TRANSFORM_BIT);
+
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_CUBE_MAP);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+    // Eye-space coordinates: planes specified under an identity modelview
+    static const GLfloat EYE_PLANES[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+    static const GLenum COORDS[4] = { GL_S, GL_T, GL_R, GL_Q };
+    static const GLenum GEN[4] = { GL_TEXTURE_GEN_S, GL_TEXTURE_GEN_T, GL_TEXTURE_GEN_R, GL_TEXTURE_GEN_Q };
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    for (int i = 0; i < 4; ++i) {
+        glTexGeni(COORDS[i], GL_TEXTURE_GEN_MODE, GL_EYE_LINEAR);
+        glTexGenfv(COORDS[i], GL_EYE_PLANE, EYE_PLANES[i]);
+        glEnable(GEN[i]);
+    }
+    glPopMatrix();
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+    glColor4f(1.0f, 1.0f, 1.0f, MIRROR_OPACITY);
+
+    glMatrixMode(GL_TEXTURE);
+    glPushMatrix();
+    glLoadMatrixf(target.textureMatrix);
+    glMatrixMode(GL_MODELVIEW);
+
+    drawMesh();
+
+    glMatrixMode(GL_TEXTURE);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+
+    glPopAttrib();
+    return true;
+}
+
+PlanarMirrors& planarMirrors() {
+    static PlanarMirrors instance;
+    return instance;
+}
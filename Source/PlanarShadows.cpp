@@ -0,0 +1,338 @@
+/**
+ * @file PlanarShadows.cpp
+ * @brief Implementation of the culled and cached planar shadow pass.
+ */
+
+#include "PlanarShadows.h"
+#include "Container.h"
+#include "Frustum.h"
+#include "GameObject.h"
+#include "Log.h"
+#include "RenderSettings.h"
+#include <GL/freeglut.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+/** @brief Half-extent of the orthographic volume used for feedback capture. */
+static const float CAPTURE_EXTENT = 4096.0f;
+
+/** @brief Viewport size used for feedback capture (only scales window coordinates). */
+static const int CAPTURE_VIEWPORT = 1024;
+
+/** @brief Side of the square ground cells the cached triangles are grouped by, in world units. */
+static const float TILE_SIZE = 8.0f;
+
+/** @brief Cached casters whose world matrix draw() compares against the cache each call. */
+static const std::size_t CHECKS_PER_DRAW = 64;
+
+namespace {
+
+/** @brief Calls a function for every leaf under an object that casts a shadow. */
+template <typename Fn>
+void forEachCaster(GameObject* obj, Fn&& fn) {
+    if (Container* c = dynamic_cast<Container*>(obj)) {
+        for (auto* child : c->getChildren()) forEachCaster(child, fn);
+        return;
+    }
+    if (obj->castsShadow && !dynamic_cast<CollisionBox*>(obj)) fn(obj);
+}
+
+/** @brief Multiplies the modelview by the world matrix of a leaf's parent (roots have none). */
+void multParentMatrix(const GameObject* leaf) {
+    if (const GameObject* parent = leaf->getParent()) {
+        glMultMatrixf(world().worldMatrices.get(parent->getEntity()).m);
+    }
+}
+
+/**
+ * @brief Records the flattened triangles of some leaves with feedback mode.
+ * * The modelview must hold the shadow matrix (tilted so the ground faces the
+ * capture); each leaf adds its parent's world matrix and its own transform. Degenerate triangles (faces seen edge-on by the
+ * light) are dropped.
+ * @param out Receives x, y, z per vertex, three vertices per triangle.
+ */
+void captureTriangles(const std::vector<GameObject*>& leaves, std::vector<float>& out) {
+    static const int FLOATS_PER_VERTEX = 3; // GL_3D
+    if (leaves.empty()) return;
+
+    std::vector<GLfloat> buffer(1 << 20);
+    GLint count;
+    for (;;) {
+        glFeedbackBuffer((GLsizei)buffer.size(), GL_3D, buffer.data());
+        glRenderMode(GL_FEEDBACK);
+        for (GameObject* leaf : leaves) {
+            glPushMatrix();
+            multParentMatrix(leaf);
+            leaf->draw();
+            glPopMatrix();
+        }
+        count = glRenderMode(GL_RENDER);
+        if (count >= 0) break;
+        buffer.resize(buffer.size() * 2); // overflowed
+    }
+
+    // Window coordinates back to world space (inverse of the capture ortho, viewport
+    // and the tilt that lays the ground facing the capture)
+    auto push = [&out](const GLfloat* f) {
+        float x = (f[0] / CAPTURE_VIEWPORT * 2.0f - 1.0f) * CAPTURE_EXTENT;
+        float y = (f[1] / CAPTURE_VIEWPORT * 2.0f - 1.0f) * CAPTURE_EXTENT;
+        float z = -(f[2] * 2.0f - 1.0f) * CAPTURE_EXTENT;
+        out.push_back(x);
+        out.push_back(z);
+        out.push_back(-y);
+    };
+
+    for (GLint i = 0; i < count;) {
+        GLfloat token = buffer[i++];
+
+        if (token == GL_POLYGON_TOKEN) {
+            int n = (int)buffer[i++];
+            const GLfloat* first = &buffer[i];
+            // Fan-triangulate the (possibly clipped) polygon
+            for (int k = 1; k + 1 < n; ++k) {
+                const GLfloat* b = first + k * FLOATS_PER_VERTEX;
+                const GLfloat* c = b + FLOATS_PER_VERTEX;
+                float area = (b[0] - first[0]) * (c[1] - first[1]) - (b[1] - first[1]) * (c[0] - first[0]);
+                if (std::fabs(area) < 1e-8f) continue;
+                push(first);
+                push(b);
+                push(c);
+            }
+            i += n * FLOATS_PER_VERTEX;
+        } else if (token == GL_LINE_TOKEN || token == GL_LINE_RESET_TOKEN) {
+            i += 2 * FLOATS_PER_VERTEX;
+        } else if (token == GL_POINT_TOKEN || token == GL_BITMAP_TOKEN ||
+                   token == GL_DRAW_PIXEL_TOKEN || token == GL_COPY_PIXEL_TOKEN) {
+            i += FLOATS_PER_VERTEX;
+        } else if (token == GL_PASS_THROUGH_TOKEN) {
+            i += 1;
+        } else {
+            break; // unknown token, stop parsing rather than misread the rest
+        }
+    }
+}
+
+/** @brief Draws a list of triangles (x, y, z per vertex). */
+void drawTriangles(const std::vector<float>& positions) {
+    if (positions.empty()) return;
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, positions.data());
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(positions.size() / 3));
+    glPopClientAttrib();
+}
+
+} // namespace
+
+void buildShadowMatrix(float fMatrix[16], const float fLightPos[4], const float fPlane[4]) {
+    float dot = fPlane[0] * fLightPos[0] + fPlane[1] * fLightPos[1] +
+                fPlane[2] * fLightPos[2] + fPlane[3] * fLightPos[3];
+
+    fMatrix[0] = dot - fLightPos[0] * fPlane[0];
+    fMatrix[4] = 0.0f - fLightPos[0] * fPlane[1];
+    fMatrix[8] = 0.0f - fLightPos[0] * fPlane[2];
+    fMatrix[12] = 0.0f - fLightPos[0] * fPlane[3];
+
+    fMatrix[1] = 0.0f - fLightPos[1] * fPlane[0];
+    fMatrix[5] = dot - fLightPos[1] * fPlane[1];
+    fMatrix[9] = 0.0f - fLightPos[1] * fPlane[2];
+    fMatrix[13] = 0.0f - fLightPos[1] * fPlane[3];
+
+    fMatrix[2] = 0.0f - fLightPos[2] * fPlane[0];
+    fMatrix[6] = 0.0f - fLightPos[2] * fPlane[1];
+    fMatrix[10] = dot - fLightPos[2] * fPlane[2];
+    fMatrix[14] = 0.0f - fLightPos[2] * fPlane[3];
+
+    fMatrix[3] = 0.0f - fLightPos[3] * fPlane[0];
+    fMatrix[7] = 0.0f - fLightPos[3] * fPlane[1];
+    fMatrix[11] = 0.0f - fLightPos[3] * fPlane[2];
+    fMatrix[15] = dot - fLightPos[3] * fPlane[3];
+}
+
+// --- PlanarShadows Implementation ---
+
+void PlanarShadows::collect(GameObject* obj) {
+    forEachCaster(obj, [this](GameObject* leaf) {
+        if (leaf->isStatic()) {
+            cached.push_back(leaf);
+            snapshots.push_back({ leaf->getEntity(), world().worldMatrices.get(leaf->getEntity()) });
+        } else {
+            moving.push_back(leaf);
+        }
+    });
+}
+
+void PlanarShadows::build(const std::vector<GameObject*>& casters, const float lightPos[4], const float groundPlane[4]) {
+    roots = casters;
+    std::copy(lightPos, lightPos + 4, light);
+    std::copy(groundPlane, groundPlane + 4, plane);
+    buildShadowMatrix(shadowMatrix, light, plane);
+    rebuild();
+}
+
+void PlanarShadows::rebuild() {
+    cached.clear();
+    snapshots.clear();
+    moving.clear();
+    for (GameObject* obj : roots) {
+        if (!obj->isTransparent() && obj->castsShadow) collect(obj);
+    }
+
+    capture();
+    checkCursor = 0;
+    dirty = false;
+}
+
+void PlanarShadows::capture() {
+    tiles.clear();
+    builtTessellation = renderSettings().tessellation;
+    if (cached.empty()) return;
+
+    std::vector<GameObject*> leaves[2];
+    for (GameObject* leaf : cached) leaves[leaf->isTransparent() ? 1 : 0].push_back(leaf);
+
+    std::vector<float> captured[2];
+
+    glPushAttrib(GL_ALL_ATTRIB_BITS);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(-CAPTURE_EXTENT, CAPTURE_EXTENT, -CAPTURE_EXTENT, CAPTURE_EXTENT, -CAPTURE_EXTENT, CAPTURE_EXTENT);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    // Seen from above, so the flattened triangles keep their area in window space
+    glLoadIdentity();
+    glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
+    glMultMatrixf(shadowMatrix);
+
+    glViewport(0, 0, CAPTURE_VIEWPORT, CAPTURE_VIEWPORT);
+    glDepthRange(0.0, 1.0);
+    glDisable(GL_CULL_FACE);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+
+    RenderContext& ctx = renderContext();
+    RenderPass previousPass = ctx.pass;
+    const Frustum* previousCull = ctx.cull;
+    ctx.pass = RenderPass::Bake;
+    ctx.cull = nullptr;
+    captureTriangles(leaves[0], captured[0]);
+    captureTriangles(leaves[1], captured[1]);
+    ctx.pass = previousPass;
+    ctx.cull = previousCull;
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    glPopAttrib();
+
+    // Group by the ground cell under each triangle's centre
+    std::map<std::pair<int, int>, std::size_t> tileOf;
+    for (int pass = 0; pass < 2; ++pass) {
+        const std::vector<float>& tris = captured[pass];
+        for (std::size_t i = 0; i + 8 < tris.size(); i += 9) {
+            float cx = (tris[i] + tris[i + 3] + tris[i + 6]) / 3.0f;
+            float cz = (tris[i + 2] + tris[i + 5] + tris[i + 8]) / 3.0f;
+            std::pair<int, int> key((int)std::floor(cx / TILE_SIZE), (int)std::floor(cz / TILE_SIZE));
+
+            auto it = tileOf.find(key);
+            if (it == tileOf.end()) {
+                it = tileOf.emplace(key, tiles.size()).first;
+                tiles.emplace_back();
+                tiles.back().bounds = { { tris[i], tris[i + 1], tris[i + 2] }, { tris[i], tris[i + 1], tris[i + 2] } };
+            }
+
+            Tile& tile = tiles[it->second];
+            std::vector<float>& dst = pass == 0 ? tile.opaque : tile.transparent;
+            dst.insert(dst.end(), tris.begin() + i, tris.begin() + i + 9);
+            for (std::size_t k = i; k < i + 9; k += 3) {
+                AABB& b = tile.bounds;
+                b.min = { std::min(b.min.x, tris[k]), std::min(b.min.y, tris[k + 1]), std::min(b.min.z, tris[k + 2]) };
+                b.max = { std::max(b.max.x, tris[k]), std::max(b.max.y, tris[k + 1]), std::max(b.max.z, tris[k + 2]) };
+            }
+        }
+    }
+}
+
+bool PlanarShadows::snapshotsMoved() {
+    if (snapshots.empty()) return false;
+
+    std::size_t checks = std::min(CHECKS_PER_DRAW, snapshots.size());
+    for (std::size_t n = 0; n < checks; ++n) {
+        if (checkCursor >= snapshots.size()) checkCursor = 0;
+        const Snapshot& s = snapshots[checkCursor++];
+        const WorldMatrix* w = world().worldMatrices.tryGet(s.entity);
+        if (!w || !std::equal(w->m, w->m + 16, s.matrix.m)) return true;
+    }
+    return false;
+}
+
+AABB PlanarShadows::projectBounds(const AABB& box) const {
+    AABB out = { { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+    const float* m = shadowMatrix;
+    for (int corner = 0; corner < 8; ++corner) {
+        float x = (corner & 1) ? box.max.x : box.min.x;
+        float y = (corner & 2) ? box.max.y : box.min.y;
+        float z = (corner & 4) ? box.max.z : box.min.z;
+        float w = m[3] * x + m[7] * y + m[11] * z + m[15];
+        if (std::fabs(w) < 1e-6f) return { { -1e30f, -1e30f, -1e30f }, { 1e30f, 1e30f, 1e30f } }; // at the light's height
+        Vec3 p = { (m[0] * x + m[4] * y + m[8] * z + m[12]) / w,
+                   (m[1] * x + m[5] * y + m[9] * z + m[13]) / w,
+                   (m[2] * x + m[6] * y + m[10] * z + m[14]) / w };
+        out.min = { std::min(out.min.x, p.x), std::min(out.min.y, p.y), std::min(out.min.z, p.z) };
+        out.max = { std::max(out.max.x, p.x), std::max(out.max.y, p.y), std::max(out.max.z, p.z) };
+    }
+    return out;
+}
+
+void PlanarShadows::draw(const Frustum* view) {
+    if (dirty || builtTessellation != renderSettings().tessellation || snapshotsMoved()) {
+        if (!dirty) LOG_DEBUG("Planar shadows: a cached caster moved, rebuilding");
+        rebuild();
+    }
+
+    // Cached casters: only the tiles whose flattened triangles reach into view
+    for (const Tile& tile : tiles) {
+        if (view && !view->intersects(tile.bounds)) continue;
+        glDisable(GL_BLEND);
+        drawTriangles(tile.opaque);
+        if (!tile.transparent.empty()) {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            drawTriangles(tile.transparent);
+        }
+    }
+
+    // Moving casters: live through the shadow matrix, if their flattened bounds are in view
+    drawnMoving = 0;
+    RenderContext& ctx = renderContext();
+    const Frustum* previousCull = ctx.cull;
+    ctx.cull = nullptr;
+    for (GameObject* leaf : moving) {
+        if (view) {
+            AABB bounds = transformBounds(world().worldMatrices.get(leaf->getEntity()), leaf->getLocalBounds());
+            if (!view->intersects(projectBounds(bounds))) continue;
+        }
+        glPushMatrix();
+        glMultMatrixf(shadowMatrix);
+        multParentMatrix(leaf);
+        leaf->draw();
+        glPopMatrix();
+        ++drawnMoving;
+    }
+    ctx.cull = previousCull;
+}
+
+std::size_t PlanarShadows::cachedTriangles() const {
+    std::size_t floats = 0;
+    for (const Tile& tile : tiles) floats += tile.opaque.size() + tile.transparent.size();
+    return floats / 9;
+}
+
+PlanarShadows& planarShadows() {
+    static PlanarShadows instance;
+    return instance;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file PosterRenderer.cpp
+ * @brief Implementation of the tiled poster renderer.
+ */
+
+#include "PosterRenderer.h"
+#include "GLExtensions.h"
+#include "Log.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+bool PosterRenderer::prepareTarget(int size) {
+    if (!GLExt::load()) return false;
+    if (framebuffer && targetSize == size) return true;
+
+    if (colorTexture) {
+        GLuint textures[2] = { colorTexture, depthTexture };
+        glDeleteTextures(2, textures);
+    }
+    if (!framebuffer) GLExt::GenFramebuffers(1, &framebuffer);
+    colorTexture = GLExt::createTargetTexture(GL_RGBA8, size, size, GL_NEAREST);
+    depthTexture = GLExt::createTargetTexture(GL_DEPTH_COMPONENT24, size, size, GL_NEAREST);
+    targetSize = size;
+
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    GLenum status = GLExt::CheckFramebufferStatus(GL_FRAMEBUFFER);
+    GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_WARNING("Poster framebuffer incomplete (0x%x); using window-sized tiles.", status);
+        targetSize = 0;
+        return false;
+    }
+    return true;
+}
+
+bool PosterRenderer::render(const std::string& path, int width, int height, double fovY, double zNear, double zFar,
+                            const TileFn& drawTile) {
+    if (width <= 0 || height <= 0) return false;
+
+    // The file is laid out up front; tiles are written into it as they finish
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) {
+        LOG_ERROR("Poster: cannot open %s", path.c_str());
+        return false;
+    }
+    std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    file.write(header.data(), (std::streamsize)header.size());
+    const std::streamoff dataStart = (std::streamoff)header.size();
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // Tile size: offscreen up to the GL limits, otherwise the window itself
+    GLint maxViewport[2], maxTexture;
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewport);
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTexture);
+    int tileSize = std::min(maxTileSize, (int)std::min(maxTexture, std::min(maxViewport[0], maxViewport[1])));
+    bool offscreen = prepareTarget(tileSize);
+    int tileWidth = offscreen ? tileSize : viewport[2];
+    int tileHeight = offscreen ? tileSize : viewport[3];
+
+    GLint previousFramebuffer = 0;
+    if (offscreen) {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        GLExt::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+
+    // The whole poster's frustum at the near plane; each tile takes its window of it
+    double top = zNear * std::tan(fovY * M_PI / 360.0);
+    double right = top * width / height;
+
+    int columns = (width + tileWidth - 1) / tileWidth;
+    int rows = (height + tileHeight - 1) / tileHeight;
+    std::vector<unsigned char> pixels((std::size_t)tileWidth * tileHeight * 3);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glMatrixMode(GL_MODELVIEW);
+
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            int x0 = column * tileWidth, y0 = row * tileHeight;
+            int w = std::min(tileWidth, width - x0), h = std::min(tileHeight, height - y0);
+
+            glMatrixMode(GL_PROJECTION);
+            glLoadIdentity();
+            glFrustum(-right + 2.0 * right * x0 / width, -right + 2.0 * right * (x0 + w) / width,
+                      -top + 2.0 * top * y0 / height, -top + 2.0 * top * (y0 + h) / height, zNear, zFar);
+            glMatrixMode(GL_MODELVIEW);
+            glViewport(0, 0, w, h);
+
+            glPushMatrix();
+            drawTile();
+            glPopMatrix();
+
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+            // GL rows are bottom-up, PPM rows top-down
+            for (int r = 0; r < h; ++r) {
+                std::streamoff line = height - 1 - (y0 + r);
+                file.seekp(dataStart + (line * width + x0) * 3);
+                file.write((const char*)pixels.data() + (std::size_t)r * w * 3, (std::streamsize)w * 3);
+            }
+        }
+        LOG_INFO("Poster: %d/%d tiles", (row + 1) * columns, rows * columns);
+    }
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+
+    if (offscreen) GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    if (!file) {
+        LOG_ERROR("Poster: write to %s failed", path.c_str());
+        return false;
+    }
+    LOG_INFO("Poster: %dx%d written to %s", width, height, path.c_str());
+    return true;
+}
+
+PosterRenderer& posterRenderer() {
+    static PosterRenderer instance;
+    return instance;
+}
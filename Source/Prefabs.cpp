@@ -0,0 +1,104 @@
+/**
+ * @file Prefabs.cpp
+ * @brief Implementation of PartBatch and prefab instancing.
+ */
+
+#include "Prefabs.h"
+#include "Container.h"
+#include <algorithm>
+#include <cmath>
+
+/** @brief Unit cube faces: outward normal, then four corners counter-clockwise from outside. */
+static const float CUBE_FACES[6][5][3] = {
+    { { 1, 0, 0 }, { 0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, -0.5f }, { 0.5f, 0.5f, 0.5f }, { 0.5f, -0.5f, 0.5f } },
+    { { -1, 0, 0 }, { -0.5f, -0.5f, 0.5f }, { -0.5f, 0.5f, 0.5f }, { -0.5f, 0.5f, -0.5f }, { -0.5f, -0.5f, -0.5f } },
+    { { 0, 1, 0 }, { -0.5f, 0.5f, 0.5f }, { 0.5f, 0.5f, 0.5f }, { 0.5f, 0.5f, -0.5f }, { -0.5f, 0.5f, -0.5f } },
+    { { 0, -1, 0 }, { -0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, 0.5f }, { -0.5f, -0.5f, 0.5f } },
+    { { 0, 0, 1 }, { -0.5f, -0.5f, 0.5f }, { 0.5f, -0.5f, 0.5f }, { 0.5f, 0.5f, 0.5f }, { -0.5f, 0.5f, 0.5f } },
+    { { 0, 0, -1 }, { 0.5f, -0.5f, -0.5f }, { -0.5f, -0.5f, -0.5f }, { -0.5f, 0.5f, -0.5f }, { 0.5f, 0.5f, -0.5f } },
+};
+
+/** @brief Places a unit cube corner of a part: scale, move, then tilt about the pivot. */
+static Vec3 placeCorner(const Prefab::Part& p, const float corner[3], float c, float s) {
+    float x = p.position[0] + corner[0] * p.scale[0];
+    float y = p.position[1] + corner[1] * p.scale[1];
+    float z = p.position[2] + corner[2] * p.scale[2];
+    return { p.pivot[0] + x, p.pivot[1] + c * y - s * z, p.pivot[2] + s * y + c * z };
+}
+
+PartBatch::PartBatch(const Prefab::Part* parts, std::size_t count, std::uint8_t slot) {
+    auto expanded = std::make_shared<std::vector<float>>();
+    Vec3 lo = { INFINITY, INFINITY, INFINITY };
+    Vec3 hi = { -INFINITY, -INFINITY, -INFINITY };
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const Prefab::Part& p = parts[i];
+        if (p.material != slot) continue;
+
+        float angle = p.pitch * 3.14159265f / 180.0f;
+        float c = std::cos(angle), s = std::sin(angle);
+
+        for (const auto& face : CUBE_FACES) {
+            // Scaling keeps the axis-aligned normals; only the tilt turns them
+            float n[3] = { face[0][0], c * face[0][1] - s * face[0][2], s * face[0][1] + c * face[0][2] };
+
+            for (int v = 1; v <= 4; ++v) {
+                Vec3 w = placeCorner(p, face[v], c, s);
+
+                expanded->insert(expanded->end(), { n[0], n[1], n[2], w.x, w.y, w.z });
+                lo = { std::min(lo.x, w.x), std::min(lo.y, w.y), std::min(lo.z, w.z) };
+                hi = { std::max(hi.x, w.x), std::max(hi.y, w.y), std::max(hi.z, w.z) };
+            }
+        }
+    }
+
+    vertices = expanded;
+    if (!expanded->empty()) bounds = { lo, hi };
+}
+
+void PartBatch::drawMesh() {
+    if (vertices->empty()) return;
+
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glInterleavedArrays(GL_N3F_V3F, 0, vertices->data());
+    glDrawArrays(GL_QUADS, 0, (GLsizei)(vertices->size() / 6));
+    glPopClientAttrib();
+}
+
+Container* Prefab::instantiate(const Part* parts, std::size_t count, const Material* materials, std::size_t materialCount) {
+    Container* group = new Container();
+
+    for (std::size_t slot = 0; slot < materialCount; ++slot) {
+        PartBatch* batch = new PartBatch(parts, count, (std::uint8_t)slot);
+        if (batch->size() == 0) {
+            delete batch;
+            continue;
+        }
+        batch->setMaterial(materials[slot]);
+        batch->castsShadow = !materials[slot].isTransparent();
+        group->addChild(batch);
+    }
+    return group;
+}
+
+AABB Prefab::bounds(const Part* parts, std::size_t count) {
+    Vec3 lo = { INFINITY, INFINITY, INFINITY };
+    Vec3 hi = { -INFINITY, -INFINITY, -INFINITY };
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const Part& p = parts[i];
+        float angle = p.pitch * 3.14159265f / 180.0f;
+        float c = std::cos(angle), s = std::sin(angle);
+
+        for (const auto& face : CUBE_FACES) {
+            for (int v = 1; v <= 4; ++v) {
+                Vec3 w = placeCorner(p, face[v], c, s);
+                lo = { std::min(lo.x, w.x), std::min(lo.y, w.y), std::min(lo.z, w.z) };
+                hi = { std::max(hi.x, w.x), std::max(hi.y, w.y), std::max(hi.z, w.z) };
+            }
+        }
+    }
+
+    if (count == 0) return { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+    return { lo, hi };
+}
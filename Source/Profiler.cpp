@@ -0,0 +1,61 @@
+/**
+ * @file Profiler.cpp
+ * @brief Implementation of the frame profiler.
+ */
+
+#include "Profiler.h"
+#include <cstring>
+
+/** @brief Weight of the newest frame in the moving averages. */
+static const double SMOOTHING = 0.1;
+
+FrameProfiler::Scope::Scope(FrameProfiler& p, const char* s)
+    : profiler(p), section(s), start(std::chrono::steady_clock::now()) {}
+
+FrameProfiler::Scope::~Scope() {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    profiler.addSample(section, elapsed.count());
+}
+
+FrameProfiler::Section& FrameProfiler::find(const char* section) {
+    for (auto& s : sections) {
+        if (s.name == section || std::strcmp(s.name, section) == 0) return s;
+    }
+    sections.push_back({ section, 0.0, 0.0 });
+    return sections.back();
+}
+
+void FrameProfiler::beginFrame() {
+    auto now = std::chrono::steady_clock::now();
+
+    if (started) {
+        std::chrono::duration<double, std::milli> elapsed = now - frameStart;
+        lastFrameMs = elapsed.count();
+        frameMs = (frameCount == 0) ? lastFrameMs : frameMs + (lastFrameMs - frameMs) * SMOOTHING;
+
+        for (auto& s : sections) {
+            s.average = (frameCount == 0) ? s.current : s.average + (s.current - s.average) * SMOOTHING;
+            s.current = 0.0;
+        }
+        ++frameCount;
+    }
+
+    frameStart = now;
+    started = true;
+}
+
+void FrameProfiler::addSample(const char* section, double ms) {
+    find(section).current += ms;
+}
+
+double FrameProfiler::getSectionMs(const char* section) const {
+    for (const auto& s : sections) {
+        if (s.name == section || std::strcmp(s.name, section) == 0) return s.average;
+    }
+    return 0.0;
+}
+
+FrameProfiler& profiler() {
+    static FrameProfiler instance;
+    return instance;
+}
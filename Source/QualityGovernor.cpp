@@ -0,0 +1,68 @@
+/**
+ * @file QualityGovernor.cpp
+ * @brief Implementation of the automatic quality governor.
+ */
+
+#include "QualityGovernor.h"
+#include "Log.h"
+#include <algorithm>
+
+static const QualityTier TIERS[] = {
+    //  name        lights shadows lodBias tess  distance transparency
+    { "Ultra",      4,     true,   1.0f,   20,   200.0f,  1.0f  },
+    { "High",       4,     true,   1.5f,   16,   140.0f,  1.0f  },
+    { "Medium",     3,     true,   2.0f,   12,   100.0f,  0.5f  },
+    { "Low",        2,     false,  3.0f,   8,    70.0f,   0.5f  },
+    { "Minimum",    1,     false,  4.0f,   6,    50.0f,   0.25f },
+};
+
+const QualityTier* QualityGovernor::tiers() { return TIERS; }
+
+int QualityGovernor::tierCount() { return (int)(sizeof(TIERS) / sizeof(TIERS[0])); }
+
+void QualityGovernor::apply(int newTier, RenderSettings& settings) {
+    tier = std::min(std::max(newTier, 0), tierCount() - 1);
+    const QualityTier& t = TIERS[tier];
+    settings.maxPointLights = t.maxPointLights;
+    settings.shadowsEnabled = t.shadows;
+    settings.lodBias = t.lodBias;
+    settings.tessellation = t.tessellation;
+    settings.drawDistance = t.drawDistance;
+    settings.transparencyResolutionScale =
+        std::min(settings.maxTransparencyResolutionScale, t.transparencyResolutionScale);
+}
+
+void QualityGovernor::change(int newTier, double frameMs, double budgetMs, const char* reason) {
+    LOG_INFO("Quality: %s -> %s: %s (%.1f ms, budget %.1f ms)", TIERS[tier].name, TIERS[newTier].name, reason,
+             frameMs, budgetMs);
+    apply(newTier, renderSettings());
+    overBudget = 0.0f;
+    underBudget = 0.0f;
+}
+
+void QualityGovernor::update(float dt, double frameMs, double budgetMs, bool resolutionAtMin, bool resolutionAtMax) {
+    sinceUpgrade += dt;
+    lockIn = std::max(0.0f, lockIn - dt);
+
+    overBudget = (frameMs > budgetMs && resolutionAtMin) ? overBudget + dt : 0.0f;
+    underBudget = (frameMs < budgetMs * UpgradeHeadroom && resolutionAtMax) ? underBudget + dt : 0.0f;
+
+    if (overBudget >= DowngradeDelay && tier + 1 < tierCount()) {
+        // A failed upgrade means the higher tier does not fit: stay here for a while
+        if (sinceUpgrade < Probation) {
+            lockIn = nextLockIn;
+            nextLockIn = std::min(nextLockIn * 2.0f, MaxLockIn);
+            LOG_INFO("Quality: %s not sustainable; locking in %s for %.0f s", TIERS[tier].name,
+                     TIERS[tier + 1].name, lockIn);
+        }
+        change(tier + 1, frameMs, budgetMs, "over budget");
+    } else if (underBudget >= UpgradeDelay && tier > 0 && lockIn <= 0.0f) {
+        sinceUpgrade = 0.0f;
+        change(tier - 1, frameMs, budgetMs, "under budget");
+    }
+}
+
+QualityGovernor& qualityGovernor() {
+    static QualityGovernor instance;
+    return instance;
+}
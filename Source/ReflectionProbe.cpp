@@ -0,0 +1,184 @@
+/**
+ * @file ReflectionProbe.cpp
+ * @brief Implementation of the reflection probes.
+ */
+
+#include "ReflectionProbe.h"
+#include "RenderSettings.h"
+#include <algorithm>
+#include <cmath>
+
+/** @brief Look direction and up vector of each cube face (GL face order +X, -X, +Y, -Y, +Z, -Z). */
+static const float FACE_DIRS[6][6] = {
+    {  1,  0,  0,   0, -1,  0 },
+    { -1,  0,  0,   0, -1,  0 },
+    {  0,  1,  0,   0,  0,  1 },
+    {  0, -1,  0,   0,  0, -1 },
+    {  0,  0,  1,   0, -1,  0 },
+    {  0,  0, -1,   0, -1,  0 },
+};
+
+int ReflectionProbes::add(Vec3 position, float radius) {
+    Probe p;
+    p.position = position;
+    p.radius = radius;
+    probes.push_back(p);
+    return (int)probes.size() - 1;
+}
+
+void ReflectionProbes::markDirty(Vec3 center, float radius) {
+    for (auto& p : probes) {
+        float dx = p.position.x - center.x, dy = p.position.y - center.y, dz = p.position.z - center.z;
+        float reach = p.radius + radius;
+        if (dx * dx + dy * dy + dz * dz > reach * reach) continue;
+        std::fill(std::begin(p.dirty), std::end(p.dirty), true);
+    }
+}
+
+void ReflectionProbes::markAllDirty() {
+    for (auto& p : probes) std::fill(std::begin(p.dirty), std::end(p.dirty), true);
+}
+
+void ReflectionProbes::renderFace(Probe& probe, int face, const RenderFn& renderWorld) {
+    const float* f = FACE_DIRS[face];
+    const Vec3& p = probe.position;
+
+    glViewport(0, 0, probe.resolution, probe.resolution);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluPerspective(90.0, 1.0, 0.1, 200.0);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    gluLookAt(p.x, p.y, p.z, p.x + f[0], p.y + f[1], p.z + f[2], f[3], f[4], f[5]);
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    renderWorld();
+
+    glBindTexture(GL_TEXTURE_CUBE_MAP, probe.texture);
+    glCopyTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, 0, 0, 0, 0, probe.resolution, probe.resolution);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+}
+
+int ReflectionProbes::update(int faceBudget, int resolution, const RenderFn& renderWorld) {
+    if (probes.empty() || faceBudget <= 0) return 0;
+
+    // Faces are copied out of the back buffer, so they cannot exceed the window
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    int limit = std::min(resolution, (int)std::min(viewport[2], viewport[3]));
+    int size = 16;
+    while (size * 2 <= limit) size *= 2;
+
+    for (auto& probe : probes) {
+        if (probe.texture && probe.resolution == size) continue;
+
+        if (!probe.texture) glGenTextures(1, &probe.texture);
+        probe.resolution = size;
+        probe.captured = false;
+        std::fill(std::begin(probe.dirty), std::end(probe.dirty), true);
+
+        glBindTexture(GL_TEXTURE_CUBE_MAP, probe.texture);
+        for (int face = 0; face < 6; ++face) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGB, size, size, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    }
+
+    RenderPass previous = renderContext().pass;
+    renderContext().pass = RenderPass::Reflection;
+
+    // Round-robin over every (probe, face) slot, skipping clean ones
+    int rendered = 0;
+    std::size_t slots = probes.size() * 6;
+    for (std::size_t step = 0; step < slots && rendered < faceBudget; ++step) {
+        std::size_t slot = (cursor + step) % slots;
+        Probe& probe = probes[slot / 6];
+        int face = (int)(slot % 6);
+        if (!probe.dirty[face]) continue;
+
+        renderFace(probe, face, renderWorld);
+        probe.dirty[face] = false;
+        probe.captured = probe.captured || std::none_of(std::begin(probe.dirty), std::end(probe.dirty), [](bool d) { return d; });
+        ++rendered;
+
+        if (rendered == faceBudget) cursor = (slot + 1) % slots;
+    }
+
+    renderContext().pass = previous;
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    return rendered;
+}
+
+void ReflectionProbes::beginView() {
+    // Texgen reflection vectors are in eye space; the texture matrix rotates them
+    // back to world space with the transpose of the view rotation
+    GLfloat mv[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+    for (int c = 0; c < 3; ++c) {
+        for (int r = 0; r < 3; ++r) viewInverse[c * 4 + r] = mv[r * 4 + c];
+    }
+}
+
+void ReflectionProbes::drawReflection(Vec3 worldPosition, float strength, const MeshFn& drawMesh) const {
+    // Nearest probe that has a complete capture
+    const Probe* best = nullptr;
+    float bestDist = 0.0f;
+    for (const auto& p : probes) {
+        if (!p.captured) continue;
+        float dx = p.position.x - worldPosition.x, dy = p.position.y - worldPosition.y, dz = p.position.z - worldPosition.z;
+        float d = dx * dx + dy * dy + dz * dz;
+        if (!best || d < bestDist) { best = &p; bestDist = d; }
+    }
+    if (!best) return;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT | GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT | GL_TRANSFORM_BIT);
+
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glEnable(GL_TEXTURE_CUBE_MAP);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, best->texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+    glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_REFLECTION_MAP);
+    glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_REFLECTION_MAP);
+    glTexGeni(GL_R, GL_TEXTURE_GEN_MODE, GL_REFLECTION_MAP);
+    glEnable(GL_TEXTURE_GEN_S);
+    glEnable(GL_TEXTURE_GEN_T);
+    glEnable(GL_TEXTURE_GEN_R);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+    glColor4f(1.0f, 1.0f, 1.0f, strength);
+
+    glMatrixMode(GL_TEXTURE);
+    glPushMatrix();
+    glLoadMatrixf(viewInverse);
+    glMatrixMode(GL_MODELVIEW);
+
+    drawMesh();
+
+    glMatrixMode(GL_TEXTURE);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+
+    glPopAttrib();
+}
+
+ReflectionProbes& reflectionProbes() {
+    static ReflectionProbes instance;
+    return instance;
+}
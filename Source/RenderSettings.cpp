@@ -0,0 +1,16 @@
+/**
+ * @file RenderSettings.cpp
+ * @brief Storage for the render settings and render context.
+ */
+
+#include "RenderSettings.h"
+
+RenderSettings& renderSettings() {
+    static RenderSettings instance;
+    return instance;
+}
+
+RenderContext& renderContext() {
+    static RenderContext instance;
+    return instance;
+}
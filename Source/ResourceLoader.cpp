@@ -0,0 +1,321 @@
+/**
+ * @file ResourceLoader.cpp
+ * @brief Implementation of the background resource loader.
+ */
+
+#include "ResourceLoader.h"
+#include "GLExtensions.h"
+#include "Log.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#ifdef ENGINE_HAS_GLX
+#include <GL/glx.h>
+#endif
+
+/** @brief How long finish() waits for one fence before checking again. */
+static const GLuint64 FENCE_WAIT_NS = 100000000;
+
+struct ResourceLoader::SharedContext {
+#ifdef ENGINE_HAS_GLX
+    Display* display = nullptr;
+    GLXContext context = nullptr;
+    GLXPbuffer surface = 0;
+#endif
+};
+
+#ifdef ENGINE_HAS_GLX
+/** @brief Swallows X errors while probing for a shared context (the default handler exits). */
+static int ignoreXError(Display*, XErrorEvent*) { return 0; }
+
+/**
+ * @brief Creates a context sharing objects with the current one, and a 1x1 pbuffer to bind it to.
+ * @return Null if there is no current GLX context or either creation fails.
+ */
+ResourceLoader::SharedContext* ResourceLoader::createSharedContext() {
+    Display* display = glXGetCurrentDisplay();
+    GLXContext mainContext = glXGetCurrentContext();
+    if (!display || !mainContext) return nullptr;
+
+    int configId = 0, screen = 0;
+    glXQueryContext(display, mainContext, GLX_FBCONFIG_ID, &configId);
+    glXQueryContext(display, mainContext, GLX_SCREEN, &screen);
+
+    // The window's own config if it can back a pbuffer, else any RGBA pbuffer config
+    const int byId[] = { GLX_FBCONFIG_ID, configId, None };
+    const int pbufferAttribs[] = { GLX_DRAWABLE_TYPE, GLX_PBUFFER_BIT, GLX_RENDER_TYPE, GLX_RGBA_BIT, None };
+    int count = 0;
+    GLXFBConfig* configs = glXChooseFBConfig(display, screen, byId, &count);
+    int drawableTypes = 0;
+    if (configs && count > 0) glXGetFBConfigAttrib(display, configs[0], GLX_DRAWABLE_TYPE, &drawableTypes);
+    if (!(drawableTypes & GLX_PBUFFER_BIT)) {
+        if (configs) XFree(configs);
+        configs = glXChooseFBConfig(display, screen, pbufferAttribs, &count);
+    }
+    if (!configs || count == 0) return nullptr;
+
+    int (*previousHandler)(Display*, XErrorEvent*) = XSetErrorHandler(ignoreXError);
+    GLXContext context = glXCreateNewContext(display, configs[0], GLX_RGBA_TYPE, mainContext, True);
+    const int size[] = { GLX_PBUFFER_WIDTH, 1, GLX_PBUFFER_HEIGHT, 1, None };
+    GLXPbuffer surface = context ? glXCreatePbuffer(display, configs[0], size) : 0;
+    XSync(display, False);
+    XSetErrorHandler(previousHandler);
+    XFree(configs);
+
+    if (!context || !surface) {
+        if (context) glXDestroyContext(display, context);
+        return nullptr;
+    }
+
+    auto* shared = new SharedContext();
+    shared->display = display;
+    shared->context = context;
+    shared->surface = surface;
+    return shared;
+}
+#endif
+
+ResourceLoader::~ResourceLoader() {
+    if (!thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void ResourceLoader::initThreads() {
+#ifdef ENGINE_HAS_GLX
+    // The loader binds its context through the window's display connection
+    XInitThreads();
+#endif
+}
+
+bool ResourceLoader::start() {
+    if (started) return shared;
+    started = true;
+
+#ifdef ENGINE_HAS_GLX
+    // Fences tell the render thread when the loader's commands have landed
+    if (GLExt::loadReadback()) context.reset(createSharedContext());
+#endif
+
+    thread = std::thread(&ResourceLoader::threadLoop, this);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return threadReady; });
+    }
+
+    if (shared) {
+        LOG_INFO("Resource loader: textures and buffers are created on a shared-context thread");
+    } else {
+        LOG_INFO("Resource loader: no shared GL context; decoding on a thread, creating on the render thread");
+    }
+    return shared;
+}
+
+std::shared_ptr<StreamedResource> ResourceLoader::loadTexture(const std::string& path) {
+    Request request;
+    request.resource = std::make_shared<StreamedResource>();
+    request.path = path;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::weak_ptr<StreamedResource>& known = texturesByPath[path];
+        if (auto existing = known.lock()) return existing;
+        known = request.resource;
+    }
+    auto resource = request.resource;
+    enqueue(std::move(request));
+    return resource;
+}
+
+std::shared_ptr<StreamedResource> ResourceLoader::loadBuffer(GLenum target, std::vector<unsigned char> data) {
+    Request request;
+    request.resource = std::make_shared<StreamedResource>();
+    request.target = target;
+    request.data = std::move(data);
+    auto resource = request.resource;
+    enqueue(std::move(request));
+    return resource;
+}
+
+void ResourceLoader::enqueue(Request request) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+
+    // Not started: the caller is the render thread, so do it all here
+    if (!started) {
+        if (decode(request) && create(request)) {
+            request.resource->state.store(StreamedResource::Ready, std::memory_order_release);
+        } else {
+            request.resource->state.store(StreamedResource::Failed, std::memory_order_release);
+        }
+        pending.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(request));
+    }
+    wake.notify_one();
+}
+
+void ResourceLoader::threadLoop() {
+    bool current = false;
+#ifdef ENGINE_HAS_GLX
+    if (context) {
+        current = glXMakeContextCurrent(context->display, context->surface, context->surface, context->context);
+    }
+#endif
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shared = current;
+        threadReady = true;
+    }
+    idle.notify_all();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (stopping) return;
+
+        Request request = std::move(queue.front());
+        queue.pop_front();
+        busy = true;
+        lock.unlock();
+
+        bool ok = decode(request);
+        if (ok && shared) {
+            // Create here; the fence is flushed so the render thread's poll can see it signal
+            ok = create(request);
+            if (ok) {
+                request.resource->fence = GLExt::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                glFlush();
+            }
+        }
+        if (!ok) {
+            request.resource->state.store(StreamedResource::Failed, std::memory_order_release);
+            pending.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        lock.lock();
+        if (ok && shared) {
+            request.resource->state.store(StreamedResource::Published, std::memory_order_release);
+            published.push_back(request.resource);
+        } else if (ok) {
+            decoded.push_back(std::move(request));
+        }
+        busy = false;
+        if (queue.empty()) idle.notify_all();
+    }
+}
+
+bool ResourceLoader::decode(Request& request) {
+    if (request.target != 0) return true;
+
+    request.pixels = stbi_load(request.path.c_str(), &request.width, &request.height, &request.components, 0);
+    if (!request.pixels) {
+        LOG_ERROR("Texture failed to load: %s (%s)", request.path.c_str(), stbi_failure_reason());
+        return false;
+    }
+    return true;
+}
+
+bool ResourceLoader::create(Request& request) {
+    StreamedResource& resource = *request.resource;
+
+    if (request.target != 0) {
+        if (!GLExt::loadReadback()) return false;
+        GLExt::GenBuffers(1, &resource.name);
+        GLExt::BindBuffer(request.target, resource.name);
+        GLExt::BufferData(request.target, (GLsizeiptr)request.data.size(), request.data.data(), GL_STATIC_DRAW);
+        GLExt::BindBuffer(request.target, 0);
+        std::vector<unsigned char>().swap(request.data);
+        return true;
+    }
+
+    GLenum format = GL_RGBA;
+    if (request.components == 1) format = GL_RED;
+    else if (request.components == 3) format = GL_RGB;
+
+    glGenTextures(1, &resource.name);
+    glBindTexture(GL_TEXTURE_2D, resource.name);
+    gluBuild2DMipmaps(GL_TEXTURE_2D, format, request.width, request.height, format, GL_UNSIGNED_BYTE, request.pixels);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    stbi_image_free(request.pixels);
+    request.pixels = nullptr;
+    return true;
+}
+
+void ResourceLoader::retire(bool wait) {
+    std::vector<std::shared_ptr<StreamedResource>> waiting;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        waiting.swap(published);
+    }
+
+    std::vector<std::shared_ptr<StreamedResource>> unsignalled;
+    for (auto& resource : waiting) {
+        GLenum result = GLExt::ClientWaitSync(resource->fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                              wait ? FENCE_WAIT_NS : 0);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+            GLExt::DeleteSync(resource->fence);
+            resource->fence = nullptr;
+            resource->state.store(StreamedResource::Ready, std::memory_order_release);
+            pending.fetch_sub(1, std::memory_order_relaxed);
+        } else if (result == GL_WAIT_FAILED) {
+            resource->state.store(StreamedResource::Failed, std::memory_order_release);
+            pending.fetch_sub(1, std::memory_order_relaxed);
+        } else {
+            unsignalled.push_back(std::move(resource));
+        }
+    }
+
+    if (!unsignalled.empty()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        published.insert(published.end(), unsignalled.begin(), unsignalled.end());
+    }
+}
+
+void ResourceLoader::update() {
+    if (!started) return;
+
+    // 1. Without a shared context, the render thread creates what the loader decoded
+    std::vector<Request> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(decoded);
+    }
+    for (Request& request : ready) {
+        bool ok = create(request);
+        request.resource->state.store(ok ? StreamedResource::Ready : StreamedResource::Failed, std::memory_order_release);
+        pending.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // 2. Objects the loader created become usable once their fences signal
+    retire(false);
+}
+
+void ResourceLoader::finish() {
+    if (!started) return;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return queue.empty() && !busy; });
+    }
+    update();
+    while (pending.load(std::memory_order_relaxed) > 0) retire(true);
+}
+
+ResourceLoader& resourceLoader() {
+    static ResourceLoader instance;
+    return instance;
+}
@@ -0,0 +1,291 @@
+/**
+ * @file SceneDisplay.cpp
+ * @brief Implementation of the in-scene displays.
+ */
+
+#include "SceneDisplay.h"
+#include "Frustum.h"
+#include "GLExtensions.h"
+#include "Log.h"
+#include "RenderSettings.h"
+#include "View.h"
+#include <algorithm>
+#include <cmath>
+
+/** @brief Views whose cameras differ by less than this (eye, target, fov) are merged. */
+static const float SAME_CAMERA_TOLERANCE = 0.01f;
+
+/** @brief Brightness of a screen whose view has not been rendered yet. */
+static const float BLANK_LEVEL = 0.02f;
+
+static bool closeTo(const Vec3& a, const Vec3& b) {
+    return std::abs(a.x - b.x) < SAME_CAMERA_TOLERANCE && std::abs(a.y - b.y) < SAME_CAMERA_TOLERANCE &&
+           std::abs(a.z - b.z) < SAME_CAMERA_TOLERANCE;
+}
+
+int SceneDisplays::addView(const DisplayView& view) {
+    for (std::size_t i = 0; i < views.size(); ++i) {
+        DisplayView& s = views[i].settings;
+        if (!closeTo(s.eye, view.eye) || !closeTo(s.target, view.target) || std::abs(s.fov - view.fov) > SAME_CAMERA_TOLERANCE) continue;
+
+        // Same camera: one render serves both, at the better of the two settings
+        s.width = std::max(s.width, view.width);
+        s.height = std::max(s.height, view.height);
+        s.refreshHz = std::max(s.refreshHz, view.refreshHz);
+        s.lodBias = std::min(s.lodBias, view.lodBias);
+        s.drawDistance = std::max(s.drawDistance, view.drawDistance);
+        return (int)i;
+    }
+
+    View v;
+    v.settings = view;
+    views.push_back(v);
+    return (int)views.size() - 1;
+}
+
+void SceneDisplays::updateVisibility() {
+    bool queries = GLExt::loadQueries();
+    for (auto& v : views) v.visible = false;
+
+    for (auto& entry : screens) {
+        Screen& s = entry.second;
+
+        // Results from the last frame; an unfinished query keeps the previous answer
+        // rather than stalling the pipeline
+        if (s.pending) {
+            GLuint available = 0;
+            GLExt::GetQueryObjectuiv(s.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint samples = 0;
+                GLExt::GetQueryObjectuiv(s.query, GL_QUERY_RESULT, &samples);
+                s.visible = samples > 0;
+                s.pending = false;
+            }
+        }
+
+        // Not drawn at all: outside the view frustum or the draw distance
+        if (!s.drawn) s.visible = false;
+        else if (!queries) s.visible = true;
+        s.drawn = false;
+
+        if (s.visible && s.view >= 0 && s.view < (int)views.size()) views[s.view].visible = true;
+    }
+}
+
+bool SceneDisplays::prepareTarget(View& view, int windowWidth, int windowHeight) {
+    int w = std::max(1, view.settings.width), h = std::max(1, view.settings.height);
+    if (framebufferState < 0) framebufferState = GLExt::load() ? 1 : 0;
+
+    if (framebufferState == 1) {
+        if (view.framebuffer && view.texWidth == w && view.texHeight == h) return true;
+
+        if (view.texture) {
+            GLuint textures[2] = { view.texture, view.depthTexture };
+            glDeleteTextures(view.depthTexture ? 2 : 1, textures);
+        }
+        if (!view.framebuffer) GLExt::GenFramebuffers(1, &view.framebuffer);
+        view.texture = GLExt::createTargetTexture(GL_RGBA8, w, h, GL_LINEAR);
+        view.depthTexture = GLExt::createTargetTexture(GL_DEPTH_COMPONENT24, w, h, GL_NEAREST);
+        view.texWidth = view.usedWidth = w;
+        view.texHeight = view.usedHeight = h;
+        view.captured = false;
+
+        GLint previousFramebuffer = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        GLExt::BindFramebuffer(GL_FRAMEBUFFER, view.framebuffer);
+        GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, view.texture, 0);
+        GLExt::FramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, view.depthTexture, 0);
+        GLenum status = GLExt::CheckFramebufferStatus(GL_FRAMEBUFFER);
+        GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+        if (status == GL_FRAMEBUFFER_COMPLETE) return true;
+
+        LOG_WARNING("Display framebuffer incomplete (0x%x); rendering displays through the back buffer.", status);
+        framebufferState = 0;
+        for (auto& v : views) v.texWidth = v.texHeight = 0; // reallocate as plain textures
+    }
+
+    // Back buffer fallback: the view is copied out of the window, so it is clamped to it
+    int usedWidth = std::min(w, windowWidth), usedHeight = std::min(h, windowHeight);
+    if (usedWidth <= 0 || usedHeight <= 0) return false;
+    if (view.texWidth != w || view.texHeight != h) {
+        if (view.depthTexture) glDeleteTextures(1, &view.depthTexture);
+        view.depthTexture = 0;
+        if (!view.texture) glGenTextures(1, &view.texture);
+        glBindTexture(GL_TEXTURE_2D, view.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        view.texWidth = w;
+        view.texHeight = h;
+        view.captured = false;
+    }
+    view.usedWidth = usedWidth;
+    view.usedHeight = usedHeight;
+    return true;
+}
+
+void SceneDisplays::renderView(View& view, const RenderFn& renderWorld) {
+    const DisplayView& s = view.settings;
+    bool offscreen = framebufferState == 1;
+
+    GLint previousFramebuffer = 0;
+    if (offscreen) {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        GLExt::BindFramebuffer(GL_FRAMEBUFFER, view.framebuffer);
+    }
+
+    glViewport(0, 0, view.usedWidth, view.usedHeight);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluPerspective(s.fov, (double)s.width / s.height, 0.1, s.drawDistance);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    gluLookAt(s.eye.x, s.eye.y, s.eye.z, s.target.x, s.target.y, s.target.z, 0.0, 1.0, 0.0);
+
+    // Every screen showing this view shares the culling below
+    Frustum cull = viewFrustum();
+    RenderContext& ctx = renderContext();
+    RenderPass previousPass = ctx.pass;
+    const Frustum* previousCull = ctx.cull;
+    float previousBias = ctx.lodBias;
+    ctx.pass = RenderPass::Display;
+    ctx.cull = &cull;
+    ctx.lodBias = s.lodBias;
+
+    renderWorld();
+
+    ctx.pass = previousPass;
+    ctx.cull = previousCull;
+    ctx.lodBias = previousBias;
+
+    if (offscreen) {
+        GLExt::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, view.texture);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, view.usedWidth, view.usedHeight);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+}
+
+int SceneDisplays::render(double now, int budget, const RenderFn& renderWorld) {
+    updateVisibility();
+    if (views.empty() || budget <= 0) return 0;
+
+    // Due views, most overdue (in refresh periods) first
+    std::vector<std::pair<double, std::size_t>> due;
+    for (std::size_t i = 0; i < views.size(); ++i) {
+        const View& v = views[i];
+        double periods = (now - v.lastRender) * std::max(v.settings.refreshHz, 0.01f);
+        if (v.visible && periods >= 1.0) due.push_back({ periods, i });
+    }
+    if (due.empty()) return 0;
+    std::sort(due.begin(), due.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    int rendered = 0;
+    for (const auto& d : due) {
+        if (rendered == budget) break;
+        View& view = views[d.second];
+        if (!prepareTarget(view, viewport[2], viewport[3])) continue;
+
+        renderingView = (int)d.second;
+        renderView(view, renderWorld);
+        renderingView = -1;
+
+        view.lastRender = now;
+        view.captured = true;
+        ++rendered;
+    }
+
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    return rendered;
+}
+
+void SceneDisplays::drawPicture(const GameObject* screen, int viewIndex) {
+    const RenderContext& ctx = renderContext();
+    if (ctx.pass == RenderPass::Shadow || ctx.pass == RenderPass::Bake) return;
+    if (viewIndex < 0 || viewIndex >= (int)views.size()) return;
+    const View& view = views[viewIndex];
+
+    // Main pass: record that the screen was drawn and measure how much of it shows
+    Screen* state = nullptr;
+    if (ctx.pass == RenderPass::Main) {
+        state = &screens[screen];
+        state->view = viewIndex;
+        state->drawn = true;
+    }
+    bool query = state && !state->pending && GLExt::loadQueries();
+
+    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT | GL_POLYGON_BIT);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(-1.0f, -1.0f);
+
+    // A view never samples its own texture while rendering into it
+    bool textured = view.captured && viewIndex != renderingView;
+    if (textured) {
+        glDisable(GL_TEXTURE_CUBE_MAP);
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, view.texture);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+        glColor3f(1.0f, 1.0f, 1.0f);
+    } else {
+        glDisable(GL_TEXTURE_2D);
+        glColor3f(BLANK_LEVEL, BLANK_LEVEL, BLANK_LEVEL);
+    }
+
+    if (query) {
+        if (!state->query) GLExt::GenQueries(1, &state->query);
+        GLExt::BeginQuery(GL_SAMPLES_PASSED, state->query);
+    }
+
+    float su = view.texWidth ? (float)view.usedWidth / view.texWidth : 1.0f;
+    float sv = view.texHeight ? (float)view.usedHeight / view.texHeight : 1.0f;
+    glBegin(GL_QUADS);
+    glNormal3f(0.0f, 0.0f, 1.0f);
+    glTexCoord2f(0.0f, 0.0f); glVertex3f(-0.5f, -0.5f, 0.5f);
+    glTexCoord2f(su, 0.0f);   glVertex3f(0.5f, -0.5f, 0.5f);
+    glTexCoord2f(su, sv);     glVertex3f(0.5f, 0.5f, 0.5f);
+    glTexCoord2f(0.0f, sv);   glVertex3f(-0.5f, 0.5f, 0.5f);
+    glEnd();
+
+    if (query) {
+        GLExt::EndQuery(GL_SAMPLES_PASSED);
+        state->pending = true;
+    }
+
+    glPopAttrib();
+}
+
+void SceneDisplays::forget(const GameObject* screen) {
+    auto it = screens.find(screen);
+    if (it == screens.end()) return;
+    if (it->second.query) GLExt::DeleteQueries(1, &it->second.query);
+    screens.erase(it);
+}
+
+SceneDisplays& sceneDisplays() {
+    static SceneDisplays instance;
+    return instance;
+}
+
+// --- DisplayScreen Implementation ---
+
+void DisplayScreen::drawMesh() {
+    Cube::drawMesh();
+    sceneDisplays().drawPicture(this, view);
+}
@@ -0,0 +1,111 @@
+/**
+ * @file SceneIndex.cpp
+ * @brief Implementation of the name and tag indices.
+ */
+
+#include "SceneIndex.h"
+#include "GameObject.h"
+#include "Log.h"
+#include <unordered_map>
+
+namespace {
+    struct IndexStore {
+        std::unordered_map<std::string, Tag> tagNames;
+        std::unordered_map<std::string, GameObject*> byName;
+
+        // Per tag: the object list plus each object's slot in it for O(1) removal
+        std::vector<GameObject*> byTag[SceneIndex::MaxTags];
+        std::unordered_map<GameObject*, std::size_t> slot[SceneIndex::MaxTags];
+    };
+
+    IndexStore& store() {
+        static IndexStore* instance = new IndexStore();
+        return *instance;
+    }
+}
+
+Tag SceneIndex::tag(const std::string& name) {
+    IndexStore& s = store();
+    auto it = s.tagNames.find(name);
+    if (it != s.tagNames.end()) return it->second;
+
+    if (s.tagNames.size() >= (std::size_t)MaxTags) {
+        LOG_ERROR("SceneIndex: no tag bits left for \"%s\" (%d tags registered)", name.c_str(), MaxTags);
+        return NoTag;
+    }
+
+    Tag t = (Tag)s.tagNames.size();
+    s.tagNames.emplace(name, t);
+    return t;
+}
+
+GameObject* SceneIndex::findByName(const std::string& name) {
+    IndexStore& s = store();
+    auto it = s.byName.find(name);
+    return it != s.byName.end() ? it->second : nullptr;
+}
+
+const std::vector<GameObject*>& SceneIndex::findByTag(Tag t) {
+    static const std::vector<GameObject*> none;
+    if (t >= MaxTags) return none;
+    return store().byTag[t];
+}
+
+void SceneIndex::query(TagMask mask, std::vector<GameObject*>& out) {
+    out.clear();
+    if (mask == 0) return;
+
+    IndexStore& s = store();
+    const std::vector<GameObject*>* shortest = nullptr;
+    for (int t = 0; t < MaxTags; ++t) {
+        if ((mask & tagBit((Tag)t)) && (!shortest || s.byTag[t].size() < shortest->size())) {
+            shortest = &s.byTag[t];
+        }
+    }
+
+    for (auto* obj : *shortest) {
+        if ((obj->getTags() & mask) == mask) out.push_back(obj);
+    }
+}
+
+void SceneIndex::rename(GameObject* obj, const std::string& oldName, const std::string& newName) {
+    IndexStore& s = store();
+    if (!oldName.empty()) {
+        auto it = s.byName.find(oldName);
+        if (it != s.byName.end() && it->second == obj) s.byName.erase(it);
+    }
+    if (!newName.empty()) {
+        s.byName[newName] = obj;
+    }
+}
+
+void SceneIndex::addTags(GameObject* obj, TagMask added) {
+    IndexStore& s = store();
+    for (int t = 0; t < MaxTags && added; ++t) {
+        if (!(added & tagBit((Tag)t))) continue;
+        added &= ~tagBit((Tag)t);
+        if (s.slot[t].count(obj)) continue;
+
+        s.slot[t][obj] = s.byTag[t].size();
+        s.byTag[t].push_back(obj);
+    }
+}
+
+void SceneIndex::removeTags(GameObject* obj, TagMask removed) {
+    IndexStore& s = store();
+    for (int t = 0; t < MaxTags && removed; ++t) {
+        if (!(removed & tagBit((Tag)t))) continue;
+        removed &= ~tagBit((Tag)t);
+
+        auto it = s.slot[t].find(obj);
+        if (it == s.slot[t].end()) continue;
+
+        // Swap-remove so the list stays dense
+        std::size_t idx = it->second;
+        GameObject* last = s.byTag[t].back();
+        s.byTag[t][idx] = last;
+        s.slot[t][last] = idx;
+        s.byTag[t].pop_back();
+        s.slot[t].erase(obj);
+    }
+}
@@ -34,3 +34,9 @@ void Text3D::drawMesh() {
 
     glPopMatrix();
 }
+
+AABB Text3D::getLocalBounds() const {
+    // Same scale and centring as drawMesh(); stroke glyphs span about -33 to 119 units
+    float halfWidth = glutStrokeLength(GLUT_STROKE_ROMAN, (const unsigned char*)text.c_str()) * 0.01f / 2.0f;
+    return { { -halfWidth, -0.95f, -0.05f }, { halfWidth, 0.6f, 0.05f } };
+}
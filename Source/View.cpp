@@ -0,0 +1,101 @@
+/**
+ * @file View.cpp
+ * @brief Implementation of the camera measurement helpers.
+ */
+
+#include "View.h"
+#include <GL/freeglut.h>
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Largest axis scale of the upper 3x3 of a column-major matrix.
+ */
+static float maxAxisScale(const GLfloat m[16]) {
+    float sx = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+    float sy = std::sqrt(m[4] * m[4] + m[5] * m[5] + m[6] * m[6]);
+    float sz = std::sqrt(m[8] * m[8] + m[9] * m[9] + m[10] * m[10]);
+    return std::max(sx, std::max(sy, sz));
+}
+
+bool invertAffine(const float m[16], float out[16]) {
+    float a = m[0], b = m[4], c = m[8];
+    float d = m[1], e = m[5], f = m[9];
+    float g = m[2], h = m[6], k = m[10];
+    float det = a * (e * k - f * h) - b * (d * k - f * g) + c * (d * h - e * g);
+    if (std::abs(det) < 1e-12f) return false;
+    float inv = 1.0f / det;
+
+    // Inverse of the 3x3 part (adjugate / determinant), column-major
+    float r[9] = {
+        (e * k - f * h) * inv, (f * g - d * k) * inv, (d * h - e * g) * inv,
+        (c * h - b * k) * inv, (a * k - c * g) * inv, (b * g - a * h) * inv,
+        (b * f - c * e) * inv, (c * d - a * f) * inv, (a * e - b * d) * inv,
+    };
+
+    out[0] = r[0]; out[1] = r[1]; out[2] = r[2];  out[3] = 0.0f;
+    out[4] = r[3]; out[5] = r[4]; out[6] = r[5];  out[7] = 0.0f;
+    out[8] = r[6]; out[9] = r[7]; out[10] = r[8]; out[11] = 0.0f;
+
+    // Translation: -R^-1 * t
+    out[12] = -(r[0] * m[12] + r[3] * m[13] + r[6] * m[14]);
+    out[13] = -(r[1] * m[12] + r[4] * m[13] + r[7] * m[14]);
+    out[14] = -(r[2] * m[12] + r[5] * m[13] + r[8] * m[14]);
+    out[15] = 1.0f;
+    return true;
+}
+
+Frustum viewFrustum() {
+    GLfloat mv[16], proj[16], clip[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+    glGetFloatv(GL_PROJECTION_MATRIX, proj);
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            float v = 0.0f;
+            for (int k = 0; k < 4; ++k) v += proj[k * 4 + r] * mv[c * 4 + k];
+            clip[c * 4 + r] = v;
+        }
+    }
+    return Frustum::fromMatrix(clip);
+}
+
+Vec3 localEyePosition() {
+    GLfloat mv[16], inv[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+    if (!invertAffine(mv, inv)) return { 0.0f, 0.0f, 0.0f };
+    return { inv[12], inv[13], inv[14] };
+}
+
+float projectedSize(const Vec3& c, float r) {
+    GLfloat mv[16], proj[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+    glGetFloatv(GL_PROJECTION_MATRIX, proj);
+
+    float eyeRadius = r * maxAxisScale(mv);
+    float eyeZ = mv[2] * c.x + mv[6] * c.y + mv[10] * c.z + mv[14];
+    float dist = -eyeZ;
+    if (dist <= eyeRadius) return 1e9f; // camera inside or behind the sphere
+
+    return eyeRadius * proj[5] / dist;
+}
+
+float projectedErrorPixels(const AABB& bounds, float error) {
+    GLfloat mv[16], proj[16], inv[16];
+    GLint viewport[4];
+    glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+    glGetFloatv(GL_PROJECTION_MATRIX, proj);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (!invertAffine(mv, inv)) return 1e9f;
+
+    // Distance from the camera to the nearest point of the box, in eye units
+    Vec3 eye = { inv[12], inv[13], inv[14] };
+    float dx = std::max(bounds.min.x - eye.x, std::max(0.0f, eye.x - bounds.max.x));
+    float dy = std::max(bounds.min.y - eye.y, std::max(0.0f, eye.y - bounds.max.y));
+    float dz = std::max(bounds.min.z - eye.z, std::max(0.0f, eye.z - bounds.max.z));
+    float scale = maxAxisScale(mv);
+    float dist = std::sqrt(dx * dx + dy * dy + dz * dz) * scale;
+    if (dist <= 1e-4f) return 1e9f;
+
+    // Half the viewport height corresponds to proj[5] at unit distance
+    return error * scale * proj[5] / dist * viewport[3] * 0.5f;
+}
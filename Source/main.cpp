@@ -8,7 +8,10 @@
  */
 
 #include <GL/freeglut.h>
-#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <cmath>
 #include <vector>
 
@@ -19,12 +22,42 @@
 #include "Container.h"
 #include "Model.h"
 #include "Text3D.h"
+#include "Behavior.h"
+#include "Physics.h"
+#include "Agents.h"
+#include "Navigation.h"
+#include "Profiler.h"
+#include "RenderSettings.h"
+#include "HLOD.h"
+#include "IndirectScene.h"
+#include "OcclusionCulling.h"
+#include "PlanarShadows.h"
+#include "ReflectionProbe.h"
+#include "PlanarMirror.h"
+#include "OIT.h"
+#include "LowResTransparency.h"
+#include "DynamicResolution.h"
+#include "QualityGovernor.h"
+#include "SceneDisplay.h"
+#include "FrameCapture.h"
+#include "PosterRenderer.h"
+#include "Particles.h"
+#include "Prefabs.h"
+#include "ResourceLoader.h"
+#include "Log.h"
+#include "View.h"
 
 // --- GLOBAL ENGINE STATE ---
 
 /** @brief List of all renderable objects in the scene. */
 std::vector<GameObject*> objects;
 
+/** @brief Adds a root object to the scene, indexing its subtree by name and tag. */
+void addToScene(GameObject* obj) {
+    objects.push_back(obj);
+    obj->enterScene();
+}
+
 /** @brief List of objects that possess collision properties. */
 std::vector<GameObject*> physicsObjects;
 
@@ -34,9 +67,30 @@ std::vector<PointLight> pointLights;
 /** @brief The global directional light (Sun). */
 DirectionalLight sun;
 
+/** @brief Typed behaviors (doors, turntables) updated in per-type batches. */
+BehaviorSystem behaviors;
+
+/** @brief Spatial grid over every collision box in physicsObjects. */
+Broadphase broadphase;
+
+/** @brief Enter/stay/exit tracking for trigger boxes. */
+TriggerSystem triggers;
+
+/** @brief Walkable regions baked from the floor and every collision box. */
+NavMesh navMesh;
+
+/** @brief A* queries over navMesh, shared by every agent. */
+PathService pathService(navMesh);
+
+/** @brief Visitor agents walking around the showroom. */
+AgentSystem agents;
+
 /** @brief The player camera. */
 Camera camera;
 
+/** @brief Fog density at full draw distance (see applyProjection()). */
+const float FOG_DENSITY = 0.03f;
+
 /** @brief Array to track the state of keyboard keys (pressed/released). */
 bool keys[256];
 
@@ -57,10 +111,73 @@ const float GRAVITY = 9.8f;
 const float PLAYER_HEIGHT = 1.5f; /**< Eye level from feet. */
 const float PLAYER_RADIUS = 0.3f; /**< Collision radius of the player. */
 
+/** @brief Physical parameters of the player, shared with stepCharacter(). */
+const CharacterBody playerBody = { PLAYER_RADIUS, PLAYER_HEIGHT, GRAVITY };
+
+// --- CROWD ---
+/** @brief Number of crowd agents to spawn (set with --agents=N). */
+std::size_t agentCount = 0;
+
+// --- PARTICLES ---
+/** @brief Particles kept alive by the stress-test fountain (set with --particles=N). */
+std::size_t particleCount = 0;
+
+/** @brief Timestamp of the last window title refresh. */
+int lastTitleTime = 0;
+
+// --- CAPTURE ---
+/** @brief Output of --capture (a .y4m file, otherwise a PNG directory); empty = off. */
+std::string capturePath;
+
+/** @brief Frame rate of the capture; the simulation steps 1/fps per frame while capturing. */
+int captureFps = 30;
+
+/** @brief Frames to capture before exiting (0 = until Esc). */
+long captureFrameLimit = 0;
+
+/** @brief Renders offscreen at the capture size with the window hidden (--headless). */
+bool headless = false;
+
+// --- POSTER ---
+/** @brief Output of the tiled poster render ('p' key, or --poster=FILE.ppm). */
+std::string posterPath = "poster.ppm";
+
+/** @brief Poster size in pixels (--poster-size=WxH). */
+int posterWidth = 16384;
+int posterHeight = 9216;
+
+/** @brief Render the poster right after start-up (and exit when headless). */
+bool posterOnStart = false;
+
+// --- PREFAB LAYOUTS ---
+// Computed by the compiler: the scene's walls, table and chairs are built from these arrays
+constexpr auto OUTER_WALL_LAYOUT = Prefab::glassWall<Prefab::glassWallPaneCount(20.0f, 1.5f)>(5.0f, 1.5f);
+constexpr auto INNER_WALL_LAYOUT = Prefab::glassWall<Prefab::glassWallPaneCount(8.0f, 1.5f)>(5.0f, 1.5f);
+constexpr auto GLASS_TABLE_LAYOUT = Prefab::glassTable(2.0f, 0.8f, 1.0f);
+constexpr auto MODERN_CHAIR_LAYOUT = Prefab::modernChair();
+
+/**
+ * @brief Builds a glass wall from a layout: chrome pillars and shadowless glass panes.
+ * @param parts A layout from Prefab::buildGlassWall() or Prefab::glassWall().
+ * @param count Number of parts.
+ * @return A pointer to the constructed Container.
+ */
+Container* createGlassWall(const Prefab::Part* parts, std::size_t count) {
+    std::array<Material, 2> materials = { Material::CreateChrome(), Material::CreateGlass() };
+    return Prefab::instantiate(parts, count, materials.data(), materials.size());
+}
+
+/** @brief Builds a glass wall from a compile-time layout. */
+template <std::size_t N>
+Container* createGlassWall(const std::array<Prefab::Part, N>& layout) {
+    return createGlassWall(layout.data(), N);
+}
+
 /**
  * @brief Helper to build a procedural glass wall with pillars.
  *
- * Generates a Container holding alternating pillars and glass panes.
+ * Generates a Container holding alternating pillars and glass panes. For
+ * constant dimensions, prefer a Prefab::glassWall() layout.
  *
  * @param length Approximate total length of the wall.
  * @param height Height of the pillars and glass.
@@ -69,64 +186,19 @@ const float PLAYER_RADIUS = 0.3f; /**< Collision radius of the player. */
  * @return A pointer to the constructed Container.
  */
 Container* createGlassWall(float length, float height, float paneWidth, float pillarThickness = 0.2f) {
-    Container* wall = new Container();
-
-    Material matGlass = Material::CreateGlass();
-    Material matPillar = Material::CreateChrome(); 
-
-    // Calculate Layout
-    // Pattern: Pillar -> Glass -> Pillar -> Glass -> Pillar
-    // Solve for N (number of panes): 
-    // Total = N*paneWidth + (N+1)*pillarThickness
-    int numPanes = (int)((length - pillarThickness) / (paneWidth + pillarThickness));
-    if (numPanes < 1) numPanes = 1; // Ensure at least one section
-
-    // Recalculate exact total length to center it perfectly
-    float totalActualLength = (numPanes * paneWidth) + ((numPanes + 1) * pillarThickness);
-    float startX = -totalActualLength / 2.0f;
-    float currentX = startX;
-    float glassDepth = 0.05f; 
-
-    // Build the Wall
-    for (int i = 0; i <= numPanes; i++) {
-        // A. Create Pillar
-        Cube* pillar = new Cube();
-        pillar->setScale(pillarThickness, height, pillarThickness);
-        // Position is relative to the Container center. 
-        // Y is moved up by height/2 so the base sits on y=0
-        pillar->setPosition(currentX + pillarThickness / 2.0f, height / 2.0f, 0.0f);
-        pillar->setMaterial(matPillar);
-        wall->addChild(pillar);
-
-        currentX += pillarThickness;
-
-        // B. Create Glass Pane (between pillars)
-        if (i < numPanes) {
-            Cube* glass = new Cube();
-            glass->setScale(paneWidth, height, glassDepth);
-            glass->setPosition(currentX + paneWidth / 2.0f, height / 2.0f, 0.0f);
-            glass->setMaterial(matGlass);
-			glass->castsShadow = false;
-            wall->addChild(glass);
-            
-            currentX += paneWidth;
-        }
-    }
-
-    return wall;
+    int panes = Prefab::glassWallPaneCount(length, paneWidth, pillarThickness);
+    std::vector<Prefab::Part> parts(Prefab::glassWallPartCount(panes));
+    Prefab::buildGlassWall(parts.data(), panes, height, paneWidth, pillarThickness);
+    return createGlassWall(parts.data(), parts.size());
 }
 
 /**
- * @brief Helper to create a glass table with metal legs.
- * @param width Table width.
- * @param height Table height.
- * @param depth Table depth.
+ * @brief Builds a glass table from a layout and gives it a collision box.
+ * * The collision box is fitted to the layout's bounds.
+ * @param layout A layout from Prefab::glassTable().
  * @return A pointer to the constructed Container.
  */
-Container* createGlassTable(float width, float height, float depth) {
-    Container* table = new Container();
-
-    // 1. Define Materials
+Container* createGlassTable(const std::array<Prefab::Part, Prefab::GlassTablePartCount>& layout) {
     // Metal: Dark grey with high specular shine
     Material matMetal;
     matMetal.ambient[0] = 0.2f; matMetal.ambient[1] = 0.2f; matMetal.ambient[2] = 0.2f; matMetal.ambient[3] = 1.0f;
@@ -134,70 +206,28 @@ Container* createGlassTable(float width, float height, float depth) {
     matMetal.specular[0] = 0.9f; matMetal.specular[1] = 0.9f; matMetal.specular[2] = 0.9f; matMetal.specular[3] = 1.0f;
     matMetal.shininess = 60.0f;
 
-    Material matGlass = Material::CreateGlass();
-
-    float legThick = 0.1f;
-    float frameThick = 0.1f; 
-    float glassThick = 0.05f;
-
-    // 2. Create Legs (4 Corners)
-    float legX = width / 2.0f - legThick / 2.0f;
-    float legZ = depth / 2.0f - legThick / 2.0f;
-    
-    for (int xDir = -1; xDir <= 1; xDir += 2) {
-        for (int zDir = -1; zDir <= 1; zDir += 2) {
-            Cube* leg = new Cube();
-            leg->setScale(legThick, height, legThick);
-            // Legs sit on the floor (y=0), so their center is at height/2
-            leg->setPosition(xDir * legX, height / 2.0f, zDir * legZ);
-            leg->setMaterial(matMetal);
-            table->addChild(leg);
-        }
-    }
+    Container* table = Prefab::instantiate(layout, std::array<Material, 2>{ matMetal, Material::CreateGlass() });
 
-    // 3. Create Metal Frame
-    
-    // Long Bars (Front/Back)
-    float longBarLen = width;
-    Cube* barFront = new Cube();
-    barFront->setScale(longBarLen, frameThick, legThick);
-    barFront->setPosition(0.0f, height - frameThick/2.0f, legZ); 
-    barFront->setMaterial(matMetal);
-    table->addChild(barFront);
-
-    Cube* barBack = dynamic_cast<Cube*>(barFront->clone());
-    barBack->setPosition(0.0f, height - frameThick/2.0f, -legZ);
-    table->addChild(barBack);
-
-    // Short Bars (Left/Right)
-    float shortBarLen = depth - (2 * legThick); 
-    Cube* barLeft = new Cube();
-    barLeft->setScale(legThick, frameThick, shortBarLen);
-    barLeft->setPosition(-legX, height - frameThick/2.0f, 0.0f);
-    barLeft->setMaterial(matMetal);
-    table->addChild(barLeft);
-
-    Cube* barRight = dynamic_cast<Cube*>(barLeft->clone());
-    barRight->setPosition(legX, height - frameThick/2.0f, 0.0f);
-    table->addChild(barRight);
-
-    // 4. Create Glass Top
-    Cube* glass = new Cube();
-    glass->setScale(width - legThick, glassThick, depth - legThick);
-    glass->setPosition(0.0f, height - frameThick/2.0f, 0.0f);
-    glass->setMaterial(matGlass);
-    glass->castsShadow = false; 
-    table->addChild(glass);
-
-    // 5. Collision Box
-    CollisionBox* collider = new CollisionBox(width, height, depth);
-    collider->setPosition(0.0f, height / 2.0f, 0.0f);
+    AABB b = Prefab::bounds(layout);
+    CollisionBox* collider = new CollisionBox(b.max.x - b.min.x, b.max.y - b.min.y, b.max.z - b.min.z);
+    collider->setPosition((b.min.x + b.max.x) / 2.0f, (b.min.y + b.max.y) / 2.0f, (b.min.z + b.max.z) / 2.0f);
     table->addChild(collider);
 	physicsObjects.push_back(collider);
 
     return table;
 }
 
+/**
+ * @brief Helper to create a glass table with metal legs.
+ * @param width Table width.
+ * @param height Table height.
+ * @param depth Table depth.
+ * @return A pointer to the constructed Container.
+ */
+Container* createGlassTable(float width, float height, float depth) {
+    return createGlassTable(Prefab::glassTable(width, height, depth));
+}
+
 /**
  * @brief Helper to create a detailed modern chair.
  * @param r Red component.
@@ -206,9 +236,7 @@ Container* createGlassTable(float width, float height, float depth) {
  * @return A pointer to the constructed Container.
  */
 Container* createModernChair(float r, float g, float b) {
-    Container* chair = new Container();
-
-    // 1. Refined Material (Less Bright)
+    // Refined Material (Less Bright)
     float darkR = r * 0.6f;
     float darkG = g * 0.6f;
     float darkB = b * 0.6f;
@@ -219,68 +247,12 @@ Container* createModernChair(float r, float g, float b) {
     matPlastic.specular[0] = 0.3f;        matPlastic.specular[1] = 0.3f;        matPlastic.specular[2] = 0.3f;        matPlastic.specular[3] = 1.0f;
     matPlastic.shininess = 20.0f;
 
-    // Dimensions
-    float seatHeight = 0.45f;
-    float seatWidth = 0.45f;
-    float seatDepth = 0.45f;
-    float legThick = 0.04f;
-    
-    // 2. Legs
-    float legOffset = seatWidth / 2.0f - legThick; 
-    
-    for (int xDir = -1; xDir <= 1; xDir += 2) {
-        for (int zDir = -1; zDir <= 1; zDir += 2) {
-            Cube* leg = new Cube();
-            leg->setScale(legThick, seatHeight, legThick);
-            leg->setPosition(xDir * legOffset, seatHeight / 2.0f, zDir * legOffset);
-            leg->setMaterial(matPlastic);
-            chair->addChild(leg);
-        }
-    }
-
-    // 3. Seat
-    Cube* seat = new Cube();
-    seat->setScale(seatWidth, 0.06f, seatDepth);
-    seat->setPosition(0.0f, seatHeight, 0.0f);
-    seat->setMaterial(matPlastic);
-    chair->addChild(seat);
-
-    // 4. Angled Backrest Container
-    Container* backrestGroup = new Container();
-    
-    // Pivot point for the backrest is at the back of the seat
-    backrestGroup->setPosition(0.0f, seatHeight, -seatDepth / 2.0f + 0.05f);
-    backrestGroup->setRotation(-15.0f, 0.0f, 0.0f); 
-
-    // A. Vertical Supports
-    float supportHeight = 0.5f;
-    for (int xDir = -1; xDir <= 1; xDir += 2) {
-        Cube* support = new Cube();
-        support->setScale(legThick, supportHeight, legThick);
-        support->setPosition(xDir * legOffset, supportHeight / 2.0f, 0.0f);
-        support->setMaterial(matPlastic);
-        backrestGroup->addChild(support);
-    }
-
-    // B. Horizontal Slats
-    float slatCount = 3;
-    float startY = 0.2f; 
-    float gap = (supportHeight - startY) / slatCount;
-
-    for (int i = 0; i < slatCount; i++) {
-        Cube* slat = new Cube();
-        slat->setScale(seatWidth, 0.03f, 0.02f);
-        // Position slats up the support
-        slat->setPosition(0.0f, startY + (i * gap) + 0.05f, 0.0f);
-        slat->setMaterial(matPlastic);
-        backrestGroup->addChild(slat);
-    }
-
-    chair->addChild(backrestGroup);
+    Container* chair = Prefab::instantiate(MODERN_CHAIR_LAYOUT, std::array<Material, 1>{ matPlastic });
 
-    // 5. Collision Box
-    CollisionBox* box = new CollisionBox(seatWidth, seatHeight + supportHeight, seatDepth);
-    box->setPosition(0.0f, (seatHeight + supportHeight) / 2.0f, 0.0f);
+    // Collision Box
+    float boxHeight = Prefab::ChairSeatHeight + Prefab::ChairBackHeight;
+    CollisionBox* box = new CollisionBox(Prefab::ChairSeatSize, boxHeight, Prefab::ChairSeatSize);
+    box->setPosition(0.0f, boxHeight / 2.0f, 0.0f);
     chair->addChild(box);
 	physicsObjects.push_back(box);
 
@@ -289,9 +261,13 @@ Container* createModernChair(float r, float g, float b) {
 
 /**
  * @brief Renders all opaque objects in the scene.
- * * This pass is typically performed first.
+ * * This pass is typically performed first. Static primitives are culled and drawn
+ * on the GPU in one call when the IndirectScene can; the loop draws the rest and
+ * tells it which containers it left out (HLOD proxies, occlusion).
  */
 void drawOpaqueObjects() {
+    renderContext().indirect = indirectScene().begin();
+
     for (auto* obj : objects) {
         Container* container = dynamic_cast<Container*>(obj);
         
@@ -303,14 +279,36 @@ void drawOpaqueObjects() {
             }
         }
     }
+
+    if (renderContext().indirect) indirectScene().draw();
+    renderContext().indirect = false;
 }
 
 /**
  * @brief Renders all transparent objects in the scene.
- * * Performs a two-pass rendering (back faces then front faces) and handles
- * depth masking to ensure proper alpha blending.
+ * * In the main view with RenderSettings::oitEnabled, draws them once into the
+ * weighted blended OIT targets. Otherwise performs a two-pass rendering (back
+ * faces then front faces) and handles depth masking to ensure proper alpha blending,
+ * at reduced resolution if RenderSettings::transparencyResolutionScale is below 1.
  */
 void drawTransparentObjects() {
+    if (renderSettings().oitEnabled && renderContext().pass == RenderPass::Main && weightedOIT().begin()) {
+        for (auto* obj : objects) {
+            Container* container = dynamic_cast<Container*>(obj);
+
+            if (container) {
+                container->drawTransparentChildren();
+            } else if (obj->isTransparent()) {
+                obj->draw();
+            }
+        }
+        weightedOIT().end();
+        return;
+    }
+
+    float scale = renderSettings().transparencyResolutionScale;
+    bool lowRes = scale < 1.0f && renderContext().pass == RenderPass::Main && lowResTransparency().begin(scale);
+
     // Disable writing to the depth buffer so glass can layer correctly
     glDepthMask(GL_FALSE); 
 
@@ -349,163 +347,224 @@ void drawTransparentObjects() {
     
     // Re-enable depth writing
     glDepthMask(GL_TRUE); 
+
+    if (lowRes) lowResTransparency().end();
 }
 
+/** @brief Direction of the sun for the planar shadows (w = 0: directional). */
+static const GLfloat SHADOW_LIGHT[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+
+/** @brief Ground plane the shadows are flattened onto (y = 0). */
+static const GLfloat GROUND_PLANE[4] = { 0.0f, 1.0f, 0.0f, 0.0f };
+
 /**
- * @brief Constructs a planar shadow projection matrix.
- * @param fMatrix Output 4x4 matrix.
- * @param fLightPos Position of the light source (x, y, z, w).
- * @param fPlane Plane equation (Ax + By + Cz + D = 0).
+ * @brief Draws the opaque objects flattened onto the ground along the sun direction.
+ * * Static casters come from PlanarShadows' cache; only shadows reaching into the
+ * view are drawn.
  */
-void buildShadowMatrix(float fMatrix[16], float fLightPos[4], float fPlane[4]) {
-    float dot = fPlane[0] * fLightPos[0] + fPlane[1] * fLightPos[1] +
-                fPlane[2] * fLightPos[2] + fPlane[3] * fLightPos[3];
-
-    fMatrix[0] = dot - fLightPos[0] * fPlane[0];
-    fMatrix[4] = 0.0f - fLightPos[0] * fPlane[1];
-    fMatrix[8] = 0.0f - fLightPos[0] * fPlane[2];
-    fMatrix[12] = 0.0f - fLightPos[0] * fPlane[3];
-
-    fMatrix[1] = 0.0f - fLightPos[1] * fPlane[0];
-    fMatrix[5] = dot - fLightPos[1] * fPlane[1];
-    fMatrix[9] = 0.0f - fLightPos[1] * fPlane[2];
-    fMatrix[13] = 0.0f - fLightPos[1] * fPlane[3];
-
-    fMatrix[2] = 0.0f - fLightPos[2] * fPlane[0];
-    fMatrix[6] = 0.0f - fLightPos[2] * fPlane[1];
-    fMatrix[10] = dot - fLightPos[2] * fPlane[2];
-    fMatrix[14] = 0.0f - fLightPos[2] * fPlane[3];
-
-    fMatrix[3] = 0.0f - fLightPos[3] * fPlane[0];
-    fMatrix[7] = 0.0f - fLightPos[3] * fPlane[1];
-    fMatrix[11] = 0.0f - fLightPos[3] * fPlane[2];
-    fMatrix[15] = dot - fLightPos[3] * fPlane[3];
+void drawShadows() {
+    glDisable(GL_LIGHTING);
+    glDepthMask(GL_FALSE); 
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(-1.0f, -1.0f); 
+
+    glColor4f(0.0f, 0.0f, 0.0f, 0.5f);
+
+    RenderPass viewPass = renderContext().pass;
+    renderContext().pass = RenderPass::Shadow;
+    planarShadows().draw(renderContext().cull);
+    renderContext().pass = viewPass;
+    
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDepthMask(GL_TRUE); 
+    glEnable(GL_LIGHTING);
 }
 
 /**
- * @brief Main rendering loop.
- * * Handles the 3-pass rendering strategy:
+ * @brief Draws the world from the current view.
+ * * Assumes the projection and modelview (camera) matrices are already loaded.
+ * Handles the 3-pass rendering strategy:
  * 1. Opaque objects.
- * 2. Shadows (flattened geometry).
+ * 2. Shadows (flattened geometry, if enabled).
  * 3. Transparent objects.
+ * 4. Particles (main view only).
  */
-void display() {
-    // 1. CLEAR BUFFERS
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glLoadIdentity();
-
-    camera.updateLook();
-    
-    // Update lights
+void renderWorld() {
+    // Update lights: only the point lights nearest to the player stay on
     sun.enable();
-    for (auto& l : pointLights) {
-		l.enable();
+    static std::vector<std::size_t> lightOrder;
+    lightOrder.resize(pointLights.size());
+    for (std::size_t i = 0; i < lightOrder.size(); ++i) lightOrder[i] = i;
+    auto distance2 = [](const PointLight& l) {
+        Vec3 p = l.getPosition();
+        return (p.x - camera.x) * (p.x - camera.x) + (p.y - camera.y) * (p.y - camera.y) + (p.z - camera.z) * (p.z - camera.z);
+    };
+    std::sort(lightOrder.begin(), lightOrder.end(), [&](std::size_t a, std::size_t b) {
+        return distance2(pointLights[a]) < distance2(pointLights[b]);
+    });
+    for (std::size_t i = 0; i < lightOrder.size(); ++i) {
+        if ((int)i < renderSettings().maxPointLights) pointLights[lightOrder[i]].enable();
+        else pointLights[lightOrder[i]].disable();
 	}
 
-    // PASS 1: OPAQUE WORLD
+    // PASS 1: OPAQUE WORLD (then the occlusion tests, against its finished depth)
     drawOpaqueObjects();
+    agents.draw();
+    occlusionCuller().issueQueries();
 
     // PASS 2: SHADOWS
-    GLfloat lightPos[] = { 1.0f, 1.0f, 1.0f, 0.0f }; 
-    GLfloat groundPlane[] = { 0.0f, 1.0f, 0.0f, 0.0f }; 
-    GLfloat shadowMat[16];
-    buildShadowMatrix(shadowMat, lightPos, groundPlane);
-
-    glDisable(GL_LIGHTING);
-    glDepthMask(GL_FALSE); 
-    glEnable(GL_POLYGON_OFFSET_FILL);
-    glPolygonOffset(-1.0f, -1.0f); 
-
-    glPushMatrix();
-    glMultMatrixf(shadowMat);
-    glColor4f(0.0f, 0.0f, 0.0f, 0.5f);
-
-    for (auto* obj : objects) {
-        if (!obj->isTransparent() && obj->castsShadow) {
-            obj->draw();
-        }
-    }
+    if (renderSettings().shadowsEnabled) drawShadows();
 
-    glPopMatrix();
-    
-    glDisable(GL_POLYGON_OFFSET_FILL);
-    glDepthMask(GL_TRUE); 
     glEnable(GL_BLEND); 
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_LIGHTING);
 
     // PASS 3: TRANSPARENT WORLD
     drawTransparentObjects();
 
-    glutSwapBuffers();
+    // PASS 4: PARTICLES (additive glows, then sorted smoke and dust)
+    particles().draw();
 }
 
-// --- PHYSICS ENGINE ---
 
 /**
- * @brief Checks if a point overlaps with a CollisionBox.
- * * Uses local space transformation to handle Oriented Bounding Box (OBB) collision.
- * @param box The collision box to check against.
- * @param px Point X.
- * @param py Point Y.
- * @param pz Point Z.
- * @return True if the point (inflated by player radius) intersects the box.
+ * @brief Marks reflection probes near anything that moved this frame as dirty.
+ */
+void markProbesDirty() {
+    ReflectionProbes& probes = reflectionProbes();
+
+    // Doors and other moving colliders
+    for (auto* box : broadphase.getMoved()) {
+        AABB b;
+        if (!broadphase.getBounds(box, b)) continue;
+        Vec3 c = { (b.min.x + b.max.x) / 2.0f, (b.min.y + b.max.y) / 2.0f, (b.min.z + b.max.z) / 2.0f };
+        float dx = b.max.x - c.x, dy = b.max.y - c.y, dz = b.max.z - c.z;
+        probes.markDirty(c, std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+
+    // Turntables
+    BehaviorPool<SpinBehavior>& spinners = behaviors.pool<SpinBehavior>();
+    for (std::size_t i = 0; i < spinners.size(); ++i) {
+        const WorldMatrix& w = world().worldMatrices.get(spinners.getOwner(i)->getEntity());
+        probes.markDirty({ w.m[12], w.m[13], w.m[14] }, 3.0f);
+    }
+
+    // Crowd
+    for (std::size_t i = 0; i < agents.size(); ++i) {
+        probes.markDirty(agents.getPosition(i), agents.getHeight(i));
+    }
+}
+
+/**
+ * @brief Loads the camera projection, with the far plane at the governed draw distance.
+ * * The fog is thickened for short draw distances so objects fade out before the cut.
  */
-bool isOverlap(CollisionBox* box, float px, float py, float pz) {
-    // 1. Transform World Point to Local Space
-    Vec3 localPos = box->getPointInLocalSpace({ px, py, pz });
-
-    // 2. Get Local Bounds
-    float hw = box->width / 2.0f;
-    float hh = box->height / 2.0f;
-    float hd = box->depth / 2.0f;
-
-    // 3. Scale Player Dimensions to Local Space
-    Vec3 s = box->getScale();
-    float sx = (std::abs(s.x) > 0.001f) ? (1.0f / s.x) : 1.0f;
-    float sy = (std::abs(s.y) > 0.001f) ? (1.0f / s.y) : 1.0f;
-    float sz = (std::abs(s.z) > 0.001f) ? (1.0f / s.z) : 1.0f;
-
-    float localRadius = PLAYER_RADIUS * std::max(std::abs(sx), std::abs(sz)); 
-    float localHeight = PLAYER_HEIGHT * std::abs(sy);
-
-    // 4. Check Overlaps
-    if (localPos.x < (-hw - localRadius) || localPos.x > (hw + localRadius)) return false;
-    if (localPos.z < (-hd - localRadius) || localPos.z > (hd + localRadius)) return false;
-    if ((localPos.y - localHeight) < hh && localPos.y > -hh) return true;
-
-    return false;
+void applyProjection() {
+    float drawDistance = renderSettings().drawDistance;
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+	gluPerspective(45.0f, windowWidth * 1.0 / windowHeight, 0.1f, drawDistance);
+    glMatrixMode(GL_MODELVIEW);
+
+    glFogf(GL_FOG_DENSITY, std::max(FOG_DENSITY, 2.0f / drawDistance));
 }
 
 /**
- * @brief Recursively checks the scene graph for collisions.
+ * @brief Main rendering loop.
+ * * Refreshes a bounded number of reflection probe faces, the visible
+ * mirror reflections and the due in-scene displays, then renders the camera view (at the dynamic resolution
+ * scale).
  */
-bool checkSceneCollision(GameObject* node, float px, float py, float pz) {
-    CollisionBox* box = dynamic_cast<CollisionBox*>(node);
-    if (box) {
-        if (isOverlap(box, px, py, pz)) return true;
+void display() {
+    FrameProfiler::Scope renderScope(profiler(), "render");
+
+    // Headless: the whole frame goes to the capture target instead of the hidden window
+    bool offscreen = headless && frameCapture().beginOffscreen(windowWidth, windowHeight);
+
+    applyProjection();
+
+    // 1. REFLECTION PROBES (uses the back buffer before the frame is cleared)
+    if (renderSettings().reflectionsEnabled) {
+        FrameProfiler::Scope probeScope(profiler(), "probes");
+        reflectionProbes().update(renderSettings().probeFacesPerFrame, renderSettings().probeResolution,
+                                  []() { renderWorld(); });
     }
 
-    Container* container = dynamic_cast<Container*>(node);
-    if (container) {
-        for (auto* child : container->getChildren()) {
-            if (checkSceneCollision(child, px, py, pz)) return true;
+    glLoadIdentity();
+    camera.updateLook();
+
+    // 2. PLANAR MIRRORS (also drawn into the back buffer before the clear)
+    if (renderSettings().mirrorsEnabled) {
+        FrameProfiler::Scope mirrorScope(profiler(), "mirrors");
+        planarMirrors().render(renderSettings().mirrorResolutionScale * dynamicResolution().getScale(),
+                               []() { renderWorld(); });
+    }
+
+    // 3. IN-SCENE DISPLAYS (their own targets, or the back buffer before the clear)
+    if (renderSettings().displaysEnabled) {
+        FrameProfiler::Scope displayScope(profiler(), "displays");
+        sceneDisplays().render(glutGet(GLUT_ELAPSED_TIME) / 1000.0, renderSettings().displayUpdatesPerFrame,
+                               []() { renderWorld(); });
+    }
+
+    // 4. CLEAR BUFFERS (of the scaled scene target when below native resolution)
+    bool scaled = renderSettings().dynamicResolutionEnabled && dynamicResolution().begin(windowWidth, windowHeight);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    reflectionProbes().beginView();
+
+    // 5. WORLD (culled to the view frustum, which ends at the draw distance)
+    Frustum view = viewFrustum();
+    renderContext().cull = &view;
+    occlusionCuller().beginView();
+    renderWorld();
+    occlusionCuller().endView();
+    renderContext().cull = nullptr;
+    if (scaled) dynamicResolution().end();
+
+    // 6. CAPTURE (queued readback, mapped a few frames later)
+    if (frameCapture().isActive()) {
+        frameCapture().captureFrame(windowWidth, windowHeight);
+        if (captureFrameLimit > 0 && frameCapture().getFramesCaptured() >= captureFrameLimit) {
+            frameCapture().stop();
+            exit(0);
         }
     }
+    if (offscreen) frameCapture().endOffscreen();
 
-    return false;
+    if (!headless) glutSwapBuffers();
 }
 
 /**
- * @brief Global collision check against all physics objects.
+ * @brief Renders the current view into a tiled poster at the highest quality tier.
+ * * Each tile is drawn like a main view frame (mirrors, then the world culled to
+ * the tile's sub-frustum).
  */
-bool isColliding(float px, float py, float pz) {
-    for (auto* obj : physicsObjects) {
-        if (checkSceneCollision(obj, px, py, pz)) return true;
-    }
-    return false;
+void renderPoster() {
+    RenderSettings& settings = renderSettings();
+    RenderSettings saved = settings;
+    int tier = qualityGovernor().getTier();
+    qualityGovernor().apply(0, settings);
+    settings.oitEnabled = false; // the OIT targets are window-sized
+
+    glLoadIdentity();
+    camera.updateLook();
+    posterRenderer().render(posterPath, posterWidth, posterHeight, 45.0, 0.1, settings.drawDistance, []() {
+        if (renderSettings().mirrorsEnabled) planarMirrors().render(1.0f, []() { renderWorld(); });
+
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        reflectionProbes().beginView();
+
+        Frustum tile = viewFrustum();
+        renderContext().cull = &tile;
+        renderWorld();
+        renderContext().cull = nullptr;
+    });
+
+    qualityGovernor().apply(tier, settings);
+    settings = saved;
 }
 
+// --- PHYSICS ENGINE ---
+
 /**
  * @brief Main update loop.
  * * Handles physics (gravity, collision), inputs, and object updates.
@@ -516,32 +575,31 @@ void update() {
     float deltaTime = (currentTime - lastTime) / 1000.0f;
     lastTime = currentTime;
 
-    // 2. PHYSICS: Gravity
-    playerVelocityY -= GRAVITY * deltaTime;
-    
-    // Apply Vertical Movement
-    camera.y += playerVelocityY * deltaTime;
+    // Captures advance by whole video frames, however long a frame takes to render
+    if (frameCapture().isActive()) deltaTime = 1.0f / captureFps;
 
-    // Ground Check
-    if (camera.y < PLAYER_HEIGHT) {
-        camera.y = PLAYER_HEIGHT;
-        playerVelocityY = 0.0f;
-    }
+    profiler().beginFrame();
+    FrameProfiler::Scope updateScope(profiler(), "update");
 
-    // Vertical Collision with Boxes
-    if (isColliding(camera.x, camera.y, camera.z)) {
-        if (playerVelocityY < 0) {
-            camera.y -= playerVelocityY * deltaTime;
-            playerVelocityY = 0.0f;
-        } else {
-             // Hit head
-             camera.y -= playerVelocityY * deltaTime;
-             playerVelocityY = 0.0f;
-        }
+    // Textures and buffers finished by the loader thread become usable
+    resourceLoader().update();
+
+    if (renderSettings().dynamicResolutionEnabled) {
+        dynamicResolution().update(profiler().getLastFrameMs(), renderSettings().frameBudgetMs,
+                                   renderSettings().minResolutionScale);
+    }
+    if (renderSettings().qualityGovernorEnabled) {
+        const RenderSettings& settings = renderSettings();
+        float scale = dynamicResolution().getScale();
+        qualityGovernor().update(deltaTime, profiler().getFrameMs(), settings.frameBudgetMs,
+                                 !settings.dynamicResolutionEnabled || scale <= settings.minResolutionScale,
+                                 !settings.dynamicResolutionEnabled || scale >= 1.0f);
     }
 
+    // 2. MOVEMENT INPUT
+    float deltaX = 0.0f;
+    float deltaZ = 0.0f;
 
-    // 3. MOVEMENT INPUT
     float dx = 0.0f;
     float dz = 0.0f;
     
@@ -566,21 +624,13 @@ void update() {
         float cosR = cos(rad);
         float sinR = sin(rad);
 
-        float deltaX = (effectiveDX * cosR - effectiveDZ * sinR);
-        float deltaZ = (effectiveDX * sinR + effectiveDZ * cosR);
-
-        // Try Move X
-        float nextX = camera.x + deltaX;
-        if (!isColliding(nextX, camera.y, camera.z)) {
-            camera.x = nextX;
-        }
-
-        // Try Move Z
-        float nextZ = camera.z + deltaZ;
-        if (!isColliding(camera.x, camera.y, nextZ)) {
-            camera.z = nextZ;
-        }
+        deltaX = (effectiveDX * cosR - effectiveDZ * sinR);
+        deltaZ = (effectiveDX * sinR + effectiveDZ * cosR);
     }
+
+    // 3. PHYSICS: gravity, ground, box collision (shared with the crowd)
+    stepCharacter(broadphase, playerBody, deltaX, deltaZ, deltaTime,
+                  camera.x, camera.y, camera.z, playerVelocityY);
     
     if (keys[' ']) {
          playerVelocityY = 5.0f; 
@@ -590,8 +640,50 @@ void update() {
     for (auto* obj : objects) {
         obj->update(deltaTime);
     }
+    behaviors.update(deltaTime);
+
+    // 5. Systems
+    propagateTransforms(world());
+    broadphase.update(world());
+    navMesh.refreshGates(broadphase); // doors toggle links, no rebake
 
-    glutPostRedisplay();
+    // 6. Crowd, stepped in parallel against the refreshed broadphase
+    {
+        FrameProfiler::Scope scope(profiler(), "agents");
+        agents.step(deltaTime, broadphase, jobs());
+    }
+    {
+        FrameProfiler::Scope scope(profiler(), "particles");
+        particles().step(deltaTime, jobs());
+    }
+
+    // 7. Triggers (player is agent 0, crowd agents follow), dispatched after physics
+    triggers.setAgent(0, { camera.x, camera.y, camera.z }, PLAYER_RADIUS, PLAYER_HEIGHT);
+    for (std::size_t i = 0; i < agents.size(); ++i) {
+        triggers.setAgent((int)i + 1, agents.getPosition(i), agents.getRadius(i), agents.getHeight(i));
+    }
+    triggers.update(broadphase);
+
+    // Reflection probes near moving content need re-rendering
+    markProbesDirty();
+
+    // 8. Stats in the window title, refreshed twice a second
+    if (currentTime - lastTitleTime > 500) {
+        lastTitleTime = currentTime;
+        char title[256];
+        std::snprintf(title, sizeof(title),
+                      "OpenGL Engine - %.1f ms @ %d%% %s | %zu agents: %.2f ms (%.2f us/agent) | %zu particles: %.2f ms"
+                      " | %zu occluded",
+                      profiler().getFrameMs(), (int)(dynamicResolution().getScale() * 100.0f + 0.5f),
+                      qualityGovernor().getTierName(), agents.size(),
+                      profiler().getSectionMs("agents"), agents.getCostPerAgentUs(),
+                      particles().size(), profiler().getSectionMs("particles"), occlusionCuller().getOccluded());
+        glutSetWindowTitle(title);
+    }
+
+    // freeglut never redisplays a hidden window, so headless frames are driven from here
+    if (headless) display();
+    else glutPostRedisplay();
 }
 
 
@@ -621,6 +713,10 @@ void findClosestObject(GameObject* obj, float& closestDist, GameObject*& closest
                               dirX, dirY, dirZ);
         }
     } else {
+        // Trigger volumes are invisible and not interactable
+        CollisionBox* box = dynamic_cast<CollisionBox*>(obj);
+        if (box && box->isTrigger()) return;
+
         // Perform Raycast Hit Check
         Vec3 pos = obj->getRealPosition();
         float toObjX = pos.x - camX;
@@ -677,11 +773,18 @@ void checkInteraction() {
 
 void keyboard(unsigned char key, int x, int y) {
     keys[key] = true;
-    if (key == 27) exit(0); 
+    if (key == 27) {
+        frameCapture().stop();
+        exit(0);
+    }
 
     if (key == 'e' || key == 'E') {
         checkInteraction();
     }
+
+    if (key == 'p' || key == 'P') {
+        renderPoster();
+    }
 }
 
 void keyboardUp(unsigned char key, int x, int y) {
@@ -711,6 +814,26 @@ void mouseMotion(int x, int y) {
     }
 }
 
+/**
+ * @brief Bakes impostor atlases for every Model in a subtree.
+ * @param obj The current node in the scene graph.
+ */
+void bakeImpostors(GameObject* obj) {
+    if (Model* model = dynamic_cast<Model*>(obj)) {
+        model->bakeImpostor([]() { sun.enable(); });
+    }
+    if (Container* container = dynamic_cast<Container*>(obj)) {
+        for (auto* child : container->getChildren()) bakeImpostors(child);
+    }
+}
+
+/**
+ * @brief Bakes impostor atlases for every Model in the scene.
+ */
+void bakeImpostors() {
+    for (auto* obj : objects) bakeImpostors(obj);
+}
+
 /**
  * @brief Initializes the scene, materials, lights, and objects.
  */
@@ -728,7 +851,7 @@ void init() {
     GLfloat fogColor[] = { 0.02f, 0.02f, 0.1f, 1.0f }; 
     glFogfv(GL_FOG_COLOR, fogColor);
     glFogi(GL_FOG_MODE, GL_EXP2);
-    glFogf(GL_FOG_DENSITY, 0.03f); 
+    glFogf(GL_FOG_DENSITY, FOG_DENSITY); 
 
     // 3. COOL AMBIENT
     GLfloat globalAmbient[] = { 0.1f, 0.1f, 0.25f, 1.0f }; 
@@ -748,12 +871,12 @@ void init() {
     matFloor.shininess = 0.0f;
     
     floor->setMaterial(matFloor);
-    objects.push_back(floor);
+    addToScene(floor);
 
 	Container* building = new Container();
 	{
 		// Right Wall
-		Container* wall1 = createGlassWall(20.0f, 5.0f, 1.5f);
+		Container* wall1 = createGlassWall(OUTER_WALL_LAYOUT);
 		wall1->setPosition(9.5f, 0.0f, -10.0f);
 		wall1->setRotation(0, -90, 0); 
 		{
@@ -766,6 +889,7 @@ void init() {
 			neonLight1->setPosition(0.0f, 2.5f, 0.25f);
 			neonLight1->setScale(19.3f, 0.1f, 0.1f);
 			neonLight1->setMaterial(Material::CreateNeon(1, 1, 1));
+			neonLight1->addTag("neon");
 			wall1->addChild(neonLight1);
 			
 			CollisionBox* wall1CollisionBox = new CollisionBox(20.0f, 5.0f, 0.5f);
@@ -776,7 +900,7 @@ void init() {
 		building->addChild(wall1);
 
 		// Left Wall
-		Container* wall2 = createGlassWall(20.0f, 5.0f, 1.5f);
+		Container* wall2 = createGlassWall(OUTER_WALL_LAYOUT);
 		wall2->setPosition(-9.5f, 0.0f, -10.0f);
 		wall2->setRotation(0, -90, 0); 
 		{
@@ -789,6 +913,7 @@ void init() {
 			neonLight2->setPosition(0.0f, 2.5f, -0.25f);
 			neonLight2->setScale(19.3f, 0.1f, 0.1f);
 			neonLight2->setMaterial(Material::CreateNeon(1, 1, 1));
+			neonLight2->addTag("neon");
 			wall2->addChild(neonLight2);
 
 			CollisionBox* wall2CollisionBox = new CollisionBox(20.0f, 5.0f, 0.5f);
@@ -799,7 +924,7 @@ void init() {
 		building->addChild(wall2);
 
 		// Back Wall
-		Container* wall3 = createGlassWall(20.0f, 5.0f, 1.5f);
+		Container* wall3 = createGlassWall(OUTER_WALL_LAYOUT);
 		wall3->setPosition(0.0f, 0.0f, -19.5f);
 		wall3->setRotation(0, 0, 0); 
 		{
@@ -812,6 +937,7 @@ void init() {
 			neonLight3->setPosition(0.0f, 2.5f, 0.25f);
 			neonLight3->setScale(19.3f, 0.1f, 0.1f);
 			neonLight3->setMaterial(Material::CreateNeon(1, 1, 1));
+			neonLight3->addTag("neon");
 			wall3->addChild(neonLight3);
 
 			CollisionBox* wall3CollisionBox = new CollisionBox(20.0f, 5.0f, 0.5f);
@@ -826,13 +952,13 @@ void init() {
 		Container* frontwall = new Container();
 		{
 			// Front Left
-			Container* wall4 = createGlassWall(8.0f, 5.0f, 1.5f);
+			Container* wall4 = createGlassWall(INNER_WALL_LAYOUT);
 			wall4->setPosition(-6.0f, 0.0f, -0.5f);
 			wall4->setRotation(0, 0, 0); 
 			frontwall->addChild(wall4);
 
 			// Front Right
-			Container* wall5 = createGlassWall(8.0f, 5.0f, 1.5f);
+			Container* wall5 = createGlassWall(INNER_WALL_LAYOUT);
 			wall5->setPosition(+6.0f, 0.0f, -0.5f);
 			wall5->setRotation(0, 0, 0); 
 			frontwall->addChild(wall5);
@@ -853,6 +979,7 @@ void init() {
 				{
 					Text3D* neonSign1 = new Text3D("CAR");
 					neonSign1->setMaterial(Material::CreateNeon(1.0f, 0.0f, 0.0f));
+					neonSign1->addTag("neon");
 					neonSign1->setScale(0.6, 0.6, 0.6);
 					neonSign1->setPosition(0.0f, 0.5, 0.0f);
 					signText->addChild(neonSign1);
@@ -861,6 +988,7 @@ void init() {
 					neonSign2->setScale(0.6, 0.6, 0.6);
 					neonSign2->setPosition(0.0f, -0.4, 0.0f);
 					neonSign2->setMaterial(Material::CreateNeon(1.0f, 0.0f, 0.0f));
+					neonSign2->addTag("neon");
 					signText->addChild(neonSign2);
 				}
 				sign->addChild(signText);
@@ -869,8 +997,33 @@ void init() {
 			}
 			wall5->addChild(sign);
 
+			// Sparks falling from the faulty neon sign
+			{
+				EmitterSettings sparks;
+				sparks.rate = 40.0f;
+				sparks.lifetime = 0.6f;
+				sparks.lifetimeJitter = 0.6f;
+				sparks.offset = { 0.0f, -1.0f, 0.0f };
+				sparks.extent = { 2.2f, 0.0f, 0.1f };
+				sparks.direction = { 0.0f, 0.5f, 0.0f };
+				sparks.spread = 1.0f;
+				sparks.speed = 1.5f;
+				sparks.speedJitter = 1.5f;
+				sparks.gravity = { 0.0f, -9.8f, 0.0f };
+				sparks.drag = 0.5f;
+				sparks.sizeStart = 0.025f;
+				sparks.sizeEnd = 0.01f;
+				const float sparkStart[4] = { 1.0f, 0.8f, 0.4f, 1.0f }, sparkEnd[4] = { 1.0f, 0.2f, 0.05f, 0.0f };
+				std::copy(sparkStart, sparkStart + 4, sparks.colorStart);
+				std::copy(sparkEnd, sparkEnd + 4, sparks.colorEnd);
+				sparks.blend = ParticleBlend::Additive;
+				particles().addEmitter(sign, sparks);
+			}
+
 			Container* door = new Container();
 			{
+				BehaviorPool<HingedDoorBehavior>::Handle rightHandle, leftHandle;
+
 				Container* rightCorner = new Container();
 				{
 					Cube* glassCorner = new Cube();
@@ -909,68 +1062,20 @@ void init() {
 					rightDoor->addChild(rightDoorCollision);
 
 					rightDoor->setPosition(-1.3, 0, 0);
-					rightDoor->setUpdateCallback([](GameObject* obj, float dt) {
-						obj->rotateAround(-0.6, 0, 0, 0.0f, -1.0f, 0.0f, 1.0f);
-						return;
-					});
-
-					// ---------------------------------------------------------
-					// RIGHT DOOR INTERACTION
-					// ---------------------------------------------------------
-
-					// Shared State for the Right Door
-					static float currentAngleR = 0.0f;
-					static float targetAngleR = 0.0f;
-
-					// UPDATE CALLBACK (Animation)
-					rightDoor->setUpdateCallback([](GameObject* obj, float dt) {
-						float speed = 120.0f; 
-						float diff = targetAngleR - currentAngleR;
-
-						if (std::abs(diff) < 1.0f) {
-							if (currentAngleR != targetAngleR) {
-								float finalStep = targetAngleR - currentAngleR;
-								// Hinge Pivot: Center is -1.3. Width is 1.5. 
-								// Right Edge (Hinge) is -1.3 + 0.75 = -0.55
-								obj->rotateAround(-0.55f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, finalStep);
-								currentAngleR = targetAngleR;
-							}
-							return;
-						}
-
-						float step = speed * dt;
-						if (step > std::abs(diff)) step = std::abs(diff);
-						if (diff < 0) step = -step;
-
-						// Rotate around Right Hinge (-0.55)
-						obj->rotateAround(-0.55f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, step);
-						currentAngleR += step;
-					});
-
-					// INTERACT CALLBACK (Trigger)
-					rightDoor->setInteractCallback([](GameObject* obj) {
-						if (std::abs(targetAngleR) > 1.0f) {
-							// Close the door
-							targetAngleR = 0.0f;
-						} 
-						else {
-							// OPEN THE DOOR
-							Vec3 doorPos = obj->getRealPosition();
-							float dx = camera.x - doorPos.x;
-							float dz = camera.z - doorPos.z;
-
-							Vec3 rot = obj->getRealRotation();
-							float rad = rot.y * 3.14159f / 180.0f;
-							float fwdX = std::sin(rad); 
-							float fwdZ = std::cos(rad);
-
-							float dot = dx * fwdX + dz * fwdZ;
-
-							// INVERTED LOGIC compared to Left Door:
-							targetAngleR = (dot > 0) ? -90.0f : 90.0f;
-						}
+					rightDoor->setName("frontDoorRight");
+					rightDoor->addTag("door");
+
+					// Hinge Pivot: Center is -1.3. Width is 1.5.
+					// Right Edge (Hinge) is -1.3 + 0.75 = -0.55
+					// Opens in the opposite direction to the left door.
+					HingedDoorBehavior hinge;
+					hinge.hingeX = -0.55f;
+					hinge.openAngle = -90.0f;
+					rightHandle = behaviors.attach(rightDoor, hinge);
+
+					rightDoor->setInteractCallback([rightHandle](GameObject* obj) {
+						behaviors.pool<HingedDoorBehavior>().get(rightHandle).toggle(obj, camera.x, camera.z);
 					});
-
 				}
 				door->addChild(rightDoor);
 
@@ -987,64 +1092,44 @@ void init() {
 					leftDoor->addChild(knob);
 
 					leftDoor->setPosition(-2.8, 0, 0);
-
-					// Shared State for this specific door
-					static float currentAngle = 0.0f;
-					static float targetAngle = 0.0f;
+					leftDoor->setName("frontDoorLeft");
+					leftDoor->addTag("door");
 
 					CollisionBox* leftDoorCollision = new CollisionBox(1.5, 2.1, 0.1);
 					leftDoor->addChild(leftDoorCollision);
 					physicsObjects.push_back(leftDoorCollision);
 
+					// Hinge Pivot: Door is at -2.8, Width is 1.5. Left Edge is -2.8 - 0.75 = -3.55
+					HingedDoorBehavior hinge;
+					hinge.hingeX = -3.55f;
+					leftHandle = behaviors.attach(leftDoor, hinge);
 
-					// THE UPDATE CALLBACK (Animation Logic)
-					leftDoor->setUpdateCallback([](GameObject* obj, float dt) {
-						float speed = 120.0f; 
-						float diff = targetAngle - currentAngle;
-
-						if (std::abs(diff) < 1.0f) {
-							if (currentAngle != targetAngle) {
-								float finalStep = targetAngle - currentAngle;
-								// Hinge Pivot: Door is at -2.8, Width is 1.5. Left Edge is -2.8 - 0.75 = -3.55
-								obj->rotateAround(-3.55f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, finalStep);
-								currentAngle = targetAngle;
-							}
-							return;
-						}
-
-						float step = speed * dt;
-						if (step > std::abs(diff)) step = std::abs(diff);
-						if (diff < 0) step = -step;
-
-						// Apply Rotation
-						obj->rotateAround(-3.55f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, step);
-
-						// Update state
-						currentAngle += step;
-					});
-
-					// THE INTERACT CALLBACK (Trigger Logic)
-					leftDoor->setInteractCallback([](GameObject* obj) {
-						if (std::abs(targetAngle) > 1.0f) {
-							targetAngle = 0.0f;
-						} 
-						else {
-							Vec3 doorPos = obj->getRealPosition();
-							float dx = camera.x - doorPos.x;
-							float dz = camera.z - doorPos.z;
-
-							Vec3 rot = obj->getRealRotation();
-							float rad = rot.y * 3.14159f / 180.0f;
-							float fwdX = std::sin(rad); 
-							float fwdZ = std::cos(rad);
-
-							float dot = dx * fwdX + dz * fwdZ;
-
-							targetAngle = (dot > 0) ? 90.0f : -90.0f;
-						}
+					leftDoor->setInteractCallback([leftHandle](GameObject* obj) {
+						behaviors.pool<HingedDoorBehavior>().get(leftHandle).toggle(obj, camera.x, camera.z);
 					});
 				}
 				door->addChild(leftDoor);
+
+				// Auto-open: a trigger spanning both sides of the doorway swings the
+				// doors away from whoever walks in and closes them once it is empty.
+				CollisionBox* doorTrigger = new CollisionBox(3.2f, 2.2f, 4.0f);
+				doorTrigger->setPosition(-2.05f, 0.0f, 0.0f);
+				door->addChild(doorTrigger);
+				physicsObjects.push_back(doorTrigger);
+
+				triggers.addTrigger(doorTrigger, [rightHandle, leftHandle](const TriggerEvent& ev) {
+					BehaviorPool<HingedDoorBehavior>& doors = behaviors.pool<HingedDoorBehavior>();
+					HingedDoorBehavior& right = doors.get(rightHandle);
+					HingedDoorBehavior& left = doors.get(leftHandle);
+
+					if (ev.type == TriggerEventType::Enter && ev.occupants == 1) {
+						right.open(doors.getOwner(rightHandle), ev.agentPosition.x, ev.agentPosition.z);
+						left.open(doors.getOwner(leftHandle), ev.agentPosition.x, ev.agentPosition.z);
+					} else if (ev.type == TriggerEventType::Exit && ev.occupants == 0) {
+						right.close();
+						left.close();
+					}
+				});
 				door->setScale(1, 0.95, 1);
 				door->setPosition(-4, 1.2, 0);
 			}
@@ -1077,6 +1162,7 @@ void init() {
 			cubeNeon->setScale(3, 0.1, 15);
 			cubeNeon->setPosition(0, -0.2, 0);
 			cubeNeon->setMaterial(Material::CreateNeon(1, 1, 1));
+			cubeNeon->addTag("neon");
 			roof->addChild(cubeNeon);
 
 			float rfactor = 0.2;
@@ -1089,6 +1175,7 @@ void init() {
 			cubeMirror->setScale(2.5, 0.2, 2.2);
 			cubeMirror->setPosition(0, -0.3, 6);
 			cubeMirror->setMaterial(Material::CreateGlass());
+			cubeMirror->addTag("mirror");
 			roof->addChild(cubeMirror);
 
 			for (int i = 0; i < 4; i++) {
@@ -1117,6 +1204,7 @@ void init() {
 				mirrorPane->setScale(2.0, 0.05f, 2.0f);
 				mirrorPane->setPosition(0.0, 0.2f, -2 - 4 * i);
 				mirrorPane->setMaterial(Material::CreateGlass());
+				mirrorPane->addTag("mirror");
 				base->addChild(mirrorPane);
 			}
 
@@ -1125,6 +1213,7 @@ void init() {
 			mirrorPane1->setPosition(5, 0.2f, -6.5);
 			mirrorPane1->setRotation(0, 45, 0);
 			mirrorPane1->setMaterial(Material::CreateGlass());
+			mirrorPane1->addTag("mirror");
 			base->addChild(mirrorPane1);
 
 			Cube* mirrorPane2 = new Cube();
@@ -1132,6 +1221,7 @@ void init() {
 			mirrorPane2->setPosition(-5, 0.2f, -6.5);
 			mirrorPane2->setRotation(0, 45, 0);
 			mirrorPane2->setMaterial(Material::CreateGlass());
+			mirrorPane2->addTag("mirror");
 			base->addChild(mirrorPane2);
 
 			Cube* mirrorPane3 = new Cube();
@@ -1139,13 +1229,14 @@ void init() {
 			mirrorPane3->setPosition(5, 0.2f, -13);
 			mirrorPane3->setRotation(0, 45, 0);
 			mirrorPane3->setMaterial(Material::CreateGlass());
+			mirrorPane3->addTag("mirror");
 			base->addChild(mirrorPane3);
 		}
 		building->addChild(base);
 
 		// Inside
 
-		Container* inwall1 = createGlassWall(8.0f, 5.0f, 1.5f);
+		Container* inwall1 = createGlassWall(INNER_WALL_LAYOUT);
 		inwall1->setPosition(2.8f, 0.0f, -4.0f);
 		inwall1->setRotation(0, -90, 0); 
 		CollisionBox* inwall1CollisionBox = new CollisionBox(7.0f, 5.0f, 0.5f);
@@ -1154,7 +1245,7 @@ void init() {
 		physicsObjects.push_back(inwall1CollisionBox);
 		building->addChild(inwall1);
 		
-		Container* inwall2 = createGlassWall(8.0f, 5.0f, 1.5f);
+		Container* inwall2 = createGlassWall(INNER_WALL_LAYOUT);
 		inwall2->setPosition(-2.8f, 0.0f, -4.0f);
 		inwall2->setRotation(0, -90, 0); 
 		CollisionBox* inwall2CollisionBox = new CollisionBox(7.0f, 5.0f, 0.5f);
@@ -1163,7 +1254,7 @@ void init() {
 		physicsObjects.push_back(inwall2CollisionBox);
 		building->addChild(inwall2);
 
-		Container* inwall3 = createGlassWall(8.0f, 5.0f, 1.5f);
+		Container* inwall3 = createGlassWall(INNER_WALL_LAYOUT);
 		inwall3->setPosition(-2.8f, 0.0f, -16.0f);
 		inwall3->setRotation(0, -90, 0); 
 		CollisionBox* inwall3CollisionBox = new CollisionBox(7.0f, 5.0f, 0.5f);
@@ -1172,7 +1263,7 @@ void init() {
 		physicsObjects.push_back(inwall3CollisionBox);
 		building->addChild(inwall3);
 
-		Container* inwall4 = createGlassWall(8.0f, 5.0f, 1.5f);
+		Container* inwall4 = createGlassWall(INNER_WALL_LAYOUT);
 		inwall4->setPosition(2.8f, 0.0f, -16.0f);
 		inwall4->setRotation(0, -90, 0); 
 		CollisionBox* inwall4CollisionBox = new CollisionBox(7.0f, 5.0f, 0.5f);
@@ -1181,7 +1272,7 @@ void init() {
 		physicsObjects.push_back(inwall4CollisionBox);
 		building->addChild(inwall4);
 
-		Container* inwall5 = createGlassWall(8.0f, 5.0f, 1.5f);
+		Container* inwall5 = createGlassWall(INNER_WALL_LAYOUT);
 		inwall5->setPosition(6.f, 0.0f, -10.0f);
 		CollisionBox* inwall5CollisionBox = new CollisionBox(7.0f, 5.0f, 0.5f);
 		inwall5CollisionBox->setPosition(0.0f, 2.5f, 0.0f);
@@ -1189,7 +1280,7 @@ void init() {
 		physicsObjects.push_back(inwall5CollisionBox);
 		building->addChild(inwall5);
 
-		Container* inwall6 = createGlassWall(8.0f, 5.0f, 1.5f);
+		Container* inwall6 = createGlassWall(INNER_WALL_LAYOUT);
 		inwall6->setPosition(-6.f, 0.0f, -10.0f);
 		CollisionBox* inwall6CollisionBox = new CollisionBox(7.0f, 5.0f, 0.5f);
 		inwall6CollisionBox->setPosition(0.0f, 2.5f, 0.0f);
@@ -1216,6 +1307,7 @@ void init() {
 			pod1->addChild(mainPod);
 
 			pod1->setScale(1.5, 1, 1.5);
+			pod1->addTag("pod");
 			pod1->setPosition(-7.2, 0, -2.9);
 		}
 		building->addChild(pod1);
@@ -1237,29 +1329,29 @@ void init() {
 
 
 	}
-	objects.push_back(building);
+	addToScene(building);
 
 	// =======  ROOM 3 ====== 
-	Container* glassTable =  createGlassTable(2, 0.8, 1);
+	Container* glassTable =  createGlassTable(GLASS_TABLE_LAYOUT);
 	glassTable->setPosition(8, 0, -16);
 	glassTable->setRotation(0, 0, 0);
-	objects.push_back(glassTable);
+	addToScene(glassTable);
 
     // 1. Red Chair
     Container* redChair = createModernChair(0.6f, 0.1f, 0.1f);
     redChair->setPosition(7.0f, 0.0f, -17.0f);
     redChair->setRotation(0.0f, 45.0f, 0.0f); 
-    objects.push_back(redChair);
+    addToScene(redChair);
 
     // 2. Blue Chair
     Container* blueChair = createModernChair(1.0f, 1.0f, 0.6f);
     blueChair->setPosition(8.0f, 0.0f, -17.0f);
-    objects.push_back(blueChair);
+    addToScene(blueChair);
 
     // 3. Green Chair
     Container* greenChair = createModernChair(0.1f, 0.6f, 0.1f);
     greenChair->setPosition(9.0f, 0.0f, -17.0f);
-    objects.push_back(greenChair);
+    addToScene(greenChair);
 
     // Chair 1
     Container* chair1Container = new Container();
@@ -1276,7 +1368,7 @@ void init() {
         chair1Container->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(chair1Container);
+    addToScene(chair1Container);
 
     // Chair 2
     Container* chair2Container = new Container();
@@ -1292,7 +1384,7 @@ void init() {
         chair2Container->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(chair2Container);
+    addToScene(chair2Container);
 
     // Table (Wooden)
     Container* tableContainer = new Container();
@@ -1308,7 +1400,7 @@ void init() {
         tableContainer->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(tableContainer);
+    addToScene(tableContainer);
 
     // Sofa 1
     Container* sofa1Container = new Container();
@@ -1325,7 +1417,7 @@ void init() {
         sofa1Container->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(sofa1Container);
+    addToScene(sofa1Container);
 
     // Sofa 2
     Container* sofa2Container = new Container();
@@ -1340,7 +1432,7 @@ void init() {
         sofa2Container->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(sofa2Container);
+    addToScene(sofa2Container);
 
     // Tesla Car
     Container* teslaContainer = new Container();
@@ -1356,13 +1448,52 @@ void init() {
         teslaContainer->addChild(box);
         physicsObjects.push_back(box);
 
-        teslaContainer->setUpdateCallback([](GameObject* obj, float dt) {
-            float speed = 20.0f;
-            Vec3 p = obj->getPosition();
-            obj->rotateAround(p.x, p.y, p.z, 0.0f, 1.0f, 0.0f, speed * dt);
-        });
+        behaviors.attach(teslaContainer, SpinBehavior{ 20.0f });
+        teslaContainer->setName("tesla");
+        teslaContainer->addTag("car");
+    }
+    addToScene(teslaContainer);
+
+    // Wall screens: a close-up of the Tesla on its turntable, and a security camera
+    // over the showroom shown on two screens (one shared render)
+    {
+        DisplayView closeUp;
+        closeUp.eye = { -4.6f, 1.4f, -5.6f };
+        closeUp.target = { -7.15f, 0.8f, -8.36f };
+        closeUp.fov = 35.0f;
+        closeUp.width = 320;
+        closeUp.height = 180;
+        closeUp.refreshHz = 15.0f;
+        closeUp.lodBias = 1.0f;
+        closeUp.drawDistance = 15.0f;
+
+        DisplayScreen* teslaScreen = new DisplayScreen(sceneDisplays().addView(closeUp));
+        teslaScreen->setPosition(-9.1f, 2.2f, -12.5f);
+        teslaScreen->setRotation(0, 90, 0);
+        teslaScreen->setScale(2.4f, 1.35f, 0.1f);
+        teslaScreen->setName("teslaScreen");
+        addToScene(teslaScreen);
+
+        DisplayView securityCam;
+        securityCam.eye = { 8.5f, 4.6f, -1.0f };
+        securityCam.target = { 0.0f, 0.0f, -12.0f };
+        securityCam.fov = 60.0f;
+        securityCam.width = 256;
+        securityCam.height = 144;
+        securityCam.refreshHz = 5.0f;
+        securityCam.lodBias = 3.0f;
+        securityCam.drawDistance = 30.0f;
+        int securityView = sceneDisplays().addView(securityCam);
+
+        const float securityX[2] = { -4.0f, 4.0f };
+        for (float x : securityX) {
+            DisplayScreen* screen = new DisplayScreen(securityView);
+            screen->setPosition(x, 3.2f, -19.0f);
+            screen->setScale(1.6f, 0.9f, 0.1f);
+            screen->addTag("securityScreen");
+            addToScene(screen);
+        }
     }
-    objects.push_back(teslaContainer);
 
     // Low Poly Car
     Container* lowPolyCarContainer = new Container();
@@ -1378,13 +1509,11 @@ void init() {
         lowPolyCarContainer->addChild(box);
         physicsObjects.push_back(box);
 
-        lowPolyCarContainer->setUpdateCallback([](GameObject* obj, float dt) {
-            float speed = 20.0f;
-            Vec3 p = obj->getPosition();
-            obj->rotateAround(p.x, p.y, p.z, 0.0f, 1.0f, 0.0f, speed * dt);
-        });
+        behaviors.attach(lowPolyCarContainer, SpinBehavior{ 20.0f });
+        lowPolyCarContainer->setName("lowPolyCar");
+        lowPolyCarContainer->addTag("car");
     }
-    objects.push_back(lowPolyCarContainer);
+    addToScene(lowPolyCarContainer);
 
     // Corvette
     Container* corvetteContainer = new Container();
@@ -1400,13 +1529,32 @@ void init() {
         corvetteContainer->addChild(box);
         physicsObjects.push_back(box);
 
-        corvetteContainer->setUpdateCallback([](GameObject* obj, float dt) {
-            float speed = 20.0f;
-            Vec3 p = obj->getPosition();
-            obj->rotateAround(p.x, p.y, p.z, 0.0f, 1.0f, 0.0f, speed * dt);
-        });
+        behaviors.attach(corvetteContainer, SpinBehavior{ 20.0f });
+        corvetteContainer->setName("corvette");
+        corvetteContainer->addTag("car");
+
+        // Idling exhaust, turning with the car
+        EmitterSettings exhaust;
+        exhaust.rate = 60.0f;
+        exhaust.lifetime = 2.5f;
+        exhaust.lifetimeJitter = 1.0f;
+        exhaust.offset = { 0.4f, 0.35f, -2.1f };
+        exhaust.extent = { 0.03f, 0.03f, 0.0f };
+        exhaust.direction = { 0.0f, 0.15f, -1.0f };
+        exhaust.spread = 0.25f;
+        exhaust.speed = 0.6f;
+        exhaust.speedJitter = 0.3f;
+        exhaust.gravity = { 0.0f, 0.15f, 0.0f };
+        exhaust.drag = 0.8f;
+        exhaust.sizeStart = 0.05f;
+        exhaust.sizeEnd = 0.35f;
+        const float smokeStart[4] = { 0.7f, 0.7f, 0.72f, 0.35f }, smokeEnd[4] = { 0.8f, 0.8f, 0.82f, 0.0f };
+        std::copy(smokeStart, smokeStart + 4, exhaust.colorStart);
+        std::copy(smokeEnd, smokeEnd + 4, exhaust.colorEnd);
+        exhaust.blend = ParticleBlend::Alpha;
+        particles().addEmitter(corvetteContainer, exhaust);
     }
-    objects.push_back(corvetteContainer);
+    addToScene(corvetteContainer);
 
     // Rocks (Group 1)
     Container* rocks1Container = new Container();
@@ -1420,7 +1568,7 @@ void init() {
         rocks1Container->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(rocks1Container);
+    addToScene(rocks1Container);
 
     // Rocks (Group 2)
     Container* rocks2Container = new Container();
@@ -1434,7 +1582,7 @@ void init() {
         rocks2Container->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(rocks2Container);
+    addToScene(rocks2Container);
 
     // Rocks (Group 3)
     Container* rocks3Container = new Container();
@@ -1448,7 +1596,7 @@ void init() {
         rocks3Container->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(rocks3Container);
+    addToScene(rocks3Container);
 
     // Rocks (Group 4)
     Container* rocks4Container = new Container();
@@ -1462,7 +1610,7 @@ void init() {
         rocks4Container->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(rocks4Container);
+    addToScene(rocks4Container);
 
     // Plant 1
     Container* plant1Container = new Container();
@@ -1477,7 +1625,7 @@ void init() {
         plant1Container->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(plant1Container);
+    addToScene(plant1Container);
 
     // Plant 2
     Container* plant2Container = new Container();
@@ -1493,7 +1641,7 @@ void init() {
         plant2Container->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(plant2Container);
+    addToScene(plant2Container);
 
     // Coffee Table (Table 2)
     Container* coffeeTableContainer = new Container();
@@ -1507,7 +1655,7 @@ void init() {
         coffeeTableContainer->addChild(box);
         physicsObjects.push_back(box);
     }
-    objects.push_back(coffeeTableContainer);
+    addToScene(coffeeTableContainer);
 
     // Lights
 	// Light inside the Tesla area (Cyan/Blue "Tech" feel)
@@ -1521,6 +1669,104 @@ void init() {
     
     // Back fill light (Soft White)
     pointLights.push_back(PointLight(5, -6.96, 3, -22.02,    0.8f, 0.8f, 0.9f, 0.5f));   
+
+    // Physics: bucket every collider once the scene transforms are known
+    propagateTransforms(world());
+    for (auto* obj : physicsObjects) {
+        broadphase.addHierarchy(obj);
+    }
+    broadphase.update(world());
+
+    // Static opaque primitives: packed for compute culling and one indirect draw
+    if (indirectScene().build(objects) > 0) {
+        LOG_INFO("Indirect scene: %zu objects, %zu meshes, %zu triangles", indirectScene().size(),
+                 indirectScene().meshCount(), indirectScene().triangleCount());
+    }
+
+    // Impostors: pre-render every model (shared per file) while the back buffer is free,
+    // once the loader has finished their textures
+    resourceLoader().finish();
+    bakeImpostors();
+
+    // Reflection probes: one inside the showroom, one outside the entrance
+    reflectionProbes().add({ 0.0f, 2.5f, -10.0f }, 12.0f);
+    reflectionProbes().add({ 0.0f, 2.0f, 6.0f }, 10.0f);
+
+    // HLOD: merged, simplified proxies for the building, pods and rooms
+    std::size_t proxies = buildHLOD(objects, []() {
+        sun.enable();
+        for (auto& l : pointLights) l.enable();
+    });
+    LOG_INFO("HLOD: %zu proxies", proxies);
+
+    // Planar shadows: static casters flattened once into cached ground tiles
+    planarShadows().build(objects, SHADOW_LIGHT, GROUND_PLANE);
+    LOG_INFO("Planar shadows: %zu cached triangles, %zu moving casters", planarShadows().cachedTriangles(),
+             planarShadows().movingCasters());
+
+    // Navigation: bake over the floor plane (spans -1..1 scaled); doors become gates
+    {
+        Vec3 fp = floor->getPosition(), fs = floor->getScale();
+        AABB floorBounds = { { fp.x - fs.x, fp.y, fp.z - fs.z }, { fp.x + fs.x, fp.y, fp.z + fs.z } };
+
+        NavBakeSettings nav;
+        nav.gateTag = SceneIndex::tag("door");
+        nav.useGates = true;
+
+        int bakeStart = glutGet(GLUT_ELAPSED_TIME);
+        navMesh.bake(broadphase, floorBounds, nav, jobs());
+        LOG_INFO("NavMesh: %zu regions, %zu gates (%d ms)", navMesh.getRegions().size(), navMesh.gateCount(),
+                 glutGet(GLUT_ELAPSED_TIME) - bakeStart);
+    }
+
+    // Crowd: visitors wander inside the showroom floor
+    agents.setArea(-9.0f, -24.0f, 9.0f, -6.0f);
+    agents.setNavigation(&pathService);
+    agents.spawn(agentCount, broadphase, { 0.25f, 1.5f, GRAVITY }, 1.5f);
+
+    // Dust drifting in the showroom air
+    {
+        EmitterSettings dust;
+        dust.rate = 60.0f;
+        dust.lifetime = 8.0f;
+        dust.lifetimeJitter = 4.0f;
+        dust.offset = { 0.0f, 1.6f, -15.0f };
+        dust.extent = { 9.0f, 1.4f, 9.0f };
+        dust.direction = { 0.0f, 0.0f, 0.0f };
+        dust.spread = 0.3f;
+        dust.speed = 0.05f;
+        dust.speedJitter = 0.05f;
+        dust.drag = 0.1f;
+        dust.sizeStart = dust.sizeEnd = 0.012f;
+        const float dustStart[4] = { 1.0f, 0.95f, 0.85f, 0.35f }, dustEnd[4] = { 1.0f, 0.95f, 0.85f, 0.0f };
+        std::copy(dustStart, dustStart + 4, dust.colorStart);
+        std::copy(dustEnd, dustEnd + 4, dust.colorEnd);
+        dust.blend = ParticleBlend::Alpha;
+        particles().addEmitter(nullptr, dust);
+    }
+
+    // Stress test: a fountain keeping about particleCount particles alive
+    if (particleCount > 0) {
+        EmitterSettings fountain;
+        fountain.lifetime = 1.6f;
+        fountain.lifetimeJitter = 0.4f;
+        fountain.rate = particleCount / (fountain.lifetime + fountain.lifetimeJitter * 0.5f);
+        fountain.maxParticles = particleCount;
+        fountain.offset = { 0.0f, 0.2f, -15.0f };
+        fountain.extent = { 0.1f, 0.0f, 0.1f };
+        fountain.direction = { 0.0f, 1.0f, 0.0f };
+        fountain.spread = 0.35f;
+        fountain.speed = 7.0f;
+        fountain.speedJitter = 2.0f;
+        fountain.gravity = { 0.0f, -9.8f, 0.0f };
+        fountain.sizeStart = 0.02f;
+        fountain.sizeEnd = 0.015f;
+        const float waterStart[4] = { 0.4f, 0.7f, 1.0f, 0.6f }, waterEnd[4] = { 0.2f, 0.4f, 1.0f, 0.0f };
+        std::copy(waterStart, waterStart + 4, fountain.colorStart);
+        std::copy(waterEnd, waterEnd + 4, fountain.colorEnd);
+        fountain.blend = ParticleBlend::Additive;
+        particles().addEmitter(nullptr, fountain);
+    }
 }
 
 /**
@@ -1530,16 +1776,13 @@ void init() {
  */
 void reshape(int w, int h) {
     if (h == 0) h = 1;
+    if (headless) return; // the frame size is the capture size
     
     windowWidth = w;
     windowHeight = h;
 
-    float ratio = w * 1.0 / h;
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
     glViewport(0, 0, w, h);
-	gluPerspective(45.0f, ratio, 0.1f, 200.0f);
-    glMatrixMode(GL_MODELVIEW);
+    applyProjection();
 }
 
 /**
@@ -1547,13 +1790,108 @@ void reshape(int w, int h) {
  * * Initializes GLUT, configures the window, sets up callbacks, and enters the main loop.
  */
 int main(int argc, char** argv) {
+    ResourceLoader::initThreads();
     glutInit(&argc, argv);
+
+    // Remaining arguments (GLUT removed its own)
+    int pinnedTier = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--agents=", 9) == 0) {
+            agentCount = std::strtoul(argv[i] + 9, nullptr, 10);
+        }
+        if (std::strncmp(argv[i], "--particles=", 12) == 0) {
+            particleCount = std::strtoul(argv[i] + 12, nullptr, 10);
+        }
+        if (std::strcmp(argv[i], "--oit") == 0) {
+            renderSettings().oitEnabled = true;
+        }
+        if (std::strncmp(argv[i], "--transparent-scale=", 20) == 0) {
+            renderSettings().transparencyResolutionScale = (float)std::atof(argv[i] + 20);
+            renderSettings().maxTransparencyResolutionScale = renderSettings().transparencyResolutionScale;
+        }
+        if (std::strncmp(argv[i], "--frame-budget=", 15) == 0) {
+            renderSettings().frameBudgetMs = (float)std::atof(argv[i] + 15);
+        }
+        if (std::strcmp(argv[i], "--no-dynres") == 0) {
+            renderSettings().dynamicResolutionEnabled = false;
+        }
+        if (std::strcmp(argv[i], "--no-displays") == 0) {
+            renderSettings().displaysEnabled = false;
+        }
+        if (std::strcmp(argv[i], "--no-indirect") == 0) {
+            renderSettings().indirectEnabled = false;
+        }
+        if (std::strcmp(argv[i], "--no-occlusion") == 0) {
+            renderSettings().occlusionCullingEnabled = false;
+        }
+        if (std::strncmp(argv[i], "--quality=", 10) == 0) {
+            // A fixed tier: the governor stays off
+            renderSettings().qualityGovernorEnabled = false;
+            pinnedTier = std::atoi(argv[i] + 10);
+        }
+        if (std::strncmp(argv[i], "--capture=", 10) == 0) {
+            capturePath = argv[i] + 10;
+        }
+        if (std::strncmp(argv[i], "--capture-fps=", 14) == 0) {
+            captureFps = std::max(1, std::atoi(argv[i] + 14));
+        }
+        if (std::strncmp(argv[i], "--capture-frames=", 17) == 0) {
+            captureFrameLimit = std::atol(argv[i] + 17);
+        }
+        if (std::strncmp(argv[i], "--capture-size=", 15) == 0) {
+            std::sscanf(argv[i] + 15, "%dx%d", &windowWidth, &windowHeight);
+        }
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        }
+        if (std::strncmp(argv[i], "--poster=", 9) == 0) {
+            posterPath = argv[i] + 9;
+            posterOnStart = true;
+        }
+        if (std::strncmp(argv[i], "--poster-size=", 14) == 0) {
+            std::sscanf(argv[i] + 14, "%dx%d", &posterWidth, &posterHeight);
+        }
+    }
+    // After every flag, so --transparent-scale caps the tier wherever it appears
+    if (!renderSettings().qualityGovernorEnabled) qualityGovernor().apply(pinnedTier, renderSettings());
+
     glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
     glutInitWindowSize(800, 600);
     glutCreateWindow("OpenGL Engine");
-	glutFullScreen();
 
+    if (headless) {
+        // Offline render: fixed size, full quality, as fast as the encoder allows
+        if (capturePath.empty()) capturePath = "capture";
+        glutHideWindow();
+        renderSettings().dynamicResolutionEnabled = false;
+        renderSettings().qualityGovernorEnabled = false;
+    } else {
+        windowWidth = 800;
+        windowHeight = 600;
+        glutFullScreen();
+    }
+
+    // Textures and mesh buffers are created on the loader thread from here on
+    resourceLoader().start();
+
+    // A hidden window owns no pixels, so headless start-up bakes into the capture target too
+    bool offscreenInit = headless && frameCapture().beginOffscreen(windowWidth, windowHeight);
     init();
+    if (offscreenInit) frameCapture().endOffscreen();
+
+    if (posterOnStart) {
+        renderPoster();
+        if (headless) return 0;
+    }
+
+    if (!capturePath.empty()) {
+        bool video = capturePath.size() > 4 && capturePath.compare(capturePath.size() - 4, 4, ".y4m") == 0;
+        if (!frameCapture().start(capturePath, video ? CaptureFormat::Y4m : CaptureFormat::Png, captureFps)) {
+            // Headless frames are only ever seen through the capture
+            if (headless) return 1;
+            LOG_WARNING("Capture: continuing without recording");
+        }
+    }
 
     glutDisplayFunc(display);
     glutIdleFunc(update);
@@ -0,0 +1,96 @@
+/**
+ * @file NavigationTest.cpp
+ * @brief Checks that a door gate in the NavMesh opens and closes with its door.
+ *
+ * A wall with a single 1.5-unit doorway splits the floor in two. The door is
+ * swung 90 degrees about its hinge like HingedDoorBehavior does, and paths
+ * across the wall must exist only while it is open, passing through the doorway.
+ */
+
+#include "Container.h"
+#include "JobSystem.h"
+#include "Navigation.h"
+#include "Physics.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+/** @brief Centre of the doorway and its 1.5-unit door. */
+static const float DOOR_X = 0.23f;
+
+/** @brief The door's hinge, at the doorway's left edge. */
+static const float HINGE_X = DOOR_X - 0.75f;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    std::printf("%s: %s\n", condition ? "ok" : "FAILED", what);
+    if (!condition) ++failures;
+}
+
+/** @brief Checks that a path crosses the wall (z = 0) inside the doorway. */
+static bool passesDoorway(Vec3 start, const std::vector<Vec3>& path) {
+    Vec3 a = start;
+    for (const Vec3& b : path) {
+        if ((a.z < 0.0f) != (b.z < 0.0f)) {
+            float x = a.x + (b.x - a.x) * (0.0f - a.z) / (b.z - a.z);
+            return std::fabs(x - DOOR_X) < 0.75f;
+        }
+        a = b;
+    }
+    return false;
+}
+
+int main() {
+    JobSystem pool(2);
+    Broadphase broadphase;
+
+    // Wall along z = 0 from x = -10 to 10, with a doorway over -0.52 < x < 0.98.
+    // Off the cell grid on purpose: the cells next to the hinge are clear of the
+    // wall but still covered by the open door.
+    CollisionBox* leftWall = new CollisionBox(9.48f, 2.1f, 0.2f);
+    leftWall->setPosition(-5.26f, 1.05f, 0.0f);
+    CollisionBox* rightWall = new CollisionBox(9.02f, 2.1f, 0.2f);
+    rightWall->setPosition(5.49f, 1.05f, 0.0f);
+
+    Container* door = new Container();
+    door->addChild(new CollisionBox(1.5f, 2.1f, 0.1f));
+    door->setPosition(DOOR_X, 1.05f, 0.0f);
+    door->addTag("door");
+
+    propagateTransforms(world());
+    broadphase.addHierarchy(leftWall);
+    broadphase.addHierarchy(rightWall);
+    broadphase.addHierarchy(door);
+    broadphase.update(world());
+
+    NavBakeSettings settings;
+    settings.gateTag = SceneIndex::tag("door");
+    settings.useGates = true;
+    NavMesh mesh;
+    mesh.bake(broadphase, { { -10.0f, 0.0f, -10.0f }, { 10.0f, 0.0f, 10.0f } }, settings, pool);
+    PathService paths(mesh);
+
+    Vec3 start = { 0.0f, 0.0f, -5.0f };
+    Vec3 goal = { 0.0f, 0.0f, 5.0f };
+    std::vector<Vec3> path;
+
+    check(mesh.gateCount() == 1, "the door becomes a gate");
+    check(!paths.findPath(start, goal, path), "no path while the door is closed");
+
+    // Swing open about the hinge at the doorway's left edge
+    door->rotateAround(HINGE_X, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 90.0f);
+    propagateTransforms(world());
+    broadphase.update(world());
+    check(mesh.refreshGates(broadphase), "opening the door changes the gate");
+    check(paths.findPath(start, goal, path), "a path exists once the door is open");
+    check(passesDoorway(start, path), "the path goes through the doorway");
+
+    door->rotateAround(HINGE_X, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, -90.0f);
+    propagateTransforms(world());
+    broadphase.update(world());
+    check(mesh.refreshGates(broadphase), "closing the door changes the gate");
+    check(!paths.findPath(start, goal, path), "no path once the door is closed again");
+
+    return failures == 0 ? 0 : 1;
+}